@@ -7,9 +7,17 @@ namespace reinforcement_learning {  namespace name {
       const char *const  MODEL_REFRESH_INTERVAL_MS = "model.refreshintervalms";
       const char *const  MODEL_IMPLEMENTATION    = "model.implementation";       // VW vs other ML
       const char *const  MODEL_BACKGROUND_REFRESH = "model.backgroundrefresh";
+      const char *const  MODEL_DOWNLOAD_RANGES   = "model.download.ranges";      // Concurrent Range requests per model download, 1 disables ranged downloads
+      const char *const  MODEL_DOWNLOAD_RANGE_RETRIES = "model.download.range.retries";
+      const char *const  MODEL_DOWNLOAD_MIN_RANGE_KB = "model.download.min_range_kb";
+      const char *const  MODEL_DOWNLOAD_RETRIES  = "model.download.retries";     // Retries of model HEAD / GET requests failing with a server error
+      const char *const  MODEL_DOWNLOAD_STREAMING = "model.download.streaming";  // Load the model while it downloads
+      const char *const  MODEL_DOWNLOAD_STREAM_BUFFER_KB = "model.download.stream_buffer_kb";
       const char *const  MODEL_VW_INITIAL_COMMAND_LINE = "model.vw.initial_command_line";
       const char *const  VW_CMDLINE              = "vw.commandline";
       const char *const  VW_POOL_INIT_SIZE       = "vw.pool.init.size";
+      const char *const  MODEL_CACHE_SIZE        = "model.cache.size";           // Number of loaded model versions kept for pinning / rollback
+      const char *const  MODEL_CACHE_MAX_MB      = "model.cache.max_mb";         // Memory budget for cached model versions
       const char *const  INITIAL_EPSILON         = "initial_exploration.epsilon";
       const char *const  LEARNING_MODE           = "rank.learning.mode";
       const char* const  PROTOCOL_VERSION             = "protocol.version";
@@ -21,6 +29,7 @@ namespace reinforcement_learning {  namespace name {
       const char *const  INTERACTION_EH_KEY      = "interaction.eventhub.key";
       const char *const  INTERACTION_EH_TASKS_LIMIT = "interaction.eventhub.tasks_limit";
       const char *const  INTERACTION_EH_MAX_HTTP_RETRIES = "interaction.eventhub.max_http_retries";
+      const char *const  INTERACTION_EH_CONNECTIONS = "interaction.eventhub.connections";  // Independent http clients, each with its own tasks limit
       const char *const  INTERACTION_SEND_HIGH_WATER_MARK     = "interaction.send.highwatermark";
       const char *const  INTERACTION_SEND_QUEUE_MAX_CAPACITY_KB    = "interaction.send.queue.maxcapacity.kb";
       const char *const  INTERACTION_SEND_BATCH_INTERVAL_MS   = "interaction.send.batchintervalms";
@@ -33,6 +42,7 @@ namespace reinforcement_learning {  namespace name {
       const char *const  OBSERVATION_EH_KEY      = "observation.eventhub.key";
       const char *const  OBSERVATION_EH_TASKS_LIMIT = "observation.eventhub.tasks_limit";
       const char *const  OBSERVATION_EH_MAX_HTTP_RETRIES = "observation.eventhub.max_http_retries";
+      const char *const  OBSERVATION_EH_CONNECTIONS = "observation.eventhub.connections";
       const char *const  OBSERVATION_SEND_HIGH_WATER_MARK     = "observation.send.highwatermark";
       const char *const  OBSERVATION_SEND_QUEUE_MAX_CAPACITY_KB    = "observation.send.queue.maxcapacity.kb";
       const char *const  OBSERVATION_SEND_BATCH_INTERVAL_MS   = "observation.send.batchintervalms";
@@ -51,15 +61,72 @@ namespace reinforcement_learning {  namespace name {
       const char *const  DECISION_SENDER_IMPLEMENTATION    = "decisions.sender.implementation";
 
       const char *const  EH_TEST                 = "eventhub.mock";
+      const char *const  EH_CONNECTION_SELECTION = "eventhub.connection.selection";  // ROUND_ROBIN or LEAST_OUTSTANDING
+      const char *const  EH_COALESCE_WINDOW_MS   = "eventhub.coalesce.window_ms";  // 0 sends every batch in its own request
+      const char *const  EH_COALESCE_MAX_BYTES   = "eventhub.coalesce.max_bytes";
       const char *const  TRACE_LOG_IMPLEMENTATION = "trace.logger.implementation";
       const char *const  QUEUE_MODE = "queue.mode";
+      const char *const  QUEUE_BLOCK_TIMEOUT_MS = "queue.block_timeout_ms";  // BLOCK mode appends fail after waiting this long, 0 (default) waits forever
+      const char *const  LOGGING_CONSOLIDATED = "logging.consolidated";  // One thread drains all loggers, decisions share the interaction sender
+      const char *const  LOAD_SHEDDING_JOINED = "load_shedding.joined";  // Loggers drop the same event ids under overload
+      const char *const  LOAD_SHEDDING_JOIN_WINDOW_MS = "load_shedding.join_window_ms";  // How long outcomes follow a shed interaction
+      const char *const  LOAD_SHEDDING_FILTER_MAX_KB = "load_shedding.filter_max_kb";  // Memory for shed ids, per half of the join window
+      const char *const  BATCHING_ADAPTIVE = "batching.adaptive";      // Tune batch size and interval to the sender's latency
+      const char *const  BATCHING_MIN_SIZE_KB = "batching.min_size_kb";
+      const char *const  BATCHING_MAX_SIZE_KB = "batching.max_size_kb";
+      const char *const  BATCHING_MIN_INTERVAL_MS = "batching.min_interval_ms";
+      const char *const  BATCHING_MAX_INTERVAL_MS = "batching.max_interval_ms";
+      const char *const  BATCHING_TARGET_LATENCY_MS = "batching.target_latency_ms";
+      const char *const  BATCHING_MAX_MESSAGE_BYTES = "batching.max_message_bytes";  // Hard limit of a batch, 0 for none
+      const char *const  LOGGING_COMPRESSION = "logging.compression";  // NONE, LZ4 or ZSTD, applied to each batch body
+      const char *const  LOGGING_COMPRESSION_LEVEL = "logging.compression.level";  // ZSTD level or LZ4 acceleration, 0 for the codec default
+      const char *const  LOGGING_COMPRESSION_MIN_BYTES = "logging.compression.min_bytes";  // Smaller batches are sent as they are
+      const char *const  LOGGING_COMPRESSION_DICTIONARY = "logging.compression.dictionary";  // ZSTD dictionary file from dictionary_trainer
+      const char *const  SCHEDULER_SHARED = "scheduler.shared";        // Batchers of all live models run on one timer wheel, model downloads keep their threads
+      const char *const  SCHEDULER_THREADS = "scheduler.threads";
+      const char *const  SCHEDULER_PIN_CPUS = "scheduler.pin_cpus";    // Comma separated cpu numbers, Linux only
       const char *const  INTERACTION_FILE_NAME = "interaction.file.name";
       const char *const  OBSERVATION_FILE_NAME = "observation.file.name";
+      const char *const  FILE_SENDER_MODE = "file.sender.mode";                 // SYNC or ASYNC
+      const char *const  FILE_FSYNC_POLICY = "file.fsync.policy";               // NEVER, INTERVAL or BYTES, ASYNC mode only
+      const char *const  FILE_FSYNC_INTERVAL_MS = "file.fsync.interval_ms";
+      const char *const  FILE_FSYNC_BYTES = "file.fsync.bytes";
+      const char *const  FILE_QUEUE_MAX_BYTES = "file.queue.max_bytes";         // Batches waiting for the writer before send blocks
+      const char *const  FILE_SEGMENT_MAX_BYTES = "file.segment.max_bytes";     // Rotate to a new indexed segment after this many bytes, 0 disables
+      const char *const  FILE_SEGMENT_MAX_AGE_MS = "file.segment.max_age_ms";   // Rotate once a segment is this old, 0 disables
+      const char *const  SHM_RING_PREFIX = "shm.ring.prefix";                   // Ring names start with this, the collector looks for it
+      const char *const  SHM_RING_SIZE = "shm.ring.size";                       // Bytes per ring, rounded up to a power of two
+      const char *const  SHM_SEND_TIMEOUT_MS = "shm.send.timeout_ms";           // How long a send waits for space in a full ring
+      const char *const  INTERACTION_STREAM_ADDRESS = "interaction.stream.address";  // unix:/path or tcp:host:port
+      const char *const  OBSERVATION_STREAM_ADDRESS = "observation.stream.address";
+      const char *const  STREAM_TCP_NODELAY = "stream.tcp.nodelay";
+      const char *const  STREAM_TCP_CORK = "stream.tcp.cork";                   // Send only full segments, overrides nodelay while set
+      const char *const  STREAM_BUFFER_MAX_BYTES = "stream.buffer.max_bytes";   // Batches kept while the peer is slow or away
+      const char *const  STREAM_RECONNECT_MAX_DELAY_MS = "stream.reconnect.max_delay_ms";
+      const char *const  STREAM_WRITE_TIMEOUT_MS = "stream.write.timeout_ms";
+      const char *const  SPILL_DIR = "spill.dir";                               // Batches the senders cannot take are spilled to disk here and replayed, unset disables
+      const char *const  SPILL_MAX_SIZE_MB = "spill.max_size_mb";               // Per sender, batches are dropped beyond it
+      const char *const  SPILL_SEGMENT_SIZE_MB = "spill.segment_size_mb";
       const char *const  TIME_PROVIDER_IMPLEMENTATION = "time_provider.implementation";
       const char *const  HTTP_CLIENT_DISABLE_CERT_VALIDATION  = "http.certvalidation.disable";
       const char *const  HTTP_CLIENT_TIMEOUT                  = "http.timeout"; // Timeout is in seconds, default is 30.
+      const char *const  HTTP_RETRY_BASE_DELAY_MS             = "http.retry.base_delay_ms";     // Smallest backoff before an http retry
+      const char *const  HTTP_RETRY_MAX_DELAY_MS              = "http.retry.max_delay_ms";
+      const char *const  HTTP_RETRY_BUDGET                    = "http.retry.budget";            // Retries per budget window and client, 0 is unlimited
+      const char *const  HTTP_RETRY_BUDGET_WINDOW_MS          = "http.retry.budget_window_ms";
+      const char *const  HTTP_CLIENT_IMPLEMENTATION           = "http.client.implementation";   // CPPREST or EPOLL (Linux only), used by the EventHub senders
+      const char *const  HTTP_CLIENT_MAX_CONNECTIONS          = "http.client.max_connections";  // Keep-alive connections per EPOLL client
       const char *const  MODEL_FILE_NAME                      = "model_file_loader.file_name";
       const char *const  MODEL_FILE_MUST_EXIST                = "model_file_loader.file_must_exist";
+
+      // Shadow model
+      const char *const  SHADOW_MODEL_SRC                     = "shadow.model.source";
+      const char *const  SHADOW_MODEL_BLOB_URI                = "shadow.model.blob.uri";
+      const char *const  SHADOW_MODEL_FILE_NAME               = "shadow.model_file_loader.file_name";
+      const char *const  SHADOW_MODEL_REFRESH_INTERVAL_MS     = "shadow.model.refreshintervalms";
+      const char *const  SHADOW_SAMPLE_RATE                   = "shadow.sample.rate";           // Fraction of choose_rank requests scored by the shadow model
+      const char *const  SHADOW_QUEUE_MAX_SIZE                = "shadow.queue.maxsize";         // Pending shadow requests before new ones are dropped
+      const char *const  SHADOW_THREAD_COUNT                  = "shadow.threads";
 }}
 
 namespace reinforcement_learning {  namespace value {
@@ -73,6 +140,11 @@ namespace reinforcement_learning {  namespace value {
       const char *const DECISION_EH_SENDER = "DECISION_EH_SENDER";
       const char *const OBSERVATION_FILE_SENDER = "OBSERVATION_FILE_SENDER";
       const char *const INTERACTION_FILE_SENDER = "INTERACTION_FILE_SENDER";
+      const char *const OBSERVATION_SHM_SENDER = "OBSERVATION_SHM_SENDER";
+      const char *const INTERACTION_SHM_SENDER = "INTERACTION_SHM_SENDER";
+      const char *const OBSERVATION_STREAM_SENDER = "OBSERVATION_STREAM_SENDER";
+      const char *const INTERACTION_STREAM_SENDER = "INTERACTION_STREAM_SENDER";
+      const char *const DEFAULT_SHM_RING_PREFIX = "rl";
       const char *const NULL_TRACE_LOGGER = "NULL_TRACE_LOGGER";
       const char *const CONSOLE_TRACE_LOGGER = "CONSOLE_TRACE_LOGGER";
       const char *const NULL_TIME_PROVIDER = "NULL_TIME_PROVIDER";
@@ -80,8 +152,69 @@ namespace reinforcement_learning {  namespace value {
       const char *const LEARNING_MODE_ONLINE = "ONLINE";
       const char *const LEARNING_MODE_APPRENTICE = "APPRENTICE";
       const char *const LEARNING_MODE_LOGGINGONLY = "LOGGINGONLY";
+      const char *const ROUND_ROBIN = "ROUND_ROBIN";
+      const char *const LEAST_OUTSTANDING = "LEAST_OUTSTANDING";
+      const char *const CPPREST_HTTP_CLIENT = "CPPREST";
+      const char *const EPOLL_HTTP_CLIENT = "EPOLL";
+      const char *const FILE_SENDER_SYNC = "SYNC";
+      const char *const FILE_SENDER_ASYNC = "ASYNC";
+      const char *const FSYNC_NEVER = "NEVER";
+      const char *const FSYNC_INTERVAL = "INTERVAL";
+      const char *const FSYNC_BYTES = "BYTES";
+      const char *const COMPRESSION_NONE = "NONE";
+      const char *const COMPRESSION_LZ4 = "LZ4";
+      const char *const COMPRESSION_ZSTD = "ZSTD";
       const bool DEFAULT_MODEL_BACKGROUND_REFRESH = true;
+      const bool DEFAULT_LOGGING_CONSOLIDATED = false;
+      const int DEFAULT_QUEUE_BLOCK_TIMEOUT_MS = 0;
+      const bool DEFAULT_SCHEDULER_SHARED = false;
+      const bool DEFAULT_BATCHING_ADAPTIVE = false;
+      const int DEFAULT_BATCHING_MIN_SIZE_KB = 16;
+      const int DEFAULT_BATCHING_MAX_SIZE_KB = 256;
+      const int DEFAULT_BATCHING_MIN_INTERVAL_MS = 50;
+      const int DEFAULT_BATCHING_MAX_INTERVAL_MS = 1000;
+      const int DEFAULT_BATCHING_TARGET_LATENCY_MS = 100;
+      const int DEFAULT_BATCHING_MAX_MESSAGE_BYTES = 0;
+      const int DEFAULT_LOGGING_COMPRESSION_LEVEL = 0;
+      const int DEFAULT_LOGGING_COMPRESSION_MIN_BYTES = 256;
+      const bool DEFAULT_LOAD_SHEDDING_JOINED = true;
+      const int DEFAULT_LOAD_SHEDDING_JOIN_WINDOW_MS = 10 * 60 * 1000;
+      const int DEFAULT_LOAD_SHEDDING_FILTER_MAX_KB = 8 * 1024;
+      const int DEFAULT_SCHEDULER_THREADS = 2;
+      const int DEFAULT_MODEL_DOWNLOAD_RANGES = 1;
+      const int DEFAULT_MODEL_DOWNLOAD_RANGE_RETRIES = 3;
+      const int DEFAULT_MODEL_DOWNLOAD_MIN_RANGE_KB = 1024;
+      const int DEFAULT_MODEL_DOWNLOAD_RETRIES = 3;
+      const bool DEFAULT_MODEL_DOWNLOAD_STREAMING = false;
+      const int DEFAULT_MODEL_DOWNLOAD_STREAM_BUFFER_KB = 4096;
       const int DEFAULT_VW_POOL_INIT_SIZE = 4;
+      const int DEFAULT_MODEL_CACHE_SIZE = 3;
+      const int DEFAULT_MODEL_CACHE_MAX_MB = 256;
       const int DEFAULT_PROTOCOL_VERSION = 1;
+      const int DEFAULT_EH_CONNECTIONS = 1;
+      const int DEFAULT_EH_COALESCE_WINDOW_MS = 0;
+      const int DEFAULT_EH_COALESCE_MAX_BYTES = 256 * 1024;
+      const int DEFAULT_HTTP_RETRY_BASE_DELAY_MS = 100;
+      const int DEFAULT_HTTP_RETRY_MAX_DELAY_MS = 10000;
+      const int DEFAULT_HTTP_RETRY_BUDGET = 20;
+      const int DEFAULT_HTTP_RETRY_BUDGET_WINDOW_MS = 1000;
+      const int DEFAULT_HTTP_CLIENT_MAX_CONNECTIONS = 16;
+      const int DEFAULT_FILE_FSYNC_INTERVAL_MS = 1000;
+      const int DEFAULT_FILE_FSYNC_BYTES = 16 * 1024 * 1024;
+      const int DEFAULT_FILE_QUEUE_MAX_BYTES = 64 * 1024 * 1024;
+      const int DEFAULT_FILE_SEGMENT_MAX_BYTES = 0;
+      const int DEFAULT_FILE_SEGMENT_MAX_AGE_MS = 0;
+      const int DEFAULT_SHM_RING_SIZE = 16 * 1024 * 1024;
+      const int DEFAULT_SHM_SEND_TIMEOUT_MS = 1000;
+      const bool DEFAULT_STREAM_TCP_NODELAY = true;
+      const bool DEFAULT_STREAM_TCP_CORK = false;
+      const int DEFAULT_STREAM_BUFFER_MAX_BYTES = 16 * 1024 * 1024;
+      const int DEFAULT_STREAM_RECONNECT_MAX_DELAY_MS = 5000;
+      const int DEFAULT_STREAM_WRITE_TIMEOUT_MS = 5000;
+      const int DEFAULT_SPILL_MAX_SIZE_MB = 1024;
+      const int DEFAULT_SPILL_SEGMENT_SIZE_MB = 16;
+      const float DEFAULT_SHADOW_SAMPLE_RATE = 1.f;
+      const int DEFAULT_SHADOW_QUEUE_MAX_SIZE = 1024;
+      const int DEFAULT_SHADOW_THREAD_COUNT = 1;
 }}
 
@@ -37,4 +37,20 @@ ERROR_CODE_DEFINITION(34, file_read_error, "Unable to read from file.")
 ERROR_CODE_DEFINITION(36, file_stats_error, "Unable to read file statistics e.g. modified date time.")
 ERROR_CODE_DEFINITION(37, not_supported, "Not supported")
 ERROR_CODE_DEFINITION(38, protocol_not_supported, "Protocol version is not supported")
+ERROR_CODE_DEFINITION(39, json_no_pdf_found, "Context json did not have a pdf (p array empty or not found)")
+ERROR_CODE_DEFINITION(40, json_pdf_size_mismatch, "Context json pdf size does not match the number of actions.")
+ERROR_CODE_DEFINITION(41, shadow_model_not_configured, "Shadow model is not configured (shadow.model.source not set).")
+ERROR_CODE_DEFINITION(42, model_version_not_cached, "Model version is not available in the model cache: ")
+ERROR_CODE_DEFINITION(43, model_range_download_error, "Ranged model download failed: ")
+ERROR_CODE_DEFINITION(44, model_changed_during_download, "Model blob was modified while its ranges were downloaded.")
+ERROR_CODE_DEFINITION(45, http_client_init_error, "Unable to initialize the http client: ")
+ERROR_CODE_DEFINITION(46, file_write_error, "Unable to write to file: ")
+ERROR_CODE_DEFINITION(47, shm_ring_error, "Shared memory ring error: ")
+ERROR_CODE_DEFINITION(48, shm_ring_full, "Shared memory ring stayed full, the collector is not draining it: ")
+ERROR_CODE_DEFINITION(49, stream_buffer_full, "Stream sender buffer is full, batch dropped: ")
+ERROR_CODE_DEFINITION(50, stream_connect_error, "Unable to connect the stream sender to ")
+ERROR_CODE_DEFINITION(51, logging_queue_timeout, "Logging queue stayed full, the event was dropped after waiting ")
+ERROR_CODE_DEFINITION(52, spill_log_error, "Spill log error: ")
+ERROR_CODE_DEFINITION(53, spill_log_full, "Spill log is full, batch dropped: ")
+ERROR_CODE_DEFINITION(54, compression_error, "Compression error: ")
 //! [Error Definitions]
@@ -13,6 +13,8 @@
 #include "err_constants.h"
 #include "factory_resolver.h"
 #include "sender.h"
+#include "logging_pressure.h"
+#include "shadow_stats.h"
 #include "future_compat.h"
 
 #include <memory>
@@ -227,6 +229,62 @@ namespace reinforcement_learning {
      */
     int refresh_model(api_status* status = nullptr);
 
+    /**
+     * @brief Switch to a model version that was loaded earlier, without downloading or parsing it again.
+     * The last model.cache.size versions (bounded by model.cache.max_mb) are kept in memory.  While pinned,
+     * newly downloaded models are cached but not activated.
+     * @param version  Version as listed by get_model_versions(), or a model id as reported in
+     *                 ranking_response::get_model_id(), which pins the newest cached version of that model
+     * @param status  Optional field with detailed string description if there is an error
+     * @return int Return error code.  This will also be returned in the api_status object
+     */
+    int pin_model_version(const char* version, api_status* status = nullptr);
+
+    /**
+     * @brief Pin the model version that was loaded before the active one.
+     * @param status  Optional field with detailed string description if there is an error
+     * @return int Return error code.  This will also be returned in the api_status object
+     */
+    int rollback_model(api_status* status = nullptr);
+
+    /**
+     * @brief Activate the most recently loaded model version and resume applying model updates.
+     * @param status  Optional field with detailed string description if there is an error
+     * @return int Return error code.  This will also be returned in the api_status object
+     */
+    int unpin_model_version(api_status* status = nullptr);
+
+    /**
+     * @brief List the model versions available for pinning.
+     * @param versions  Cached model versions, newest first, each "<model id>@<load sequence>"
+     * @param active_version  Version currently used for ranking
+     * @param status  Optional field with detailed string description if there is an error
+     * @return int Return error code.  This will also be returned in the api_status object
+     */
+    int get_model_versions(std::vector<std::string>& versions, std::string& active_version, api_status* status = nullptr);
+
+    /**
+     * @brief Get the divergence statistics between the shadow model and the active model.
+     * The shadow model is configured with shadow.model.source and scores a sample of choose_rank requests in the
+     * background.  Scoring never adds latency to choose_rank; under load shadow requests are dropped.
+     * @param stats  Cumulative statistics since init()
+     * @param status  Optional field with detailed string description if there is an error
+     * @return int Return error code.  This will also be returned in the api_status object
+     */
+    int get_shadow_stats(shadow_stats& stats, api_status* status = nullptr) const;
+
+    /**
+     * @brief Get the backpressure of the logging pipeline.
+     * Reports how full each logger's send queue is and how many events were dropped recently, so that callers can
+     * throttle before the queues overflow.  Cheap enough to call on every request.
+     * In BLOCK mode a full queue makes request threads wait until it drains, unless queue.block_timeout_ms bounds
+     * the wait; events that time out are dropped with logging_queue_timeout and counted in block_timeouts.
+     * @param pressure  Fill ratios and drop rates of the interaction, observation, decision and slates queues
+     * @param status  Optional field with detailed string description if there is an error
+     * @return int Return error code.  This will also be returned in the api_status object
+     */
+    int get_logging_pressure(logging_pressure& pressure, api_status* status = nullptr) const;
+
     /**
      * @brief Error callback function.
      * When live_model is constructed, a background error callback and a
@@ -0,0 +1,64 @@
+/**
+ * @brief Backpressure indicators of the logging pipeline
+ *
+ * @file logging_pressure.h
+ */
+#pragma once
+#include <cstdint>
+
+namespace reinforcement_learning {
+  /**
+   * @brief State of the send queue of one logger.
+   */
+  struct queue_pressure {
+    //! Queued bytes over the queue capacity, 1 when the queue is full
+    float fill_ratio = 0;
+    //! Fraction of appended events dropped over the last few batch intervals
+    float drop_rate = 0;
+    //! Events dropped since live_model::init()
+    uint64_t dropped = 0;
+    //! Appends in BLOCK mode that gave up after queue.block_timeout_ms since live_model::init(), when that is set
+    uint64_t block_timeouts = 0;
+    //! Smoothed time from a send until its request completed in microseconds, retries included
+    int64_t send_latency_us = 0;
+    //! Current batch size limit in bytes, tuned when batching.adaptive is set
+    uint64_t batch_size = 0;
+    //! Current flush interval in milliseconds, tuned when batching.adaptive is set
+    int64_t batch_interval_ms = 0;
+    //! Changes of the batch size or flush interval made by adaptive batching since live_model::init()
+    uint64_t batching_adjustments = 0;
+    //! Batches written to the spill log of the sender instead of being sent since live_model::init(), when spill.dir is set
+    uint64_t spilled_batches = 0;
+    //! Spilled batches sent since live_model::init(), in the order they were spilled
+    uint64_t replayed_batches = 0;
+    //! Batches lost because the spill log was full or could not be written since live_model::init()
+    uint64_t spill_dropped = 0;
+    //! Bytes in the spill log waiting for replay, those left by an earlier process included
+    uint64_t spill_backlog_bytes = 0;
+    //! Bytes spilled per second, smoothed over the last few calls
+    float spill_rate = 0;
+    //! Bytes replayed per second, smoothed over the last few calls
+    float replay_rate = 0;
+  };
+
+  /**
+   * @brief Backpressure of the four loggers of a live_model.
+   * Callers can slow down or shed traffic themselves as fill_ratio approaches 1, before the library starts dropping
+   * events (DROP mode) or blocking request threads (BLOCK mode).
+   * Loggers that share a sender report the same spill counters.
+   */
+  struct logging_pressure {
+    queue_pressure interactions;
+    queue_pressure observations;
+    queue_pressure decisions;
+    queue_pressure slates;
+    //! Highest fill ratio of the four queues
+    float fill_ratio = 0;
+    //! Highest recent drop rate of the four queues
+    float drop_rate = 0;
+    //! How long the ids of shed interactions are remembered to shed their outcomes, in milliseconds.
+    //! Half of load_shedding.join_window_ms unless more ids were shed than load_shedding.filter_max_kb can hold,
+    //! 0 when load_shedding.joined is off
+    int64_t shed_join_window_ms = 0;
+  };
+}
@@ -2,6 +2,7 @@
 #include <cstddef>
 #include <stdint.h>
 
+#include <memory>
 #include <utility>
 #include <vector>
 #include <string>
@@ -13,6 +14,8 @@ namespace reinforcement_learning {
 }
 
 namespace reinforcement_learning { namespace model_management {
+    class byte_pipe;
+
     class model_data {
       public:
         // Get data
@@ -58,6 +61,10 @@ namespace reinforcement_learning { namespace model_management {
     class i_data_transport {
     public:
       virtual int get_data(model_data& data, api_status* status = nullptr) = 0;
+      //! Starts feeding a changed model into the pipe and returns while the download may still be running.
+      //! updated is false (and the pipe closed) when the model did not change.  The default implementation
+      //! downloads the full model with get_data() first.
+      virtual int get_data_streamed(const std::shared_ptr<byte_pipe>& pipe, bool& updated, api_status* status = nullptr);
       virtual ~i_data_transport() = default;
     };
 
@@ -65,9 +72,19 @@ namespace reinforcement_learning { namespace model_management {
     class i_model {
     public:
       virtual int update(const model_data& data, bool& model_ready, api_status* status = nullptr) = 0;
+      //! Loads a model while it is being downloaded.  The default implementation reads the whole pipe and calls update().
+      virtual int update_streamed(byte_pipe& pipe, bool& model_ready, api_status* status = nullptr);
       virtual int choose_rank(uint64_t rnd_seed, const char* features, std::vector<int>& action_ids, std::vector<float>& action_pdf, std::string& model_version, api_status* status = nullptr) = 0;
       virtual int request_decision(const std::vector<const char*>& event_ids, const char* features, std::vector<std::vector<uint32_t>>& actions_ids, std::vector<std::vector<float>>& action_pdfs, std::string& model_version, api_status* status = nullptr) = 0;
       virtual int request_slates_decision(const char* event_id, uint32_t slot_count, const char* features, std::vector<std::vector<uint32_t>>& actions_ids, std::vector<std::vector<float>>& action_pdfs, std::string& model_version, api_status* status = nullptr) = 0;
+      //! Activates a previously loaded model version.  Updates are cached but not applied until unpin_version().
+      //! The default implementation returns error_code::not_supported.
+      virtual int pin_version(const char* version, api_status* status = nullptr);
+      //! Activates the most recently loaded model version and resumes applying updates.
+      //! The default implementation returns error_code::not_supported.
+      virtual int unpin_version(api_status* status = nullptr);
+      //! Loaded model versions, newest first.  The default implementation returns error_code::not_supported.
+      virtual int get_versions(std::vector<std::string>& versions, std::string& active_version, api_status* status = nullptr);
       virtual ~i_model() = default;
     };
 }}
@@ -1,13 +1,24 @@
 #pragma once
 #include "data_buffer.h"
+#include <chrono>
+#include <functional>
 #include <memory>
 namespace reinforcement_learning {
   class api_status;
   class i_sender {
   public:
     using buffer = std::shared_ptr<utility::data_buffer>;
+    // Takes a batch the sender accepted but could not deliver, returns false when it no longer takes any
+    using undelivered_fn = std::function<bool(const buffer&)>;
     virtual int init(api_status* status) = 0;
     int send(const buffer& data, api_status* status = nullptr) { return v_send(data, status); }
+    // Fraction of the in-flight window in use, negative for senders without one
+    virtual float window_occupancy() const { return -1.f; }
+    // Smoothed time from a send to the completion of its request, negative for senders that are done when send returns
+    virtual std::chrono::microseconds completion_latency() const { return std::chrono::microseconds(-1); }
+    // Asynchronous senders hand the batches they give up on after their retries to the first handler that takes
+    // them.  Senders that report every failure from send ignore the handlers.
+    virtual void add_undelivered_handler(undelivered_fn handler) {}
     virtual ~i_sender() = default;
   protected:
     virtual int v_send(const buffer& data, api_status* status = nullptr) = 0;
@@ -0,0 +1,30 @@
+/**
+ * @brief Divergence statistics collected while scoring live traffic with a shadow model
+ *
+ * @file shadow_stats.h
+ */
+#pragma once
+#include <cstdint>
+
+namespace reinforcement_learning {
+  /**
+   * @brief Counters comparing the shadow model with the active model.
+   * Values are cumulative since live_model::init()
+   */
+  struct shadow_stats {
+    //! Requests handed to the shadow worker pool
+    uint64_t enqueued = 0;
+    //! Requests dropped because the shadow queue was full
+    uint64_t dropped = 0;
+    //! Requests scored by the shadow model
+    uint64_t scored = 0;
+    //! Requests where the shadow model failed to score the context
+    uint64_t failed = 0;
+    //! Scored requests where the shadow model chose the same action as the active model
+    uint64_t chosen_action_matches = 0;
+    //! Sum over scored requests of the total variation distance between the two pdfs
+    double total_variation_sum = 0;
+    //! Largest total variation distance observed
+    float total_variation_max = 0;
+  };
+}
@@ -4,7 +4,15 @@
 #include "constants.h"
 #include "model_mgmt/restapi_data_transport.h"
 #include "logger/event_logger.h"
+#include "logger/sharded_eventhub_client.h"
+#include "trace_logger.h"
+#include "utility/epoll_http_client.h"
 #include "utility/http_helper.h"
+#include "utility/retry_scheduler.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
 
 namespace reinforcement_learning {
   namespace m = model_management;
@@ -15,6 +23,14 @@ namespace reinforcement_learning {
   int interaction_sender_create(i_sender** retval, const u::configuration&, error_callback_fn*, i_trace* trace_logger, api_status* status);
   int decision_sender_create(i_sender** retval, const u::configuration&, error_callback_fn*, i_trace* trace_logger, api_status* status);
 
+  std::shared_ptr<u::retry_policy> retry_policy_create(const u::configuration& cfg) {
+    return std::make_shared<u::retry_policy>(
+      std::chrono::milliseconds(cfg.get_int(name::HTTP_RETRY_BASE_DELAY_MS, value::DEFAULT_HTTP_RETRY_BASE_DELAY_MS)),
+      std::chrono::milliseconds(cfg.get_int(name::HTTP_RETRY_MAX_DELAY_MS, value::DEFAULT_HTTP_RETRY_MAX_DELAY_MS)),
+      cfg.get_int(name::HTTP_RETRY_BUDGET, value::DEFAULT_HTTP_RETRY_BUDGET),
+      std::chrono::milliseconds(cfg.get_int(name::HTTP_RETRY_BUDGET_WINDOW_MS, value::DEFAULT_HTTP_RETRY_BUDGET_WINDOW_MS)));
+  }
+
   void register_azure_factories() {
     data_transport_factory.register_type(value::AZURE_STORAGE_BLOB, restapi_data_transport_create);
     sender_factory.register_type(value::OBSERVATION_EH_SENDER, observation_sender_create);
@@ -28,7 +44,12 @@ namespace reinforcement_learning {
       api_status::try_update(status, error_code::http_uri_not_provided, error_code::http_uri_not_provided_s);
       return error_code::http_uri_not_provided;
     }
-    auto pret = new m::restapi_data_transport(new http_client(uri, config), trace_logger);
+    auto pret = new m::restapi_data_transport(new http_client(uri, config), trace_logger,
+      config.get_int(name::MODEL_DOWNLOAD_RANGES, value::DEFAULT_MODEL_DOWNLOAD_RANGES),
+      config.get_int(name::MODEL_DOWNLOAD_RANGE_RETRIES, value::DEFAULT_MODEL_DOWNLOAD_RANGE_RETRIES),
+      static_cast<uint64_t>(config.get_int(name::MODEL_DOWNLOAD_MIN_RANGE_KB, value::DEFAULT_MODEL_DOWNLOAD_MIN_RANGE_KB)) * 1024,
+      config.get_int(name::MODEL_DOWNLOAD_RETRIES, value::DEFAULT_MODEL_DOWNLOAD_RETRIES),
+      retry_policy_create(config));
     const auto scode = pret->check(status);
     if (scode != error_code::success) {
       delete pret;
@@ -45,57 +66,96 @@ namespace reinforcement_learning {
     return url;
   }
 
-  int observation_sender_create(i_sender** retval, const u::configuration& cfg, error_callback_fn* error_cb, i_trace* trace_logger, api_status* status) {
-    const auto eh_host = cfg.get(name::OBSERVATION_EH_HOST, "localhost:8080");
-    const auto eh_name = cfg.get(name::OBSERVATION_EH_NAME, "observation");
+  int eventhub_http_client_create(i_http_client** retval, const char* url, const u::configuration& cfg, i_trace* trace_logger, api_status* status) {
+    const std::string implementation = cfg.get(name::HTTP_CLIENT_IMPLEMENTATION, value::CPPREST_HTTP_CLIENT);
+    if (implementation == value::EPOLL_HTTP_CLIENT) {
+#ifdef __linux__
+      std::unique_ptr<epoll_http_client> client(new epoll_http_client(url, cfg, trace_logger));
+      RETURN_IF_FAIL(client->init(status));
+      *retval = client.release();
+      return error_code::success;
+#else
+      TRACE_WARN(trace_logger, "The EPOLL http client is only available on Linux, falling back to CPPREST.");
+#endif
+    }
+    *retval = new http_client(url, cfg);
+    return error_code::success;
+  }
+
+  // A single eventhub_client, or a sharded sender with one eventhub_client and http client per connection.
+  int eventhub_sender_create(i_sender** retval, const u::configuration& cfg, const char* eh_host, const char* eh_key_name,
+    const char* eh_key, const char* eh_name, int tasks_limit, int max_http_retries, int connections, error_callback_fn* error_cb,
+    i_trace* trace_logger, api_status* status) {
     const auto eh_url = build_eh_url(eh_host, eh_name);
+    const auto retry_policy = retry_policy_create(cfg);
+
+    std::vector<std::unique_ptr<eventhub_client>> shards;
+    for (int i = 0; i < (std::max)(connections, 1); ++i) {
+      i_http_client* client = nullptr;
+      RETURN_IF_FAIL(eventhub_http_client_create(&client, eh_url.c_str(), cfg, trace_logger, status));
+      shards.emplace_back(new eventhub_client(
+        client,
+        eh_host,
+        eh_key_name,
+        eh_key,
+        eh_name,
+        tasks_limit,
+        max_http_retries,
+        trace_logger,
+        error_cb,
+        retry_policy));
+    }
+    if (shards.size() == 1) {
+      *retval = shards.front().release();
+      return error_code::success;
+    }
 
-    *retval = new eventhub_client(
-      new http_client(eh_url.c_str(), cfg),
-      eh_host,
+    const auto selection = std::string(cfg.get(name::EH_CONNECTION_SELECTION, value::ROUND_ROBIN)) == value::LEAST_OUTSTANDING
+      ? shard_selection::least_outstanding
+      : shard_selection::round_robin;
+    *retval = new sharded_eventhub_client(std::move(shards), selection, trace_logger);
+    return error_code::success;
+  }
+
+  int observation_sender_create(i_sender** retval, const u::configuration& cfg, error_callback_fn* error_cb, i_trace* trace_logger, api_status* status) {
+    return eventhub_sender_create(retval, cfg,
+      cfg.get(name::OBSERVATION_EH_HOST, "localhost:8080"),
       cfg.get(name::OBSERVATION_EH_KEY_NAME, ""),
       cfg.get(name::OBSERVATION_EH_KEY, ""),
-      eh_name,
+      cfg.get(name::OBSERVATION_EH_NAME, "observation"),
       cfg.get_int(name::OBSERVATION_EH_TASKS_LIMIT, 16),
       cfg.get_int(name::OBSERVATION_EH_MAX_HTTP_RETRIES, 4),
+      cfg.get_int(name::OBSERVATION_EH_CONNECTIONS, value::DEFAULT_EH_CONNECTIONS),
+      error_cb,
       trace_logger,
-      error_cb);
-    return error_code::success;
+      status);
   }
 
   int interaction_sender_create(i_sender** retval, const u::configuration& cfg, error_callback_fn* error_cb, i_trace* trace_logger, api_status* status) {
-    const auto eh_host = cfg.get(name::INTERACTION_EH_HOST, "localhost:8080");
-    const auto eh_name = cfg.get(name::INTERACTION_EH_NAME, "interaction");
-    const auto eh_url = build_eh_url(eh_host, eh_name);
-
-    *retval = new eventhub_client(
-      new http_client(eh_url.c_str(), cfg),
+    return eventhub_sender_create(retval, cfg,
       cfg.get(name::INTERACTION_EH_HOST, "localhost:8080"),
       cfg.get(name::INTERACTION_EH_KEY_NAME, ""),
       cfg.get(name::INTERACTION_EH_KEY, ""),
       cfg.get(name::INTERACTION_EH_NAME, "interaction"),
       cfg.get_int(name::INTERACTION_EH_TASKS_LIMIT, 16),
       cfg.get_int(name::INTERACTION_EH_MAX_HTTP_RETRIES, 4),
+      cfg.get_int(name::INTERACTION_EH_CONNECTIONS, value::DEFAULT_EH_CONNECTIONS),
+      error_cb,
       trace_logger,
-      error_cb);
-    return error_code::success;
+      status);
   }
 
   int decision_sender_create(i_sender** retval, const u::configuration& cfg, error_callback_fn* error_cb, i_trace* trace_logger, api_status* status) {
-    const auto eh_host = cfg.get(name::INTERACTION_EH_HOST, "localhost:8080");
-    const auto eh_name = cfg.get(name::INTERACTION_EH_NAME, "interaction");
-    const auto eh_url = build_eh_url(eh_host, eh_name);
-
-    *retval = new eventhub_client(
-      new http_client(eh_url.c_str(), cfg),
+    return eventhub_sender_create(retval, cfg,
       cfg.get(name::INTERACTION_EH_HOST, "localhost:8080"),
       cfg.get(name::INTERACTION_EH_KEY_NAME, ""),
       cfg.get(name::INTERACTION_EH_KEY, ""),
       cfg.get(name::INTERACTION_EH_NAME, "interaction"),
       cfg.get_int(name::INTERACTION_EH_TASKS_LIMIT, 16),
       cfg.get_int(name::INTERACTION_EH_MAX_HTTP_RETRIES, 4),
+      cfg.get_int(name::INTERACTION_EH_CONNECTIONS, value::DEFAULT_EH_CONNECTIONS),
+      error_cb,
       trace_logger,
-      error_cb);
-    return error_code::success;
+      status);
   }
 }
@@ -13,7 +13,10 @@
 #include <type_traits>
 #include "console_tracer.h"
 #include "error_callback_fn.h"
+#include "logger/file/async_file_logger.h"
 #include "logger/file/file_logger.h"
+#include "logger/shm/shm_sender.h"
+#include "logger/stream/stream_sender.h"
 #include "model_mgmt/file_model_loader.h"
 namespace reinforcement_learning {
   namespace m = model_management;
@@ -76,9 +79,52 @@ namespace reinforcement_learning {
     const char * file_name,
     error_callback_fn* error_cb, i_trace* trace_logger, api_status* status)
   {
-    *retval = new logger::file::file_logger(file_name, trace_logger);
+    logger::file::segment_options segments;
+    segments.max_bytes = cfg.get_int(name::FILE_SEGMENT_MAX_BYTES, value::DEFAULT_FILE_SEGMENT_MAX_BYTES);
+    segments.max_age = std::chrono::milliseconds(cfg.get_int(name::FILE_SEGMENT_MAX_AGE_MS, value::DEFAULT_FILE_SEGMENT_MAX_AGE_MS));
+
+    if (std::string(cfg.get(name::FILE_SENDER_MODE, value::FILE_SENDER_SYNC)) != value::FILE_SENDER_ASYNC) {
+      *retval = new logger::file::file_logger(file_name, trace_logger, segments);
+      return error_code::success;
+    }
+
+    logger::file::async_file_options options;
+    options.segments = segments;
+    const std::string policy = cfg.get(name::FILE_FSYNC_POLICY, value::FSYNC_NEVER);
+    if (policy == value::FSYNC_INTERVAL) options.sync = logger::file::fsync_policy::interval;
+    else if (policy == value::FSYNC_BYTES) options.sync = logger::file::fsync_policy::bytes;
+    options.sync_interval = std::chrono::milliseconds(cfg.get_int(name::FILE_FSYNC_INTERVAL_MS, value::DEFAULT_FILE_FSYNC_INTERVAL_MS));
+    options.sync_bytes = cfg.get_int(name::FILE_FSYNC_BYTES, value::DEFAULT_FILE_FSYNC_BYTES);
+    options.max_queued_bytes = cfg.get_int(name::FILE_QUEUE_MAX_BYTES, value::DEFAULT_FILE_QUEUE_MAX_BYTES);
+    *retval = new logger::file::async_file_logger(file_name, options, error_cb, trace_logger);
+    return error_code::success;
+  }
+
+#ifdef __linux__
+  int shm_sender_create(i_sender** retval, const u::configuration& cfg, const char* channel, i_trace* trace_logger,
+    api_status* status)
+  {
+    const auto ring_name = logger::shm::shm_sender::ring_name(cfg.get(name::SHM_RING_PREFIX, value::DEFAULT_SHM_RING_PREFIX), channel);
+    *retval = new logger::shm::shm_sender(ring_name,
+      cfg.get_int(name::SHM_RING_SIZE, value::DEFAULT_SHM_RING_SIZE),
+      std::chrono::milliseconds(cfg.get_int(name::SHM_SEND_TIMEOUT_MS, value::DEFAULT_SHM_SEND_TIMEOUT_MS)),
+      trace_logger);
+    return error_code::success;
+  }
+
+  int stream_sender_create(i_sender** retval, const u::configuration& cfg, const char* address, error_callback_fn* error_cb,
+    i_trace* trace_logger, api_status* status)
+  {
+    logger::stream::stream_sender_options options;
+    options.no_delay = cfg.get_bool(name::STREAM_TCP_NODELAY, value::DEFAULT_STREAM_TCP_NODELAY);
+    options.cork = cfg.get_bool(name::STREAM_TCP_CORK, value::DEFAULT_STREAM_TCP_CORK);
+    options.max_buffered_bytes = cfg.get_int(name::STREAM_BUFFER_MAX_BYTES, value::DEFAULT_STREAM_BUFFER_MAX_BYTES);
+    options.reconnect_max_delay = std::chrono::milliseconds(cfg.get_int(name::STREAM_RECONNECT_MAX_DELAY_MS, value::DEFAULT_STREAM_RECONNECT_MAX_DELAY_MS));
+    options.write_timeout = std::chrono::milliseconds(cfg.get_int(name::STREAM_WRITE_TIMEOUT_MS, value::DEFAULT_STREAM_WRITE_TIMEOUT_MS));
+    *retval = new logger::stream::stream_sender(address, options, error_cb, trace_logger);
     return error_code::success;
   }
+#endif
 
   int empty_data_transport_create(m::i_data_transport** retval, const u::configuration& config, i_trace* trace_logger, api_status* status)
   {
@@ -149,6 +195,28 @@ namespace reinforcement_learning {
         file_name,
         cb, trace_logger, status);
     });
+
+#ifdef __linux__
+    // Shared memory senders, drained by test_tools/shm_collector
+    sender_factory.register_type(value::OBSERVATION_SHM_SENDER,
+      [](i_sender** retval, const u::configuration& c, error_callback_fn* cb, i_trace* trace_logger, api_status* status) {
+      return shm_sender_create(retval, c, "observation", trace_logger, status);
+    });
+    sender_factory.register_type(value::INTERACTION_SHM_SENDER,
+      [](i_sender** retval, const u::configuration& c, error_callback_fn* cb, i_trace* trace_logger, api_status* status) {
+      return shm_sender_create(retval, c, "interaction", trace_logger, status);
+    });
+
+    // Framed stream to a local forwarder
+    sender_factory.register_type(value::OBSERVATION_STREAM_SENDER,
+      [](i_sender** retval, const u::configuration& c, error_callback_fn* cb, i_trace* trace_logger, api_status* status) {
+      return stream_sender_create(retval, c, c.get(name::OBSERVATION_STREAM_ADDRESS, ""), cb, trace_logger, status);
+    });
+    sender_factory.register_type(value::INTERACTION_STREAM_SENDER,
+      [](i_sender** retval, const u::configuration& c, error_callback_fn* cb, i_trace* trace_logger, api_status* status) {
+      return stream_sender_create(retval, c, c.get(name::INTERACTION_STREAM_ADDRESS, ""), cb, trace_logger, status);
+    });
+#endif
   }
 
   int null_tracer_create(i_trace** retval, const u::configuration& cfg, i_trace* trace_logger, api_status* status) {
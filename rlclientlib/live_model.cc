@@ -137,4 +137,40 @@ namespace reinforcement_learning
     INIT_CHECK();
     return _pimpl->refresh_model(status);
   }
+
+  int live_model::pin_model_version(const char* version, api_status* status)
+  {
+    INIT_CHECK();
+    return _pimpl->pin_model_version(version, status);
+  }
+
+  int live_model::rollback_model(api_status* status)
+  {
+    INIT_CHECK();
+    return _pimpl->rollback_model(status);
+  }
+
+  int live_model::unpin_model_version(api_status* status)
+  {
+    INIT_CHECK();
+    return _pimpl->unpin_model_version(status);
+  }
+
+  int live_model::get_model_versions(std::vector<std::string>& versions, std::string& active_version, api_status* status)
+  {
+    INIT_CHECK();
+    return _pimpl->get_model_versions(versions, active_version, status);
+  }
+
+  int live_model::get_shadow_stats(shadow_stats& stats, api_status* status) const
+  {
+    INIT_CHECK();
+    return _pimpl->get_shadow_stats(stats, status);
+  }
+
+  int live_model::get_logging_pressure(logging_pressure& pressure, api_status* status) const
+  {
+    INIT_CHECK();
+    return _pimpl->get_logging_pressure(pressure, status);
+  }
 }
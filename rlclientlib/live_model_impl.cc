@@ -15,10 +15,14 @@
 #include "explore_internal.h"
 #include "hash.h"
 #include "factory_resolver.h"
+#include "logger/coalescing_sender.h"
+#include "logger/compressing_sender.h"
 #include "logger/preamble_sender.h"
 #include "sampling.h"
 
+#include <algorithm>
 #include <cstring>
+#include <utility>
 
 // Some namespace changes for more concise code
 namespace e = exploration;
@@ -48,6 +52,7 @@ namespace reinforcement_learning {
     RETURN_IF_FAIL(init_model(status));
     RETURN_IF_FAIL(init_model_mgmt(status));
     RETURN_IF_FAIL(init_loggers(status));
+    RETURN_IF_FAIL(init_shadow(status));
     _initial_epsilon = _configuration.get_float(name::INITIAL_EPSILON, 0.2f);
     const char* app_id = _configuration.get(name::APP_ID, "");
     _seed_shift = uniform_hash(app_id, strlen(app_id), 0);
@@ -68,6 +73,11 @@ namespace reinforcement_learning {
     }
     else {
       RETURN_IF_FAIL(explore_exploit(event_id, context, response, status));
+      if (_shadow) {
+        // Hand a copy of the request to the shadow pool.  This never blocks; work is dropped if the pool is behind.
+        const uint64_t seed = uniform_hash(event_id, strlen(event_id), 0) + _seed_shift;
+        _shadow->try_enqueue(event_id, seed, context, response);
+      }
     }
     response.set_event_id(event_id);
 
@@ -238,6 +248,67 @@ namespace reinforcement_learning {
     return error_code::success;
   }
 
+  int live_model_impl::pin_model_version(const char* version, api_status* status) {
+    RETURN_IF_FAIL(check_null_or_empty(version, status));
+    return _model->pin_version(version, status);
+  }
+
+  int live_model_impl::rollback_model(api_status* status) {
+    std::vector<std::string> versions;
+    std::string active_version;
+    RETURN_IF_FAIL(_model->get_versions(versions, active_version, status));
+
+    const auto it = std::find(versions.begin(), versions.end(), active_version);
+    if (it == versions.end() || it + 1 == versions.end()) {
+      RETURN_ERROR_LS(_trace_logger.get(), status, model_version_not_cached) << "no version older than " << active_version;
+    }
+    return _model->pin_version((it + 1)->c_str(), status);
+  }
+
+  int live_model_impl::unpin_model_version(api_status* status) {
+    return _model->unpin_version(status);
+  }
+
+  int live_model_impl::get_model_versions(std::vector<std::string>& versions, std::string& active_version, api_status* status) {
+    return _model->get_versions(versions, active_version, status);
+  }
+
+  int live_model_impl::get_shadow_stats(shadow_stats& stats, api_status* status) const {
+    if (!_shadow) {
+      RETURN_ERROR_LS(_trace_logger.get(), status, shadow_model_not_configured);
+    }
+    stats = _shadow->get_stats();
+    return error_code::success;
+  }
+
+  int live_model_impl::get_logging_pressure(logging_pressure& pressure, api_status* status) const {
+    pressure.interactions = _ranking_logger->get_pressure();
+    pressure.observations = _outcome_logger->get_pressure();
+    pressure.decisions = _decision_logger->get_pressure();
+    pressure.slates = _slates_logger->get_pressure();
+    const std::pair<queue_pressure*, l::spill::spilling_sender*> spills[] = {
+      { &pressure.interactions, _interaction_spill }, { &pressure.observations, _observation_spill },
+      { &pressure.decisions, _decision_spill }, { &pressure.slates, _slates_spill } };
+    for (const auto& spill : spills) {
+      if (spill.second == nullptr) continue;
+      const auto stats = spill.second->get_stats();
+      spill.first->spilled_batches = stats.spilled_batches;
+      spill.first->replayed_batches = stats.replayed_batches;
+      spill.first->spill_dropped = stats.dropped_batches;
+      spill.first->spill_backlog_bytes = stats.backlog_bytes;
+      spill.first->spill_rate = stats.spill_rate;
+      spill.first->replay_rate = stats.replay_rate;
+    }
+    pressure.fill_ratio = 0;
+    pressure.drop_rate = 0;
+    for (const auto* queue : { &pressure.interactions, &pressure.observations, &pressure.decisions, &pressure.slates }) {
+      pressure.fill_ratio = (std::max)(pressure.fill_ratio, queue->fill_ratio);
+      pressure.drop_rate = (std::max)(pressure.drop_rate, queue->drop_rate);
+    }
+    pressure.shed_join_window_ms = _drop_level ? _drop_level->remembered_window().count() : 0;
+    return error_code::success;
+  }
+
   live_model_impl::live_model_impl(
     const utility::configuration& config,
     const error_fn fn,
@@ -250,7 +321,10 @@ namespace reinforcement_learning {
   )
     : _configuration(config),
     _error_cb(fn, err_context),
-    _data_cb(_handle_model_update, this),
+    _data_cb(_handle_model_update,
+      config.get_bool(name::MODEL_DOWNLOAD_STREAMING, value::DEFAULT_MODEL_DOWNLOAD_STREAMING) ? _handle_model_stream : nullptr,
+      this),
+    _shadow_data_cb(_handle_shadow_model_update, this),
     _watchdog(&_error_cb),
     _trace_factory(trace_factory),
     _t_factory{ t_factory },
@@ -263,6 +337,8 @@ namespace reinforcement_learning {
       _error_cb.set(&default_error_callback, &_watchdog);
     }
 
+    // Model downloads block for as long as the transfer takes, so they keep a thread of their own instead of
+    // holding a worker of the shared scheduler
     if (_configuration.get_bool(name::MODEL_BACKGROUND_REFRESH, value::DEFAULT_MODEL_BACKGROUND_REFRESH)) {
       _bg_model_proc.reset(new utility::periodic_background_proc<model_management::model_downloader>(config.get_int(name::MODEL_REFRESH_INTERVAL_MS, 60 * 1000), _watchdog, "Model downloader", &_error_cb));
     }
@@ -289,17 +365,45 @@ namespace reinforcement_learning {
   }
 
   int live_model_impl::init_loggers(api_status* status) {
+    // The batchers of all live models can share one scheduler
+    if (_configuration.get_bool(name::SCHEDULER_SHARED, value::DEFAULT_SCHEDULER_SHARED)) {
+      utility::background_scheduler_options options;
+      options.threads = static_cast<size_t>((std::max)(1, _configuration.get_int(name::SCHEDULER_THREADS, value::DEFAULT_SCHEDULER_THREADS)));
+      options.cpus = utility::background_scheduler::parse_cpus(_configuration.get(name::SCHEDULER_PIN_CPUS, ""));
+      _scheduler = utility::background_scheduler::shared(options, _trace_logger.get());
+    }
+
+    // In consolidated mode a single engine thread drains the batchers of all four loggers
+    if (_configuration.get_bool(name::LOGGING_CONSOLIDATED, value::DEFAULT_LOGGING_CONSOLIDATED)) {
+      _logging_engine.reset(new logger::logging_engine(_watchdog, &_error_cb));
+      RETURN_IF_FAIL(_logging_engine->init(status));
+    }
+
+    // Under overload all loggers shed the same event ids, so what is sent can still be joined
+    if (_configuration.get_bool(name::LOAD_SHEDDING_JOINED, value::DEFAULT_LOAD_SHEDDING_JOINED)) {
+      _drop_level.reset(new logger::drop_level(std::chrono::milliseconds(
+        _configuration.get_int(name::LOAD_SHEDDING_JOIN_WINDOW_MS, value::DEFAULT_LOAD_SHEDDING_JOIN_WINDOW_MS)),
+        static_cast<size_t>(_configuration.get_int(name::LOAD_SHEDDING_FILTER_MAX_KB,
+          value::DEFAULT_LOAD_SHEDDING_FILTER_MAX_KB)) * 1024));
+    }
+
+    // Coalescers of the senders that post to the interaction and the observation hub, shared by the senders of
+    // this live model only
+    std::shared_ptr<l::batch_coalescer> interaction_coalescer;
+    std::shared_ptr<l::batch_coalescer> observation_coalescer;
+
     // Get the name of raw data (as opposed to message) sender for interactions.
     const auto ranking_sender_impl = _configuration.get(name::INTERACTION_SENDER_IMPLEMENTATION, value::INTERACTION_EH_SENDER);
-    i_sender* ranking_data_sender;
+    i_sender* ranking_sender_ptr;
 
     // Use the name to create an instance of raw data sender for interactions
-    RETURN_IF_FAIL(_sender_factory->create(&ranking_data_sender, ranking_sender_impl, _configuration, &_error_cb, _trace_logger.get(), status));
+    RETURN_IF_FAIL(create_sender(&ranking_sender_ptr, ranking_sender_impl, interaction_coalescer, status));
+    const std::shared_ptr<i_sender> ranking_data_sender(spill_if_configured(ranking_sender_ptr, "interaction", _interaction_spill));
     RETURN_IF_FAIL(ranking_data_sender->init(status));
 
     // Create a message sender that will prepend the message with a preamble and send the raw data using the
     // factory created raw data sender
-    l::i_message_sender* ranking_msg_sender = new l::preamble_message_sender(ranking_data_sender);
+    l::i_message_sender* ranking_msg_sender = compress_if_configured(new l::preamble_message_sender(ranking_data_sender));
     RETURN_IF_FAIL(ranking_msg_sender->init(status));
 
     // Get time provider factory and implementation
@@ -308,7 +412,7 @@ namespace reinforcement_learning {
     RETURN_IF_FAIL(_time_provider_factory->create(&interaction_time_provider, time_provider_impl, _configuration, _trace_logger.get(), status));
 
     // Create a logger for interactions that will use msg sender to send interaction messages
-    _ranking_logger.reset(new logger::cb_logger_facade(_configuration, ranking_msg_sender, _watchdog, interaction_time_provider, &_error_cb));
+    _ranking_logger.reset(new logger::cb_logger_facade(_configuration, ranking_msg_sender, _watchdog, interaction_time_provider, &_error_cb, _logging_engine.get(), _scheduler.get(), _drop_level.get()));
     RETURN_IF_FAIL(_ranking_logger->init(status));
 
     // Get the name of raw data (as opposed to message) sender for observations.
@@ -316,12 +420,13 @@ namespace reinforcement_learning {
     i_sender* outcome_sender;
 
     // Use the name to create an instance of raw data sender for observations
-    RETURN_IF_FAIL(_sender_factory->create(&outcome_sender, outcome_sender_impl, _configuration, &_error_cb, _trace_logger.get(), status));
+    RETURN_IF_FAIL(create_sender(&outcome_sender, outcome_sender_impl, observation_coalescer, status));
+    outcome_sender = spill_if_configured(outcome_sender, "observation", _observation_spill);
     RETURN_IF_FAIL(outcome_sender->init(status));
 
     // Create a message sender that will prepend the message with a preamble and send the raw data using the
     // factory created raw data sender
-    l::i_message_sender* outcome_msg_sender = new l::preamble_message_sender(outcome_sender);
+    l::i_message_sender* outcome_msg_sender = compress_if_configured(new l::preamble_message_sender(outcome_sender));
     RETURN_IF_FAIL(outcome_msg_sender->init(status));
 
     // Get time provider implementation
@@ -329,52 +434,161 @@ namespace reinforcement_learning {
     RETURN_IF_FAIL(_time_provider_factory->create(&observation_time_provider, time_provider_impl, _configuration, _trace_logger.get(), status));
 
     // Create a logger for interactions that will use msg sender to send interaction messages
-    _outcome_logger.reset(new logger::observation_logger_facade(_configuration, outcome_msg_sender, _watchdog, observation_time_provider, &_error_cb));
+    _outcome_logger.reset(new logger::observation_logger_facade(_configuration, outcome_msg_sender, _watchdog, observation_time_provider, &_error_cb, _logging_engine.get(), _scheduler.get(), _drop_level.get()));
     RETURN_IF_FAIL(_outcome_logger->init(status));
 
     // Get the name of raw data (as opposed to message) sender for interactions.
     const auto decision_sender_impl = _configuration.get(name::DECISION_SENDER_IMPLEMENTATION, value::DECISION_EH_SENDER);
-    i_sender* decision_data_sender;
 
-    // Use the name to create an instance of raw data sender for interactions
-    RETURN_IF_FAIL(_sender_factory->create(&decision_data_sender, decision_sender_impl, _configuration, &_error_cb, _trace_logger.get(), status));
-    RETURN_IF_FAIL(decision_data_sender->init(status));
+    // The event hub decision sender posts to the interaction hub.  In consolidated mode decisions and slates go
+    // through the interaction sender instead of two more senders of their own.
+    const bool share_interaction_sender = _logging_engine != nullptr
+      && strcmp(ranking_sender_impl, value::INTERACTION_EH_SENDER) == 0
+      && strcmp(decision_sender_impl, value::DECISION_EH_SENDER) == 0;
+    std::shared_ptr<i_sender> decision_data_sender = ranking_data_sender;
+    _decision_spill = _interaction_spill;
+    if (!share_interaction_sender) {
+      // Use the name to create an instance of raw data sender for interactions
+      i_sender* decision_sender_ptr;
+      RETURN_IF_FAIL(create_sender(&decision_sender_ptr, decision_sender_impl, interaction_coalescer, status));
+      decision_data_sender.reset(spill_if_configured(decision_sender_ptr, "decision", _decision_spill));
+      RETURN_IF_FAIL(decision_data_sender->init(status));
+    }
 
     // Create a message sender that will prepend the message with a preamble and send the raw data using the
     // factory created raw data sender
-    l::i_message_sender* decision_msg_sender = new l::preamble_message_sender(decision_data_sender);
+    l::i_message_sender* decision_msg_sender = compress_if_configured(new l::preamble_message_sender(decision_data_sender));
     RETURN_IF_FAIL(decision_msg_sender->init(status));
 
     i_time_provider* decision_time_provider;
     RETURN_IF_FAIL(_time_provider_factory->create(&decision_time_provider, time_provider_impl, _configuration, _trace_logger.get(), status));
 
     // Create a logger for interactions that will use msg sender to send interaction messages
-    _decision_logger.reset(new logger::ccb_logger_facade(_configuration, decision_msg_sender, _watchdog, decision_time_provider, &_error_cb));
+    _decision_logger.reset(new logger::ccb_logger_facade(_configuration, decision_msg_sender, _watchdog, decision_time_provider, &_error_cb, _logging_engine.get(), _scheduler.get(), _drop_level.get()));
     RETURN_IF_FAIL(_decision_logger->init(status));
 
-    // Get the name of raw data (as opposed to message) sender for interactions.
-    const auto* const slates_sender_impl = _configuration.get(name::DECISION_SENDER_IMPLEMENTATION, value::DECISION_EH_SENDER);
-    i_sender* slates_data_sender;
-
-    // Use the name to create an instance of raw data sender for interactions
-    RETURN_IF_FAIL(_sender_factory->create(&slates_data_sender, slates_sender_impl, _configuration, &_error_cb, _trace_logger.get(), status));
-    RETURN_IF_FAIL(slates_data_sender->init(status));
+    std::shared_ptr<i_sender> slates_data_sender = ranking_data_sender;
+    _slates_spill = _interaction_spill;
+    if (!share_interaction_sender) {
+      // Use the name to create an instance of raw data sender for interactions
+      i_sender* slates_sender_ptr;
+      RETURN_IF_FAIL(create_sender(&slates_sender_ptr, decision_sender_impl, interaction_coalescer, status));
+      slates_data_sender.reset(spill_if_configured(slates_sender_ptr, "slates", _slates_spill));
+      RETURN_IF_FAIL(slates_data_sender->init(status));
+    }
 
     // Create a message sender that will prepend the message with a preamble and send the raw data using the
     // factory created raw data sender
-    l::i_message_sender* slates_msg_sender = new l::preamble_message_sender(slates_data_sender);
+    l::i_message_sender* slates_msg_sender = compress_if_configured(new l::preamble_message_sender(slates_data_sender));
     RETURN_IF_FAIL(slates_msg_sender->init(status));
 
     i_time_provider* slates_time_provider;
     RETURN_IF_FAIL(_time_provider_factory->create(&slates_time_provider, time_provider_impl, _configuration, _trace_logger.get(), status));
 
     // // Create a logger for interactions that will use msg sender to send interaction messages
-    _slates_logger.reset(new logger::slates_logger_facade(_configuration, slates_msg_sender, _watchdog, slates_time_provider, &_error_cb));
+    _slates_logger.reset(new logger::slates_logger_facade(_configuration, slates_msg_sender, _watchdog, slates_time_provider, &_error_cb, _logging_engine.get(), _scheduler.get(), _drop_level.get()));
     RETURN_IF_FAIL(_slates_logger->init(status));
 
     return error_code::success;
   }
 
+  // With eventhub.coalesce.window_ms the event hub senders of this live model that post to the same hub share one
+  // coalescer, so that the interaction, decision and slates loggers fill the same requests.  The first of them
+  // creates the coalescer around its factory created sender, the others get a coalescing_sender on it.  Senders of
+  // other implementations are created as they are.
+  int live_model_impl::create_sender(i_sender** retval, const char* implementation, std::shared_ptr<l::batch_coalescer>& coalescer, api_status* status) {
+    const auto window = _configuration.get_int(name::EH_COALESCE_WINDOW_MS, value::DEFAULT_EH_COALESCE_WINDOW_MS);
+    const bool coalesce = window > 0 && (
+      strcmp(implementation, value::INTERACTION_EH_SENDER) == 0 ||
+      strcmp(implementation, value::DECISION_EH_SENDER) == 0 ||
+      strcmp(implementation, value::OBSERVATION_EH_SENDER) == 0);
+    if (coalesce && coalescer) {
+      *retval = new l::coalescing_sender(coalescer);
+      return error_code::success;
+    }
+    RETURN_IF_FAIL(_sender_factory->create(retval, implementation, _configuration, &_error_cb, _trace_logger.get(), status));
+    if (coalesce) {
+      l::coalescing_options options;
+      options.window = std::chrono::milliseconds(window);
+      options.max_bytes = _configuration.get_int(name::EH_COALESCE_MAX_BYTES, value::DEFAULT_EH_COALESCE_MAX_BYTES);
+      coalescer = std::make_shared<l::batch_coalescer>(*retval, options, &_error_cb, _trace_logger.get());
+      *retval = new l::coalescing_sender(coalescer);
+    }
+    return error_code::success;
+  }
+
+  i_sender* live_model_impl::spill_if_configured(i_sender* sender, const char* subdirectory, l::spill::spilling_sender*& spill) {
+    spill = nullptr;
+    const auto directory = _configuration.get(name::SPILL_DIR, nullptr);
+    if (directory == nullptr || *directory == '\0') {
+      return sender;
+    }
+    l::spill::spilling_sender_options options;
+    options.log.max_bytes = static_cast<size_t>(_configuration.get_int(name::SPILL_MAX_SIZE_MB, value::DEFAULT_SPILL_MAX_SIZE_MB)) * 1024 * 1024;
+    options.log.segment_bytes = static_cast<size_t>(_configuration.get_int(name::SPILL_SEGMENT_SIZE_MB, value::DEFAULT_SPILL_SEGMENT_SIZE_MB)) * 1024 * 1024;
+    spill = new l::spill::spilling_sender(sender, std::string(directory) + "/" + subdirectory, options, &_error_cb, _trace_logger.get());
+    return spill;
+  }
+
+  l::i_message_sender* live_model_impl::compress_if_configured(l::i_message_sender* sender) {
+    const std::string codec_name = _configuration.get(name::LOGGING_COMPRESSION, value::COMPRESSION_NONE);
+    l::compression_options options;
+    if (codec_name == value::COMPRESSION_LZ4) options.codec = l::compression_codec::lz4;
+    else if (codec_name == value::COMPRESSION_ZSTD) options.codec = l::compression_codec::zstd;
+    else if (codec_name != value::COMPRESSION_NONE) {
+      TRACE_WARN(_trace_logger.get(), "Unknown logging compression " + codec_name + ", batches are sent uncompressed.");
+    }
+    if (options.codec == l::compression_codec::none) {
+      return sender;
+    }
+    if (!l::compression_available(options.codec)) {
+      TRACE_WARN(_trace_logger.get(), codec_name + " compression is not built in, batches are sent uncompressed.");
+      return sender;
+    }
+    options.level = _configuration.get_int(name::LOGGING_COMPRESSION_LEVEL, value::DEFAULT_LOGGING_COMPRESSION_LEVEL);
+    options.min_bytes = _configuration.get_int(name::LOGGING_COMPRESSION_MIN_BYTES, value::DEFAULT_LOGGING_COMPRESSION_MIN_BYTES);
+    options.dictionary_file = _configuration.get(name::LOGGING_COMPRESSION_DICTIONARY, "");
+    return new l::compressing_message_sender(sender, options, _trace_logger.get());
+  }
+
+  int live_model_impl::init_shadow(api_status* status) {
+    const auto transport_impl = _configuration.get(name::SHADOW_MODEL_SRC, nullptr);
+    if (transport_impl == nullptr) {
+      return error_code::success;
+    }
+
+    // The shadow model uses the same implementation as the active model, but gets its own instance (and vw pool).
+    const auto model_impl = _configuration.get(name::MODEL_IMPLEMENTATION, value::VW);
+    m::i_model* pmodel;
+    RETURN_IF_FAIL(_m_factory->create(&pmodel, model_impl, _configuration, _trace_logger.get(), status));
+    _shadow.reset(new shadow_scorer(pmodel,
+      _configuration.get_int(name::SHADOW_THREAD_COUNT, value::DEFAULT_SHADOW_THREAD_COUNT),
+      _configuration.get_int(name::SHADOW_QUEUE_MAX_SIZE, value::DEFAULT_SHADOW_QUEUE_MAX_SIZE),
+      _configuration.get_float(name::SHADOW_SAMPLE_RATE, value::DEFAULT_SHADOW_SAMPLE_RATE),
+      _trace_logger.get()));
+    RETURN_IF_FAIL(_shadow->init(status));
+
+    // Transports read their location from the regular model settings, so point those at the shadow model.
+    u::configuration shadow_config(_configuration);
+    shadow_config.set(name::MODEL_BLOB_URI, _configuration.get(name::SHADOW_MODEL_BLOB_URI, ""));
+    shadow_config.set(name::MODEL_FILE_NAME, _configuration.get(name::SHADOW_MODEL_FILE_NAME, "shadow"));
+    m::i_data_transport* ptransport;
+    RETURN_IF_FAIL(_t_factory->create(&ptransport, transport_impl, shadow_config, _trace_logger.get(), status));
+    _shadow_transport.reset(ptransport);
+
+    if (_configuration.get_bool(name::MODEL_BACKGROUND_REFRESH, value::DEFAULT_MODEL_BACKGROUND_REFRESH)) {
+      const auto refresh_interval_ms = _configuration.get_int(name::SHADOW_MODEL_REFRESH_INTERVAL_MS,
+        _configuration.get_int(name::MODEL_REFRESH_INTERVAL_MS, 60 * 1000));
+      _bg_shadow_model_proc.reset(new u::periodic_background_proc<m::model_downloader>(refresh_interval_ms, _watchdog, "Shadow model downloader", &_error_cb));
+      _shadow_model_download.reset(new m::model_downloader(ptransport, &_shadow_data_cb, _trace_logger.get()));
+      return _bg_shadow_model_proc->init(_shadow_model_download.get(), status);
+    }
+
+    m::model_data md;
+    RETURN_IF_FAIL(_shadow_transport->get_data(md, status));
+    return _shadow->update_model(md, status);
+  }
+
   void inline live_model_impl::_handle_model_update(const m::model_data& data, live_model_impl* ctxt) {
     ctxt->handle_model_update(data);
   }
@@ -396,6 +610,37 @@ namespace reinforcement_learning {
     _model_ready = model_ready;
   }
 
+  void inline live_model_impl::_handle_model_stream(m::byte_pipe& pipe, live_model_impl* ctxt) {
+    ctxt->handle_model_stream(pipe);
+  }
+
+  void live_model_impl::handle_model_stream(m::byte_pipe& pipe) {
+    bool model_ready = false;
+    api_status status;
+
+    if (_model->update_streamed(pipe, model_ready, &status) != error_code::success) {
+      _error_cb.report_error(status);
+      return;
+    }
+    _model_ready = model_ready;
+  }
+
+  void inline live_model_impl::_handle_shadow_model_update(const m::model_data& data, live_model_impl* ctxt) {
+    ctxt->handle_shadow_model_update(data);
+  }
+
+  void live_model_impl::handle_shadow_model_update(const model_management::model_data& data) {
+    if (data.refresh_count() == 0) {
+      TRACE_INFO(_trace_logger, "Shadow model was not updated since previous download");
+      return;
+    }
+
+    api_status status;
+    if (_shadow->update_model(data, &status) != error_code::success) {
+      _error_cb.report_error(status);
+    }
+  }
+
   int live_model_impl::explore_only(const char* event_id, const char* context, ranking_response& response,
     api_status* status) const {
 
@@ -476,7 +721,8 @@ namespace reinforcement_learning {
 
     if (_bg_model_proc) {
       // Initialize background process and start downloading models
-      this->_model_download.reset(new m::model_downloader(ptransport, &_data_cb, _trace_logger.get()));
+      const auto stream_buffer_kb = _configuration.get_int(name::MODEL_DOWNLOAD_STREAM_BUFFER_KB, value::DEFAULT_MODEL_DOWNLOAD_STREAM_BUFFER_KB);
+      this->_model_download.reset(new m::model_downloader(ptransport, &_data_cb, _trace_logger.get(), static_cast<size_t>(stream_buffer_kb) * 1024));
       return _bg_model_proc->init(_model_download.get(), status);
     }
 
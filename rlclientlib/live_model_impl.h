@@ -1,9 +1,12 @@
 #pragma once
 #include "learning_mode.h"
 #include "logger/logger_facade.h"
+#include "logger/message_sender.h"
+#include "logger/spill/spilling_sender.h"
 #include "model_mgmt.h"
 #include "model_mgmt/data_callback_fn.h"
 #include "model_mgmt/model_downloader.h"
+#include "shadow_scorer.h"
 #include "utility/periodic_background_proc.h"
 
 #include "factory_resolver.h"
@@ -18,6 +21,7 @@ namespace reinforcement_learning
   class safe_vw;
   class ranking_response;
   class api_status;
+  namespace logger { class batch_coalescer; }
 
   class live_model_impl {
   public:
@@ -40,6 +44,14 @@ namespace reinforcement_learning
 
     int refresh_model(api_status* status);
 
+    int pin_model_version(const char* version, api_status* status);
+    int rollback_model(api_status* status);
+    int unpin_model_version(api_status* status);
+    int get_model_versions(std::vector<std::string>& versions, std::string& active_version, api_status* status);
+
+    int get_shadow_stats(shadow_stats& stats, api_status* status) const;
+    int get_logging_pressure(logging_pressure& pressure, api_status* status) const;
+
     explicit live_model_impl(
       const utility::configuration& config,
       error_fn fn,
@@ -61,8 +73,19 @@ namespace reinforcement_learning
     int init_model_mgmt(api_status* status);
     int init_loggers(api_status* status);
     int init_trace(api_status* status);
+    int init_shadow(api_status* status);
+    // Creates a raw data sender, see the definition for how event hub senders share a coalescer
+    int create_sender(i_sender** retval, const char* implementation, std::shared_ptr<logger::batch_coalescer>& coalescer, api_status* status);
+    // Wraps sender in a spilling_sender on <spill.dir>/subdirectory when spill.dir is set
+    i_sender* spill_if_configured(i_sender* sender, const char* subdirectory, logger::spill::spilling_sender*& spill);
+    // Wraps sender in a compressing_message_sender when logging.compression names a codec
+    logger::i_message_sender* compress_if_configured(logger::i_message_sender* sender);
     static void _handle_model_update(const model_management::model_data& data, live_model_impl* ctxt);
     void handle_model_update(const model_management::model_data& data);
+    static void _handle_model_stream(model_management::byte_pipe& pipe, live_model_impl* ctxt);
+    void handle_model_stream(model_management::byte_pipe& pipe);
+    static void _handle_shadow_model_update(const model_management::model_data& data, live_model_impl* ctxt);
+    void handle_shadow_model_update(const model_management::model_data& data);
     int explore_only(const char* event_id, const char* context, ranking_response& response, api_status* status) const;
     int explore_exploit(const char* event_id, const char* context, ranking_response& response, api_status* status) const;
     template<typename D>
@@ -75,7 +98,10 @@ namespace reinforcement_learning
     utility::configuration _configuration;
     error_callback_fn _error_cb;
     model_management::data_callback_fn _data_cb;
+    model_management::data_callback_fn _shadow_data_cb;
     utility::watchdog _watchdog;
+    // Shared with the other live models, declared early so that it outlives the procedures scheduled on it
+    std::shared_ptr<utility::background_scheduler> _scheduler{nullptr};
     learning_mode _learning_mode;
 
     trace_logger_factory_t* _trace_factory;
@@ -86,14 +112,28 @@ namespace reinforcement_learning
 
     std::unique_ptr<model_management::i_data_transport> _transport{nullptr};
     std::unique_ptr<model_management::i_model> _model{nullptr};
+    // Declared before the loggers, whose batchers it drains, so that it outlives them
+    std::unique_ptr<logger::logging_engine> _logging_engine{nullptr};
+    std::unique_ptr<logger::drop_level> _drop_level{nullptr};
     std::unique_ptr<logger::cb_logger_facade> _ranking_logger{nullptr};
     std::unique_ptr<logger::observation_logger_facade> _outcome_logger{nullptr};
     std::unique_ptr<logger::ccb_logger_facade> _decision_logger{nullptr};
     std::unique_ptr<logger::slates_logger_facade> _slates_logger{nullptr};
+    // Owned by the message senders of the loggers above, null unless spill.dir is set
+    logger::spill::spilling_sender* _interaction_spill = nullptr;
+    logger::spill::spilling_sender* _observation_spill = nullptr;
+    logger::spill::spilling_sender* _decision_spill = nullptr;
+    logger::spill::spilling_sender* _slates_spill = nullptr;
     std::unique_ptr<model_management::model_downloader> _model_download{nullptr};
     std::unique_ptr<i_trace> _trace_logger{nullptr};
 
     std::unique_ptr<utility::periodic_background_proc<model_management::model_downloader>> _bg_model_proc;
+
+    // Optional shadow model, scored off the request path.  Declared after the active model so that it is torn down first.
+    std::unique_ptr<model_management::i_data_transport> _shadow_transport{nullptr};
+    std::unique_ptr<shadow_scorer> _shadow{nullptr};
+    std::unique_ptr<model_management::model_downloader> _shadow_model_download{nullptr};
+    std::unique_ptr<utility::periodic_background_proc<model_management::model_downloader>> _bg_shadow_model_proc;
     uint64_t _seed_shift;
   };
 
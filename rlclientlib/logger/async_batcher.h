@@ -5,6 +5,10 @@
 #include "../error_callback_fn.h"
 #include "err_constants.h"
 #include "data_buffer.h"
+#include "batch_controller.h"
+#include "drop_level.h"
+#include "logging_pressure.h"
+#include "logging_engine.h"
 #include "utility/periodic_background_proc.h"
 
 #include "serialization/fb_serializer.h"
@@ -12,11 +16,15 @@
 #include "message_sender.h"
 #include "utility/object_pool.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
 namespace reinforcement_learning {
   //this enum sets the behavior of the queue managed by the async_batcher
   enum queue_mode_enum {
     DROP,//queue drops events if it is full (default)
-    BLOCK//queue block if it is full
+    BLOCK//queue block if it is full, for up to the block timeout
   };
 
   //convert a string to an enum value
@@ -28,22 +36,38 @@ namespace reinforcement_learning { namespace logger {
 
   // This class takes uses a queue and a background thread to accumulate events, and send them by batch asynchronously.
   // A batch is shipped with TSender::send(data)
+  // When given a logging_engine, the engine's thread drains the queue instead of a thread of its own, when given a
+  // background_scheduler its workers do.
+  // Batchers given the same drop_level shed their events together, see drop_level.
+  // In BLOCK mode append waits at most block_timeout_ms for room, 0 waits for as long as it takes.
+  // With adaptive batching options the batch size and interval are tuned by a batch_controller, starting from
+  // send_high_water_mark and batch_timeout_ms.  The queue is then checked every min_interval and flushed once the
+  // current interval has passed or a full batch is queued.
+  // A non zero max_message_size is a hard limit on the size of a batch, preamble included.  Batches are then packed
+  // against the exact serialized size: an event that would cross the limit is taken back out of its batch and starts
+  // the next one.  An event too large for any batch is sent on its own.
   template<typename TEvent, template<typename> class TSerializer = json_collection_serializer>
-  class async_batcher {
+  class async_batcher : public i_batch_source {
   public:
     int init(api_status* status);
 
     int append(TEvent&& evt, api_status* status = nullptr);
     int append(TEvent& evt, api_status* status = nullptr);
 
-    int run_iteration(api_status* status);
+    int run_iteration(api_status* status) override;
+
+    queue_pressure get_pressure() const;
 
   private:
     int fill_buffer(std::shared_ptr<utility::data_buffer>& retbuffer,
       size_t& remaining, 
+      TEvent& carried,
+      bool& has_carried,
       api_status* status);
 
     void flush(); //flush all batches
+    bool flush_due() const;
+    float refresh_drop_rate() const;
 
   public:
     async_batcher(i_message_sender* sender,
@@ -52,7 +76,14 @@ namespace reinforcement_learning { namespace logger {
                   size_t send_high_water_mark = (1024 * 1024 * 4),
                   size_t batch_timeout_ms = 1000,
                   size_t queue_max_capacity = (16 * 1024 * 1024),
-                  queue_mode_enum queue_mode = DROP);
+                  queue_mode_enum queue_mode = DROP,
+                  logging_engine* engine = nullptr,
+                  logging_priority priority = logging_priority::interaction,
+                  utility::background_scheduler* scheduler = nullptr,
+                  drop_level* shared_drop_level = nullptr,
+                  size_t block_timeout_ms = 0,
+                  const batch_controller_options* adaptive_batching = nullptr,
+                  size_t max_message_size = 0);
     ~async_batcher();
 
   private:
@@ -60,35 +91,89 @@ namespace reinforcement_learning { namespace logger {
 
     event_queue<TEvent> _queue;       // A queue to accumulate batch of events.
     size_t _send_high_water_mark;
+    const size_t _max_message_size;
     error_callback_fn* _perror_cb;
 
     utility::periodic_background_proc<async_batcher> _periodic_background_proc;
-    float _pass_prob;
+    logging_engine* _engine;
+    const logging_priority _priority;
+    // Period of run_iteration, the minimum interval with adaptive batching
+    const std::chrono::milliseconds _batch_timeout;
+    std::unique_ptr<batch_controller> _controller;
+    std::chrono::steady_clock::time_point _last_flush;
+    std::atomic<int64_t> _send_latency_us{ 0 };
+    drop_level* _drop_level;
+    size_t _drop_source;
     queue_mode_enum _queue_mode;
+    const std::chrono::milliseconds _block_timeout;
     std::condition_variable _cv;
     std::mutex _m;
+
+    std::atomic<uint64_t> _appended{ 0 };
+    std::atomic<uint64_t> _dropped{ 0 };
+    std::atomic<uint64_t> _block_timeouts{ 0 };
+    // Recent drop rate, refreshed at most once per batch interval.  Readers refresh it too, so that it stays current
+    // while the background thread is stuck in a send.
+    mutable std::mutex _rate_mutex;
+    mutable float _drop_rate = 0.f;
+    mutable uint64_t _last_appended = 0;
+    mutable uint64_t _last_dropped = 0;
+    mutable std::chrono::steady_clock::time_point _last_rate_update;
     utility::object_pool<utility::data_buffer> _buffer_pool;
   };
 
   template<typename TEvent, template<typename> class TSerializer>
   int async_batcher<TEvent, TSerializer>::init(api_status* status) {
+    if (_engine != nullptr) {
+      _engine->add(this, _priority, _batch_timeout);
+      return error_code::success;
+    }
     RETURN_IF_FAIL(_periodic_background_proc.init(this, status));
     return error_code::success;
   }
 
   template<typename TEvent, template<typename> class TSerializer>
   int async_batcher<TEvent, TSerializer>::append(TEvent&& evt, api_status* status) {
-    _queue.push(std::move(evt), TSerializer<TEvent>::serializer_t::size_estimate(evt));
-
-    //block or drop events if the queue if full
-    if (_queue.is_full()) {
-      if (BLOCK == _queue_mode) {
-        std::unique_lock<std::mutex> lk(_m);
-        _cv.wait(lk, [this] { return !_queue.is_full(); });
+    const auto item_size = TSerializer<TEvent>::serializer_t::size_estimate(evt);
+    ++_appended;
+
+    //drop events as the queue fills up, or block once it is full
+    if (DROP == _queue_mode && _drop_level != nullptr) {
+      _drop_level->set(_drop_source, _queue.admission_prob());
+      // An outcome is worthless without its interaction, and is dropped before it is ever serialized
+      const bool follows = _priority == logging_priority::observation;
+      if (follows && _drop_level->was_shed(evt.get_seed_id())) {
+        ++_dropped;
+        return error_code::success;
+      }
+      // try_push only moves from the event once it is admitted
+      if (!_queue.try_push(std::move(evt), item_size, _drop_level->level())) {
+        ++_dropped;
+        if (!follows) {
+          _drop_level->remember_shed(evt.get_seed_id());
+        }
+      }
+    }
+    else if (DROP == _queue_mode) {
+      if (!_queue.try_push(std::move(evt), item_size)) {
+        ++_dropped;
       }
-      else if (DROP == _queue_mode) {
-        _queue.prune(_pass_prob);
+    }
+    else {
+      // Wait for room before queuing, so that a stuck sender cannot hold request threads forever
+      if (_queue.is_full()) {
+        std::unique_lock<std::mutex> lk(_m);
+        const auto has_room = [this] { return !_queue.is_full(); };
+        if (_block_timeout.count() == 0) {
+          _cv.wait(lk, has_room);
+        }
+        else if (!_cv.wait_for(lk, _block_timeout, has_room)) {
+          ++_dropped;
+          ++_block_timeouts;
+          RETURN_ERROR_LS(nullptr, status, logging_queue_timeout) << _block_timeout.count() << " ms";
+        }
       }
+      _queue.push(std::move(evt), item_size);
     }
 
     return error_code::success;
@@ -101,26 +186,113 @@ namespace reinforcement_learning { namespace logger {
 
   template<typename TEvent, template<typename> class TSerializer>
   int async_batcher<TEvent, TSerializer>::run_iteration(api_status* status) {
-    flush();
+    if (_controller == nullptr) {
+      flush();
+    }
+    else if (flush_due()) {
+      const auto queued_bytes = _queue.capacity();
+      _last_flush = std::chrono::steady_clock::now();
+      flush();
+      _controller->on_flush(queued_bytes);
+    }
+    if (_drop_level != nullptr) {
+      _drop_level->set(_drop_source, _queue.admission_prob());
+    }
+    refresh_drop_rate();
     return error_code::success;
   }
 
+  template<typename TEvent, template<typename> class TSerializer>
+  bool async_batcher<TEvent, TSerializer>::flush_due() const {
+    return std::chrono::steady_clock::now() - _last_flush >= _controller->interval()
+      || _queue.capacity() >= _controller->batch_size();
+  }
+
+  template<typename TEvent, template<typename> class TSerializer>
+  float async_batcher<TEvent, TSerializer>::refresh_drop_rate() const {
+    std::lock_guard<std::mutex> lock(_rate_mutex);
+    const auto now = std::chrono::steady_clock::now();
+    if (now - _last_rate_update < _batch_timeout) {
+      return _drop_rate;
+    }
+
+    // Smooth the rate over the last few intervals, it decays while nothing is appended.  Every drop is counted after
+    // its append, so the drops are read first.
+    const uint64_t dropped = _dropped;
+    const uint64_t appended = _appended;
+    float interval_rate = 0.f;
+    if (appended > _last_appended) {
+      interval_rate = (std::min)(1.f, static_cast<float>(dropped - _last_dropped) / static_cast<float>(appended - _last_appended));
+    }
+    _drop_rate = (_drop_rate + interval_rate) / 2;
+    _last_appended = appended;
+    _last_dropped = dropped;
+    _last_rate_update = now;
+    return _drop_rate;
+  }
+
+  template<typename TEvent, template<typename> class TSerializer>
+  queue_pressure async_batcher<TEvent, TSerializer>::get_pressure() const {
+    queue_pressure pressure;
+    pressure.fill_ratio = _queue.fill_ratio();
+    pressure.drop_rate = refresh_drop_rate();
+    pressure.dropped = _dropped;
+    pressure.block_timeouts = _block_timeouts;
+    pressure.send_latency_us = _send_latency_us;
+    if (_controller != nullptr) {
+      const auto batching = _controller->get_stats();
+      pressure.batch_size = batching.batch_size;
+      pressure.batch_interval_ms = batching.interval.count();
+      pressure.batching_adjustments = batching.size_increases + batching.size_decreases
+        + batching.interval_increases + batching.interval_decreases;
+    }
+    else {
+      pressure.batch_size = _send_high_water_mark;
+      pressure.batch_interval_ms = _batch_timeout.count();
+    }
+    return pressure;
+  }
+
   template<typename TEvent, template<typename> class TSerializer>
   int async_batcher<TEvent, TSerializer>::fill_buffer(
                                                       std::shared_ptr<utility::data_buffer>& buffer, 
                                                       size_t& remaining, 
+                                                      TEvent& carried,
+                                                      bool& has_carried,
                                                       api_status* status)
   {
     TEvent evt;
     TSerializer<TEvent> collection_serializer(*buffer.get());
+    size_t high_water_mark = _controller != nullptr ? _controller->batch_size() : _send_high_water_mark;
+    const size_t max_body_size = _max_message_size > buffer->preamble_size() ? _max_message_size - buffer->preamble_size() : 0;
+    if (_max_message_size > 0) {
+      high_water_mark = (std::min)(high_water_mark, max_body_size);
+    }
 
-    while (remaining > 0 && collection_serializer.size() < _send_high_water_mark) {
+    bool empty = true;
+    if (has_carried) {
+      has_carried = false;
+      empty = false;
+      RETURN_IF_FAIL(collection_serializer.add(carried, status));
+    }
+
+    // Every batch takes at least one event, so that flush makes progress whatever the limits
+    while (remaining > 0 && (empty || collection_serializer.size() < high_water_mark)) {
       if (_queue.pop(&evt)) {
         if (BLOCK == _queue_mode) {
+          // Taking the lock orders the pop before a waiter's check, so that the wakeup is not lost
+          { std::lock_guard<std::mutex> lk(_m); }
           _cv.notify_one();
         }
         RETURN_IF_FAIL(collection_serializer.add(evt, status));
         --remaining;
+        if (_max_message_size > 0 && !empty && collection_serializer.finalized_size() > max_body_size) {
+          collection_serializer.remove_last();
+          carried = std::move(evt);
+          has_carried = true;
+          break;
+        }
+        empty = false;
       }
     }
 
@@ -139,19 +311,32 @@ namespace reinforcement_learning { namespace logger {
     }
 
     auto remaining = queue_size;
+    // The event taken back out of a full batch, it starts the next one
+    TEvent carried;
+    bool has_carried = false;
     // Handle batching
-    while (remaining > 0) {
+    while (remaining > 0 || has_carried) {
       api_status status;
 
       auto buffer = _buffer_pool.acquire();
 
-      if (fill_buffer(buffer, remaining, &status) != error_code::success) {
+      if (fill_buffer(buffer, remaining, carried, has_carried, &status) != error_code::success) {
         ERROR_CALLBACK(_perror_cb, status);
       }
 
+      const auto send_start = std::chrono::steady_clock::now();
       if (_sender->send(TSerializer<TEvent>::message_id(), buffer, &status) != error_code::success) {
         ERROR_CALLBACK(_perror_cb, status);
       }
+      // Asynchronous senders return before the request completes, their completion latency is the one that counts.
+      // Waiting for a slot of their window still shows in the time of the call.
+      const auto latency = (std::max)(_sender->completion_latency(),
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - send_start));
+      const auto smoothed = _send_latency_us.load();
+      _send_latency_us = smoothed == 0 ? latency.count() : (3 * smoothed + latency.count()) / 4;
+      if (_controller != nullptr) {
+        _controller->on_send(latency, _sender->window_occupancy());
+      }
     }
   }
 
@@ -159,19 +344,37 @@ namespace reinforcement_learning { namespace logger {
   async_batcher<TEvent, TSerializer>::async_batcher(
     i_message_sender* sender, utility::watchdog& watchdog, 
 	  error_callback_fn* perror_cb, const size_t send_high_water_mark,
-    const size_t batch_timeout_ms, const size_t queue_max_capacity, queue_mode_enum queue_mode)
+    const size_t batch_timeout_ms, const size_t queue_max_capacity, queue_mode_enum queue_mode,
+    logging_engine* engine, logging_priority priority, utility::background_scheduler* scheduler,
+    drop_level* shared_drop_level, size_t block_timeout_ms, const batch_controller_options* adaptive_batching,
+    size_t max_message_size)
     : _sender(sender)
     , _queue(queue_max_capacity)
     , _send_high_water_mark(send_high_water_mark)
+    , _max_message_size(max_message_size)
     , _perror_cb(perror_cb)
-    , _periodic_background_proc(static_cast<int>(batch_timeout_ms), watchdog, "Async batcher thread", perror_cb)
-    , _pass_prob(0.5)
+    , _periodic_background_proc(static_cast<int>(adaptive_batching != nullptr ? adaptive_batching->min_interval.count() : batch_timeout_ms),
+        watchdog, "Async batcher thread", perror_cb, scheduler)
+    , _engine(engine)
+    , _priority(priority)
+    , _batch_timeout(adaptive_batching != nullptr ? adaptive_batching->min_interval : std::chrono::milliseconds(batch_timeout_ms))
+    , _controller(adaptive_batching != nullptr
+        ? new batch_controller(*adaptive_batching, send_high_water_mark, std::chrono::milliseconds(batch_timeout_ms))
+        : nullptr)
+    , _last_flush(std::chrono::steady_clock::now())
+    , _drop_level(shared_drop_level)
+    , _drop_source(shared_drop_level != nullptr ? shared_drop_level->add_source() : 0)
     , _queue_mode(queue_mode)
+    , _block_timeout(block_timeout_ms)
+    , _last_rate_update(std::chrono::steady_clock::now())
   {}
 
   template<typename TEvent, template<typename> class TSerializer>
   async_batcher<TEvent, TSerializer>::~async_batcher() {
     // Stop the background procedure the queue before exiting
+    if (_engine != nullptr) {
+      _engine->remove(this);
+    }
     _periodic_background_proc.stop();
     if (_queue.size() > 0) {
       flush();
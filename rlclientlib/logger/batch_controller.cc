@@ -0,0 +1,88 @@
+#include "batch_controller.h"
+
+#include <algorithm>
+
+namespace reinforcement_learning { namespace logger {
+  namespace {
+    template <typename T>
+    T clamp(T value, T low, T high) {
+      return (std::max)(low, (std::min)(value, high));
+    }
+  }
+
+  batch_controller::batch_controller(const batch_controller_options& options, size_t initial_batch_size,
+    std::chrono::milliseconds initial_interval)
+    : _options(options)
+    , _batch_size(clamp(initial_batch_size, options.min_batch_size, options.max_batch_size))
+    , _interval_ms(clamp(initial_interval, options.min_interval, options.max_interval).count())
+  {}
+
+  size_t batch_controller::batch_size() const {
+    return _batch_size;
+  }
+
+  std::chrono::milliseconds batch_controller::interval() const {
+    return std::chrono::milliseconds(_interval_ms.load());
+  }
+
+  void batch_controller::on_send(std::chrono::microseconds latency, float occupancy) {
+    _flush_latency = (std::max)(_flush_latency, latency);
+    _flush_occupancy = (std::max)(_flush_occupancy, occupancy);
+    _flush_sent = true;
+  }
+
+  void batch_controller::on_flush(size_t queued_bytes) {
+    if (!_flush_sent) {
+      // Nothing was queued, only let the interval grow towards the maximum
+      const auto interval = _interval_ms.load();
+      if (interval < _options.max_interval.count()) {
+        _interval_ms = (std::min)(interval + _options.min_interval.count(), _options.max_interval.count());
+        ++_interval_increases;
+      }
+      return;
+    }
+
+    const auto size = _batch_size.load();
+    const bool congested = _flush_latency > _options.target_latency;
+    const bool saturated = _flush_occupancy >= _options.high_occupancy;
+
+    if (congested && size > _options.min_batch_size) {
+      _batch_size = (std::max)(size / 2, _options.min_batch_size);
+      ++_size_decreases;
+    }
+    else if (!congested && queued_bytes >= size && size < _options.max_batch_size) {
+      // Batches were cut at the size limit, larger ones cost fewer sends
+      _batch_size = (std::min)(size + _options.min_batch_size, _options.max_batch_size);
+      ++_size_increases;
+    }
+
+    const auto interval = _interval_ms.load();
+    if (saturated || queued_bytes < size / 2) {
+      if (interval < _options.max_interval.count()) {
+        _interval_ms = (std::min)(interval + _options.min_interval.count(), _options.max_interval.count());
+        ++_interval_increases;
+      }
+    }
+    else if (queued_bytes > size && !congested) {
+      if (interval > _options.min_interval.count()) {
+        _interval_ms = (std::max)(interval / 2, _options.min_interval.count());
+        ++_interval_decreases;
+      }
+    }
+
+    _flush_latency = std::chrono::microseconds(0);
+    _flush_occupancy = -1.f;
+    _flush_sent = false;
+  }
+
+  batch_controller_stats batch_controller::get_stats() const {
+    batch_controller_stats stats;
+    stats.batch_size = _batch_size;
+    stats.interval = interval();
+    stats.size_increases = _size_increases;
+    stats.size_decreases = _size_decreases;
+    stats.interval_increases = _interval_increases;
+    stats.interval_decreases = _interval_decreases;
+    return stats;
+  }
+}}
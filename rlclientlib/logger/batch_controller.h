@@ -0,0 +1,67 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace reinforcement_learning { namespace logger {
+  struct batch_controller_options {
+    size_t min_batch_size = 16 * 1024;
+    size_t max_batch_size = 256 * 1024;
+    std::chrono::milliseconds min_interval{ 50 };
+    std::chrono::milliseconds max_interval{ 1000 };
+    // Sends taking longer than this are taken as congestion
+    std::chrono::milliseconds target_latency{ 100 };
+    // In-flight window occupancy from which the sender is taken as saturated
+    float high_occupancy = 0.9f;
+  };
+
+  struct batch_controller_stats {
+    size_t batch_size = 0;
+    std::chrono::milliseconds interval{ 0 };
+    uint64_t size_increases = 0;
+    uint64_t size_decreases = 0;
+    uint64_t interval_increases = 0;
+    uint64_t interval_decreases = 0;
+  };
+
+  // Tunes the batch size and flush interval of an async_batcher within the configured bounds.
+  //
+  // The batch size follows AIMD on send latency: it grows by min_batch_size after a flush whose sends all stayed
+  // under the target latency and whose batches were full, and is halved after a flush with a slower send.  The
+  // interval follows the queue: it is halved when more than a batch piles up between flushes and the sender has
+  // room, and grows by min_interval when traffic is light or the sender's in-flight window is saturated, so that
+  // fewer and fuller batches go out.
+  //
+  // on_send and on_flush are called from the thread that flushes, the getters from any thread.
+  class batch_controller {
+  public:
+    batch_controller(const batch_controller_options& options, size_t initial_batch_size,
+      std::chrono::milliseconds initial_interval);
+
+    size_t batch_size() const;
+    std::chrono::milliseconds interval() const;
+
+    // After each send of a flush, occupancy is negative for senders without an in-flight window
+    void on_send(std::chrono::microseconds latency, float occupancy);
+    // After each flush, queued_bytes is what the queue held when it started
+    void on_flush(size_t queued_bytes);
+
+    batch_controller_stats get_stats() const;
+    const batch_controller_options& options() const { return _options; }
+
+  private:
+    const batch_controller_options _options;
+    std::atomic<size_t> _batch_size;
+    std::atomic<std::chrono::milliseconds::rep> _interval_ms;
+    std::atomic<uint64_t> _size_increases{ 0 };
+    std::atomic<uint64_t> _size_decreases{ 0 };
+    std::atomic<uint64_t> _interval_increases{ 0 };
+    std::atomic<uint64_t> _interval_decreases{ 0 };
+
+    // Worst of the sends of the current flush, flushing thread only
+    std::chrono::microseconds _flush_latency{ 0 };
+    float _flush_occupancy = -1.f;
+    bool _flush_sent = false;
+  };
+}}
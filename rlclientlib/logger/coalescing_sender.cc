@@ -0,0 +1,147 @@
+#include "coalescing_sender.h"
+#include "api_status.h"
+#include "err_constants.h"
+#include "error_callback_fn.h"
+#include "trace_logger.h"
+
+#include <cstring>
+
+namespace reinforcement_learning { namespace logger {
+  batch_coalescer::batch_coalescer(i_sender* destination, const coalescing_options& options, error_callback_fn* error_cb,
+    i_trace* trace)
+    : _destination(destination), _options(options), _error_cb(error_cb), _trace(trace)
+  {}
+
+  batch_coalescer::~batch_coalescer() {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _cv.notify_all();
+    if (_thread.joinable()) _thread.join();
+  }
+
+  int batch_coalescer::init(api_status* status) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_initialized) return error_code::success;
+    RETURN_IF_FAIL(_destination->init(status));
+    try {
+      _thread = std::thread(&batch_coalescer::run, this);
+    }
+    catch (const std::exception& e) {
+      RETURN_ERROR_LS(_trace, status, background_thread_start) << "batch coalescer: " << e.what();
+    }
+    _initialized = true;
+    return error_code::success;
+  }
+
+  int batch_coalescer::send(const i_sender::buffer& data, api_status* status) {
+    const auto size = data->buffer_filled_size();
+    bool queued = false;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (_pending_bytes == 0 || _pending_bytes + size <= _options.max_bytes) {
+        queue(data);
+        queued = true;
+        if (_pending_bytes < _options.max_bytes) return error_code::success;
+      }
+    }
+
+    // The request is as large as it gets, the caller sends it and feels the destination's back pressure
+    std::lock_guard<std::mutex> send_lock(_send_mutex);
+    RETURN_IF_FAIL(flush(status));
+    if (!queued) {
+      // It did not fit next to what was pending, it starts the next request
+      std::lock_guard<std::mutex> lock(_mutex);
+      queue(data);
+    }
+    return error_code::success;
+  }
+
+  void batch_coalescer::add_undelivered_handler(i_sender::undelivered_fn handler) {
+    _destination->add_undelivered_handler(std::move(handler));
+  }
+
+  void batch_coalescer::queue(const i_sender::buffer& data) {
+    if (_pending.empty()) {
+      _deadline = std::chrono::steady_clock::now() + _options.window;
+      _cv.notify_one();
+    }
+    _pending.push_back(data);
+    _pending_bytes += data->buffer_filled_size();
+    ++_stats.batches;
+  }
+
+  coalescing_stats batch_coalescer::get_stats() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+  }
+
+  void batch_coalescer::run() {
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cv.wait(lock, [this] { return _stop || !_pending.empty(); });
+        if (!_stop) {
+          _cv.wait_until(lock, _deadline, [this] { return _stop || _pending.empty(); });
+        }
+        if (_pending.empty()) {
+          if (_stop) break;
+          continue;
+        }
+      }
+
+      std::lock_guard<std::mutex> send_lock(_send_mutex);
+      api_status status;
+      if (flush(&status) != error_code::success) {
+        ERROR_CALLBACK(_error_cb, status);
+      }
+    }
+  }
+
+  int batch_coalescer::flush(api_status* status) {
+    std::vector<i_sender::buffer> batches;
+    size_t bytes;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      batches.swap(_pending);
+      bytes = _pending_bytes;
+      _pending_bytes = 0;
+      if (batches.empty()) return error_code::success;
+      ++_stats.posts;
+      _stats.bytes += bytes;
+    }
+    if (batches.size() == 1) return _destination->send(batches.front(), status);
+
+    // The first frame's preamble lands in the preamble region, everything else follows it in the body
+    const auto preamble_size = batches.front()->preamble_size();
+    auto request = std::make_shared<utility::data_buffer>(bytes - preamble_size);
+    auto out = request->preamble_begin();
+    for (const auto& batch : batches) {
+      memcpy(out, batch->preamble_begin(), batch->buffer_filled_size());
+      out += batch->buffer_filled_size();
+    }
+    request->set_body_endoffset(bytes);
+    return _destination->send(request, status);
+  }
+
+  coalescing_sender::coalescing_sender(std::shared_ptr<batch_coalescer> coalescer)
+    : _coalescer(std::move(coalescer))
+  {}
+
+  int coalescing_sender::init(api_status* status) {
+    return _coalescer->init(status);
+  }
+
+  void coalescing_sender::add_undelivered_handler(undelivered_fn handler) {
+    _coalescer->add_undelivered_handler(std::move(handler));
+  }
+
+  const std::shared_ptr<batch_coalescer>& coalescing_sender::coalescer() const {
+    return _coalescer;
+  }
+
+  int coalescing_sender::v_send(const buffer& data, api_status* status) {
+    return _coalescer->send(data, status);
+  }
+}}
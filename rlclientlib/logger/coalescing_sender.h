@@ -0,0 +1,96 @@
+#pragma once
+#include "sender.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace reinforcement_learning {
+  class i_trace;
+  class error_callback_fn;
+}
+
+namespace reinforcement_learning { namespace logger {
+  struct coalescing_options {
+    std::chrono::milliseconds window{ 20 };  // how long the first batch waits for company
+    size_t max_bytes = 256 * 1024;           // request body limit of the endpoint
+  };
+
+  struct coalescing_stats {
+    uint64_t batches = 0;  // batches handed to the coalescer
+    uint64_t posts = 0;    // sends to the destination
+    uint64_t bytes = 0;
+  };
+
+  // Collects the preamble framed batches of one or more loggers that post to the same destination and sends the
+  // ones that arrive within a short window as a single request body, the frames back to back:
+  //
+  //   preamble | body | preamble | body | ...
+  //
+  // Each preamble carries the size of its body, so the receiver splits the request the same way it reads a file
+  // written by the file sender.  A request never exceeds max_bytes unless a single batch does.  A lone batch is
+  // passed on as it is, without a copy.
+  class batch_coalescer {
+  public:
+    // Takes the ownership of the destination sender
+    batch_coalescer(i_sender* destination, const coalescing_options& options, error_callback_fn* error_cb, i_trace* trace);
+    // Sends what is pending
+    ~batch_coalescer();
+
+    // Initializes the destination and starts the timer thread, later calls do nothing
+    int init(api_status* status);
+    int send(const i_sender::buffer& data, api_status* status);
+
+    coalescing_stats get_stats();
+    // Undelivered requests go to the handlers with all the batches they carried
+    void add_undelivered_handler(i_sender::undelivered_fn handler);
+
+    batch_coalescer(const batch_coalescer&) = delete;
+    batch_coalescer& operator=(const batch_coalescer&) = delete;
+
+  private:
+    void run();
+    // Appends to the pending request, the caller holds _mutex
+    void queue(const i_sender::buffer& data);
+    // Sends the pending batches, the caller holds _send_mutex
+    int flush(api_status* status);
+
+    std::unique_ptr<i_sender> _destination;
+    const coalescing_options _options;
+    error_callback_fn* _error_cb;
+    i_trace* _trace;
+
+    std::mutex _send_mutex;  // orders sends to the destination, taken before _mutex
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    std::vector<i_sender::buffer> _pending;
+    size_t _pending_bytes = 0;
+    std::chrono::steady_clock::time_point _deadline;
+    bool _initialized = false;
+    bool _stop = false;
+    coalescing_stats _stats;
+    std::thread _thread;
+  };
+
+  // The i_sender a logger sees, several of them can share one coalescer.
+  class coalescing_sender : public i_sender {
+  public:
+    explicit coalescing_sender(std::shared_ptr<batch_coalescer> coalescer);
+
+    int init(api_status* status) override;
+    void add_undelivered_handler(undelivered_fn handler) override;
+
+    const std::shared_ptr<batch_coalescer>& coalescer() const;
+
+  protected:
+    int v_send(const buffer& data, api_status* status) override;
+
+  private:
+    const std::shared_ptr<batch_coalescer> _coalescer;
+  };
+}}
@@ -0,0 +1,51 @@
+#include "compressing_sender.h"
+#include "api_status.h"
+#include "err_constants.h"
+#include "message_type.h"
+#include "trace_logger.h"
+
+namespace reinforcement_learning { namespace logger {
+  compressing_message_sender::compressing_message_sender(i_message_sender* sender, const compression_options& options,
+    i_trace* trace)
+    : _sender(sender), _compressor(options.codec, options.level), _min_bytes(options.min_bytes),
+    _dictionary_file(options.dictionary_file), _trace(trace)
+  {}
+
+  int compressing_message_sender::send(const uint16_t msg_type, const buffer& db, api_status* status) {
+    const auto size = db->body_filled_size();
+    if (size < _min_bytes) {
+      return _sender->send(msg_type, db, status);
+    }
+
+    auto compressed = _buffer_pool.acquire();
+    api_status compress_status;
+    if (_compressor.compress(msg_type, db->body_begin(), size, *compressed, &compress_status) != error_code::success) {
+      TRACE_WARN(_trace, std::string("Sending a batch uncompressed: ") + compress_status.get_error_msg());
+      return _sender->send(msg_type, db, status);
+    }
+    if (compressed->body_filled_size() >= size) {
+      return _sender->send(msg_type, db, status);
+    }
+    return _sender->send(message_type::compressed, compressed, status);
+  }
+
+  int compressing_message_sender::init(api_status* status) {
+    if (!_dictionary_file.empty()) {
+      std::vector<uint8_t> dictionary;
+      api_status dictionary_status;
+      if (read_dictionary_file(_dictionary_file, dictionary, &dictionary_status) != error_code::success ||
+        _compressor.set_dictionary(dictionary, &dictionary_status) != error_code::success) {
+        TRACE_WARN(_trace, std::string("Compressing without a dictionary: ") + dictionary_status.get_error_msg());
+      }
+    }
+    return _sender->init(status);
+  }
+
+  float compressing_message_sender::window_occupancy() const {
+    return _sender->window_occupancy();
+  }
+
+  std::chrono::microseconds compressing_message_sender::completion_latency() const {
+    return _sender->completion_latency();
+  }
+}}
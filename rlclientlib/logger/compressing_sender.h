@@ -0,0 +1,43 @@
+#pragma once
+#include "compression.h"
+#include "message_sender.h"
+#include "utility/object_pool.h"
+
+#include <memory>
+#include <string>
+
+namespace reinforcement_learning {
+  class i_trace;
+}
+
+namespace reinforcement_learning { namespace logger {
+  struct compression_options {
+    compression_codec codec = compression_codec::none;
+    int level = 0;           // zstd level or LZ4 acceleration, 0 for the default of the codec
+    size_t min_bytes = 256;  // smaller batches are sent as they are
+    std::string dictionary_file;  // zstd dictionary loaded by init, plain zstd when it cannot be loaded
+  };
+
+  // Sends each batch body of at least min_bytes as a message_type::compressed message, compressed into a buffer of
+  // its own pool.  Batches that do not get smaller or fail to compress are sent as they are, so a reader has to
+  // handle both.
+  class compressing_message_sender : public i_message_sender {
+  public:
+    // Takes the ownership of sender
+    compressing_message_sender(i_message_sender* sender, const compression_options& options, i_trace* trace);
+
+    int send(const uint16_t msg_type, const buffer& db, api_status* status) override;
+    int init(api_status* status) override;
+    float window_occupancy() const override;
+    std::chrono::microseconds completion_latency() const override;
+
+  private:
+    // Declared before the sender, whose queues may still hold its buffers when it is destroyed
+    utility::object_pool<utility::data_buffer> _buffer_pool;
+    std::unique_ptr<i_message_sender> _sender;
+    batch_compressor _compressor;
+    const size_t _min_bytes;
+    const std::string _dictionary_file;
+    i_trace* _trace;
+  };
+}}
@@ -0,0 +1,316 @@
+#include "compression.h"
+#include "api_status.h"
+#include "err_constants.h"
+
+#ifdef RL_HAVE_LZ4
+#include <lz4.h>
+#endif
+#ifdef RL_HAVE_ZSTD
+#include <zstd.h>
+#include <zdict.h>
+#endif
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <map>
+
+namespace reinforcement_learning { namespace logger {
+  namespace {
+    // Larger sizes in a header are taken for corruption
+    const uint32_t MAX_UNCOMPRESSED_SIZE = 1024 * 1024 * 1024;
+  }
+
+  bool compression_available(compression_codec codec) {
+    switch (codec) {
+    case compression_codec::none:
+      return true;
+#ifdef RL_HAVE_LZ4
+    case compression_codec::lz4:
+      return true;
+#endif
+#ifdef RL_HAVE_ZSTD
+    case compression_codec::zstd:
+    case compression_codec::zstd_dictionary:
+      return true;
+#endif
+    default:
+      return false;
+    }
+  }
+
+  uint32_t compression_header::encoded_size() const {
+    return size() + (codec == static_cast<uint8_t>(compression_codec::zstd_dictionary) ? 4 : 0);
+  }
+
+  bool compression_header::write_to_bytes(uint8_t* buffer, size_t buffersz) const {
+    if (buffersz < encoded_size())
+      return false;
+
+    buffer[0] = codec;
+    buffer[1] = reserved;
+    buffer[2] = static_cast<uint8_t>(msg_type >> 8);
+    buffer[3] = static_cast<uint8_t>(msg_type);
+    for (int i = 0; i < 4; ++i) buffer[4 + i] = static_cast<uint8_t>(uncompressed_size >> (8 * (3 - i)));
+    if (encoded_size() > size()) {
+      for (int i = 0; i < 4; ++i) buffer[8 + i] = static_cast<uint8_t>(dictionary_id >> (8 * (3 - i)));
+    }
+    return true;
+  }
+
+  bool compression_header::read_from_bytes(const uint8_t* buffer, size_t buffersz) {
+    if (buffersz < size())
+      return false;
+
+    codec = buffer[0];
+    reserved = buffer[1];
+    msg_type = static_cast<uint16_t>((buffer[2] << 8) | buffer[3]);
+    uncompressed_size = 0;
+    for (int i = 0; i < 4; ++i) uncompressed_size = (uncompressed_size << 8) | buffer[4 + i];
+    dictionary_id = 0;
+    if (encoded_size() > size()) {
+      if (buffersz < encoded_size())
+        return false;
+      for (int i = 0; i < 4; ++i) dictionary_id = (dictionary_id << 8) | buffer[8 + i];
+    }
+    return true;
+  }
+
+  struct batch_compressor::context {
+#ifdef RL_HAVE_ZSTD
+    ZSTD_CCtx* zstd = nullptr;
+    ZSTD_CDict* dictionary = nullptr;
+    uint32_t dictionary_id = 0;
+    ~context() {
+      ZSTD_freeCDict(dictionary);
+      ZSTD_freeCCtx(zstd);
+    }
+#endif
+  };
+
+  batch_compressor::batch_compressor(compression_codec codec, int level)
+    : _codec(codec), _level(level), _context(new context())
+  {}
+
+  batch_compressor::~batch_compressor() = default;
+
+  int batch_compressor::set_dictionary(const std::vector<uint8_t>& dictionary, api_status* status) {
+    if (_codec != compression_codec::zstd || !compression_available(_codec)) {
+      RETURN_ERROR_LS(nullptr, status, compression_error) << "dictionaries are only used by zstd";
+    }
+#ifdef RL_HAVE_ZSTD
+    const auto id = dictionary_id(dictionary);
+    if (id == 0) {
+      RETURN_ERROR_LS(nullptr, status, compression_error) << "not a trained zstd dictionary";
+    }
+    ZSTD_CDict* const cdict = ZSTD_createCDict(dictionary.data(), dictionary.size(), _level);
+    if (cdict == nullptr) {
+      RETURN_ERROR_LS(nullptr, status, compression_error) << "unable to load zstd dictionary " << id;
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    ZSTD_freeCDict(_context->dictionary);
+    _context->dictionary = cdict;
+    _context->dictionary_id = id;
+#endif
+    return error_code::success;
+  }
+
+  int batch_compressor::compress(uint16_t msg_type, const uint8_t* body, size_t size, utility::data_buffer& out,
+    api_status* status) {
+    if (!compression_available(_codec) || _codec == compression_codec::none) {
+      RETURN_ERROR_LS(nullptr, status, compression_error) << "codec " << static_cast<int>(_codec) << " is not built in";
+    }
+    if (size > MAX_UNCOMPRESSED_SIZE) {
+      RETURN_ERROR_LS(nullptr, status, compression_error) << "a body of " << size << " bytes is too large";
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    compression_header header;
+    header.codec = static_cast<uint8_t>(_codec);
+    header.msg_type = msg_type;
+    header.uncompressed_size = static_cast<uint32_t>(size);
+#ifdef RL_HAVE_ZSTD
+    if (_context->dictionary != nullptr) {
+      header.codec = static_cast<uint8_t>(compression_codec::zstd_dictionary);
+      header.dictionary_id = _context->dictionary_id;
+    }
+#endif
+
+    size_t bound = 0;
+#ifdef RL_HAVE_LZ4
+    if (_codec == compression_codec::lz4) bound = LZ4_compressBound(static_cast<int>(size));
+#endif
+#ifdef RL_HAVE_ZSTD
+    if (_codec == compression_codec::zstd) bound = ZSTD_compressBound(size);
+#endif
+    out.resize_body_region(header.encoded_size() + bound);
+    out.set_body_beginoffset(out.preamble_size());
+    uint8_t* const dest = out.body_begin() + header.encoded_size();
+    size_t compressed_size = 0;
+
+#ifdef RL_HAVE_LZ4
+    if (_codec == compression_codec::lz4) {
+      const auto result = LZ4_compress_fast(reinterpret_cast<const char*>(body), reinterpret_cast<char*>(dest),
+        static_cast<int>(size), static_cast<int>(bound), (std::max)(_level, 1));
+      if (result <= 0) {
+        RETURN_ERROR_LS(nullptr, status, compression_error) << "LZ4 failed to compress " << size << " bytes";
+      }
+      compressed_size = static_cast<size_t>(result);
+    }
+#endif
+#ifdef RL_HAVE_ZSTD
+    if (_codec == compression_codec::zstd) {
+      if (_context->zstd == nullptr) _context->zstd = ZSTD_createCCtx();
+      if (_context->zstd == nullptr) {
+        RETURN_ERROR_LS(nullptr, status, compression_error) << "unable to create a zstd context";
+      }
+      const auto result = _context->dictionary != nullptr
+        ? ZSTD_compress_usingCDict(_context->zstd, dest, bound, body, size, _context->dictionary)
+        : ZSTD_compressCCtx(_context->zstd, dest, bound, body, size, _level);
+      if (ZSTD_isError(result)) {
+        RETURN_ERROR_LS(nullptr, status, compression_error) << "zstd: " << ZSTD_getErrorName(result);
+      }
+      compressed_size = result;
+    }
+#endif
+    header.write_to_bytes(out.body_begin(), header.encoded_size());
+    out.set_body_endoffset(out.preamble_size() + header.encoded_size() + compressed_size);
+    return error_code::success;
+  }
+
+  struct compression_dictionaries::entries {
+#ifdef RL_HAVE_ZSTD
+    std::map<uint32_t, ZSTD_DDict*> by_id;
+    ~entries() {
+      for (auto& entry : by_id) ZSTD_freeDDict(entry.second);
+    }
+#endif
+  };
+
+  compression_dictionaries::compression_dictionaries()
+    : _entries(new entries())
+  {}
+
+  compression_dictionaries::~compression_dictionaries() = default;
+
+  int compression_dictionaries::add(const std::vector<uint8_t>& dictionary, api_status* status) {
+#ifdef RL_HAVE_ZSTD
+    const auto id = dictionary_id(dictionary);
+    if (id == 0) {
+      RETURN_ERROR_LS(nullptr, status, compression_error) << "not a trained zstd dictionary";
+    }
+    ZSTD_DDict* const ddict = ZSTD_createDDict(dictionary.data(), dictionary.size());
+    if (ddict == nullptr) {
+      RETURN_ERROR_LS(nullptr, status, compression_error) << "unable to load zstd dictionary " << id;
+    }
+    auto& entry = _entries->by_id[id];
+    ZSTD_freeDDict(entry);
+    entry = ddict;
+    return error_code::success;
+#else
+    RETURN_ERROR_LS(nullptr, status, compression_error) << "zstd is not built in";
+#endif
+  }
+
+  int decompress_message(const uint8_t* data, size_t size, const compression_dictionaries* dictionaries,
+    uint16_t& msg_type, std::vector<uint8_t>& body, api_status* status) {
+    compression_header header;
+    if (!header.read_from_bytes(data, size) || header.uncompressed_size > MAX_UNCOMPRESSED_SIZE) {
+      RETURN_ERROR_LS(nullptr, status, compression_error) << "invalid header in a message of " << size << " bytes";
+    }
+    const auto codec = static_cast<compression_codec>(header.codec);
+    if (!compression_available(codec) || codec == compression_codec::none) {
+      RETURN_ERROR_LS(nullptr, status, compression_error) << "codec " << static_cast<int>(header.codec) << " is not built in";
+    }
+
+    const uint8_t* const payload = data + header.encoded_size();
+    const size_t payload_size = size - header.encoded_size();
+    body.resize(header.uncompressed_size);
+    bool valid = false;
+#ifdef RL_HAVE_LZ4
+    if (codec == compression_codec::lz4) {
+      const auto result = LZ4_decompress_safe(reinterpret_cast<const char*>(payload), reinterpret_cast<char*>(body.data()),
+        static_cast<int>(payload_size), static_cast<int>(body.size()));
+      valid = result >= 0 && static_cast<size_t>(result) == body.size();
+    }
+#endif
+#ifdef RL_HAVE_ZSTD
+    if (codec == compression_codec::zstd) {
+      const auto result = ZSTD_decompress(body.data(), body.size(), payload, payload_size);
+      valid = !ZSTD_isError(result) && result == body.size();
+    }
+    if (codec == compression_codec::zstd_dictionary) {
+      const ZSTD_DDict* ddict = nullptr;
+      if (dictionaries != nullptr) {
+        const auto entry = dictionaries->_entries->by_id.find(header.dictionary_id);
+        if (entry != dictionaries->_entries->by_id.end()) ddict = entry->second;
+      }
+      if (ddict == nullptr) {
+        RETURN_ERROR_LS(nullptr, status, compression_error) << "zstd dictionary " << header.dictionary_id << " is not loaded";
+      }
+      ZSTD_DCtx* const dctx = ZSTD_createDCtx();
+      const auto result = ZSTD_decompress_usingDDict(dctx, body.data(), body.size(), payload, payload_size, ddict);
+      ZSTD_freeDCtx(dctx);
+      valid = !ZSTD_isError(result) && result == body.size();
+    }
+#endif
+    if (!valid) {
+      RETURN_ERROR_LS(nullptr, status, compression_error) << "corrupt body in a message of " << size << " bytes";
+    }
+    msg_type = header.msg_type;
+    return error_code::success;
+  }
+
+  int train_dictionary(const std::vector<std::string>& samples, size_t capacity, std::vector<uint8_t>& dictionary,
+    api_status* status) {
+#ifdef RL_HAVE_ZSTD
+    std::string concatenated;
+    std::vector<size_t> sizes;
+    for (const auto& sample : samples) {
+      concatenated += sample;
+      sizes.push_back(sample.size());
+    }
+    dictionary.resize(capacity);
+    const auto result = ZDICT_trainFromBuffer(&dictionary[0], dictionary.size(), concatenated.data(), sizes.data(),
+      static_cast<unsigned>(sizes.size()));
+    if (ZDICT_isError(result)) {
+      RETURN_ERROR_LS(nullptr, status, compression_error) << "unable to train a dictionary on " << samples.size()
+        << " samples: " << ZDICT_getErrorName(result);
+    }
+    dictionary.resize(result);
+    return error_code::success;
+#else
+    RETURN_ERROR_LS(nullptr, status, compression_error) << "zstd is not built in";
+#endif
+  }
+
+  uint32_t dictionary_id(const std::vector<uint8_t>& dictionary) {
+#ifdef RL_HAVE_ZSTD
+    return ZSTD_getDictID_fromDict(dictionary.data(), dictionary.size());
+#else
+    return 0;
+#endif
+  }
+
+  int read_dictionary_file(const std::string& file, std::vector<uint8_t>& dictionary, api_status* status) {
+    std::ifstream in(file, std::ios_base::binary);
+    if (!in.good()) {
+      RETURN_ERROR_LS(nullptr, status, compression_error) << "unable to open dictionary " << file;
+    }
+    dictionary.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    if (in.bad()) {
+      RETURN_ERROR_LS(nullptr, status, compression_error) << "unable to read dictionary " << file;
+    }
+    return error_code::success;
+  }
+
+  int write_dictionary_file(const std::string& file, const std::vector<uint8_t>& dictionary, api_status* status) {
+    std::ofstream out(file, std::ios_base::binary | std::ios_base::trunc);
+    out.write(reinterpret_cast<const char*>(dictionary.data()), dictionary.size());
+    out.close();
+    if (out.fail()) {
+      RETURN_ERROR_LS(nullptr, status, compression_error) << "unable to write dictionary " << file;
+    }
+    return error_code::success;
+  }
+}}
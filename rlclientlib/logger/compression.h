@@ -0,0 +1,106 @@
+#pragma once
+#include "data_buffer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace reinforcement_learning {
+  class api_status;
+}
+
+namespace reinforcement_learning { namespace logger {
+  enum class compression_codec : uint8_t {
+    none = 0,
+    lz4 = 1,   // LZ4 block
+    zstd = 2,  // zstd frame
+    zstd_dictionary = 3,  // zstd frame compressed with a trained dictionary
+  };
+
+  // Whether the codec was built into the library, LZ4 and zstd are optional dependencies
+  bool compression_available(compression_codec codec);
+
+  // Starts the body of a message_type::compressed message, the compressed body of the original message follows:
+  //
+  //   preamble | codec | reserved | msg_type | uncompressed_size [| dictionary_id] | compressed body
+  //
+  // The preamble carries message_type::compressed, msg_type is the type of the original message.  dictionary_id is
+  // only present for compression_codec::zstd_dictionary.  Fields are in network byte order like the preamble.
+  struct compression_header {
+    uint8_t codec = 0;
+    uint8_t reserved = 0;
+    uint16_t msg_type = 0;
+    uint32_t uncompressed_size = 0;
+    uint32_t dictionary_id = 0;
+
+    bool write_to_bytes(uint8_t* buffer, size_t buffersz) const;
+    bool read_from_bytes(const uint8_t* buffer, size_t buffersz);
+    // Size of the fields every header has
+    constexpr static uint32_t size() { return 8; }
+    // Size of this header, with the dictionary id if the codec has one
+    uint32_t encoded_size() const;
+  };
+
+  // Compresses message bodies with one codec and keeps its context between calls.  Thread safe.
+  class batch_compressor {
+  public:
+    // level is the zstd level or the LZ4 acceleration, 0 for the default of the codec
+    batch_compressor(compression_codec codec, int level);
+    ~batch_compressor();
+
+    // Compresses later bodies with a zstd dictionary trained by train_dictionary, zstd only
+    int set_dictionary(const std::vector<uint8_t>& dictionary, api_status* status);
+
+    // Writes the body of the compressed message for msg_type and body into the body of out
+    int compress(uint16_t msg_type, const uint8_t* body, size_t size, utility::data_buffer& out, api_status* status);
+
+    batch_compressor(const batch_compressor&) = delete;
+    batch_compressor& operator=(const batch_compressor&) = delete;
+
+  private:
+    struct context;
+
+    const compression_codec _codec;
+    const int _level;
+    std::mutex _mutex;
+    std::unique_ptr<context> _context;
+  };
+
+  // zstd dictionaries by id, for reading messages compressed with one
+  class compression_dictionaries {
+  public:
+    compression_dictionaries();
+    ~compression_dictionaries();
+
+    // Adds a dictionary trained by train_dictionary, replacing one with the same id
+    int add(const std::vector<uint8_t>& dictionary, api_status* status);
+
+    compression_dictionaries(const compression_dictionaries&) = delete;
+    compression_dictionaries& operator=(const compression_dictionaries&) = delete;
+
+  private:
+    struct entries;
+    std::unique_ptr<entries> _entries;
+
+    friend int decompress_message(const uint8_t*, size_t, const compression_dictionaries*, uint16_t&,
+      std::vector<uint8_t>&, api_status*);
+  };
+
+  // Restores the type and body of the original message from the body of a compressed message.  dictionaries may be
+  // null when no message was compressed with a dictionary.
+  int decompress_message(const uint8_t* data, size_t size, const compression_dictionaries* dictionaries,
+    uint16_t& msg_type, std::vector<uint8_t>& body, api_status* status);
+
+  // Trains a zstd dictionary of at most capacity bytes on sample message bodies, the dictionary picks its own id
+  int train_dictionary(const std::vector<std::string>& samples, size_t capacity, std::vector<uint8_t>& dictionary,
+    api_status* status);
+
+  // Id of a dictionary trained by train_dictionary, 0 if it is not one
+  uint32_t dictionary_id(const std::vector<uint8_t>& dictionary);
+
+  int read_dictionary_file(const std::string& file, std::vector<uint8_t>& dictionary, api_status* status);
+  int write_dictionary_file(const std::string& file, const std::vector<uint8_t>& dictionary, api_status* status);
+}}
@@ -0,0 +1,97 @@
+#include "drop_level.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace reinforcement_learning { namespace logger {
+  const size_t drop_level::MAX_SOURCES;
+  const size_t drop_level::MIN_FILTER_BITS;
+
+  drop_level::drop_level(std::chrono::milliseconds join_window, size_t max_filter_bytes)
+    : _generation_span(join_window / 2)
+    , _max_filter_bits((std::max)(max_filter_bytes * 8, MIN_FILTER_BITS))
+    , _remembered_ms(_generation_span.count()) {
+    for (auto& p : _pass_probs) p = 1.f;
+  }
+
+  size_t drop_level::add_source() {
+    // Sources past the limit share the last slot, which only makes them shed a little more eagerly
+    return (std::min)(_sources++, MAX_SOURCES - 1);
+  }
+
+  void drop_level::set(size_t source, float pass_prob) {
+    if (source >= MAX_SOURCES) return;
+    _pass_probs[source].store(pass_prob, std::memory_order_relaxed);
+  }
+
+  float drop_level::level() const {
+    float lowest = 1.f;
+    const auto sources = (std::min)(_sources.load(), MAX_SOURCES);
+    for (size_t i = 0; i < sources; ++i) {
+      lowest = (std::min)(lowest, _pass_probs[i].load(std::memory_order_relaxed));
+    }
+    return lowest;
+  }
+
+  void drop_level::remember_shed(const std::string& event_id) {
+    const auto hash = std::hash<std::string>()(event_id);
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto now = clock::now();
+    if (_current.bits.empty()) {
+      _current.bits.assign(MIN_FILTER_BITS / 64, 0);
+      _current.started = now;
+    }
+    rotate_if_due(now);
+    test_and_set(_current, hash, true);
+    ++_current.ids;
+    _any_shed = true;
+  }
+
+  bool drop_level::was_shed(const std::string& event_id) {
+    // Nothing to look up until the first interaction was shed
+    if (!_any_shed.load(std::memory_order_relaxed)) return false;
+    const auto hash = std::hash<std::string>()(event_id);
+    std::lock_guard<std::mutex> lock(_mutex);
+    rotate_if_due(clock::now());
+    return test_and_set(_current, hash, false) || (!_previous.bits.empty() && test_and_set(_previous, hash, false));
+  }
+
+  std::chrono::milliseconds drop_level::remembered_window() const {
+    return std::chrono::milliseconds(_remembered_ms.load());
+  }
+
+  void drop_level::rotate_if_due(clock::time_point now) {
+    const auto elapsed = (std::max)(std::chrono::duration_cast<std::chrono::milliseconds>(now - _current.started),
+      std::chrono::milliseconds(1));
+    if (_current.ids < _current.capacity() && elapsed < _generation_span) return;
+    _remembered_ms = (std::min)(elapsed, _generation_span).count();
+
+    // The next generation takes the ids shed at this one's rate over a full span, with a quarter to spare
+    const auto rate_ids = static_cast<double>(_current.ids) * _generation_span.count() / elapsed.count();
+    const auto wanted_bits = static_cast<size_t>(
+      (std::min)(rate_ids * BITS_PER_ID * 1.25, static_cast<double>(_max_filter_bits)));
+    const auto words = ((std::max)(wanted_bits, MIN_FILTER_BITS) + 63) / 64;
+
+    std::swap(_previous, _current);
+    if (_current.bits.size() == words) std::fill(_current.bits.begin(), _current.bits.end(), 0);
+    else _current.bits.assign(words, 0);
+    _current.ids = 0;
+    _current.started = now;
+  }
+
+  bool drop_level::test_and_set(generation& g, uint64_t hash, bool set) {
+    // Probes from the two halves of one hash, h1 + i * h2
+    const auto h1 = hash & 0xffffffff;
+    const auto h2 = (hash >> 32) | 1;
+    const auto size = g.bits.size() * 64;
+    bool present = true;
+    for (int i = 0; i < PROBES; ++i) {
+      const auto bit = (h1 + i * h2) % size;
+      auto& word = g.bits[bit / 64];
+      const auto mask = uint64_t(1) << (bit % 64);
+      present = present && (word & mask) != 0;
+      if (set) word |= mask;
+    }
+    return present;
+  }
+}}
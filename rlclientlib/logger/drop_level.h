@@ -0,0 +1,74 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace reinforcement_learning { namespace logger {
+  // Load shedding shared by the loggers of a live_model.  Every batcher reports the pass probability its own fill
+  // level asks for and all of them shed at the lowest one.  The draw compared against it only depends on the event
+  // id, so an interaction and an outcome handled at about the same time are kept or dropped together.
+  //
+  // Outcomes can arrive long after their interaction, when the level has changed.  The ids of shed interactions are
+  // therefore remembered, in two generations of a bloom filter that each cover half the join window, and their
+  // outcomes are shed on arrival.  A false positive sheds an outcome that could have been joined.
+  //
+  // Each generation is sized for the rate ids were shed at during the one before, over half the window, so the
+  // filter grows with the overload up to max_filter_bytes per generation.  A generation that fills up anyway is
+  // rotated early and its ids are remembered for less than half the window, remembered_window() tells for how long.
+  class drop_level {
+  public:
+    static const size_t MAX_SOURCES = 8;
+
+    explicit drop_level(std::chrono::milliseconds join_window = std::chrono::minutes(10),
+      size_t max_filter_bytes = 8 * 1024 * 1024);
+
+    // Registers a batcher, its index is passed to set
+    size_t add_source();
+    void set(size_t source, float pass_prob);
+
+    // Pass probability for new events
+    float level() const;
+
+    void remember_shed(const std::string& event_id);
+    // Whether an event with this id was shed, for the events that refer back to it
+    bool was_shed(const std::string& event_id);
+    // How long the last generation lasted before it was rotated, half the join window unless it filled up before
+    std::chrono::milliseconds remembered_window() const;
+
+    drop_level(const drop_level&) = delete;
+    drop_level& operator=(const drop_level&) = delete;
+
+  private:
+    using clock = std::chrono::steady_clock;
+    static const size_t MIN_FILTER_BITS = 1 << 20;
+    static const size_t BITS_PER_ID = 10;  // about 1% false positives with three probes
+    static const int PROBES = 3;
+
+    struct generation {
+      std::vector<uint64_t> bits;
+      size_t ids = 0;
+      clock::time_point started;
+
+      size_t capacity() const { return bits.size() * 64 / BITS_PER_ID; }
+    };
+
+    // The caller holds _mutex
+    void rotate_if_due(clock::time_point now);
+    static bool test_and_set(generation& g, uint64_t hash, bool set);
+
+    const std::chrono::milliseconds _generation_span;
+    const size_t _max_filter_bits;
+    std::atomic<int64_t> _remembered_ms;
+    std::atomic<size_t> _sources{ 0 };
+    std::atomic<float> _pass_probs[MAX_SOURCES];
+
+    std::mutex _mutex;
+    std::atomic<bool> _any_shed{ false };
+    generation _current;
+    generation _previous;
+  };
+}}
@@ -3,6 +3,18 @@
 #include "err_constants.h"
 #include "time_helper.h"
 namespace reinforcement_learning { namespace logger {
+  std::unique_ptr<batch_controller_options> adaptive_batching_options(const utility::configuration& c) {
+    if (!c.get_bool(name::BATCHING_ADAPTIVE, value::DEFAULT_BATCHING_ADAPTIVE)) {
+      return nullptr;
+    }
+    std::unique_ptr<batch_controller_options> options(new batch_controller_options());
+    options->min_batch_size = c.get_int(name::BATCHING_MIN_SIZE_KB, value::DEFAULT_BATCHING_MIN_SIZE_KB) * 1024;
+    options->max_batch_size = c.get_int(name::BATCHING_MAX_SIZE_KB, value::DEFAULT_BATCHING_MAX_SIZE_KB) * 1024;
+    options->min_interval = std::chrono::milliseconds(c.get_int(name::BATCHING_MIN_INTERVAL_MS, value::DEFAULT_BATCHING_MIN_INTERVAL_MS));
+    options->max_interval = std::chrono::milliseconds(c.get_int(name::BATCHING_MAX_INTERVAL_MS, value::DEFAULT_BATCHING_MAX_INTERVAL_MS));
+    options->target_latency = std::chrono::milliseconds(c.get_int(name::BATCHING_TARGET_LATENCY_MS, value::DEFAULT_BATCHING_TARGET_LATENCY_MS));
+    return options;
+  }
 
   int interaction_logger::log(const char* event_id, const char* context, unsigned int flags, const ranking_response& response, api_status* status, learning_mode learning_mode) {
     const auto now = _time_provider != nullptr ? _time_provider->gmt_now() : timestamp();
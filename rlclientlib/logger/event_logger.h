@@ -20,6 +20,9 @@
 #include "message_sender.h"
 #include "time_helper.h"
 namespace reinforcement_learning { namespace logger {
+  // Options of the batch_controller, nullptr unless batching.adaptive is set
+  std::unique_ptr<batch_controller_options> adaptive_batching_options(const utility::configuration& c);
+
   // This class wraps logging event to event_hub in a generic way that live_model can consume.
   template<typename TEvent>
   class event_logger {
@@ -30,12 +33,21 @@ namespace reinforcement_learning { namespace logger {
       int send_batch_interval_ms,
       int send_queue_max_capacity,
       const char* queue_mode,
+      int queue_block_timeout_ms,
       utility::watchdog& watchdog,
       i_time_provider* time_provider,
-      error_callback_fn* perror_cb = nullptr);
+      error_callback_fn* perror_cb = nullptr,
+      logging_engine* engine = nullptr,
+      logging_priority priority = logging_priority::interaction,
+      utility::background_scheduler* scheduler = nullptr,
+      drop_level* shared_drop_level = nullptr,
+      const batch_controller_options* adaptive_batching = nullptr,
+      int max_message_size = 0);
 
     int init(api_status* status);
 
+    queue_pressure get_pressure() const;
+
   protected:
     int append(TEvent&& item, api_status* status);
     int append(TEvent& item, api_status* status);
@@ -55,9 +67,16 @@ namespace reinforcement_learning { namespace logger {
     int send_batch_interval_ms,
     int send_queue_max_capacity,
     const char* queue_mode,
+    int queue_block_timeout_ms,
     utility::watchdog& watchdog,
     i_time_provider* time_provider,
-    error_callback_fn* perror_cb
+    error_callback_fn* perror_cb,
+    logging_engine* engine,
+    logging_priority priority,
+    utility::background_scheduler* scheduler,
+    drop_level* shared_drop_level,
+    const batch_controller_options* adaptive_batching,
+    int max_message_size
   )
     : _batcher(
       sender,
@@ -66,7 +85,14 @@ namespace reinforcement_learning { namespace logger {
       send_high_watermark,
       send_batch_interval_ms,
       send_queue_max_capacity,
-      to_queue_mode_enum(queue_mode)),
+      to_queue_mode_enum(queue_mode),
+      engine,
+      priority,
+      scheduler,
+      shared_drop_level,
+      queue_block_timeout_ms,
+      adaptive_batching,
+      max_message_size),
       _time_provider(time_provider)
   {}
 
@@ -77,6 +103,11 @@ namespace reinforcement_learning { namespace logger {
     return error_code::success;
   }
 
+  template<typename TEvent>
+  queue_pressure event_logger<TEvent>::get_pressure() const {
+    return _batcher.get_pressure();
+  }
+
   template<typename TEvent>
   int event_logger<TEvent>::append(TEvent&& item, api_status* status) {
     if (!_initialized) {
@@ -96,16 +127,23 @@ namespace reinforcement_learning { namespace logger {
 
   class interaction_logger : public event_logger<ranking_event> {
   public:
-    interaction_logger(const utility::configuration& c, i_message_sender* sender, utility::watchdog& watchdog, i_time_provider* time_provider,error_callback_fn* perror_cb = nullptr)
+    interaction_logger(const utility::configuration& c, i_message_sender* sender, utility::watchdog& watchdog, i_time_provider* time_provider,error_callback_fn* perror_cb = nullptr, logging_engine* engine = nullptr, utility::background_scheduler* scheduler = nullptr, drop_level* shared_drop_level = nullptr)
       : event_logger(
         sender,
         c.get_int(name::INTERACTION_SEND_HIGH_WATER_MARK, 198 * 1024),
         c.get_int(name::INTERACTION_SEND_BATCH_INTERVAL_MS, 1000),
         c.get_int(name::INTERACTION_SEND_QUEUE_MAX_CAPACITY_KB, 16 * 1024) * 1024,
         c.get(name::QUEUE_MODE, "DROP"),
+        c.get_int(name::QUEUE_BLOCK_TIMEOUT_MS, value::DEFAULT_QUEUE_BLOCK_TIMEOUT_MS),
         watchdog,
         time_provider,
-        perror_cb)
+        perror_cb,
+        engine,
+        logging_priority::interaction,
+        scheduler,
+        shared_drop_level,
+        adaptive_batching_options(c).get(),
+        c.get_int(name::BATCHING_MAX_MESSAGE_BYTES, value::DEFAULT_BATCHING_MAX_MESSAGE_BYTES))
     {}
 
     int log(const char* event_id, const char* context, unsigned int flags, const ranking_response& response, api_status* status, learning_mode learning_mode = ONLINE);
@@ -113,16 +151,23 @@ namespace reinforcement_learning { namespace logger {
 
 class ccb_logger : public event_logger<decision_ranking_event> {
   public:
-    ccb_logger(const utility::configuration& c, i_message_sender* sender, utility::watchdog& watchdog, i_time_provider* time_provider, error_callback_fn* perror_cb = nullptr)
+    ccb_logger(const utility::configuration& c, i_message_sender* sender, utility::watchdog& watchdog, i_time_provider* time_provider, error_callback_fn* perror_cb = nullptr, logging_engine* engine = nullptr, utility::background_scheduler* scheduler = nullptr, drop_level* shared_drop_level = nullptr)
       : event_logger(
         sender,
         c.get_int(name::DECISION_SEND_HIGH_WATER_MARK, 198 * 1024),
         c.get_int(name::DECISION_SEND_BATCH_INTERVAL_MS, 1000),
         c.get_int(name::DECISION_SEND_QUEUE_MAX_CAPACITY_KB, 16 * 1024) * 1024,
         c.get(name::QUEUE_MODE, "DROP"),
+        c.get_int(name::QUEUE_BLOCK_TIMEOUT_MS, value::DEFAULT_QUEUE_BLOCK_TIMEOUT_MS),
         watchdog,
         time_provider,
-        perror_cb)
+        perror_cb,
+        engine,
+        logging_priority::decision,
+        scheduler,
+        shared_drop_level,
+        adaptive_batching_options(c).get(),
+        c.get_int(name::BATCHING_MAX_MESSAGE_BYTES, value::DEFAULT_BATCHING_MAX_MESSAGE_BYTES))
     {}
 
     int log_decisions(std::vector<const char*>& event_ids, const char* context, unsigned int flags, const std::vector<std::vector<uint32_t>>& action_ids,
@@ -131,16 +176,23 @@ class ccb_logger : public event_logger<decision_ranking_event> {
 
 class slates_logger : public event_logger<slates_decision_event> {
   public:
-    slates_logger(const utility::configuration& c, i_message_sender* sender, utility::watchdog& watchdog, i_time_provider* time_provider, error_callback_fn* perror_cb = nullptr)
+    slates_logger(const utility::configuration& c, i_message_sender* sender, utility::watchdog& watchdog, i_time_provider* time_provider, error_callback_fn* perror_cb = nullptr, logging_engine* engine = nullptr, utility::background_scheduler* scheduler = nullptr, drop_level* shared_drop_level = nullptr)
       : event_logger(
         sender,
         c.get_int(name::DECISION_SEND_HIGH_WATER_MARK, 198 * 1024),
         c.get_int(name::DECISION_SEND_BATCH_INTERVAL_MS, 1000),
         c.get_int(name::DECISION_SEND_QUEUE_MAX_CAPACITY_KB, 16 * 1024) * 1024,
         c.get(name::QUEUE_MODE, "DROP"),
+        c.get_int(name::QUEUE_BLOCK_TIMEOUT_MS, value::DEFAULT_QUEUE_BLOCK_TIMEOUT_MS),
         watchdog,
         time_provider,
-        perror_cb)
+        perror_cb,
+        engine,
+        logging_priority::slates,
+        scheduler,
+        shared_drop_level,
+        adaptive_batching_options(c).get(),
+        c.get_int(name::BATCHING_MAX_MESSAGE_BYTES, value::DEFAULT_BATCHING_MAX_MESSAGE_BYTES))
     {}
 
     int log_decision(const std::string &event_id, const char* context, unsigned int flags, const std::vector<std::vector<uint32_t>>& action_ids,
@@ -149,16 +201,23 @@ class slates_logger : public event_logger<slates_decision_event> {
 
   class observation_logger : public event_logger<outcome_event> {
   public:
-    observation_logger(const utility::configuration& c, i_message_sender* sender, utility::watchdog& watchdog, i_time_provider* time_provider, error_callback_fn* perror_cb = nullptr)
+    observation_logger(const utility::configuration& c, i_message_sender* sender, utility::watchdog& watchdog, i_time_provider* time_provider, error_callback_fn* perror_cb = nullptr, logging_engine* engine = nullptr, utility::background_scheduler* scheduler = nullptr, drop_level* shared_drop_level = nullptr)
       : event_logger(
         sender,
         c.get_int(name::OBSERVATION_SEND_HIGH_WATER_MARK, 198 * 1024),
         c.get_int(name::OBSERVATION_SEND_BATCH_INTERVAL_MS, 1000),
         c.get_int(name::OBSERVATION_SEND_QUEUE_MAX_CAPACITY_KB, 16 * 1024) * 1024,
         c.get(name::QUEUE_MODE, "DROP"),
+        c.get_int(name::QUEUE_BLOCK_TIMEOUT_MS, value::DEFAULT_QUEUE_BLOCK_TIMEOUT_MS),
         watchdog,
         time_provider,
-        perror_cb)
+        perror_cb,
+        engine,
+        logging_priority::observation,
+        scheduler,
+        shared_drop_level,
+        adaptive_batching_options(c).get(),
+        c.get_int(name::BATCHING_MAX_MESSAGE_BYTES, value::DEFAULT_BATCHING_MAX_MESSAGE_BYTES))
     {}
 
     template <typename D>
@@ -17,14 +17,17 @@ namespace reinforcement_learning {
     using iterator_t = typename queue_t::iterator;
 
     queue_t _queue;
-    std::mutex _mutex;
-    int _drop_pass{ 0 };
+    mutable std::mutex _mutex;
     size_t _capacity{ 0 };
     size_t _max_capacity{ 0 };
+    size_t _shed_capacity{ 0 };
+    size_t _shed_count{ 0 };
 
   public:
-    event_queue(size_t max_capacity) 
-      : _max_capacity(max_capacity) {
+    // Past shed_threshold of max_capacity try_push starts turning events away, see admission_prob
+    event_queue(size_t max_capacity, float shed_threshold = 0.75f)
+      : _max_capacity(max_capacity)
+      , _shed_capacity(static_cast<size_t>(max_capacity * shed_threshold)) {
       static_assert(std::is_base_of<event, T>::value, "T must be a descendant of event");
     }
 
@@ -53,14 +56,19 @@ namespace reinforcement_learning {
       _queue.push_back({std::forward<T>(item),item_size});
     }
 
-    void prune(float pass_prob)
+    // Admission control: the event passes with admission_prob of the current fill level, or max_pass_prob when that
+    // is lower, which is recorded on it, and is otherwise dropped on the spot.  Returns false when the event was dropped.
+    bool try_push(T&& item, size_t item_size, float max_pass_prob = 1.f)
     {
       std::unique_lock<std::mutex> mlock(_mutex);
-      if (!is_full()) return;
-      for (auto it = _queue.begin(); it != _queue.end();) {
-        it = it->first.try_drop(pass_prob, _drop_pass) ? erase(it) : (++it);
+      const auto pass_prob = (std::min)(fill_pass_prob(), max_pass_prob);
+      if (pass_prob < 1.f && item.try_drop(pass_prob)) {
+        ++_shed_count;
+        return false;
       }
-      ++_drop_pass;
+      _capacity += item_size;
+      _queue.push_back({std::forward<T>(item),item_size});
+      return true;
     }
 
     //approximate size
@@ -76,15 +84,38 @@ namespace reinforcement_learning {
 
     size_t capacity() const 
     {
+      std::unique_lock<std::mutex> mlock(_mutex);
       return _capacity;
     }
 
+    // Queued bytes over the maximum capacity, 1 once full
+    float fill_ratio() const
+    {
+      std::unique_lock<std::mutex> mlock(_mutex);
+      return (std::min)(1.f, static_cast<float>(_capacity) / static_cast<float>(_max_capacity));
+    }
+
+    // Pass probability try_push currently applies by itself
+    float admission_prob() const
+    {
+      std::unique_lock<std::mutex> mlock(_mutex);
+      return fill_pass_prob();
+    }
+
+    // Events turned away by try_push so far
+    size_t shed_count() const
+    {
+      std::unique_lock<std::mutex> mlock(_mutex);
+      return _shed_count;
+    }
+
   private:
     //thread-unsafe
-    iterator_t erase(iterator_t it) {
-      _capacity = (std::max)(0, static_cast<int>(_capacity) - static_cast<int>(it->second));
-      return _queue.erase(it);
+    // 1 up to the shed capacity, then falling linearly to 0 at max capacity, where everything is dropped
+    float fill_pass_prob() const {
+      if (_capacity <= _shed_capacity) return 1.f;
+      if (_capacity >= _max_capacity) return 0.f;
+      return static_cast<float>(_max_capacity - _capacity) / static_cast<float>(_max_capacity - _shed_capacity);
     }
   };
 }
-
@@ -8,7 +8,6 @@
 #include "utility/http_client.h"
 
 #include <sstream>
-#include "utility/stl_container_adapter.h"
 
 using namespace std::chrono;
 using namespace utility; // Common utilities like string conversions
@@ -22,6 +21,9 @@ namespace reinforcement_learning {
     const std::string& host,
     const std::string& auth,
     const buffer& post_data,
+    completion_fn on_complete,
+    utility::retry_policy* retry_policy,
+    utility::retry_scheduler* retry_scheduler,
     size_t max_retries,
     error_callback_fn* error_callback,
     i_trace* trace)
@@ -29,86 +31,83 @@ namespace reinforcement_learning {
     _host(host),
     _auth(auth),
     _post_data(post_data),
+    _on_complete(std::move(on_complete)),
+    _retry_policy(retry_policy),
+    _retry_scheduler(retry_scheduler),
     _max_retries(max_retries),
     _error_callback(error_callback),
     _trace(trace)
-    {
-      _task = send_request(0 /* inital try */);
-    }
+    {}
+
+  void eventhub_client::http_request_task::start() {
+    send_request(0 /* inital try */);
+  }
 
-  pplx::task<web::http::status_code> eventhub_client::http_request_task::send_request(size_t try_count) {
+  void eventhub_client::http_request_task::send_request(size_t try_count) {
     http_request request(methods::POST);
     request.headers().add(_XPLATSTR("Authorization"), _auth.c_str());
     request.headers().add(_XPLATSTR("Host"), _host.c_str());
 
-    utility::stl_container_adapter container(_post_data.get());
-    const size_t container_size = container.size();
-    const auto stream = concurrency::streams::bytestream::open_istream(container);
-    request.set_body(stream, container_size);
-
-    return _client->request(request).then([this, try_count](pplx::task<http_response> response) {
-      web::http::status_code code = status_codes::InternalError;
-      api_status status;
-
-      try {
-        code = response.get().status_code();
-      }
-      catch (const std::exception& e) {
-        TRACE_ERROR(_trace, e.what());
-      }
+    // The body is read in place from the batch buffer, there is no copy into an intermediate stream.
+    // The continuation keeps this request alive until its final attempt completes.
+    auto self = shared_from_this();
+    _client->request_with_body(request, _post_data).then([self, try_count](pplx::task<http_response> response) {
+      self->on_response(response, try_count);
+    });
+  }
 
-      // If the response is not the expected code then it has failed. Retry if possible otherwise report background error.
-      if(code != status_codes::Created) {
-        // Stop condition of recurison.
-        if(try_count < _max_retries){
-          TRACE_ERROR(_trace, "HTTP request failed, retrying...");
+  void eventhub_client::http_request_task::on_response(pplx::task<http_response> response, size_t try_count) {
+    web::http::status_code code = status_codes::InternalError;
 
-          // Yes, recursively send another request inside this one. If a subsequent request returns success we are good, otherwise the failure will propagate.
-          return send_request(try_count + 1).get();
-        }
-        else {
-          auto msg = u::concat("(expected 201): Found ", code, ", failed after ", try_count, " retries.");
-          api_status::try_update(&status, error_code::http_bad_status_code, msg.c_str());
-          ERROR_CALLBACK(_error_callback, status);
+    try {
+      code = response.get().status_code();
+    }
+    catch (const std::exception& e) {
+      TRACE_ERROR(_trace, e.what());
+    }
 
-          return code;
+    // If the response is not the expected code then it has failed. Retry if possible otherwise report background error.
+    if (code != status_codes::Created) {
+      if (try_count < _max_retries) {
+        std::chrono::milliseconds delay;
+        if (_retry_policy->next_retry(_retry_delay, delay)) {
+          TRACE_ERROR(_trace, u::concat("HTTP request failed, retrying in ", delay.count(), " ms..."));
+          _retry_delay = delay;
+          // The scheduler thread kicks off the next attempt, this thread returns to the pool right away.
+          auto self = shared_from_this();
+          _retry_scheduler->schedule(delay, [self, try_count]() { self->retry(try_count + 1); });
+          return;
         }
+        TRACE_WARN(_trace, "HTTP request failed and the retry budget is exhausted.");
       }
 
-      // We have succeeded, return success.
-      return code;
-    });
-  }
-
-  int eventhub_client::http_request_task::join() {
-    _task.get();
-
-    // The task may have failed but was reported with the callback. This function's primary purpose
-    // is to block if the task is not yet complete.
-    return error_code::success;
-  }
+      fail(code, try_count);
+      return;
+    }
 
-  int eventhub_client::init(api_status* status) {
-    RETURN_IF_FAIL(_authorization.init(status));
-    return error_code::success;
+    _on_complete(code);
   }
 
-  int eventhub_client::pop_task(api_status* status) {
-    // This function must be under a lock as there is a delay between popping from the queue and joining the task, but it should essentially be atomic.
-    std::lock_guard<std::mutex> lock(_mutex);
-
-    std::unique_ptr<http_request_task> oldest;
-    _tasks.pop(&oldest);
-
+  void eventhub_client::http_request_task::retry(size_t try_count) {
     try {
-      // This will block if the task is not complete yet.
-      RETURN_IF_FAIL(oldest->join());
+      send_request(try_count);
     }
-    catch (...) {
-      // Ignore if there is an exception surfaced as this should have been handled in the continuation.
-      TRACE_WARN(_trace, "There should not be an exception raised in pop_task function.");
+    catch (const std::exception& e) {
+      TRACE_ERROR(_trace, e.what());
+      fail(status_codes::InternalError, try_count);
     }
+  }
 
+  void eventhub_client::http_request_task::fail(web::http::status_code code, size_t try_count) {
+    api_status status;
+    auto msg = u::concat("(expected 201): Found ", code, ", failed after ", try_count, " retries.");
+    api_status::try_update(&status, error_code::http_bad_status_code, msg.c_str());
+    ERROR_CALLBACK(_error_callback, status);
+    _on_complete(code);
+  }
+
+  int eventhub_client::init(api_status* status) {
+    RETURN_IF_FAIL(_authorization.init(status));
     return error_code::success;
   }
 
@@ -117,16 +116,24 @@ namespace reinforcement_learning {
     std::string auth_str;
     RETURN_IF_FAIL(_authorization.get(auth_str, status));
 
-    try {
-      // Before creating the task, ensure that it is allowed to be created.
-      if (_tasks.size() >= _max_tasks_count) {
-        RETURN_IF_FAIL(pop_task(status));
-      }
+    // Wait for a free slot in the in-flight window.  It is released by whichever request completes first.
+    _in_flight.acquire();
 
-      std::unique_ptr<http_request_task> request_task(new http_request_task(_client.get(), _eventhub_host, auth_str, post_data, _max_retries, _error_callback, _trace));
-      _tasks.push(std::move(request_task));
+    try {
+      const auto start = std::chrono::steady_clock::now();
+      const auto request_task = std::make_shared<http_request_task>(_client.get(), _eventhub_host, auth_str, post_data,
+        [this, start, post_data](web::http::status_code code) {
+          // The latency batching adapts to is the round trip, send only starts the request
+          const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+          const auto smoothed = _completion_latency_us.load();
+          _completion_latency_us = smoothed < 0 ? latency : (3 * smoothed + latency) / 4;
+          if (code != status_codes::Created) undelivered(post_data);
+          _in_flight.release();
+        }, _retry_policy.get(), _retry_scheduler.get(), _max_retries, _error_callback, _trace);
+      request_task->start();
     }
     catch (const std::exception& e) {
+      _in_flight.release();
       RETURN_ERROR_LS(_trace, status, eventhub_http_generic) << e.what();
     }
     return error_code::success;
@@ -135,19 +142,50 @@ namespace reinforcement_learning {
   eventhub_client::eventhub_client(i_http_client* client, const std::string& host, const std::string& key_name,
                                    const std::string& key, const std::string& name,
                                    size_t max_tasks_count, size_t max_retries,  i_trace* trace,
-                                   error_callback_fn* error_callback)
+                                   error_callback_fn* error_callback,
+                                   std::shared_ptr<utility::retry_policy> retry_policy,
+                                   std::shared_ptr<utility::retry_scheduler> retry_scheduler)
     : _client(client)
     , _authorization(host, key_name, key, name, trace)
     , _eventhub_host(host)
-    , _max_tasks_count(max_tasks_count)
+    , _in_flight(max_tasks_count > 0 ? max_tasks_count : 1)
     , _max_retries(max_retries)
+    , _retry_policy(retry_policy ? std::move(retry_policy) : utility::retry_policy::immediate())
+    , _retry_scheduler(retry_scheduler ? std::move(retry_scheduler) : utility::retry_scheduler::shared())
     , _trace(trace)
     , _error_callback(error_callback) {
   }
 
-  eventhub_client::~eventhub_client() {
-    while (_tasks.size() != 0) {
-      pop_task(nullptr);
+  void eventhub_client::add_undelivered_handler(undelivered_fn handler) {
+    std::lock_guard<std::mutex> lock(_handlers_mutex);
+    _undelivered_handlers.push_back(std::move(handler));
+  }
+
+  void eventhub_client::undelivered(const buffer& data) {
+    std::lock_guard<std::mutex> lock(_handlers_mutex);
+    for (const auto& handler : _undelivered_handlers) {
+      if (handler(data)) return;
     }
   }
+
+  utility::retry_stats eventhub_client::get_retry_stats() const {
+    return _retry_policy->get_stats();
+  }
+
+  size_t eventhub_client::in_flight() const {
+    return _in_flight.in_use();
+  }
+
+  float eventhub_client::window_occupancy() const {
+    return static_cast<float>(_in_flight.in_use()) / static_cast<float>(_in_flight.capacity());
+  }
+
+  std::chrono::microseconds eventhub_client::completion_latency() const {
+    return std::chrono::microseconds(_completion_latency_us.load());
+  }
+
+  eventhub_client::~eventhub_client() {
+    // Requests reference the http client, so it must outlive all of them.
+    _in_flight.wait_all();
+  }
 }
@@ -1,16 +1,22 @@
 #pragma once
 
 #include "api_status.h"
-#include "moving_queue.h"
 #include "sender.h"
 #include "error_callback_fn.h"
 
+#include "utility/counting_semaphore.h"
 #include "utility/http_authorization.h"
 #include "utility/http_client.h"
+#include "utility/retry_scheduler.h"
 
 #include <pplx/pplxtasks.h>
 
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <vector>
 #include "data_buffer.h"
 
 namespace reinforcement_learning {
@@ -18,50 +24,73 @@ namespace reinforcement_learning {
 
   // The eventhub_client send string data in POST requests to an HTTP endpoint.
   // It handles authorization headers specific for the Azure event hubs.
+  // Requests are fully asynchronous: at most tasks_count are in flight and a slot is freed by whichever request
+  // completes first, so one slow POST does not hold up the caller while others have finished.
+  // Failed requests are retried after a backoff and within the budget of the retry policy.
   class eventhub_client : public i_sender {
   public:
     virtual int init(api_status* status) override;
     
     // Takes the ownership of the i_http_client and delete it at the end of lifetime
+    // Without a retry policy failed requests are retried right away, without a scheduler the shared one is used.
     eventhub_client(i_http_client* client, const std::string& host, const std::string& key_name,
                     const std::string& key, const std::string& name,
-                    size_t tasks_count, size_t MAX_RETRIES, i_trace* trace, error_callback_fn* _error_cb);
+                    size_t tasks_count, size_t MAX_RETRIES, i_trace* trace, error_callback_fn* _error_cb,
+                    std::shared_ptr<utility::retry_policy> retry_policy = nullptr,
+                    std::shared_ptr<utility::retry_scheduler> retry_scheduler = nullptr);
     ~eventhub_client();
+
+    utility::retry_stats get_retry_stats() const;
+    // Requests currently holding a slot of the tasks limit
+    size_t in_flight() const;
+    float window_occupancy() const override;
+    // From the start of a request to its completion, retries included
+    std::chrono::microseconds completion_latency() const override;
+    // Requests that fail after their retries hand their batch to the handlers
+    void add_undelivered_handler(undelivered_fn handler) override;
   protected:
     int v_send(const buffer& data, api_status* status) override;
 
   private:
-    class http_request_task {
+    // A request owns itself through the continuations and retries it schedules and calls the completion function
+    // exactly once, after the final attempt.  Retries wait on the retry scheduler and never block a thread.
+    class http_request_task : public std::enable_shared_from_this<http_request_task> {
     public:
       using buffer = std::shared_ptr< utility::data_buffer>;
-      http_request_task() = default;
+      using completion_fn = std::function<void(web::http::status_code)>;
       http_request_task(
         i_http_client* client,
         const std::string& host,
         const std::string& auth,
         const buffer& data,
+        completion_fn on_complete,
+        utility::retry_policy* retry_policy,
+        utility::retry_scheduler* retry_scheduler,
         size_t max_retries = 1, // If MAX_RETRIES is set to 1, only the initial request will be attempted.
         error_callback_fn* error_callback = nullptr,
         i_trace* trace = nullptr);
 
-      // The constructor kicks off an async request which captures the this variable. If this object is moved then the
-      // this pointer is invalidated and causes tricky bugs.
       http_request_task(http_request_task&& other) = delete;
       http_request_task& operator=(http_request_task&& other) = delete;
       http_request_task(const http_request_task&) = delete;
       http_request_task& operator=(const http_request_task&) = delete;
 
-      // Return error_code
-      int join();
+      // Kicks off the initial request.  Throws if the request could not be issued, the completion is not called then.
+      void start();
     private:
-      pplx::task<web::http::status_code> send_request(size_t try_count);
+      void send_request(size_t try_count);
+      void on_response(pplx::task<web::http::http_response> response, size_t try_count);
+      void retry(size_t try_count);
+      void fail(web::http::status_code code, size_t try_count);
 
       i_http_client* _client;
       std::string _host;
       std::string _auth;
       buffer _post_data;
-
-      pplx::task<web::http::status_code> _task;
+      completion_fn _on_complete;
+      utility::retry_policy* _retry_policy;
+      utility::retry_scheduler* _retry_scheduler;
+      std::chrono::milliseconds _retry_delay{ 0 };
 
       size_t _max_retries = 1;
 
@@ -69,25 +98,29 @@ namespace reinforcement_learning {
       i_trace* _trace;
     };
 
-  private:
-    int pop_task(api_status* status);
-
     // cannot be copied or assigned
     eventhub_client(const eventhub_client&) = delete;
     eventhub_client(eventhub_client&&) = delete;
     eventhub_client& operator=(const eventhub_client&) = delete;
     eventhub_client& operator=(eventhub_client&&) = delete;
 
+  private:
+    void undelivered(const buffer& data);
+
   private:
     std::unique_ptr<i_http_client> _client;
     http_authorization _authorization;
     const std::string _eventhub_host; //e.g. "ingest-x2bw4dlnkv63q.servicebus.windows.net"
 
-    std::mutex _mutex;
-    moving_queue<std::unique_ptr<http_request_task>> _tasks;
-    const size_t _max_tasks_count;
+    // In-flight window, released from the completion of each request
+    mutable utility::counting_semaphore _in_flight;
     const size_t _max_retries;
+    std::atomic<int64_t> _completion_latency_us{ -1 };
+    const std::shared_ptr<utility::retry_policy> _retry_policy;
+    const std::shared_ptr<utility::retry_scheduler> _retry_scheduler;
     i_trace* _trace;
     error_callback_fn* _error_callback;
+    std::mutex _handlers_mutex;
+    std::vector<undelivered_fn> _undelivered_handlers;
   };
 }
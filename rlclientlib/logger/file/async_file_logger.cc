@@ -0,0 +1,133 @@
+#include "async_file_logger.h"
+#include "api_status.h"
+#include "err_constants.h"
+#include "error_callback_fn.h"
+#include "trace_logger.h"
+
+namespace reinforcement_learning { namespace logger { namespace file {
+  async_file_logger::async_file_logger(const std::string& file_name, const async_file_options& options,
+    error_callback_fn* error_cb, i_trace* trace)
+    : _file_name(file_name), _options(options), _error_cb(error_cb), _trace(trace),
+    _writer(file_name, options.segments, trace)
+  {}
+
+  async_file_logger::~async_file_logger() {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _data_cv.notify_all();
+    _space_cv.notify_all();
+    if (_thread.joinable()) _thread.join();
+    // _writer closes the file, writing the index of the last segment
+  }
+
+  int async_file_logger::init(api_status* status) {
+    RETURN_IF_FAIL(_writer.open(status));
+    _last_sync = std::chrono::steady_clock::now();
+    try {
+      _thread = std::thread(&async_file_logger::run, this);
+    }
+    catch (const std::exception& e) {
+      RETURN_ERROR_LS(_trace, status, background_thread_start) << "file writer: " << e.what();
+    }
+    return error_code::success;
+  }
+
+  async_file_stats async_file_logger::get_stats() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+  }
+
+  int async_file_logger::v_send(const buffer& data, api_status* status) {
+    if (_failed) {
+      RETURN_ERROR_LS(_trace, status, file_write_error) << " File:" << _file_name;
+    }
+
+    const auto size = data->buffer_filled_size();
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      const auto has_space = [this, size] {
+        return _stop || _queued_bytes == 0 || _queued_bytes + size <= _options.max_queued_bytes;
+      };
+      if (!has_space()) {
+        ++_stats.blocked_sends;
+        _space_cv.wait(lock, has_space);
+      }
+      _queue.push_back(data);
+      _queued_bytes += size;
+    }
+    _data_cv.notify_one();
+    return error_code::success;
+  }
+
+  void async_file_logger::run() {
+    std::vector<buffer> batches;
+    while (true) {
+      size_t bytes;
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        const auto ready = [this] { return _stop || !_queue.empty(); };
+        if (_options.sync == fsync_policy::interval && _unsynced_bytes > 0) {
+          _data_cv.wait_until(lock, _last_sync + _options.sync_interval, ready);
+        }
+        else {
+          _data_cv.wait(lock, ready);
+        }
+        if (_stop && _queue.empty()) break;
+        // Everything queued while the previous write was running goes out in this one
+        batches.swap(_queue);
+        bytes = _queued_bytes;
+      }
+
+      // After a failure batches are dropped so that senders never wait on a writer that cannot make progress.
+      const bool written = !batches.empty() && !_failed && write_batches(batches);
+      const auto count = batches.size();
+      batches.clear();
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _queued_bytes -= bytes;
+        if (written) {
+          _stats.batches += count;
+          _stats.bytes += bytes;
+        }
+      }
+      _space_cv.notify_all();
+
+      if (written) _unsynced_bytes += bytes;
+      if (_unsynced_bytes == 0) continue;
+      if ((_options.sync == fsync_policy::bytes && _unsynced_bytes >= _options.sync_bytes) ||
+        (_options.sync == fsync_policy::interval && std::chrono::steady_clock::now() - _last_sync >= _options.sync_interval)) {
+        sync();
+      }
+    }
+
+    if (_options.sync != fsync_policy::never && _unsynced_bytes > 0) sync();
+  }
+
+  bool async_file_logger::write_batches(const std::vector<buffer>& batches) {
+    const auto calls = _writer.write_calls();
+    api_status status;
+    const auto result = _writer.write(batches, &status);
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stats.writes += _writer.write_calls() - calls;
+    }
+    if (result == error_code::success) return true;
+
+    _failed = true;
+    ERROR_CALLBACK(_error_cb, status);
+    return false;
+  }
+
+  void async_file_logger::sync() {
+    api_status status;
+    if (_writer.sync(&status) != error_code::success) {
+      TRACE_WARN(_trace, status.get_error_msg());
+    }
+    _unsynced_bytes = 0;
+    _last_sync = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(_mutex);
+    ++_stats.syncs;
+  }
+}}}
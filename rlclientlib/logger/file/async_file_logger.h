@@ -0,0 +1,84 @@
+#pragma once
+#include "sender.h"
+#include "segment_writer.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace reinforcement_learning {
+  class i_trace;
+  class error_callback_fn;
+}
+
+namespace reinforcement_learning { namespace logger { namespace file {
+  enum class fsync_policy { never, interval, bytes };
+
+  struct async_file_options {
+    fsync_policy sync = fsync_policy::never;
+    std::chrono::milliseconds sync_interval{ 1000 };  // fsync_policy::interval
+    size_t sync_bytes = 16 * 1024 * 1024;             // fsync_policy::bytes
+    size_t max_queued_bytes = 64 * 1024 * 1024;       // send blocks while this much is waiting for the writer
+    segment_options segments;                          // rotation, disabled by default
+  };
+
+  struct async_file_stats {
+    uint64_t batches = 0;         // batches written
+    uint64_t bytes = 0;           // bytes written
+    uint64_t writes = 0;          // write system calls
+    uint64_t syncs = 0;           // fsync calls
+    uint64_t blocked_sends = 0;   // sends that waited for queue space
+  };
+
+  // File sender that hands batches to a writer thread instead of writing them on the batcher thread.  Batches
+  // queued while a write is in progress go out together in the next writev, straight from their buffers.  The
+  // queue is bounded by max_queued_bytes, once it is full send blocks until the writer catches up.
+  class async_file_logger : public i_sender {
+  public:
+    async_file_logger(const std::string& file_name, const async_file_options& options, error_callback_fn* error_cb,
+      i_trace* trace);
+    // Writes out the queued batches before returning
+    ~async_file_logger();
+
+    int init(api_status* status) override;
+
+    async_file_stats get_stats();
+
+    async_file_logger(const async_file_logger&) = delete;
+    async_file_logger(async_file_logger&&) = delete;
+    async_file_logger& operator=(const async_file_logger&) = delete;
+    async_file_logger& operator=(async_file_logger&&) = delete;
+
+  protected:
+    int v_send(const buffer& data, api_status* status) override;
+
+  private:
+    void run();
+    bool write_batches(const std::vector<buffer>& batches);
+    void sync();
+
+    const std::string _file_name;
+    const async_file_options _options;
+    error_callback_fn* _error_cb;
+    i_trace* _trace;
+    segment_writer _writer;                             // writer thread only after init
+
+    std::mutex _mutex;
+    std::condition_variable _data_cv;
+    std::condition_variable _space_cv;
+    std::vector<buffer> _queue;
+    size_t _queued_bytes = 0;
+    bool _stop = false;
+    async_file_stats _stats;
+
+    std::atomic<bool> _failed{ false };
+    size_t _unsynced_bytes = 0;                         // writer thread only
+    std::chrono::steady_clock::time_point _last_sync;  // writer thread only
+    std::thread _thread;
+  };
+}}}
@@ -1,34 +1,20 @@
-#include <sys/stat.h>
 #include "file_logger.h"
 #include "err_constants.h"
 #include "api_status.h"
-#include <fstream>
 namespace reinforcement_learning { namespace logger { namespace file {
 
-  file_logger::file_logger(const std::string& file_name, i_trace* trace)
+  file_logger::file_logger(const std::string& file_name, i_trace* trace, const segment_options& segments)
   : _file_name(file_name),
-  _trace(trace)
+  _trace(trace),
+  _writer(file_name, segments, trace)
   {}
 
   int file_logger::init(api_status* status) {
-    _file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    try {
-      _file.open(_file_name, std::ios::binary);
-    }
-    catch(const std::ios_base::failure& e){
-      RETURN_ERROR_LS(_trace, status, file_open_error) << " File:" << _file_name << " Error:" << e.what();
-    }
-    return error_code::success;
+    return _writer.open(status);
   }
 
   int file_logger::v_send(const buffer& data, api_status* status) {
-    try {
-      _file.write(reinterpret_cast<char*>(data->preamble_begin()), data->buffer_filled_size());
-      _file.flush();
-    }
-    catch (const std::ios_base::failure& e) {
-      RETURN_ERROR_LS(_trace, status, file_open_error) << " File:" << _file_name << " Error:" << e.what();
-    }
-    return error_code::success;
+    // Written straight to the file descriptor, there is no stream buffer left to flush
+    return _writer.write({ data }, status);
   }
 }}}
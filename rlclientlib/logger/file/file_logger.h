@@ -1,6 +1,6 @@
 #pragma once
 #include "sender.h"
-#include <fstream>
+#include "segment_writer.h"
 
 namespace reinforcement_learning {
   class i_trace;
@@ -11,7 +11,7 @@ namespace reinforcement_learning { namespace logger { namespace file {
     public i_sender
   {
   public:
-    explicit file_logger(const std::string& file_name, i_trace*);
+    explicit file_logger(const std::string& file_name, i_trace*, const segment_options& segments = segment_options());
     int init(api_status* status) override;
 
     file_logger(const file_logger&) = delete;
@@ -22,6 +22,6 @@ namespace reinforcement_learning { namespace logger { namespace file {
     int v_send(const buffer& data, reinforcement_learning::api_status* status) override;
     std::string _file_name;
     i_trace* _trace;
-    std::ofstream _file;
+    segment_writer _writer;
   };
 }}}
@@ -0,0 +1,177 @@
+#include "segment_index.h"
+#include "logger/message_type.h"
+#include "logger/preamble.h"
+#include "generated/v1/DecisionRankingEvent_generated.h"
+#include "generated/v1/OutcomeEvent_generated.h"
+#include "generated/v1/RankingEvent_generated.h"
+#include "generated/v1/SlatesEvent_generated.h"
+#include "time_helper.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+namespace flat = reinforcement_learning::messages::flatbuff;
+
+namespace reinforcement_learning { namespace logger { namespace file {
+  namespace {
+    const char MAGIC[8] = { 'R', 'L', 'S', 'E', 'G', 'I', 'D', 'X' };
+
+    void put(uint8_t*& p, uint64_t value, int bytes) {
+      for (int i = bytes - 1; i >= 0; --i) *p++ = static_cast<uint8_t>(value >> (8 * i));
+    }
+
+    uint64_t get(const uint8_t*& p, int bytes) {
+      uint64_t value = 0;
+      for (int i = 0; i < bytes; ++i) value = (value << 8) | *p++;
+      return value;
+    }
+
+    // Days between 1970-01-01 and the given civil date, proleptic Gregorian calendar.
+    int64_t days_from_civil(int64_t y, unsigned m, unsigned d) {
+      y -= m <= 2;
+      const int64_t era = (y >= 0 ? y : y - 399) / 400;
+      const auto yoe = static_cast<unsigned>(y - era * 400);
+      const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+      const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+      return era * 146097 + static_cast<int64_t>(doe) - 719468;
+    }
+
+    int64_t to_epoch_us(const flat::TimeStamp& ts) {
+      const auto seconds = days_from_civil(ts.year(), ts.month(), ts.day()) * 86400
+        + ts.hour() * 3600 + ts.minute() * 60 + ts.second();
+      return seconds * 1000000 + std::chrono::duration_cast<std::chrono::microseconds>(sub_second_ticks(ts.subsecond())).count();
+    }
+
+    template <typename batch_t>
+    void describe_events(const batch_t* batch, index_entry& entry) {
+      if (batch == nullptr || batch->events() == nullptr) return;
+      entry.event_count = batch->events()->size();
+      bool first = true;
+      for (const auto evt : *batch->events()) {
+        if (evt->meta() == nullptr || evt->meta()->client_time_utc() == nullptr) continue;
+        const auto time = to_epoch_us(*evt->meta()->client_time_utc());
+        if (first || time < entry.min_client_time) entry.min_client_time = time;
+        if (first || time > entry.max_client_time) entry.max_client_time = time;
+        first = false;
+      }
+    }
+  }
+
+  bool index_entry::write_to_bytes(uint8_t* buffer, size_t buffersz) const {
+    if (buffersz < size()) return false;
+    auto p = buffer;
+    put(p, offset, 8);
+    put(p, msg_type, 2);
+    put(p, 0, 2);
+    put(p, msg_size, 4);
+    put(p, event_count, 4);
+    put(p, static_cast<uint64_t>(min_client_time), 8);
+    put(p, static_cast<uint64_t>(max_client_time), 8);
+    return true;
+  }
+
+  bool index_entry::read_from_bytes(const uint8_t* buffer, size_t buffersz) {
+    if (buffersz < size()) return false;
+    auto p = buffer;
+    offset = get(p, 8);
+    msg_type = static_cast<uint16_t>(get(p, 2));
+    get(p, 2);
+    msg_size = static_cast<uint32_t>(get(p, 4));
+    event_count = static_cast<uint32_t>(get(p, 4));
+    min_client_time = static_cast<int64_t>(get(p, 8));
+    max_client_time = static_cast<int64_t>(get(p, 8));
+    return true;
+  }
+
+  bool segment_trailer::write_to_bytes(uint8_t* buffer, size_t buffersz) const {
+    if (buffersz < size()) return false;
+    auto p = buffer;
+    put(p, index_offset, 8);
+    put(p, entry_count, 4);
+    put(p, version, 1);
+    put(p, 0, 3);
+    memcpy(p, MAGIC, sizeof(MAGIC));
+    return true;
+  }
+
+  bool segment_trailer::read_from_bytes(const uint8_t* buffer, size_t buffersz) {
+    if (buffersz < size() || memcmp(buffer + 16, MAGIC, sizeof(MAGIC)) != 0) return false;
+    auto p = buffer;
+    index_offset = get(p, 8);
+    entry_count = static_cast<uint32_t>(get(p, 4));
+    version = static_cast<uint8_t>(get(p, 1));
+    return true;
+  }
+
+  std::string segment_file_name(const std::string& file_name, size_t sequence) {
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), ".%06zu", sequence);
+    return file_name + suffix;
+  }
+
+  bool describe_message(const uint8_t* message, size_t size, index_entry& entry) {
+    preamble pre;
+    if (!pre.read_from_bytes(const_cast<uint8_t*>(message), size)) return false;
+    entry.msg_type = pre.msg_type;
+    entry.msg_size = pre.msg_size;
+    entry.event_count = 0;
+    entry.min_client_time = entry.max_client_time = 0;
+
+    const auto body = message + preamble::size();
+    if (pre.msg_size > size - preamble::size()) return true;
+    flatbuffers::Verifier verifier(body, pre.msg_size);
+    switch (pre.msg_type) {
+    case message_type::fb_ranking_event_collection:
+    case message_type::fb_ranking_learning_mode_event_collection:
+      if (flat::VerifyRankingEventBatchBuffer(verifier)) describe_events(flat::GetRankingEventBatch(body), entry);
+      break;
+    case message_type::fb_outcome_event_collection:
+      if (flat::VerifyOutcomeEventBatchBuffer(verifier)) describe_events(flat::GetOutcomeEventBatch(body), entry);
+      break;
+    case message_type::fb_decision_event_collection:
+      if (flat::VerifyDecisionEventBatchBuffer(verifier)) describe_events(flat::GetDecisionEventBatch(body), entry);
+      break;
+    case message_type::fb_slates_event_collection:
+      if (flat::VerifySlatesEventBatchBuffer(verifier)) describe_events(flat::GetSlatesEventBatch(body), entry);
+      break;
+    default:
+      break;
+    }
+    return true;
+  }
+
+  bool read_segment_index(std::istream& in, segment_trailer& trailer, std::vector<index_entry>& entries) {
+    in.seekg(0, std::ios::end);
+    const auto end = static_cast<int64_t>(in.tellg());
+    if (!in || end < static_cast<int64_t>(segment_trailer::size())) {
+      in.clear();
+      return false;
+    }
+
+    uint8_t raw_trailer[segment_trailer::size()];
+    in.seekg(end - segment_trailer::size());
+    in.read(reinterpret_cast<char*>(raw_trailer), sizeof(raw_trailer));
+    if (!in || !trailer.read_from_bytes(raw_trailer, sizeof(raw_trailer))) {
+      in.clear();
+      return false;
+    }
+    const auto index_size = static_cast<int64_t>(trailer.entry_count) * index_entry::size();
+    if (static_cast<int64_t>(trailer.index_offset) + index_size + segment_trailer::size() != end) {
+      return false;
+    }
+
+    std::vector<uint8_t> raw_index(static_cast<size_t>(index_size));
+    in.seekg(static_cast<std::streamoff>(trailer.index_offset));
+    in.read(reinterpret_cast<char*>(raw_index.data()), raw_index.size());
+    if (!in) {
+      in.clear();
+      return false;
+    }
+    entries.resize(trailer.entry_count);
+    for (size_t i = 0; i < entries.size(); ++i) {
+      entries[i].read_from_bytes(raw_index.data() + i * index_entry::size(), index_entry::size());
+    }
+    return true;
+  }
+}}}
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace reinforcement_learning { namespace logger { namespace file {
+  // A closed segment holds its messages, laid out like an unsegmented file, followed by an index footer:
+  //
+  //   message[0] ... message[n-1] | index_entry[0] ... index_entry[n-1] | segment_trailer
+  //
+  // Readers take the trailer from the last segment_trailer::size() bytes, check its magic and seek to index_offset.
+  // The segment being written, or one left behind by a crash, has no trailer and is read message by message.
+  // Integers are in network byte order like the preamble.
+  struct index_entry {
+    uint64_t offset = 0;          // of the message preamble from the start of the segment
+    uint16_t msg_type = 0;
+    uint32_t msg_size = 0;        // body size, as in the preamble
+    uint32_t event_count = 0;
+    int64_t min_client_time = 0;  // microseconds since the epoch, 0 if the message carries no client time
+    int64_t max_client_time = 0;
+
+    bool write_to_bytes(uint8_t* buffer, size_t buffersz) const;
+    bool read_from_bytes(const uint8_t* buffer, size_t buffersz);
+    constexpr static uint32_t size() { return 36; }
+  };
+
+  struct segment_trailer {
+    uint64_t index_offset = 0;
+    uint32_t entry_count = 0;
+    uint8_t version = 1;
+
+    bool write_to_bytes(uint8_t* buffer, size_t buffersz) const;
+    // Returns false if the bytes do not end with the segment magic
+    bool read_from_bytes(const uint8_t* buffer, size_t buffersz);
+    constexpr static uint32_t size() { return 24; }
+  };
+
+  // Name of a segment file, the sequence number is zero padded so that names sort in write order.
+  std::string segment_file_name(const std::string& file_name, size_t sequence);
+
+  // Sets everything but the offset from a message (preamble and body).  Event count and client times are read from
+  // flatbuffer event collections, other messages only get their type and size.  Returns false if the preamble is
+  // truncated.
+  bool describe_message(const uint8_t* message, size_t size, index_entry& entry);
+
+  // Reads the index of a closed segment.  Returns false if the stream has no trailer.
+  bool read_segment_index(std::istream& in, segment_trailer& trailer, std::vector<index_entry>& entries);
+}}}
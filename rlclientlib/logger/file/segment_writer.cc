@@ -0,0 +1,239 @@
+#include "segment_writer.h"
+#include "api_status.h"
+#include "err_constants.h"
+#include "trace_logger.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <io.h>
+#include <share.h>
+#else
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+
+namespace reinforcement_learning { namespace logger { namespace file {
+  namespace {
+    // Messages per writev call, the smallest IOV_MAX in use is 1024
+    const size_t MAX_IOV = 1024;
+
+#ifdef _WIN32
+    int open_file(const std::string& file_name) {
+      int fd = -1;
+      _sopen_s(&fd, file_name.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _SH_DENYWR, _S_IREAD | _S_IWRITE);
+      return fd;
+    }
+    int sync_file(int fd) { return _commit(fd); }
+    void close_file(int fd) { _close(fd); }
+#else
+    int open_file(const std::string& file_name) {
+      return ::open(file_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    }
+    int sync_file(int fd) {
+#ifdef __linux__
+      return fdatasync(fd);
+#else
+      return fsync(fd);
+#endif
+    }
+    void close_file(int fd) { ::close(fd); }
+#endif
+
+    bool file_exists(const std::string& file_name) {
+      return std::ifstream(file_name).good();
+    }
+  }
+
+  segment_writer::segment_writer(const std::string& file_name, const segment_options& options, i_trace* trace)
+    : _file_name(file_name), _options(options), _trace(trace), _next_sequence(options.first_sequence)
+  {}
+
+  segment_writer::~segment_writer() {
+    api_status status;
+    if (close_segment(&status) != error_code::success) {
+      TRACE_ERROR(_trace, status.get_error_msg());
+    }
+  }
+
+  int segment_writer::open(api_status* status) {
+    if (_options.enabled()) {
+      // Never overwrite segments left by an earlier run
+      _next_sequence = _options.first_sequence;
+      while (file_exists(segment_file_name(_file_name, _next_sequence))) ++_next_sequence;
+    }
+    return open_segment(status);
+  }
+
+  int segment_writer::write(const std::vector<buffer>& messages, api_status* status) {
+    size_t begin = 0;
+    while (begin < messages.size()) {
+      if (_fd < 0) {
+        RETURN_IF_FAIL(open_segment(status));
+      }
+      else if (should_rotate(messages[begin]->buffer_filled_size())) {
+        RETURN_IF_FAIL(close_segment(status));
+        RETURN_IF_FAIL(open_segment(status));
+      }
+
+      // Everything that still fits into the active segment goes out together
+      auto end = begin + 1;
+      if (_options.max_bytes > 0) {
+        auto bytes = _segment_bytes + messages[begin]->buffer_filled_size();
+        while (end < messages.size() && bytes + messages[end]->buffer_filled_size() <= _options.max_bytes) {
+          bytes += messages[end++]->buffer_filled_size();
+        }
+      }
+      else {
+        end = messages.size();
+      }
+      RETURN_IF_FAIL(write_range(messages, begin, end, status));
+      begin = end;
+    }
+    return error_code::success;
+  }
+
+  int segment_writer::sync(api_status* status) {
+    if (_fd >= 0 && sync_file(_fd) != 0) {
+      RETURN_ERROR_LS(_trace, status, file_write_error) << " File:" << _current_file << " fsync failed:" << strerror(errno);
+    }
+    return error_code::success;
+  }
+
+  int segment_writer::rotate(api_status* status) {
+    return close_segment(status);
+  }
+
+  uint64_t segment_writer::write_calls() const {
+    return _write_calls;
+  }
+
+  uint64_t segment_writer::segments_closed() const {
+    return _segments_closed;
+  }
+
+  const std::string& segment_writer::current_file() const {
+    return _current_file;
+  }
+
+  size_t segment_writer::sequence() const {
+    return _fd >= 0 ? _next_sequence - 1 : _next_sequence;
+  }
+
+  bool segment_writer::should_rotate(size_t next_message_size) const {
+    if (!_options.enabled() || _segment_bytes == 0) return false;
+    if (_options.max_bytes > 0 && _segment_bytes + next_message_size > _options.max_bytes) return true;
+    return _options.max_age.count() > 0 && std::chrono::steady_clock::now() - _segment_opened >= _options.max_age;
+  }
+
+  int segment_writer::open_segment(api_status* status) {
+    _current_file = _options.enabled() ? segment_file_name(_file_name, _next_sequence++) : _file_name;
+    _fd = open_file(_current_file);
+    if (_fd < 0) {
+      RETURN_ERROR_LS(_trace, status, file_open_error) << " File:" << _current_file << " Error:" << strerror(errno);
+    }
+    _segment_bytes = 0;
+    _segment_opened = std::chrono::steady_clock::now();
+    _index.clear();
+    return error_code::success;
+  }
+
+  int segment_writer::close_segment(api_status* status) {
+    if (_fd < 0) return error_code::success;
+
+    int result = error_code::success;
+    if (_options.enabled()) {
+      segment_trailer trailer;
+      trailer.index_offset = _segment_bytes;
+      trailer.entry_count = static_cast<uint32_t>(_index.size());
+      std::vector<uint8_t> footer(_index.size() * index_entry::size() + segment_trailer::size());
+      auto p = footer.data();
+      for (const auto& entry : _index) {
+        entry.write_to_bytes(p, index_entry::size());
+        p += index_entry::size();
+      }
+      trailer.write_to_bytes(p, segment_trailer::size());
+      result = write_all(footer.data(), footer.size(), status);
+      ++_segments_closed;
+    }
+    close_file(_fd);
+    _fd = -1;
+    return result;
+  }
+
+  int segment_writer::write_range(const std::vector<buffer>& messages, size_t begin, size_t end, api_status* status) {
+    if (_options.enabled()) {
+      auto offset = _segment_bytes;
+      for (auto i = begin; i < end; ++i) {
+        index_entry entry;
+        describe_message(messages[i]->preamble_begin(), messages[i]->buffer_filled_size(), entry);
+        entry.offset = offset;
+        offset += messages[i]->buffer_filled_size();
+        _index.push_back(entry);
+      }
+    }
+
+#ifdef _WIN32
+    for (auto i = begin; i < end; ++i) {
+      RETURN_IF_FAIL(write_all(messages[i]->preamble_begin(), messages[i]->buffer_filled_size(), status));
+      _segment_bytes += messages[i]->buffer_filled_size();
+    }
+#else
+    size_t next = begin;
+    size_t offset = 0;  // bytes of messages[next] already written
+    while (next < end) {
+      iovec iov[MAX_IOV];
+      int count = 0;
+      for (auto i = next; i < end && count < static_cast<int>(MAX_IOV); ++i) {
+        const auto skip = i == next ? offset : 0;
+        iov[count].iov_base = messages[i]->preamble_begin() + skip;
+        iov[count].iov_len = messages[i]->buffer_filled_size() - skip;
+        ++count;
+      }
+      const auto written = ::writev(_fd, iov, count);
+      if (written < 0) {
+        if (errno == EINTR) continue;
+        RETURN_ERROR_LS(_trace, status, file_write_error) << " File:" << _current_file << " Error:" << strerror(errno);
+      }
+      ++_write_calls;
+      _segment_bytes += written;
+
+      // Advance past what was written, a short write resumes inside a message
+      auto left = static_cast<size_t>(written);
+      while (next < end) {
+        const auto remaining = messages[next]->buffer_filled_size() - offset;
+        if (left < remaining) {
+          offset += left;
+          break;
+        }
+        left -= remaining;
+        offset = 0;
+        ++next;
+      }
+    }
+#endif
+    return error_code::success;
+  }
+
+  int segment_writer::write_all(const uint8_t* data, size_t size, api_status* status) {
+    while (size > 0) {
+#ifdef _WIN32
+      const auto written = _write(_fd, data, static_cast<unsigned int>(size));
+#else
+      const auto written = ::write(_fd, data, size);
+#endif
+      if (written < 0) {
+        if (errno == EINTR) continue;
+        RETURN_ERROR_LS(_trace, status, file_write_error) << " File:" << _current_file << " Error:" << strerror(errno);
+      }
+      ++_write_calls;
+      data += written;
+      size -= written;
+    }
+    return error_code::success;
+  }
+}}}
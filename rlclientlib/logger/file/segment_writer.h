@@ -0,0 +1,71 @@
+#pragma once
+#include "sender.h"
+#include "segment_index.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace reinforcement_learning {
+  class i_trace;
+}
+
+namespace reinforcement_learning { namespace logger { namespace file {
+  struct segment_options {
+    size_t max_bytes = 0;                     // message bytes per segment, 0 for no limit
+    std::chrono::milliseconds max_age{ 0 };   // a segment older than this is closed on the next write, 0 for no limit
+    size_t first_sequence = 0;                // numbering starts here, or after the last segment on disk from here
+
+    bool enabled() const { return max_bytes > 0 || max_age.count() > 0; }
+  };
+
+  // Appends messages to file_name.  With segments enabled they go to file_name.000000, file_name.000001 ... numbered
+  // after the segments already on disk, and each segment is closed with an index footer when it is full, too old,
+  // or the writer is destroyed.  Without segments the file is a plain sequence of messages like before.
+  // Not thread safe.
+  class segment_writer {
+  public:
+    using buffer = i_sender::buffer;
+
+    segment_writer(const std::string& file_name, const segment_options& options, i_trace* trace);
+    ~segment_writer();
+
+    segment_writer(const segment_writer&) = delete;
+    segment_writer& operator=(const segment_writer&) = delete;
+
+    // Opens the first segment.  Without it the first write opens segment first_sequence, whatever is on disk.
+    int open(api_status* status);
+    // Writes the messages in order, as few writev calls as the segment boundaries allow
+    int write(const std::vector<buffer>& messages, api_status* status);
+    int sync(api_status* status);
+    // Closes the active segment, the next write opens a new one
+    int rotate(api_status* status);
+
+    uint64_t write_calls() const;
+    uint64_t segments_closed() const;
+    const std::string& current_file() const;
+    // Sequence number of the active segment, or of the next one while none is open
+    size_t sequence() const;
+
+  private:
+    bool should_rotate(size_t next_message_size) const;
+    int open_segment(api_status* status);
+    int close_segment(api_status* status);
+    int write_range(const std::vector<buffer>& messages, size_t begin, size_t end, api_status* status);
+    int write_all(const uint8_t* data, size_t size, api_status* status);
+
+    const std::string _file_name;
+    const segment_options _options;
+    i_trace* _trace;
+
+    int _fd = -1;
+    std::string _current_file;
+    size_t _next_sequence;
+    uint64_t _segment_bytes = 0;
+    std::chrono::steady_clock::time_point _segment_opened;
+    std::vector<index_entry> _index;
+    uint64_t _write_calls = 0;
+    uint64_t _segments_closed = 0;
+  };
+}}}
@@ -9,9 +9,9 @@ namespace reinforcement_learning {
       return error_code::protocol_not_supported;
     }
 
-    cb_logger_facade::cb_logger_facade(const utility::configuration& c, i_message_sender* sender, utility::watchdog& watchdog, i_time_provider* time_provider, error_callback_fn* perror_cb)
+    cb_logger_facade::cb_logger_facade(const utility::configuration& c, i_message_sender* sender, utility::watchdog& watchdog, i_time_provider* time_provider, error_callback_fn* perror_cb, logging_engine* engine, utility::background_scheduler* scheduler, drop_level* shared_drop_level)
     : version(c.get_int(name::PROTOCOL_VERSION, value::DEFAULT_PROTOCOL_VERSION))
-    , v1(version == 1 ? new interaction_logger(c, sender, watchdog, time_provider, perror_cb) : nullptr) {
+    , v1(version == 1 ? new interaction_logger(c, sender, watchdog, time_provider, perror_cb, engine, scheduler, shared_drop_level) : nullptr) {
     }
 
     int cb_logger_facade::init(api_status* status) {
@@ -21,6 +21,13 @@ namespace reinforcement_learning {
       }
     }
 
+    queue_pressure cb_logger_facade::get_pressure() const {
+      switch (version) {
+        case 1: return v1->get_pressure();
+        default: return queue_pressure();
+      }
+    }
+
     int cb_logger_facade::log(const char* event_id, const char* context, unsigned int flags, const ranking_response& response, api_status* status, learning_mode learning_mode) {
       switch (version) {
         case 1: return v1->log(event_id, context, flags, response, status, learning_mode);
@@ -28,9 +35,9 @@ namespace reinforcement_learning {
       }
     }
 
-    ccb_logger_facade::ccb_logger_facade(const utility::configuration& c, i_message_sender* sender, utility::watchdog& watchdog, i_time_provider* time_provider, error_callback_fn* perror_cb)
+    ccb_logger_facade::ccb_logger_facade(const utility::configuration& c, i_message_sender* sender, utility::watchdog& watchdog, i_time_provider* time_provider, error_callback_fn* perror_cb, logging_engine* engine, utility::background_scheduler* scheduler, drop_level* shared_drop_level)
     : version(c.get_int(name::PROTOCOL_VERSION, value::DEFAULT_PROTOCOL_VERSION))
-    , v1(version == 1 ? new ccb_logger(c, sender, watchdog, time_provider, perror_cb) : nullptr) {
+    , v1(version == 1 ? new ccb_logger(c, sender, watchdog, time_provider, perror_cb, engine, scheduler, shared_drop_level) : nullptr) {
     }
 
     int ccb_logger_facade::init(api_status* status) {
@@ -40,6 +47,13 @@ namespace reinforcement_learning {
       }
     }
 
+    queue_pressure ccb_logger_facade::get_pressure() const {
+      switch (version) {
+        case 1: return v1->get_pressure();
+        default: return queue_pressure();
+      }
+    }
+
     int ccb_logger_facade::log_decisions(std::vector<const char*>& event_ids, const char* context, unsigned int flags, const std::vector<std::vector<uint32_t>>& action_ids,
       const std::vector<std::vector<float>>& pdfs, const std::string& model_version, api_status* status) {
       switch (version) {
@@ -48,9 +62,9 @@ namespace reinforcement_learning {
       }
     }
 
-    slates_logger_facade::slates_logger_facade(const utility::configuration& c, i_message_sender* sender, utility::watchdog& watchdog, i_time_provider* time_provider, error_callback_fn* perror_cb)
+    slates_logger_facade::slates_logger_facade(const utility::configuration& c, i_message_sender* sender, utility::watchdog& watchdog, i_time_provider* time_provider, error_callback_fn* perror_cb, logging_engine* engine, utility::background_scheduler* scheduler, drop_level* shared_drop_level)
     : version(c.get_int(name::PROTOCOL_VERSION, value::DEFAULT_PROTOCOL_VERSION))
-    , v1(version == 1 ? new slates_logger(c, sender, watchdog, time_provider, perror_cb) : nullptr) {
+    , v1(version == 1 ? new slates_logger(c, sender, watchdog, time_provider, perror_cb, engine, scheduler, shared_drop_level) : nullptr) {
     }
 
     int slates_logger_facade::init(api_status* status) {
@@ -60,6 +74,13 @@ namespace reinforcement_learning {
       }
     }
 
+    queue_pressure slates_logger_facade::get_pressure() const {
+      switch (version) {
+        case 1: return v1->get_pressure();
+        default: return queue_pressure();
+      }
+    }
+
     int slates_logger_facade::log_decision(const std::string& event_id, const char* context, unsigned int flags, const std::vector<std::vector<uint32_t>>& action_ids,
       const std::vector<std::vector<float>>& pdfs, const std::string& model_version, api_status* status) {
       switch (version) {
@@ -68,9 +89,9 @@ namespace reinforcement_learning {
       }
     }
 
-    observation_logger_facade::observation_logger_facade(const utility::configuration& c, i_message_sender* sender, utility::watchdog& watchdog, i_time_provider* time_provider, error_callback_fn* perror_cb)
+    observation_logger_facade::observation_logger_facade(const utility::configuration& c, i_message_sender* sender, utility::watchdog& watchdog, i_time_provider* time_provider, error_callback_fn* perror_cb, logging_engine* engine, utility::background_scheduler* scheduler, drop_level* shared_drop_level)
     : version(c.get_int(name::PROTOCOL_VERSION, value::DEFAULT_PROTOCOL_VERSION))
-    , v1(version == 1 ? new observation_logger(c, sender, watchdog, time_provider, perror_cb) : nullptr) {
+    , v1(version == 1 ? new observation_logger(c, sender, watchdog, time_provider, perror_cb, engine, scheduler, shared_drop_level) : nullptr) {
     }
 
     int observation_logger_facade::init(api_status* status) {
@@ -80,6 +101,13 @@ namespace reinforcement_learning {
       }
     }
 
+    queue_pressure observation_logger_facade::get_pressure() const {
+      switch (version) {
+        case 1: return v1->get_pressure();
+        default: return queue_pressure();
+      }
+    }
+
     int observation_logger_facade::log(const char* event_id, float outcome, api_status* status) {
       switch (version) {
         case 1: return v1->log(event_id, outcome, status);
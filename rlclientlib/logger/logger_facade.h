@@ -19,7 +19,7 @@ namespace reinforcement_learning
   namespace logger {
     class cb_logger_facade {
     public:
-      cb_logger_facade(const utility::configuration& c, i_message_sender* sender, utility::watchdog& watchdog, i_time_provider* time_provider, error_callback_fn* perror_cb = nullptr);
+      cb_logger_facade(const utility::configuration& c, i_message_sender* sender, utility::watchdog& watchdog, i_time_provider* time_provider, error_callback_fn* perror_cb = nullptr, logging_engine* engine = nullptr, utility::background_scheduler* scheduler = nullptr, drop_level* shared_drop_level = nullptr);
       
       cb_logger_facade(const cb_logger_facade& other) = delete;
       cb_logger_facade& operator=(const cb_logger_facade& other) = delete;
@@ -30,6 +30,8 @@ namespace reinforcement_learning
 
       int init(api_status* status);
 
+      queue_pressure get_pressure() const;
+
       int log(const char* event_id, const char* context, unsigned int flags, const ranking_response& response, api_status* status, learning_mode learning_mode = ONLINE);
     
     private:
@@ -39,7 +41,7 @@ namespace reinforcement_learning
 
     class ccb_logger_facade {
     public:
-      ccb_logger_facade(const utility::configuration& c, i_message_sender* sender, utility::watchdog& watchdog, i_time_provider* time_provider, error_callback_fn* perror_cb = nullptr);
+      ccb_logger_facade(const utility::configuration& c, i_message_sender* sender, utility::watchdog& watchdog, i_time_provider* time_provider, error_callback_fn* perror_cb = nullptr, logging_engine* engine = nullptr, utility::background_scheduler* scheduler = nullptr, drop_level* shared_drop_level = nullptr);
 
       ccb_logger_facade(const ccb_logger_facade& other) = delete;
       ccb_logger_facade& operator=(const ccb_logger_facade& other) = delete;
@@ -50,6 +52,8 @@ namespace reinforcement_learning
 
       int init(api_status* status);
 
+      queue_pressure get_pressure() const;
+
       int log_decisions(std::vector<const char*>& event_ids, const char* context, unsigned int flags, const std::vector<std::vector<uint32_t>>& action_ids,
         const std::vector<std::vector<float>>& pdfs, const std::string& model_version, api_status* status);
 
@@ -60,7 +64,7 @@ namespace reinforcement_learning
 
     class slates_logger_facade {
     public:
-      slates_logger_facade(const utility::configuration& c, i_message_sender* sender, utility::watchdog& watchdog, i_time_provider* time_provider, error_callback_fn* perror_cb = nullptr);
+      slates_logger_facade(const utility::configuration& c, i_message_sender* sender, utility::watchdog& watchdog, i_time_provider* time_provider, error_callback_fn* perror_cb = nullptr, logging_engine* engine = nullptr, utility::background_scheduler* scheduler = nullptr, drop_level* shared_drop_level = nullptr);
 
       slates_logger_facade(const slates_logger_facade& other) = delete;
       slates_logger_facade& operator=(const slates_logger_facade& other) = delete;
@@ -71,6 +75,8 @@ namespace reinforcement_learning
 
       int init(api_status* status);
 
+      queue_pressure get_pressure() const;
+
       int log_decision(const std::string& event_id, const char* context, unsigned int flags, const std::vector<std::vector<uint32_t>>& action_ids,
         const std::vector<std::vector<float>>& pdfs, const std::string& model_version, api_status* status);
 
@@ -81,7 +87,7 @@ namespace reinforcement_learning
 
     class observation_logger_facade {
     public:
-      observation_logger_facade(const utility::configuration& c, i_message_sender* sender, utility::watchdog& watchdog, i_time_provider* time_provider, error_callback_fn* perror_cb = nullptr);
+      observation_logger_facade(const utility::configuration& c, i_message_sender* sender, utility::watchdog& watchdog, i_time_provider* time_provider, error_callback_fn* perror_cb = nullptr, logging_engine* engine = nullptr, utility::background_scheduler* scheduler = nullptr, drop_level* shared_drop_level = nullptr);
 
       observation_logger_facade(const observation_logger_facade& other) = delete;
       observation_logger_facade& operator=(const observation_logger_facade& other) = delete;
@@ -92,6 +98,8 @@ namespace reinforcement_learning
 
       int init(api_status* status);
 
+      queue_pressure get_pressure() const;
+
       int log(const char* event_id, float outcome, api_status* status);
 
       int log(const char* event_id, const char* outcome, api_status* status);
@@ -0,0 +1,112 @@
+#include "logging_engine.h"
+#include "api_status.h"
+#include "err_constants.h"
+#include "error_callback_fn.h"
+#include "utility/periodic_background_proc.h"
+
+#include <algorithm>
+
+namespace reinforcement_learning { namespace logger {
+  namespace {
+    // Longest sleep, so that the engine checks in with the watchdog while no source is due
+    const std::chrono::milliseconds max_wait(1000);
+  }
+
+  logging_engine::logging_engine(utility::watchdog& watchdog, error_callback_fn* perror_cb)
+    : _watchdog(watchdog), _perror_cb(perror_cb)
+  {}
+
+  logging_engine::~logging_engine() {
+    stop();
+  }
+
+  int logging_engine::init(api_status* status) {
+    if (_thread.joinable()) return error_code::success;
+    try {
+      _thread = std::thread(&logging_engine::run, this);
+    }
+    catch (const std::exception& e) {
+      RETURN_ERROR_LS(nullptr, status, background_thread_start) << " (logging engine)" << e.what();
+    }
+    return error_code::success;
+  }
+
+  void logging_engine::stop() {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _cv.notify_one();
+    if (_thread.joinable()) {
+      const auto thread_id = _thread.get_id();
+      _thread.join();
+      _watchdog.unregister_thread(thread_id);
+    }
+  }
+
+  void logging_engine::add(i_batch_source* source, logging_priority priority, std::chrono::milliseconds interval) {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      const entry e{ source, priority, interval, clock::now() + interval };
+      const auto pos = std::upper_bound(_sources.begin(), _sources.end(), e,
+        [](const entry& a, const entry& b) { return a.priority < b.priority; });
+      _sources.insert(pos, e);
+      _added = true;
+    }
+    _cv.notify_one();
+  }
+
+  void logging_engine::remove(i_batch_source* source) {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _sources.erase(std::remove_if(_sources.begin(), _sources.end(),
+        [source](const entry& e) { return e.source == source; }), _sources.end());
+    }
+    // Wait for a pass that may have picked the source up before it was removed
+    std::lock_guard<std::mutex> run_lock(_run_mutex);
+  }
+
+  logging_engine_stats logging_engine::get_stats() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+  }
+
+  void logging_engine::run() {
+    _watchdog.register_thread(std::this_thread::get_id(), "Logging engine thread",
+      static_cast<long long>(max_wait.count() * utility::timeout_grace_multiplier_c));
+
+    std::vector<i_batch_source*> due;
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (!_stop) {
+      _watchdog.check_in(std::this_thread::get_id());
+
+      auto wake = clock::now() + max_wait;
+      for (const auto& e : _sources) wake = (std::min)(wake, e.due);
+      _cv.wait_until(lock, wake, [this] { return _stop || _added; });
+      if (_stop) break;
+      _added = false;
+
+      const auto now = clock::now();
+      due.clear();
+      for (auto& e : _sources) {
+        if (e.due > now) continue;
+        due.push_back(e.source);
+        e.due = now + e.interval;
+      }
+      if (due.empty()) continue;
+      ++_stats.passes;
+      _stats.iterations += due.size();
+
+      std::unique_lock<std::mutex> run_lock(_run_mutex);
+      lock.unlock();
+      for (auto source : due) {
+        api_status status;
+        if (source->run_iteration(&status) != error_code::success) {
+          ERROR_CALLBACK(_perror_cb, status);
+        }
+      }
+      run_lock.unlock();
+      lock.lock();
+    }
+  }
+}}
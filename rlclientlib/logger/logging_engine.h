@@ -0,0 +1,83 @@
+#pragma once
+#include "utility/watchdog.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace reinforcement_learning {
+  class api_status;
+  class error_callback_fn;
+}
+
+namespace reinforcement_learning { namespace logger {
+  // Something the engine drains periodically, an async_batcher
+  class i_batch_source {
+  public:
+    virtual ~i_batch_source() = default;
+    // Serializes and sends what is queued
+    virtual int run_iteration(api_status* status) = 0;
+  };
+
+  // Drain order within a pass: interactions go out before the outcomes that refer to them
+  enum class logging_priority : int {
+    interaction = 0,
+    decision = 1,
+    slates = 2,
+    observation = 3
+  };
+
+  struct logging_engine_stats {
+    uint64_t passes = 0;      // wake ups that found a source due
+    uint64_t iterations = 0;  // run_iteration calls
+  };
+
+  // One thread that drains the batchers of all loggers of a live_model, instead of a background thread per batcher.
+  // Each source keeps its own batch interval; sources that are due at the same time are drained in a single pass,
+  // in priority order.
+  class logging_engine {
+  public:
+    explicit logging_engine(utility::watchdog& watchdog, error_callback_fn* perror_cb = nullptr);
+    ~logging_engine();
+
+    int init(api_status* status);
+    void stop();
+
+    void add(i_batch_source* source, logging_priority priority, std::chrono::milliseconds interval);
+    // When this returns the engine does not run the source anymore
+    void remove(i_batch_source* source);
+
+    logging_engine_stats get_stats();
+
+    logging_engine(const logging_engine&) = delete;
+    logging_engine& operator=(const logging_engine&) = delete;
+
+  private:
+    using clock = std::chrono::steady_clock;
+
+    struct entry {
+      i_batch_source* source;
+      logging_priority priority;
+      std::chrono::milliseconds interval;
+      clock::time_point due;
+    };
+
+    void run();
+
+    utility::watchdog& _watchdog;
+    error_callback_fn* _perror_cb;
+
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    std::vector<entry> _sources;  // sorted by priority
+    bool _stop = false;
+    bool _added = false;  // wakes the engine to reschedule
+    logging_engine_stats _stats;
+
+    std::mutex _run_mutex;  // held while sources run, taken after _mutex
+    std::thread _thread;
+  };
+}}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <cstdint>
 #include <memory>
 namespace reinforcement_learning {
@@ -17,6 +18,10 @@ namespace reinforcement_learning {
       virtual ~i_message_sender() = default;
       virtual int send(const uint16_t msg_type, const buffer& db, api_status* status = nullptr) = 0;
       virtual int init(api_status* status = nullptr) = 0;
+      // Fraction of the in-flight window in use, negative for senders without one
+      virtual float window_occupancy() const { return -1.f; }
+      // Smoothed time from a send to the completion of its request, negative for senders that are done when send returns
+      virtual std::chrono::microseconds completion_latency() const { return std::chrono::microseconds(-1); }
     };
   }
 }
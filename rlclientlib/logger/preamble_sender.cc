@@ -8,6 +8,9 @@ namespace reinforcement_learning { namespace logger {
     preamble_message_sender::preamble_message_sender(i_sender* sender) :_sender{sender} 
     {}
 
+    preamble_message_sender::preamble_message_sender(std::shared_ptr<i_sender> sender) :_sender{std::move(sender)}
+    {}
+
     int preamble_message_sender::send(const uint16_t msg_type, const buffer& db, api_status* status) {
       // Set the preamble for this message
       preamble pre;
@@ -23,5 +26,13 @@ namespace reinforcement_learning { namespace logger {
     int preamble_message_sender::init(api_status* status) {
       return error_code::success;
     }
+
+    float preamble_message_sender::window_occupancy() const {
+      return _sender->window_occupancy();
+    }
+
+    std::chrono::microseconds preamble_message_sender::completion_latency() const {
+      return _sender->completion_latency();
+    }
   }
 }
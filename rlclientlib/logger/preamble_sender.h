@@ -6,9 +6,13 @@ namespace reinforcement_learning { namespace logger {
     class preamble_message_sender : public i_message_sender {
     public:
       explicit preamble_message_sender(i_sender*);
+      // Several message senders can share one data sender
+      explicit preamble_message_sender(std::shared_ptr<i_sender>);
       int send(const uint16_t msg_type, const buffer& db, api_status* status) override;
       int init(api_status* status) override;
+      float window_occupancy() const override;
+      std::chrono::microseconds completion_latency() const override;
     private:
-      std::unique_ptr<i_sender> _sender;
+      std::shared_ptr<i_sender> _sender;
     };
 }}
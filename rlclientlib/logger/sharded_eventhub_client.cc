@@ -0,0 +1,76 @@
+#include "sharded_eventhub_client.h"
+#include "err_constants.h"
+#include "trace_logger.h"
+
+#include <algorithm>
+
+namespace reinforcement_learning {
+  sharded_eventhub_client::sharded_eventhub_client(std::vector<std::unique_ptr<eventhub_client>> shards, shard_selection selection, i_trace* trace)
+    : _shards(std::move(shards))
+    , _counters(new counters[_shards.size()])
+    , _selection(selection)
+    , _trace(trace) {
+  }
+
+  int sharded_eventhub_client::init(api_status* status) {
+    if (_shards.empty()) {
+      RETURN_ERROR_LS(_trace, status, invalid_argument) << "sharded eventhub sender needs at least one connection";
+    }
+    for (auto& shard : _shards) {
+      RETURN_IF_FAIL(shard->init(status));
+    }
+    return error_code::success;
+  }
+
+  size_t sharded_eventhub_client::select_shard() {
+    const size_t start = _next++ % _shards.size();
+    if (_selection == shard_selection::round_robin) return start;
+
+    size_t best = start;
+    size_t best_in_flight = _shards[start]->in_flight();
+    for (size_t i = 1; i < _shards.size() && best_in_flight > 0; ++i) {
+      const size_t candidate = (start + i) % _shards.size();
+      const size_t in_flight = _shards[candidate]->in_flight();
+      if (in_flight < best_in_flight) {
+        best = candidate;
+        best_in_flight = in_flight;
+      }
+    }
+    return best;
+  }
+
+  int sharded_eventhub_client::v_send(const buffer& data, api_status* status) {
+    const size_t shard = select_shard();
+    const size_t bytes = data->buffer_filled_size();
+    RETURN_IF_FAIL(_shards[shard]->send(data, status));
+    ++_counters[shard].batches;
+    _counters[shard].bytes += bytes;
+    return error_code::success;
+  }
+
+  std::vector<shard_stats> sharded_eventhub_client::get_shard_stats() const {
+    std::vector<shard_stats> result(_shards.size());
+    for (size_t i = 0; i < _shards.size(); ++i) {
+      result[i].batches = _counters[i].batches;
+      result[i].bytes = _counters[i].bytes;
+      result[i].in_flight = _shards[i]->in_flight();
+    }
+    return result;
+  }
+
+  float sharded_eventhub_client::window_occupancy() const {
+    float sum = 0.f;
+    for (const auto& shard : _shards) sum += shard->window_occupancy();
+    return _shards.empty() ? -1.f : sum / static_cast<float>(_shards.size());
+  }
+
+  std::chrono::microseconds sharded_eventhub_client::completion_latency() const {
+    std::chrono::microseconds slowest(-1);
+    for (const auto& shard : _shards) slowest = (std::max)(slowest, shard->completion_latency());
+    return slowest;
+  }
+
+  void sharded_eventhub_client::add_undelivered_handler(undelivered_fn handler) {
+    for (auto& shard : _shards) shard->add_undelivered_handler(handler);
+  }
+}
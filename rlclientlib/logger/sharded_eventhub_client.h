@@ -0,0 +1,61 @@
+#pragma once
+
+#include "eventhub_client.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace reinforcement_learning {
+  enum class shard_selection {
+    round_robin,
+    least_outstanding  // fewest requests in flight, ties go round robin
+  };
+
+  struct shard_stats {
+    uint64_t batches = 0;
+    uint64_t bytes = 0;
+    size_t in_flight = 0;
+  };
+
+  // Spreads batches over several eventhub_clients, each with its own http client and therefore its own connections,
+  // so that the throughput of one connection does not cap the pipeline.  Every shard enforces its own tasks limit.
+  class sharded_eventhub_client : public i_sender {
+  public:
+    // Takes the ownership of the shards
+    sharded_eventhub_client(std::vector<std::unique_ptr<eventhub_client>> shards, shard_selection selection, i_trace* trace);
+
+    int init(api_status* status) override;
+
+    std::vector<shard_stats> get_shard_stats() const;
+    // Mean over the shards
+    float window_occupancy() const override;
+    // Slowest of the shards
+    std::chrono::microseconds completion_latency() const override;
+    void add_undelivered_handler(undelivered_fn handler) override;
+
+  protected:
+    int v_send(const buffer& data, api_status* status) override;
+
+  private:
+    size_t select_shard();
+
+    // cannot be copied or assigned
+    sharded_eventhub_client(const sharded_eventhub_client&) = delete;
+    sharded_eventhub_client(sharded_eventhub_client&&) = delete;
+    sharded_eventhub_client& operator=(const sharded_eventhub_client&) = delete;
+    sharded_eventhub_client& operator=(sharded_eventhub_client&&) = delete;
+
+  private:
+    struct counters {
+      std::atomic<uint64_t> batches{ 0 };
+      std::atomic<uint64_t> bytes{ 0 };
+    };
+
+    std::vector<std::unique_ptr<eventhub_client>> _shards;
+    std::unique_ptr<counters[]> _counters;
+    const shard_selection _selection;
+    std::atomic<size_t> _next{ 0 };
+    i_trace* _trace;
+  };
+}
@@ -0,0 +1,255 @@
+#ifdef __linux__
+#include "shm_ring.h"
+#include "api_status.h"
+#include "err_constants.h"
+#include "trace_logger.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace reinforcement_learning { namespace logger { namespace shm {
+  namespace {
+    const uint64_t MAGIC = 0x524c53484d52494eULL;  // "RLSHMRIN"
+    const uint32_t VERSION = 2;
+    // The data starts on its own page, the header is never touched by record copies
+    const size_t HEADER_SIZE = 4096;
+
+    enum record_state : uint32_t { unpublished = 0, published = 1, padding = 2 };
+
+    struct record {
+      uint32_t size;
+      std::atomic<uint32_t> state;
+    };
+    static_assert(sizeof(record) == 8, "record header must stay 8 bytes");
+
+    size_t align8(size_t size) { return (size + 7) & ~size_t(7); }
+
+    size_t round_up_pow2(size_t value) {
+      size_t result = 4096;
+      while (result < value) result <<= 1;
+      return result;
+    }
+
+    std::string object_name(const std::string& name) {
+      return "/" + name;
+    }
+
+    // Clock ticks since boot at which the process started, 0 if it does not exist.  Tells a process from a later one
+    // that got the same pid.
+    uint64_t process_start_time(int32_t pid) {
+      std::ifstream in("/proc/" + std::to_string(pid) + "/stat");
+      std::string stat;
+      if (!std::getline(in, stat)) return 0;
+      // The command name in parentheses may contain spaces, the fields after it are fixed.  starttime is field 22,
+      // the 20th after the name.
+      const auto end_of_name = stat.rfind(')');
+      if (end_of_name == std::string::npos) return 0;
+      std::istringstream fields(stat.substr(end_of_name + 1));
+      std::string field;
+      for (int i = 0; i < 19; ++i) fields >> field;
+      uint64_t start_time = 0;
+      fields >> start_time;
+      return start_time;
+    }
+  }
+
+  struct shm_ring::header {
+    std::atomic<uint64_t> magic;  // set last by create, open refuses rings that are still being set up
+    uint32_t version;
+    int32_t owner_pid;
+    uint64_t capacity;
+    uint64_t owner_start_time;  // see process_start_time, 0 if /proc could not be read
+    alignas(64) std::atomic<uint64_t> claim;   // producers
+    alignas(64) std::atomic<uint64_t> read;    // collector
+    alignas(64) std::atomic<uint32_t> closed;
+  };
+
+  int shm_ring::create(const std::string& name, size_t capacity, std::unique_ptr<shm_ring>& ring, i_trace* trace,
+    api_status* status) {
+    static_assert(sizeof(header) <= HEADER_SIZE, "ring header must fit in front of the data");
+    capacity = round_up_pow2(capacity);
+    const auto object = object_name(name);
+    int fd = shm_open(object.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0 && errno == EEXIST) {
+      // Left behind by a process that had our pid before
+      shm_unlink(object.c_str());
+      fd = shm_open(object.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    }
+    if (fd < 0) {
+      RETURN_ERROR_LS(trace, status, shm_ring_error) << name << ": shm_open failed: " << strerror(errno);
+    }
+
+    const auto mapping_size = HEADER_SIZE + capacity;
+    if (ftruncate(fd, static_cast<off_t>(mapping_size)) != 0) {
+      const auto error = errno;
+      ::close(fd);
+      shm_unlink(object.c_str());
+      RETURN_ERROR_LS(trace, status, shm_ring_error) << name << ": ftruncate failed: " << strerror(error);
+    }
+    const auto mapping = mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    const auto error = errno;
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+      shm_unlink(object.c_str());
+      RETURN_ERROR_LS(trace, status, shm_ring_error) << name << ": mmap failed: " << strerror(error);
+    }
+
+    ring.reset(new shm_ring(name, mapping, mapping_size));
+    // ftruncate zero filled the object, positions and record states start at zero
+    ring->_header->version = VERSION;
+    ring->_header->owner_pid = static_cast<int32_t>(getpid());
+    ring->_header->owner_start_time = process_start_time(ring->_header->owner_pid);
+    ring->_header->capacity = capacity;
+    ring->_header->magic.store(MAGIC, std::memory_order_release);
+    return error_code::success;
+  }
+
+  int shm_ring::open(const std::string& name, std::unique_ptr<shm_ring>& ring, i_trace* trace, api_status* status) {
+    const auto object = object_name(name);
+    const int fd = shm_open(object.c_str(), O_RDWR, 0600);
+    if (fd < 0) {
+      RETURN_ERROR_LS(trace, status, shm_ring_error) << name << ": shm_open failed: " << strerror(errno);
+    }
+    struct stat st {};
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) <= HEADER_SIZE) {
+      ::close(fd);
+      RETURN_ERROR_LS(trace, status, shm_ring_error) << name << ": not initialized";
+    }
+    const auto mapping_size = static_cast<size_t>(st.st_size);
+    const auto mapping = mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    const auto error = errno;
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+      RETURN_ERROR_LS(trace, status, shm_ring_error) << name << ": mmap failed: " << strerror(error);
+    }
+
+    std::unique_ptr<shm_ring> result(new shm_ring(name, mapping, mapping_size));
+    const auto h = result->_header;
+    if (h->magic.load(std::memory_order_acquire) != MAGIC || h->version != VERSION ||
+      HEADER_SIZE + h->capacity != mapping_size) {
+      RETURN_ERROR_LS(trace, status, shm_ring_error) << name << ": not a ring or not initialized";
+    }
+    ring = std::move(result);
+    return error_code::success;
+  }
+
+  std::vector<std::string> shm_ring::list(const std::string& prefix) {
+    std::vector<std::string> names;
+    const auto dir = opendir("/dev/shm");
+    if (dir == nullptr) return names;
+    while (const auto entry = readdir(dir)) {
+      const std::string name(entry->d_name);
+      if (name.compare(0, prefix.size(), prefix) == 0) names.push_back(name);
+    }
+    closedir(dir);
+    return names;
+  }
+
+  void shm_ring::unlink(const std::string& name) {
+    shm_unlink(object_name(name).c_str());
+  }
+
+  shm_ring::shm_ring(const std::string& name, void* mapping, size_t mapping_size)
+    : _name(name), _mapping(mapping), _mapping_size(mapping_size),
+    _header(static_cast<header*>(mapping)),
+    _data(static_cast<uint8_t*>(mapping) + HEADER_SIZE)
+  {}
+
+  shm_ring::~shm_ring() {
+    munmap(_mapping, _mapping_size);
+  }
+
+  bool shm_ring::try_write(const uint8_t* data, size_t size) {
+    const auto capacity = _header->capacity;
+    const auto need = align8(sizeof(record) + size);
+    if (size > max_record_size()) return false;
+
+    auto pos = _header->claim.load(std::memory_order_relaxed);
+    size_t offset;
+    size_t pad;
+    while (true) {
+      offset = pos & (capacity - 1);
+      pad = offset + need > capacity ? capacity - offset : 0;
+      if (pos + pad + need - _header->read.load(std::memory_order_acquire) > capacity) return false;
+      if (_header->claim.compare_exchange_weak(pos, pos + pad + need, std::memory_order_acq_rel, std::memory_order_relaxed)) break;
+    }
+
+    if (pad > 0) {
+      const auto skip = reinterpret_cast<record*>(_data + offset);
+      skip->size = 0;
+      skip->state.store(padding, std::memory_order_release);
+      offset = 0;
+    }
+    const auto rec = reinterpret_cast<record*>(_data + offset);
+    rec->size = static_cast<uint32_t>(size);
+    memcpy(_data + offset + sizeof(record), data, size);
+    rec->state.store(published, std::memory_order_release);
+    return true;
+  }
+
+  size_t shm_ring::max_record_size() const {
+    // Half the ring always fits, either behind the current position or after padding to the start
+    return _header->capacity / 2 - sizeof(record);
+  }
+
+  void shm_ring::close_producer() {
+    _header->closed.store(1, std::memory_order_release);
+  }
+
+  size_t shm_ring::read(const std::function<void(const uint8_t* data, size_t size)>& fn, size_t max_records) {
+    const auto capacity = _header->capacity;
+    auto pos = _header->read.load(std::memory_order_relaxed);
+    size_t count = 0;
+    while (count < max_records) {
+      const auto offset = pos & (capacity - 1);
+      const auto rec = reinterpret_cast<record*>(_data + offset);
+      const auto state = rec->state.load(std::memory_order_acquire);
+      if (state == unpublished) break;
+
+      size_t length = capacity - offset;
+      if (state == published) {
+        fn(_data + offset + sizeof(record), rec->size);
+        length = align8(sizeof(record) + rec->size);
+        ++count;
+      }
+      // Zeroed space reads as unpublished when producers come around again
+      memset(_data + offset, 0, length);
+      pos += length;
+      _header->read.store(pos, std::memory_order_release);
+    }
+    return count;
+  }
+
+  bool shm_ring::empty() const {
+    return _header->read.load(std::memory_order_acquire) == _header->claim.load(std::memory_order_acquire);
+  }
+
+  bool shm_ring::producer_closed() const {
+    return _header->closed.load(std::memory_order_acquire) != 0;
+  }
+
+  bool shm_ring::owner_alive() const {
+    if (kill(_header->owner_pid, 0) != 0 && errno != EPERM) return false;
+    // The pid may belong to a new process by now
+    return _header->owner_start_time == 0 || process_start_time(_header->owner_pid) == _header->owner_start_time;
+  }
+
+  const std::string& shm_ring::name() const {
+    return _name;
+  }
+
+  size_t shm_ring::capacity() const {
+    return _header->capacity;
+  }
+}}}
+#endif
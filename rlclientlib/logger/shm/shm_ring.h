@@ -0,0 +1,66 @@
+#pragma once
+#ifdef __linux__
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace reinforcement_learning {
+  class api_status;
+  class i_trace;
+}
+
+namespace reinforcement_learning { namespace logger { namespace shm {
+  // Byte ring in a POSIX shared memory object, written by any number of threads of the owning process and drained by
+  // one collector process.  Producers claim space with a compare and swap on the claim position, copy the record and
+  // publish it by setting its state.  The collector consumes records in claim order, zeroes them and moves the read
+  // position forward, which is what frees the space.  Records never wrap, the tail of the ring is skipped with a
+  // padding record instead.  Linux only.
+  class shm_ring {
+  public:
+    // Creates the shared memory object, replacing one left behind by an earlier process with the same name.
+    // capacity is rounded up to a power of two.
+    static int create(const std::string& name, size_t capacity, std::unique_ptr<shm_ring>& ring, i_trace* trace,
+      api_status* status);
+    // Maps an existing ring for the collector
+    static int open(const std::string& name, std::unique_ptr<shm_ring>& ring, i_trace* trace, api_status* status);
+    // Names of the rings whose name starts with prefix
+    static std::vector<std::string> list(const std::string& prefix);
+    static void unlink(const std::string& name);
+
+    ~shm_ring();
+    shm_ring(const shm_ring&) = delete;
+    shm_ring& operator=(const shm_ring&) = delete;
+
+    // Producer side, thread safe.  Returns false without writing anything if the ring has no room for the record.
+    bool try_write(const uint8_t* data, size_t size);
+    // Records larger than this never fit
+    size_t max_record_size() const;
+    // Tells the collector that no more records will come
+    void close_producer();
+
+    // Consumer side, one caller at a time.  Calls fn for up to max_records published records in claim order and
+    // returns how many were consumed.  Stops at the first claimed record that is not published yet.
+    size_t read(const std::function<void(const uint8_t* data, size_t size)>& fn, size_t max_records = SIZE_MAX);
+    bool empty() const;
+    bool producer_closed() const;
+    // False once the process that created the ring has exited, also when its pid has been reused since
+    bool owner_alive() const;
+
+    const std::string& name() const;
+    size_t capacity() const;
+
+  private:
+    struct header;
+    shm_ring(const std::string& name, void* mapping, size_t mapping_size);
+
+    const std::string _name;
+    void* _mapping;
+    size_t _mapping_size;
+    header* _header;
+    uint8_t* _data;
+  };
+}}}
+#endif
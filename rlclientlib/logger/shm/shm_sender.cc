@@ -0,0 +1,55 @@
+#ifdef __linux__
+#include "shm_sender.h"
+#include "api_status.h"
+#include "err_constants.h"
+#include "trace_logger.h"
+
+#include <unistd.h>
+
+#include <atomic>
+#include <thread>
+
+namespace reinforcement_learning { namespace logger { namespace shm {
+  shm_sender::shm_sender(const std::string& ring_name, size_t ring_size, std::chrono::milliseconds send_timeout,
+    i_trace* trace)
+    : _ring_name(ring_name), _ring_size(ring_size), _send_timeout(send_timeout), _trace(trace)
+  {}
+
+  shm_sender::~shm_sender() {
+    if (_ring == nullptr) return;
+    _ring->close_producer();
+    if (_ring->empty()) shm_ring::unlink(_ring_name);
+  }
+
+  int shm_sender::init(api_status* status) {
+    RETURN_IF_FAIL(shm_ring::create(_ring_name, _ring_size, _ring, _trace, status));
+    TRACE_INFO(_trace, "Shared memory sender writing to " + _ring_name);
+    return error_code::success;
+  }
+
+  std::string shm_sender::ring_name(const std::string& prefix, const std::string& channel) {
+    static std::atomic<int> instance{ 0 };
+    return prefix + "." + channel + "." + std::to_string(getpid()) + "." + std::to_string(instance++);
+  }
+
+  int shm_sender::v_send(const buffer& data, api_status* status) {
+    const auto bytes = data->preamble_begin();
+    const auto size = data->buffer_filled_size();
+    if (size > _ring->max_record_size()) {
+      RETURN_ERROR_LS(_trace, status, shm_ring_error) << _ring_name << ": batch of " << size
+        << " bytes is larger than the ring allows (" << _ring->max_record_size() << ")";
+    }
+    if (_ring->try_write(bytes, size)) return error_code::success;
+
+    // Full, spin briefly and then back off while the collector drains
+    const auto deadline = std::chrono::steady_clock::now() + _send_timeout;
+    for (int attempt = 0;; ++attempt) {
+      if (attempt < 64) std::this_thread::yield();
+      else std::this_thread::sleep_for(std::chrono::microseconds(100));
+      if (_ring->try_write(bytes, size)) return error_code::success;
+      if (std::chrono::steady_clock::now() >= deadline) break;
+    }
+    RETURN_ERROR_LS(_trace, status, shm_ring_full) << _ring_name;
+  }
+}}}
+#endif
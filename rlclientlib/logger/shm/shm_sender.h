@@ -0,0 +1,49 @@
+#pragma once
+#ifdef __linux__
+#include "sender.h"
+#include "shm_ring.h"
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+namespace reinforcement_learning {
+  class i_trace;
+}
+
+namespace reinforcement_learning { namespace logger { namespace shm {
+  // Hands preamble framed batches to a collector process through a shared memory ring instead of sending them
+  // itself.  The collector (test_tools/shm_collector) forwards the batches of every process on the host through
+  // one real sender.  A send into a full ring waits up to send_timeout for the collector before failing.
+  //
+  // A ring that is empty when the sender goes away is removed right away.  One that still holds records stays in
+  // /dev/shm until a collector drains and removes it, or until a later process with the same pid replaces it, so
+  // without a collector on the host each exiting process can leave one ring behind, as does a crashed one.
+  class shm_sender : public i_sender {
+  public:
+    shm_sender(const std::string& ring_name, size_t ring_size, std::chrono::milliseconds send_timeout, i_trace* trace);
+    // Marks the ring closed and removes it if it is empty, otherwise the collector removes it once drained
+    ~shm_sender();
+
+    int init(api_status* status) override;
+
+    shm_sender(const shm_sender&) = delete;
+    shm_sender(shm_sender&&) = delete;
+    shm_sender& operator=(const shm_sender&) = delete;
+    shm_sender& operator=(shm_sender&&) = delete;
+
+    // <prefix>.<channel>.<pid>.<n>, unique per sender of this process
+    static std::string ring_name(const std::string& prefix, const std::string& channel);
+
+  protected:
+    int v_send(const buffer& data, api_status* status) override;
+
+  private:
+    const std::string _ring_name;
+    const size_t _ring_size;
+    const std::chrono::milliseconds _send_timeout;
+    i_trace* _trace;
+    std::unique_ptr<shm_ring> _ring;
+  };
+}}}
+#endif
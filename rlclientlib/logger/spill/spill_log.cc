@@ -0,0 +1,347 @@
+#include "spill_log.h"
+#include "api_status.h"
+#include "data_buffer.h"
+#include "err_constants.h"
+#include "trace_logger.h"
+#include "logger/file/segment_index.h"
+#include "logger/preamble.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#include <io.h>
+#include <share.h>
+#else
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+namespace reinforcement_learning { namespace logger { namespace spill {
+  namespace {
+    const size_t CURSOR_SIZE = 16;
+    // Spill logs sharing a directory take directory.1 ... up to this
+    const int MAX_DIRECTORIES = 64;
+
+    void put(uint8_t*& p, uint64_t value) {
+      for (int i = 7; i >= 0; --i) *p++ = static_cast<uint8_t>(value >> (8 * i));
+    }
+
+    uint64_t get(const uint8_t*& p) {
+      uint64_t value = 0;
+      for (int i = 0; i < 8; ++i) value = (value << 8) | *p++;
+      return value;
+    }
+
+    bool file_exists(const std::string& file_name) {
+      return std::ifstream(file_name).good();
+    }
+
+    // Creates path and its missing parents, returns 0 or the errno of the failure
+    int make_directories(const std::string& path) {
+      for (size_t end = 1; end <= path.size(); ++end) {
+        if (end < path.size() && path[end] != '/' && path[end] != '\\') continue;
+        const auto prefix = path.substr(0, end);
+#ifdef _WIN32
+        const auto result = _mkdir(prefix.c_str());
+#else
+        const auto result = mkdir(prefix.c_str(), 0755);
+#endif
+        if (result != 0 && errno != EEXIST) return errno;
+      }
+      return 0;
+    }
+
+    // Opens directory/lock for this spill log alone, returns -1 while another one holds it
+    int lock_directory(const std::string& directory) {
+      const auto file_name = directory + "/lock";
+#ifdef _WIN32
+      // Opening without sharing is the lock
+      int fd = -1;
+      _sopen_s(&fd, file_name.c_str(), _O_RDWR | _O_CREAT | _O_BINARY, _SH_DENYRW, _S_IREAD | _S_IWRITE);
+      return fd;
+#else
+      // flock locks belong to the open file, so two spill logs of one process exclude each other too
+      const auto fd = ::open(file_name.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+      if (fd >= 0 && flock(fd, LOCK_EX | LOCK_NB) != 0) {
+        ::close(fd);
+        return -1;
+      }
+      return fd;
+#endif
+    }
+
+    void unlock_directory(int fd) {
+#ifdef _WIN32
+      _close(fd);
+#else
+      ::close(fd);
+#endif
+    }
+  }
+
+  // A segment file in memory, mapped where mmap is available
+  class mapped_segment {
+  public:
+    static int open(const std::string& file_name, std::unique_ptr<mapped_segment>& segment, i_trace* trace,
+      api_status* status);
+    ~mapped_segment();
+
+    const uint8_t* data() const { return _data; }
+    // Size of the batch at offset, preamble included, 0 past the last complete batch
+    uint64_t batch_size(uint64_t offset) const;
+
+  private:
+    mapped_segment() = default;
+
+    const uint8_t* _data = nullptr;
+    size_t _size = 0;
+    // Offset past the last batch: the index of a closed segment, or the file size for one left behind by a crash
+    uint64_t _batches_end = 0;
+#ifdef _WIN32
+    std::vector<uint8_t> _bytes;
+#endif
+  };
+
+  int mapped_segment::open(const std::string& file_name, std::unique_ptr<mapped_segment>& segment, i_trace* trace,
+    api_status* status) {
+    std::unique_ptr<mapped_segment> result(new mapped_segment());
+#ifdef _WIN32
+    std::ifstream in(file_name, std::ios::binary);
+    if (!in) {
+      RETURN_ERROR_LS(trace, status, spill_log_error) << "Unable to open " << file_name << ": " << strerror(errno);
+    }
+    result->_bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    result->_data = result->_bytes.data();
+    result->_size = result->_bytes.size();
+#else
+    const auto fd = ::open(file_name.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      RETURN_ERROR_LS(trace, status, spill_log_error) << "Unable to open " << file_name << ": " << strerror(errno);
+    }
+    struct stat st{};
+    if (fstat(fd, &st) != 0) {
+      const auto error = errno;
+      ::close(fd);
+      RETURN_ERROR_LS(trace, status, spill_log_error) << "Unable to stat " << file_name << ": " << strerror(error);
+    }
+    result->_size = static_cast<size_t>(st.st_size);
+    if (result->_size > 0) {
+      const auto mapping = mmap(nullptr, result->_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapping == MAP_FAILED) {
+        const auto error = errno;
+        ::close(fd);
+        RETURN_ERROR_LS(trace, status, spill_log_error) << "Unable to map " << file_name << ": " << strerror(error);
+      }
+      result->_data = static_cast<const uint8_t*>(mapping);
+    }
+    ::close(fd);
+#endif
+
+    result->_batches_end = result->_size;
+    file::segment_trailer trailer;
+    if (result->_size >= file::segment_trailer::size()
+      && trailer.read_from_bytes(result->_data + result->_size - file::segment_trailer::size(), file::segment_trailer::size())
+      && trailer.index_offset <= result->_size) {
+      result->_batches_end = trailer.index_offset;
+    }
+    segment = std::move(result);
+    return error_code::success;
+  }
+
+  mapped_segment::~mapped_segment() {
+#ifndef _WIN32
+    if (_data != nullptr) munmap(const_cast<uint8_t*>(_data), _size);
+#endif
+  }
+
+  uint64_t mapped_segment::batch_size(uint64_t offset) const {
+    if (offset + preamble::size() > _batches_end) return 0;
+    // Batches are not aligned in the segment, the preamble is read from a copy
+    uint8_t bytes[preamble::size()];
+    memcpy(bytes, _data + offset, preamble::size());
+    preamble pre;
+    pre.read_from_bytes(bytes, preamble::size());
+    const uint64_t size = preamble::size() + static_cast<uint64_t>(pre.msg_size);
+    return offset + size <= _batches_end ? size : 0;
+  }
+
+  spill_log::spill_log(const std::string& directory, const spill_log_options& options, i_trace* trace)
+    : _base_directory(directory), _options(options), _trace(trace)
+  {}
+
+  spill_log::~spill_log() {
+    // The last segment is closed before another spill log can take the directory
+    _writer.reset();
+    _cursor.close();
+    if (_lock_fd >= 0) unlock_directory(_lock_fd);
+  }
+
+  int spill_log::open(api_status* status) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (int i = 0; _lock_fd < 0; ++i) {
+      if (i == MAX_DIRECTORIES) {
+        RETURN_ERROR_LS(_trace, status, spill_log_error) << "Unable to lock " << _base_directory << " or any of the "
+          << MAX_DIRECTORIES - 1 << " directories next to it";
+      }
+      const auto directory = i == 0 ? _base_directory : _base_directory + "." + std::to_string(i);
+      const auto error = make_directories(directory);
+      if (error != 0) {
+        RETURN_ERROR_LS(_trace, status, spill_log_error) << "Unable to create " << directory << ": " << strerror(error);
+      }
+      _lock_fd = lock_directory(directory);
+      _directory = directory;
+    }
+    _segment_prefix = _directory + "/spill";
+
+    const auto cursor_file = _directory + "/cursor";
+    {
+      std::ifstream in(cursor_file, std::ios::binary);
+      uint8_t bytes[CURSOR_SIZE];
+      if (in.read(reinterpret_cast<char*>(bytes), CURSOR_SIZE)) {
+        const uint8_t* p = bytes;
+        _read_sequence = static_cast<size_t>(get(p));
+        _read_offset = get(p);
+      }
+      else {
+        std::ofstream(cursor_file, std::ios::binary);
+      }
+    }
+    _cursor.open(cursor_file, std::ios::in | std::ios::out | std::ios::binary);
+    if (!_cursor) {
+      RETURN_ERROR_LS(_trace, status, spill_log_error) << "Unable to open " << cursor_file << ": " << strerror(errno);
+    }
+    // A crash between moving the cursor and deleting the segment behind it leaves that segment
+    if (_read_sequence > 0) std::remove(file::segment_file_name(_segment_prefix, _read_sequence - 1).c_str());
+
+    // Count what an earlier process left for replay, new segments are numbered after it
+    auto sequence = _read_sequence;
+    for (; file_exists(file::segment_file_name(_segment_prefix, sequence)); ++sequence) {
+      std::unique_ptr<mapped_segment> segment;
+      RETURN_IF_FAIL(mapped_segment::open(file::segment_file_name(_segment_prefix, sequence), segment, _trace, status));
+      auto offset = sequence == _read_sequence ? _read_offset : 0;
+      for (auto size = segment->batch_size(offset); size > 0; size = segment->batch_size(offset)) {
+        _backlog_bytes += size;
+        ++_backlog_batches;
+        offset += size;
+      }
+    }
+
+    file::segment_options segments;
+    segments.max_bytes = _options.segment_bytes;
+    segments.first_sequence = sequence;
+    _writer.reset(new file::segment_writer(_segment_prefix, segments, _trace));
+    return save_cursor(status);
+  }
+
+  int spill_log::append(const buffer& batch, api_status* status) {
+    const auto size = batch->buffer_filled_size();
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_backlog_batches > 0 && _backlog_bytes + size > _options.max_bytes) {
+      RETURN_ERROR_LS(_trace, status, spill_log_full) << _directory << " holds " << _backlog_bytes << " bytes";
+    }
+    RETURN_IF_FAIL(_writer->write({ batch }, status));
+    _backlog_bytes += size;
+    ++_backlog_batches;
+    return error_code::success;
+  }
+
+  int spill_log::front(buffer& batch, api_status* status) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    batch = nullptr;
+    while (_backlog_batches > 0) {
+      if (_segment == nullptr) {
+        // Replay caught up with the writer, its segment has to be closed to be read
+        if (_read_sequence == _writer->sequence()) {
+          RETURN_IF_FAIL(_writer->rotate(status));
+        }
+        if (_read_sequence >= _writer->sequence()) {
+          TRACE_WARN(_trace, "Spill log " + _directory + " lost " + std::to_string(_backlog_batches) + " batches");
+          _backlog_bytes = 0;
+          _backlog_batches = 0;
+          break;
+        }
+        const auto file_name = file::segment_file_name(_segment_prefix, _read_sequence);
+        if (!file_exists(file_name)) {
+          RETURN_IF_FAIL(next_segment(status));
+          continue;
+        }
+        RETURN_IF_FAIL(mapped_segment::open(file_name, _segment, _trace, status));
+      }
+
+      const auto size = _segment->batch_size(_read_offset);
+      if (size == 0) {
+        RETURN_IF_FAIL(next_segment(status));
+        continue;
+      }
+      const auto body_size = static_cast<size_t>(size - preamble::size());
+      batch = std::make_shared<utility::data_buffer>((std::max)(body_size, size_t(1)));
+      memcpy(batch->preamble_begin(), _segment->data() + _read_offset, static_cast<size_t>(size));
+      batch->set_body_endoffset(batch->preamble_size() + body_size);
+      _front_size = size;
+      break;
+    }
+    return error_code::success;
+  }
+
+  int spill_log::pop(api_status* status) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_front_size == 0) return error_code::success;
+    _read_offset += _front_size;
+    _backlog_bytes -= (std::min)(_backlog_bytes, _front_size);
+    --_backlog_batches;
+    _front_size = 0;
+    if (_segment != nullptr && _segment->batch_size(_read_offset) == 0) {
+      return next_segment(status);
+    }
+    return save_cursor(status);
+  }
+
+  uint64_t spill_log::backlog_bytes() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _backlog_bytes;
+  }
+
+  const std::string& spill_log::directory() const {
+    return _directory;
+  }
+
+  uint64_t spill_log::backlog_batches() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _backlog_batches;
+  }
+
+  int spill_log::next_segment(api_status* status) {
+    const auto done = _segment != nullptr;
+    _segment.reset();
+    ++_read_sequence;
+    _read_offset = 0;
+    // The cursor moves first, a crash in between leaves a segment that open deletes rather than one replayed twice
+    RETURN_IF_FAIL(save_cursor(status));
+    if (done) std::remove(file::segment_file_name(_segment_prefix, _read_sequence - 1).c_str());
+    return error_code::success;
+  }
+
+  int spill_log::save_cursor(api_status* status) {
+    uint8_t bytes[CURSOR_SIZE];
+    uint8_t* p = bytes;
+    put(p, _read_sequence);
+    put(p, _read_offset);
+    _cursor.seekp(0);
+    _cursor.write(reinterpret_cast<const char*>(bytes), CURSOR_SIZE);
+    _cursor.flush();
+    if (!_cursor) {
+      _cursor.clear();
+      RETURN_ERROR_LS(_trace, status, spill_log_error) << "Unable to update the cursor of " << _directory;
+    }
+    return error_code::success;
+  }
+}}}
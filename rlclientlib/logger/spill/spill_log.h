@@ -0,0 +1,82 @@
+#pragma once
+#include "sender.h"
+#include "logger/file/segment_writer.h"
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace reinforcement_learning {
+  class i_trace;
+}
+
+namespace reinforcement_learning { namespace logger { namespace spill {
+  struct spill_log_options {
+    size_t max_bytes = 1024 * 1024 * 1024;     // batches waiting for replay, beyond this appends fail
+    size_t segment_bytes = 16 * 1024 * 1024;   // per segment file
+  };
+
+  class mapped_segment;
+
+  // Append-only log of preamble framed batches in a directory, replayed in the order they were appended, across
+  // process restarts.
+  //
+  // Batches go to segment files with the layout of a segmented file sender: directory/spill.000000, spill.000001 ...
+  // Replay maps a closed segment and walks it batch by batch, when it catches up with the segment being written that
+  // one is closed first.  Replayed segments are deleted.  The replay position is kept in directory/cursor and updated
+  // in place after every batch, so that a restarted process resumes where the last one stopped.  Batches are replayed
+  // at least once: one sent just before a crash, before the cursor moved past it, is replayed again.
+  //
+  // A spill log holds a lock on directory/lock while it is open.  When another spill log, in this process or another
+  // one, holds the directory, open takes the first free one of directory.1, directory.2 ... so that live models
+  // sharing a spill.dir do not mix their batches.  A restarted process takes the same directories in the same
+  // order and replays what was left in them.
+  // Thread safe.
+  class spill_log {
+  public:
+    using buffer = i_sender::buffer;
+
+    spill_log(const std::string& directory, const spill_log_options& options, i_trace* trace);
+    ~spill_log();
+
+    spill_log(const spill_log&) = delete;
+    spill_log& operator=(const spill_log&) = delete;
+
+    // Creates and locks the directory and picks up the batches an earlier process left
+    int open(api_status* status);
+    int append(const buffer& batch, api_status* status);
+    // Copies the oldest batch into a new buffer, batch is null once the log is empty
+    int front(buffer& batch, api_status* status);
+    // Drops the batch of the last front
+    int pop(api_status* status);
+
+    uint64_t backlog_bytes() const;
+    uint64_t backlog_batches() const;
+    // The directory open took
+    const std::string& directory() const;
+
+  private:
+    // Moves to the next segment, the caller holds _mutex
+    int next_segment(api_status* status);
+    int save_cursor(api_status* status);
+
+    const std::string _base_directory;
+    std::string _directory;
+    std::string _segment_prefix;
+    int _lock_fd = -1;
+    const spill_log_options _options;
+    i_trace* _trace;
+
+    mutable std::mutex _mutex;
+    std::unique_ptr<file::segment_writer> _writer;  // created by open, numbered after the segments on disk
+    std::fstream _cursor;
+    size_t _read_sequence = 0;
+    uint64_t _read_offset = 0;
+    uint64_t _front_size = 0;
+    std::unique_ptr<mapped_segment> _segment;
+    uint64_t _backlog_bytes = 0;
+    uint64_t _backlog_batches = 0;
+  };
+}}}
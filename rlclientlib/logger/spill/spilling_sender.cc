@@ -0,0 +1,167 @@
+#include "spilling_sender.h"
+#include "api_status.h"
+#include "err_constants.h"
+#include "error_callback_fn.h"
+#include "trace_logger.h"
+
+#include <algorithm>
+
+namespace reinforcement_learning { namespace logger { namespace spill {
+  spilling_sender::spilling_sender(i_sender* destination, const std::string& directory,
+    const spilling_sender_options& options, error_callback_fn* error_cb, i_trace* trace)
+    : _destination(destination)
+    , _options(options)
+    , _error_cb(error_cb)
+    , _trace(trace)
+    , _log(directory, options.log, trace)
+    , _rate_update(std::chrono::steady_clock::now())
+  {}
+
+  spilling_sender::~spilling_sender() {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _cv.notify_all();
+    if (_thread.joinable()) _thread.join();
+    // Requests still in flight may give up on their batches while the destination shuts down
+    _destination.reset();
+    if (_sink) {
+      std::lock_guard<std::mutex> lock(_sink->mutex);
+      _sink->sender = nullptr;
+    }
+  }
+
+  int spilling_sender::init(api_status* status) {
+    RETURN_IF_FAIL(_log.open(status));
+    _sink = std::make_shared<undelivered_sink>();
+    _sink->sender = this;
+    const auto sink = _sink;
+    _destination->add_undelivered_handler([sink](const buffer& data) {
+      std::lock_guard<std::mutex> lock(sink->mutex);
+      if (sink->sender == nullptr) return false;
+      TRACE_WARN(sink->sender->_trace, "Spilling a batch the sender gave up on");
+      sink->sender->spill(data, nullptr);
+      return true;
+    });
+    RETURN_IF_FAIL(_destination->init(status));
+    const auto backlog = _log.backlog_batches();
+    if (backlog > 0) {
+      TRACE_INFO(_trace, "Replaying " + std::to_string(backlog) + " batches spilled to " + _log.directory());
+    }
+    try {
+      _thread = std::thread(&spilling_sender::run, this);
+    }
+    catch (const std::exception& e) {
+      RETURN_ERROR_LS(_trace, status, background_thread_start) << "spilling sender: " << e.what();
+    }
+    return error_code::success;
+  }
+
+  float spilling_sender::window_occupancy() const {
+    return _destination->window_occupancy();
+  }
+
+  std::chrono::microseconds spilling_sender::completion_latency() const {
+    return _destination->completion_latency();
+  }
+
+  const std::string& spilling_sender::directory() const {
+    return _log.directory();
+  }
+
+  spill_stats spilling_sender::get_stats() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto now = std::chrono::steady_clock::now();
+    const auto elapsed = std::chrono::duration_cast<std::chrono::duration<float>>(now - _rate_update).count();
+    if (elapsed >= 1.f) {
+      _stats.spill_rate = (_stats.spill_rate + (_stats.spilled_bytes - _rate_spilled_bytes) / elapsed) / 2;
+      _stats.replay_rate = (_stats.replay_rate + (_stats.replayed_bytes - _rate_replayed_bytes) / elapsed) / 2;
+      _rate_spilled_bytes = _stats.spilled_bytes;
+      _rate_replayed_bytes = _stats.replayed_bytes;
+      _rate_update = now;
+    }
+    auto stats = _stats;
+    stats.backlog_bytes = _log.backlog_bytes();
+    return stats;
+  }
+
+  int spilling_sender::v_send(const buffer& data, api_status* status) {
+    if (_log.backlog_batches() == 0 && destination_has_room()) {
+      api_status send_status;
+      if (_destination->send(data, &send_status) == error_code::success) {
+        return error_code::success;
+      }
+      TRACE_WARN(_trace, "Spilling a batch the sender failed to send: " + std::string(send_status.get_error_msg()));
+    }
+    return spill(data, status);
+  }
+
+  int spilling_sender::spill(const buffer& data, api_status* status) {
+    const auto code = _log.append(data, status);
+    {
+      // Updated under the lock the replay thread waits with, so that the wakeup is not lost
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (code == error_code::success) {
+        ++_stats.spilled_batches;
+        _stats.spilled_bytes += data->buffer_filled_size();
+      }
+      else {
+        ++_stats.dropped_batches;
+      }
+    }
+    _cv.notify_one();
+    return code;
+  }
+
+  bool spilling_sender::destination_has_room() const {
+    return _destination->window_occupancy() < 1.f;
+  }
+
+  void spilling_sender::run() {
+    auto delay = _options.retry_base_delay;
+    bool reported = false;  // replay trouble is reported once per outage
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (!_stop) {
+      if (_log.backlog_batches() == 0) {
+        _cv.wait(lock, [this] { return _stop || _log.backlog_batches() > 0; });
+        continue;
+      }
+      if (!destination_has_room()) {
+        _cv.wait_for(lock, _options.poll_interval, [this] { return _stop; });
+        continue;
+      }
+      lock.unlock();
+
+      api_status status;
+      buffer batch;
+      auto code = _log.front(batch, &status);
+      size_t bytes = 0;
+      if (code == error_code::success && batch != nullptr) {
+        bytes = batch->buffer_filled_size();
+        code = _destination->send(batch, &status);
+        // Moving past a batch that was sent can still fail, it is then sent again
+        if (code == error_code::success) code = _log.pop(&status);
+      }
+      if (code != error_code::success && !reported) {
+        TRACE_WARN(_trace, "Replay from " + _log.directory() + " failed: " + status.get_error_msg());
+        ERROR_CALLBACK(_error_cb, status);
+        reported = true;
+      }
+
+      lock.lock();
+      if (code == error_code::success) {
+        if (bytes > 0) {
+          ++_stats.replayed_batches;
+          _stats.replayed_bytes += bytes;
+        }
+        delay = _options.retry_base_delay;
+        reported = false;
+        continue;
+      }
+      _cv.wait_for(lock, delay, [this] { return _stop; });
+      delay = (std::min)(delay * 2, _options.retry_max_delay);
+    }
+  }
+}}}
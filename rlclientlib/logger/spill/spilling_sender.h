@@ -0,0 +1,96 @@
+#pragma once
+#include "sender.h"
+#include "spill_log.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace reinforcement_learning {
+  class i_trace;
+  class error_callback_fn;
+}
+
+namespace reinforcement_learning { namespace logger { namespace spill {
+  struct spilling_sender_options {
+    spill_log_options log;
+    std::chrono::milliseconds poll_interval{ 10 };        // how often replay checks the destination for room
+    std::chrono::milliseconds retry_base_delay{ 100 };    // after a failed replay, doubled up to the maximum
+    std::chrono::milliseconds retry_max_delay{ 5000 };
+  };
+
+  struct spill_stats {
+    uint64_t spilled_batches = 0;   // batches written to disk instead of the destination
+    uint64_t spilled_bytes = 0;
+    uint64_t replayed_batches = 0;  // spilled batches sent to the destination since
+    uint64_t replayed_bytes = 0;
+    uint64_t dropped_batches = 0;   // batches lost because the spill log was full or could not be written
+    uint64_t backlog_bytes = 0;     // on disk, waiting for replay
+    float spill_rate = 0;           // bytes per second, smoothed over the last few reads of the stats
+    float replay_rate = 0;
+  };
+
+  // Sends batches to a destination sender, and spills them to a spill_log on disk when the destination cannot take
+  // them: its in-flight window is full or the send fails.  While anything is on disk later batches are spilled too,
+  // so that the destination gets them in order.  A replay thread sends the backlog one batch at a time whenever the
+  // destination has room, and backs off after a failure.  What is left at destruction is replayed by the next
+  // spilling_sender on the same directory, possibly in another process.
+  //
+  // Senders without an in-flight window only spill what they fail to send.  Batches an asynchronous destination
+  // accepts and gives up on after its retries come back through its undelivered handler and are spilled then, behind
+  // what was sent after them.
+  class spilling_sender : public i_sender {
+  public:
+    // Takes the ownership of the destination sender
+    spilling_sender(i_sender* destination, const std::string& directory, const spilling_sender_options& options,
+      error_callback_fn* error_cb, i_trace* trace);
+    // Stops the replay, the backlog stays on disk
+    ~spilling_sender();
+
+    // Initializes the destination, picks up the backlog of an earlier run and starts the replay
+    int init(api_status* status) override;
+    float window_occupancy() const override;
+    std::chrono::microseconds completion_latency() const override;
+
+    spill_stats get_stats();
+    // The spill log directory, set by init
+    const std::string& directory() const;
+
+    spilling_sender(const spilling_sender&) = delete;
+    spilling_sender& operator=(const spilling_sender&) = delete;
+
+  protected:
+    int v_send(const buffer& data, api_status* status) override;
+
+  private:
+    // Handed to the destination, which may outlive this sender
+    struct undelivered_sink {
+      std::mutex mutex;
+      spilling_sender* sender;
+    };
+
+    void run();
+    bool destination_has_room() const;
+    int spill(const buffer& data, api_status* status);
+
+    std::unique_ptr<i_sender> _destination;
+    const spilling_sender_options _options;
+    error_callback_fn* _error_cb;
+    i_trace* _trace;
+    spill_log _log;
+
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    bool _stop = false;
+    spill_stats _stats;
+    uint64_t _rate_spilled_bytes = 0;
+    uint64_t _rate_replayed_bytes = 0;
+    std::chrono::steady_clock::time_point _rate_update;
+    std::thread _thread;
+    std::shared_ptr<undelivered_sink> _sink;
+  };
+}}}
@@ -0,0 +1,276 @@
+#ifdef __linux__
+#include "stream_sender.h"
+#include "api_status.h"
+#include "err_constants.h"
+#include "error_callback_fn.h"
+#include "trace_logger.h"
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+
+namespace reinforcement_learning { namespace logger { namespace stream {
+  namespace {
+    // Batches per sendmsg call, the smallest IOV_MAX in use is 1024
+    const size_t MAX_IOV = 1024;
+
+    timeval to_timeval(std::chrono::milliseconds ms) {
+      timeval tv{};
+      tv.tv_sec = static_cast<time_t>(ms.count() / 1000);
+      tv.tv_usec = static_cast<suseconds_t>((ms.count() % 1000) * 1000);
+      return tv;
+    }
+  }
+
+  int parse_stream_address(const std::string& address, stream_address& result, i_trace* trace, api_status* status) {
+    const std::string unix_scheme = "unix:";
+    const std::string tcp_scheme = "tcp:";
+    if (address.compare(0, unix_scheme.size(), unix_scheme) == 0) {
+      result.is_unix = true;
+      result.path = address.substr(unix_scheme.size());
+      if (result.path.empty() || result.path.size() >= sizeof(sockaddr_un::sun_path)) {
+        RETURN_ERROR_LS(trace, status, invalid_argument) << "Bad unix socket path in stream address: " << address;
+      }
+      return error_code::success;
+    }
+    if (address.compare(0, tcp_scheme.size(), tcp_scheme) == 0) {
+      const auto host_port = address.substr(tcp_scheme.size());
+      const auto colon = host_port.rfind(':');
+      if (colon == std::string::npos || colon == 0 || colon + 1 == host_port.size()) {
+        RETURN_ERROR_LS(trace, status, invalid_argument) << "Stream address needs tcp:host:port, got: " << address;
+      }
+      result.is_unix = false;
+      result.host = host_port.substr(0, colon);
+      // [::1]:port
+      if (result.host.size() > 2 && result.host.front() == '[' && result.host.back() == ']') {
+        result.host = result.host.substr(1, result.host.size() - 2);
+      }
+      result.port = host_port.substr(colon + 1);
+      return error_code::success;
+    }
+    RETURN_ERROR_LS(trace, status, invalid_argument) << "Stream address must start with unix: or tcp:, got: " << address;
+  }
+
+  stream_sender::stream_sender(const std::string& address, const stream_sender_options& options,
+    error_callback_fn* error_cb, i_trace* trace)
+    : _address_text(address), _options(options), _error_cb(error_cb), _trace(trace)
+  {}
+
+  stream_sender::~stream_sender() {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _cv.notify_all();
+    if (_thread.joinable()) _thread.join();
+    disconnect();
+  }
+
+  int stream_sender::init(api_status* status) {
+    RETURN_IF_FAIL(parse_stream_address(_address_text, _address, _trace, status));
+    try {
+      // The peer does not have to be up yet, batches are buffered until it is
+      _thread = std::thread(&stream_sender::run, this);
+    }
+    catch (const std::exception& e) {
+      RETURN_ERROR_LS(_trace, status, background_thread_start) << "stream sender: " << e.what();
+    }
+    return error_code::success;
+  }
+
+  stream_sender_stats stream_sender::get_stats() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+  }
+
+  int stream_sender::v_send(const buffer& data, api_status* status) {
+    const auto size = data->buffer_filled_size();
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      // An empty buffer always takes one batch, however large
+      if (_buffered_bytes > 0 && _buffered_bytes + size > _options.max_buffered_bytes) {
+        ++_stats.dropped;
+        RETURN_ERROR_LS(_trace, status, stream_buffer_full) << _address_text << " buffered bytes: " << _buffered_bytes;
+      }
+      _queue.push_back(data);
+      _buffered_bytes += size;
+    }
+    _cv.notify_one();
+    return error_code::success;
+  }
+
+  void stream_sender::run() {
+    std::vector<buffer> batches;
+    size_t next = 0;  // batches before next have been written
+    auto delay = _options.reconnect_base_delay;
+    bool reported = false;  // connection trouble is reported once per outage
+
+    while (true) {
+      bool stopping;
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (next == batches.size()) {
+          batches.clear();
+          next = 0;
+          _cv.wait(lock, [this] { return _stop || !_queue.empty(); });
+        }
+        stopping = _stop;
+        // Everything queued while the previous write was running goes out in the next one
+        std::move(_queue.begin(), _queue.end(), std::back_inserter(batches));
+        _queue.clear();
+      }
+      if (batches.empty()) break;
+
+      if (_fd < 0 && !connect_socket()) {
+        if (!reported) {
+          api_status status;
+          api_status::try_update(&status, error_code::stream_connect_error,
+            (std::string(error_code::stream_connect_error_s) + _address_text + ": " + strerror(errno)).c_str());
+          TRACE_WARN(_trace, status.get_error_msg());
+          ERROR_CALLBACK(_error_cb, status);
+          reported = true;
+        }
+        if (stopping) break;
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cv.wait_for(lock, delay, [this] { return _stop; });
+        delay = (std::min)(delay * 2, _options.reconnect_max_delay);
+        continue;
+      }
+      delay = _options.reconnect_base_delay;
+      reported = false;
+
+      set_cork(true);
+      const auto written = write_batches(batches, next);
+      set_cork(false);
+
+      size_t bytes = 0;
+      for (auto i = next; i < next + written; ++i) bytes += batches[i]->buffer_filled_size();
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _buffered_bytes -= bytes;
+        _stats.batches += written;
+        _stats.bytes += bytes;
+      }
+      next += written;
+
+      if (next < batches.size()) {
+        // The receiver drops the torn batch with the connection, it is sent again in full after reconnecting
+        TRACE_WARN(_trace, "Stream connection to " + _address_text + " lost: " + strerror(errno));
+        disconnect();
+        if (stopping) break;
+      }
+    }
+  }
+
+  bool stream_sender::connect_socket() {
+    // SO_SNDTIMEO also bounds connect on Linux
+    const auto timeout = to_timeval(_options.write_timeout);
+    if (_address.is_unix) {
+      _fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+      if (_fd < 0) return false;
+      setsockopt(_fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+      sockaddr_un addr{};
+      addr.sun_family = AF_UNIX;
+      strncpy(addr.sun_path, _address.path.c_str(), sizeof(addr.sun_path) - 1);
+      if (connect(_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        disconnect();
+        return false;
+      }
+    }
+    else {
+      addrinfo hints{};
+      hints.ai_family = AF_UNSPEC;
+      hints.ai_socktype = SOCK_STREAM;
+      addrinfo* addresses = nullptr;
+      if (getaddrinfo(_address.host.c_str(), _address.port.c_str(), &hints, &addresses) != 0) {
+        errno = EHOSTUNREACH;
+        return false;
+      }
+      for (auto ai = addresses; ai != nullptr && _fd < 0; ai = ai->ai_next) {
+        _fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+        if (_fd < 0) continue;
+        setsockopt(_fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        if (connect(_fd, ai->ai_addr, ai->ai_addrlen) != 0) disconnect();
+      }
+      const auto error = errno;
+      freeaddrinfo(addresses);
+      if (_fd < 0) {
+        errno = error;
+        return false;
+      }
+      const int no_delay = _options.no_delay ? 1 : 0;
+      setsockopt(_fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+    }
+
+    TRACE_INFO(_trace, "Stream sender connected to " + _address_text);
+    std::lock_guard<std::mutex> lock(_mutex);
+    ++_stats.connects;
+    return true;
+  }
+
+  void stream_sender::disconnect() {
+    if (_fd < 0) return;
+    const auto error = errno;
+    ::close(_fd);
+    _fd = -1;
+    errno = error;
+  }
+
+  size_t stream_sender::write_batches(const std::vector<buffer>& batches, size_t next) {
+    const auto first = next;
+    size_t offset = 0;  // bytes of batches[next] already written
+    uint64_t writes = 0;
+    while (next < batches.size()) {
+      iovec iov[MAX_IOV];
+      size_t count = 0;
+      for (auto i = next; i < batches.size() && count < MAX_IOV; ++i) {
+        const auto skip = i == next ? offset : 0;
+        iov[count].iov_base = batches[i]->preamble_begin() + skip;
+        iov[count].iov_len = batches[i]->buffer_filled_size() - skip;
+        ++count;
+      }
+      msghdr msg{};
+      msg.msg_iov = iov;
+      msg.msg_iovlen = count;
+      const auto sent = sendmsg(_fd, &msg, MSG_NOSIGNAL);
+      if (sent < 0) {
+        if (errno == EINTR) continue;
+        break;
+      }
+      ++writes;
+
+      // Advance past what was written, a short write resumes inside a batch
+      auto left = static_cast<size_t>(sent);
+      while (next < batches.size()) {
+        const auto remaining = batches[next]->buffer_filled_size() - offset;
+        if (left < remaining) {
+          offset += left;
+          break;
+        }
+        left -= remaining;
+        offset = 0;
+        ++next;
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stats.writes += writes;
+    return next - first;
+  }
+
+  void stream_sender::set_cork(bool on) {
+    if (!_options.cork || _address.is_unix || _fd < 0) return;
+    const int value = on ? 1 : 0;
+    setsockopt(_fd, IPPROTO_TCP, TCP_CORK, &value, sizeof(value));
+  }
+}}}
+#endif
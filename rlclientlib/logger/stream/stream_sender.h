@@ -0,0 +1,93 @@
+#pragma once
+#ifdef __linux__
+#include "sender.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace reinforcement_learning {
+  class i_trace;
+  class error_callback_fn;
+}
+
+namespace reinforcement_learning { namespace logger { namespace stream {
+  // unix:/path/to/socket or tcp:host:port
+  struct stream_address {
+    bool is_unix = false;
+    std::string path;   // unix
+    std::string host;   // tcp
+    std::string port;   // tcp
+  };
+  int parse_stream_address(const std::string& address, stream_address& result, i_trace* trace, api_status* status);
+
+  struct stream_sender_options {
+    bool no_delay = true;                          // TCP_NODELAY
+    bool cork = false;                             // TCP_CORK around each group of batches, full segments only
+    size_t max_buffered_bytes = 16 * 1024 * 1024;  // queued while the peer is slow or away, beyond this sends fail
+    std::chrono::milliseconds reconnect_base_delay{ 100 };
+    std::chrono::milliseconds reconnect_max_delay{ 5000 };
+    std::chrono::milliseconds write_timeout{ 5000 };  // a peer that stops reading this long is reconnected
+  };
+
+  struct stream_sender_stats {
+    uint64_t batches = 0;      // batches written to the socket
+    uint64_t bytes = 0;
+    uint64_t writes = 0;       // sendmsg calls
+    uint64_t connects = 0;     // successful connections, the first one included
+    uint64_t dropped = 0;      // batches refused because the buffer was full
+  };
+
+  // Streams preamble framed batches over one persistent Unix domain or TCP connection.  The preamble already carries
+  // the body length, so the stream is simply the batches back to back, the same layout as a file sender's file.
+  // A writer thread sends everything queued since its last write with one vectored sendmsg, straight from the batch
+  // buffers.  When the connection drops it reconnects with exponential backoff and resends the batch that was cut
+  // off, batches sent in the meantime are buffered up to max_buffered_bytes.
+  class stream_sender : public i_sender {
+  public:
+    stream_sender(const std::string& address, const stream_sender_options& options, error_callback_fn* error_cb,
+      i_trace* trace);
+    // Gives the writer until write_timeout to send what is queued
+    ~stream_sender();
+
+    int init(api_status* status) override;
+
+    stream_sender_stats get_stats();
+
+    stream_sender(const stream_sender&) = delete;
+    stream_sender(stream_sender&&) = delete;
+    stream_sender& operator=(const stream_sender&) = delete;
+    stream_sender& operator=(stream_sender&&) = delete;
+
+  protected:
+    int v_send(const buffer& data, api_status* status) override;
+
+  private:
+    void run();
+    bool connect_socket();
+    void disconnect();
+    // Writes batches[next..] and returns how many were written completely before an error
+    size_t write_batches(const std::vector<buffer>& batches, size_t next);
+    void set_cork(bool on);
+
+    const std::string _address_text;
+    const stream_sender_options _options;
+    error_callback_fn* _error_cb;
+    i_trace* _trace;
+    stream_address _address;
+    int _fd = -1;  // writer thread only
+
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    std::vector<buffer> _queue;
+    size_t _buffered_bytes = 0;  // queued and in flight
+    bool _stop = false;
+    stream_sender_stats _stats;
+    std::thread _thread;
+  };
+}}}
+#endif
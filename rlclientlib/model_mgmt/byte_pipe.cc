@@ -0,0 +1,95 @@
+#include "byte_pipe.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace reinforcement_learning { namespace model_management {
+  byte_pipe::byte_pipe(size_t capacity)
+    : _capacity(capacity)
+  {}
+
+  bool byte_pipe::write(const char* data, size_t len) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _writable.wait(lock, [this, len] { return _cancelled || _buffered == 0 || _buffered + len <= _capacity; });
+    if (_cancelled) return false;
+    if (_closed || _failed || len == 0) return true;
+
+    _chunks.emplace_back(data, data + len);
+    _buffered += len;
+    lock.unlock();
+    _readable.notify_one();
+    return true;
+  }
+
+  void byte_pipe::close() {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (_failed) return;
+      _closed = true;
+    }
+    _readable.notify_all();
+  }
+
+  void byte_pipe::fail(const std::string& error) {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (_closed || _failed) return;
+      _failed = true;
+      _error = error;
+    }
+    _readable.notify_all();
+  }
+
+  int64_t byte_pipe::read(char* buffer, size_t len) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _readable.wait(lock, [this] { return _buffered > 0 || _closed || _failed || _cancelled; });
+    if (_buffered == 0) {
+      return _failed ? -1 : 0;
+    }
+
+    size_t copied = 0;
+    while (copied < len && !_chunks.empty()) {
+      auto& front = _chunks.front();
+      const auto n = (std::min)(len - copied, front.size() - _front_offset);
+      std::memcpy(buffer + copied, front.data() + _front_offset, n);
+      copied += n;
+      _front_offset += n;
+      if (_front_offset == front.size()) {
+        _chunks.pop_front();
+        _front_offset = 0;
+      }
+    }
+    _buffered -= copied;
+    _bytes_read += copied;
+    lock.unlock();
+    _writable.notify_one();
+    return static_cast<int64_t>(copied);
+  }
+
+  void byte_pipe::cancel() {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _cancelled = true;
+      _chunks.clear();
+      _front_offset = 0;
+      _buffered = 0;
+    }
+    _writable.notify_all();
+    _readable.notify_all();
+  }
+
+  void byte_pipe::wait_closed() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _readable.wait(lock, [this] { return _closed || _failed; });
+  }
+
+  std::string byte_pipe::error() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _error;
+  }
+
+  uint64_t byte_pipe::bytes_read() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _bytes_read;
+  }
+}}
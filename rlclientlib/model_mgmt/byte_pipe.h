@@ -0,0 +1,54 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace reinforcement_learning { namespace model_management {
+  // Single producer / single consumer byte stream used to hand a model from a transport to a model loader while it
+  // is still downloading.  At most capacity bytes are buffered; a larger write is accepted once the buffer is empty.
+  class byte_pipe {
+  public:
+    explicit byte_pipe(size_t capacity);
+
+    byte_pipe(const byte_pipe&) = delete;
+    byte_pipe& operator=(const byte_pipe&) = delete;
+    byte_pipe(byte_pipe&&) = delete;
+    byte_pipe& operator=(byte_pipe&&) = delete;
+
+    // Producer side.  write blocks while the buffer is full and returns false once the reader has cancelled.
+    // The producer always finishes with close() or fail(), also after a cancelled write.
+    bool write(const char* data, size_t len);
+    // No more data.  The reader sees the end of the stream after draining the buffer.
+    void close();
+    // Abort the stream.  The reader gets an error as soon as it has drained the buffer.
+    void fail(const std::string& error);
+
+    // Consumer side.  Blocks until data is available.  Returns the number of bytes read, 0 at the end of the stream
+    // and -1 if the producer failed.
+    int64_t read(char* buffer, size_t len);
+    // Reader is no longer interested.  Buffered data is dropped and blocked or future writes return false.
+    void cancel();
+    // Blocks until the producer closed or failed the stream.
+    void wait_closed();
+
+    std::string error() const;
+    uint64_t bytes_read() const;
+
+  private:
+    const size_t _capacity;
+    mutable std::mutex _mutex;
+    std::condition_variable _readable;
+    std::condition_variable _writable;
+    std::deque<std::vector<char>> _chunks;
+    size_t _front_offset = 0;
+    size_t _buffered = 0;
+    uint64_t _bytes_read = 0;
+    bool _closed = false;
+    bool _failed = false;
+    bool _cancelled = false;
+    std::string _error;
+  };
+}}
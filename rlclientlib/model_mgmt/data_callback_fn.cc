@@ -23,7 +23,28 @@ namespace reinforcement_learning { namespace model_management {
     }
   }
 
-  data_callback_fn::data_callback_fn(data_fn fn, void* ctxt)
-    : _fn{fn}, _context{ctxt}
+  int data_callback_fn::report_stream(byte_pipe& pipe, i_trace* trace, api_status* status) {
+    if(_stream_fn == nullptr) {
+      RETURN_ERROR_LS(trace, status, data_callback_not_set);
+    }
+
+    try {
+      _stream_fn(pipe, _context);
+      return error_code::success;
+    }
+    catch ( const std::exception& ex ) {
+      RETURN_ERROR_LS(trace, status, data_callback_exception) << ex.what();
+    }
+    catch ( ... ) {
+      RETURN_ERROR_LS(trace, status, data_callback_exception) << "Unknown exception";
+    }
+  }
+
+  bool data_callback_fn::accepts_stream() const {
+    return _stream_fn != nullptr;
+  }
+
+  data_callback_fn::data_callback_fn(data_fn fn, stream_fn sfn, void* ctxt)
+    : _fn{fn}, _stream_fn{sfn}, _context{ctxt}
   {}
 }}
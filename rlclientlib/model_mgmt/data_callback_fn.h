@@ -7,14 +7,22 @@ namespace reinforcement_learning {
   class data_callback_fn {
   public:
     using data_fn = void(*)(const model_data& data, void*);
+    using stream_fn = void(*)(byte_pipe& pipe, void*);
     int report_data(const model_data& data, i_trace* trace, api_status* status = nullptr);
+    int report_stream(byte_pipe& pipe, i_trace* trace, api_status* status = nullptr);
+    // True when a stream handler is registered, so model data can be handed over while it downloads
+    bool accepts_stream() const;
 
     // Typed constructor
     template<typename DataCntxt>
     using data_fn_t = void(*)(const model_data&, DataCntxt*);
+    template<typename DataCntxt>
+    using stream_fn_t = void(*)(byte_pipe&, DataCntxt*);
 
     template<typename DataCntxt>
     explicit data_callback_fn(data_fn_t<DataCntxt>, DataCntxt*);
+    template<typename DataCntxt>
+    data_callback_fn(data_fn_t<DataCntxt>, stream_fn_t<DataCntxt>, DataCntxt*);
 
     ~data_callback_fn() = default;
 
@@ -24,12 +32,17 @@ namespace reinforcement_learning {
     data_callback_fn& operator=(data_callback_fn&&) = delete;
 
   private:
-    data_callback_fn(data_fn, void*);
+    data_callback_fn(data_fn, stream_fn, void*);
     data_fn _fn;
+    stream_fn _stream_fn;
     void* _context;
   };
 
   template <typename DataCntxt>
   data_callback_fn::data_callback_fn(data_fn_t<DataCntxt> fn, DataCntxt* ctxt)
-  : data_callback_fn((data_fn) fn, (void*) ctxt){ }
+  : data_callback_fn((data_fn) fn, nullptr, (void*) ctxt){ }
+
+  template <typename DataCntxt>
+  data_callback_fn::data_callback_fn(data_fn_t<DataCntxt> fn, stream_fn_t<DataCntxt> sfn, DataCntxt* ctxt)
+  : data_callback_fn((data_fn) fn, (stream_fn) sfn, (void*) ctxt){ }
 }}
@@ -1,9 +1,10 @@
 #include "model_downloader.h"
+#include "byte_pipe.h"
 #include "api_status.h"
 
 namespace reinforcement_learning { namespace model_management {
-  model_downloader::model_downloader(i_data_transport* ptrans, data_callback_fn* pdata_cb, i_trace* trace)
-    : _ptrans(ptrans), _pdata_cb(pdata_cb), _trace(trace) {}
+  model_downloader::model_downloader(i_data_transport* ptrans, data_callback_fn* pdata_cb, i_trace* trace, size_t stream_buffer_size)
+    : _ptrans(ptrans), _pdata_cb(pdata_cb), _trace(trace), _stream_buffer_size(stream_buffer_size) {}
 
   model_downloader::model_downloader(model_downloader&& temp) noexcept {
     _ptrans = temp._ptrans;
@@ -12,6 +13,7 @@ namespace reinforcement_learning { namespace model_management {
     temp._pdata_cb = nullptr;
     _trace = temp._trace;
     temp._trace = nullptr;
+    _stream_buffer_size = temp._stream_buffer_size;
   }
 
   model_downloader& model_downloader::operator=(model_downloader&& temp) noexcept {
@@ -22,11 +24,25 @@ namespace reinforcement_learning { namespace model_management {
       temp._pdata_cb = nullptr;
       _trace = temp._trace;
       temp._trace = nullptr;
+      _stream_buffer_size = temp._stream_buffer_size;
     }
     return *this;
   }
 
   int model_downloader::run_iteration(api_status* status) const {
+    if (_pdata_cb->accepts_stream()) {
+      const auto pipe = std::make_shared<byte_pipe>(_stream_buffer_size);
+      bool updated = false;
+      RETURN_IF_FAIL(_ptrans->get_data_streamed(pipe, updated, status));
+      if (!updated) return error_code::success;
+
+      const auto scode = _pdata_cb->report_stream(*pipe, _trace, status);
+      // Release the transport if the model stopped reading early, and make sure it is done with the pipe.
+      pipe->cancel();
+      pipe->wait_closed();
+      return scode;
+    }
+
     model_data md;
     RETURN_IF_FAIL(_ptrans->get_data(md, status));
 
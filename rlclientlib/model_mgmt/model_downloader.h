@@ -8,7 +8,9 @@ namespace reinforcement_learning {
 namespace reinforcement_learning { namespace model_management {
   class model_downloader {
   public:
-    model_downloader(i_data_transport* ptrans, data_callback_fn* pdata_cb, i_trace* trace);
+    // When pdata_cb accepts streams, models are handed over through a byte_pipe buffering up to stream_buffer_size
+    // bytes while the download is still running.
+    model_downloader(i_data_transport* ptrans, data_callback_fn* pdata_cb, i_trace* trace, size_t stream_buffer_size = 4 * 1024 * 1024);
     model_downloader(model_downloader&& temp) noexcept;
     model_downloader& operator=(model_downloader&& temp) noexcept;
 
@@ -18,5 +20,6 @@ namespace reinforcement_learning { namespace model_management {
     i_data_transport* _ptrans = nullptr;
     data_callback_fn* _pdata_cb = nullptr;
     i_trace* _trace;
+    size_t _stream_buffer_size;
   };
 }}
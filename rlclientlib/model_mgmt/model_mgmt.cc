@@ -1,4 +1,7 @@
 #include "model_mgmt.h"
+#include "byte_pipe.h"
+#include "api_status.h"
+#include "err_constants.h"
 
 #include <new>
 #include <cstring>
@@ -63,4 +66,46 @@ namespace reinforcement_learning {
 
       return *this;
     }
+
+    int i_data_transport::get_data_streamed(const std::shared_ptr<byte_pipe>& pipe, bool& updated, api_status* status) {
+      model_data data;
+      const auto scode = get_data(data, status);
+      updated = scode == error_code::success && data.data_sz() > 0;
+      if (updated) {
+        pipe->write(data.data(), data.data_sz());
+      }
+      pipe->close();
+      return scode;
+    }
+
+    int i_model::update_streamed(byte_pipe& pipe, bool& model_ready, api_status* status) {
+      std::vector<char> buffer;
+      char chunk[64 * 1024];
+      int64_t n;
+      while ((n = pipe.read(chunk, sizeof(chunk))) > 0) {
+        buffer.insert(buffer.end(), chunk, chunk + n);
+      }
+      if (n < 0) {
+        RETURN_ERROR_LS(nullptr, status, model_update_error) << pipe.error();
+      }
+
+      model_data data;
+      if (!buffer.empty()) {
+        std::memcpy(data.alloc(buffer.size()), buffer.data(), buffer.size());
+      }
+      data.increment_refresh_count();
+      return update(data, model_ready, status);
+    }
+
+    int i_model::pin_version(const char* version, api_status* status) {
+      return error_code::not_supported;
+    }
+
+    int i_model::unpin_version(api_status* status) {
+      return error_code::not_supported;
+    }
+
+    int i_model::get_versions(std::vector<std::string>& versions, std::string& active_version, api_status* status) {
+      return error_code::not_supported;
+    }
 }}
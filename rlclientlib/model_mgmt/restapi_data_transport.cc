@@ -1,10 +1,16 @@
 #include "restapi_data_transport.h"
+#include "byte_pipe.h"
 #include <cpprest/http_client.h>
 #include <cpprest/asyncrt_utils.h>
 #include <cpprest/rawptrstream.h>
 #include "api_status.h"
 #include "factory_resolver.h"
 #include "trace_logger.h"
+#include "str_util.h"
+
+#include <algorithm>
+#include <future>
+#include <thread>
 
 using namespace web; // Common features like URIs.
 using namespace web::http; // Common HTTP functionality
@@ -14,10 +20,53 @@ namespace u = reinforcement_learning::utility;
 
 namespace reinforcement_learning { namespace model_management {
 
-  restapi_data_transport::restapi_data_transport(i_http_client* httpcli, i_trace* trace)
-    : _httpcli(httpcli), _datasz{ 0 }, _trace{ trace }
+  namespace {
+    // Server side failures and dropped connections may go away on their own, other errors will not.
+    bool is_transient(int scode, status_code code) {
+      return scode == error_code::exception_during_http_req ||
+        (scode == error_code::http_bad_status_code && (code >= 500 || code == 429 /* Too Many Requests */ || code == status_codes::RequestTimeout));
+    }
+  }
+
+  // A streamed download, shared by the continuations that forward its body
+  struct restapi_data_transport::body_stream {
+    http_response response;
+    Concurrency::streams::streambuf<uint8_t> body;
+    std::shared_ptr<byte_pipe> pipe;
+    std::vector<uint8_t> chunk = std::vector<uint8_t>(64 * 1024);
+    size_t read = 0;
+    uint64_t total = 0;
+    bool cancelled = false;
+  };
+
+  restapi_data_transport::restapi_data_transport(i_http_client* httpcli, i_trace* trace, size_t max_ranges, size_t max_range_retries, uint64_t min_range_size,
+    size_t max_retries, std::shared_ptr<utility::retry_policy> retry_policy, std::shared_ptr<utility::retry_scheduler> retry_scheduler)
+    : _httpcli(httpcli), _datasz{ 0 }, _max_ranges{ max_ranges }, _max_range_retries{ max_range_retries }, _min_range_size{ (std::max)(min_range_size, uint64_t(1)) },
+    _max_retries{ max_retries },
+    _retry_policy{ retry_policy ? std::move(retry_policy) : utility::retry_policy::immediate() },
+    _retry_scheduler{ retry_scheduler ? std::move(retry_scheduler) : utility::retry_scheduler::shared() },
+    _trace{ trace }
   {}
 
+  bool restapi_data_transport::wait_for_retry(std::chrono::milliseconds& delay) {
+    std::chrono::milliseconds next;
+    if ( !_retry_policy->next_retry(delay, next) ) {
+      TRACE_WARN(_trace, "Model download retry budget is exhausted.");
+      return false;
+    }
+    delay = next;
+
+    std::promise<void> due;
+    auto due_future = due.get_future();
+    _retry_scheduler->schedule(next, [&due]() { due.set_value(); });
+    due_future.wait();
+    return true;
+  }
+
+  utility::retry_stats restapi_data_transport::get_retry_stats() const {
+    return _retry_policy->get_stats();
+  }
+
   /*
    * Example successful response
    *
@@ -38,12 +87,24 @@ namespace reinforcement_learning { namespace model_management {
    * x-ms-version = 2017-04-17
    */
 
-  int restapi_data_transport::get_data_info(::utility::datetime& last_modified, ::utility::size64_t& sz, api_status* status) {
+  int restapi_data_transport::get_data_info(::utility::datetime& last_modified, ::utility::size64_t& sz, bool& accepts_ranges, api_status* status) {
+    std::chrono::milliseconds delay{ 0 };
+    for ( size_t attempt = 0; ; ++attempt ) {
+      status_code code = 0;
+      const auto scode = request_data_info(last_modified, sz, accepts_ranges, code, status);
+      if ( scode == error_code::success || attempt >= _max_retries || !is_transient(scode, code) || !wait_for_retry(delay) )
+        return scode;
+      TRACE_WARN(_trace, u::concat("Model HEAD request failed, retry ", attempt + 1, " of ", _max_retries));
+    }
+  }
+
+  int restapi_data_transport::request_data_info(::utility::datetime& last_modified, ::utility::size64_t& sz, bool& accepts_ranges, status_code& code, api_status* status) {
 
     // Build request URI and start the request.
     auto request_task = _httpcli->request(methods::HEAD)
       // Handle response headers arriving.
       .then([&](http_response response) {
+      code = response.status_code();
       if ( response.status_code() != 200 )
         RETURN_ERROR_ARG(_trace, status, http_bad_status_code, _httpcli->get_url());
 
@@ -57,6 +118,9 @@ namespace reinforcement_learning { namespace model_management {
 
       sz = response.headers().content_length();
 
+      const auto ranges_iter = response.headers().find(U("Accept-Ranges"));
+      accepts_ranges = ranges_iter != response.headers().end() && ranges_iter->second == U("bytes");
+
       return error_code::success;
     });
 
@@ -73,16 +137,38 @@ namespace reinforcement_learning { namespace model_management {
 
     ::utility::datetime curr_last_modified;
     ::utility::size64_t curr_datasz;
-    RETURN_IF_FAIL(get_data_info(curr_last_modified, curr_datasz, status));
+    bool accepts_ranges = false;
+    RETURN_IF_FAIL(get_data_info(curr_last_modified, curr_datasz, accepts_ranges, status));
 
     if ( curr_last_modified == _last_modified && curr_datasz == _datasz )
       return error_code::success;
 
+    if ( use_ranges(accepts_ranges, curr_datasz) ) {
+      RETURN_IF_FAIL(get_data_ranges(ret, curr_last_modified, curr_datasz, status));
+      if ( !_ranges_ignored )
+        return error_code::success;
+    }
+
+    std::chrono::milliseconds delay{ 0 };
+    for ( size_t attempt = 0; ; ++attempt ) {
+      status_code code = 0;
+      const auto scode = request_data(ret, code, status);
+      if ( scode == error_code::success || attempt >= _max_retries || !is_transient(scode, code) || !wait_for_retry(delay) )
+        return scode;
+      TRACE_WARN(_trace, u::concat("Model GET request failed, retry ", attempt + 1, " of ", _max_retries));
+    }
+  }
+
+  int restapi_data_transport::request_data(model_data& ret, status_code& code, api_status* status) {
+    ::utility::datetime curr_last_modified;
+    ::utility::size64_t curr_datasz;
+
     // Build request URI and start the request.
     auto request_task = _httpcli->request(methods::GET)
       // Handle response headers arriving.
       .then([&](pplx::task<http_response> resp_task) {
       auto response = resp_task.get();
+      code = response.status_code();
       if ( response.status_code() != 200 )
         RETURN_ERROR_ARG(_trace, status, http_bad_status_code, "Found: ", response.status_code(), _httpcli->get_url());
 
@@ -131,9 +217,208 @@ namespace reinforcement_learning { namespace model_management {
     return request_task.get();
   }
 
+  int restapi_data_transport::get_data_streamed(const std::shared_ptr<byte_pipe>& pipe, bool& updated, api_status* status) {
+    updated = false;
+
+    ::utility::datetime curr_last_modified;
+    ::utility::size64_t curr_datasz;
+    bool accepts_ranges = false;
+    RETURN_IF_FAIL(get_data_info(curr_last_modified, curr_datasz, accepts_ranges, status));
+
+    if ( curr_last_modified == _last_modified && curr_datasz == _datasz ) {
+      pipe->close();
+      return error_code::success;
+    }
+
+    if ( use_ranges(accepts_ranges, curr_datasz) )
+      return i_data_transport::get_data_streamed(pipe, updated, status);
+
+    // Until the first chunk is in hand nothing reached the pipe, so failures up to there are retried like get_data
+    auto stream = std::make_shared<body_stream>();
+    stream->pipe = pipe;
+    ::utility::datetime last_modified;
+    std::chrono::milliseconds delay{ 0 };
+    for ( size_t attempt = 0; ; ++attempt ) {
+      status_code code = 0;
+      const auto scode = request_stream(*stream, last_modified, code, status);
+      if ( scode == error_code::success )
+        break;
+      if ( attempt >= _max_retries || !is_transient(scode, code) || !wait_for_retry(delay) ) {
+        pipe->close();
+        return scode;
+      }
+      TRACE_WARN(_trace, u::concat("Model GET request failed, retry ", attempt + 1, " of ", _max_retries));
+    }
+
+    // The rest of the body is forwarded by pplx continuations while the caller reads the other end of the pipe, no
+    // pool thread waits for the network.  They touch this object only before they close the pipe, which the caller
+    // waits for.
+    forward_body(stream)
+      .then([this, stream, last_modified](pplx::task<void> task) {
+      try {
+        task.get();
+      }
+      catch ( const std::exception& e ) {
+        stream->pipe->fail(u::concat(error_code::exception_during_http_req_s, e.what()));
+        return;
+      }
+      if ( stream->cancelled ) {
+        stream->pipe->fail("Model stream cancelled by reader");
+        return;
+      }
+      _datasz = stream->total;
+      _last_modified = last_modified;
+      stream->pipe->close();
+    });
+
+    updated = true;
+    return error_code::success;
+  }
+
+  int restapi_data_transport::request_stream(body_stream& stream, ::utility::datetime& last_modified, status_code& code, api_status* status) {
+    try {
+      stream.response = _httpcli->request(methods::GET).get();
+      code = stream.response.status_code();
+      if ( code != 200 )
+        RETURN_ERROR_ARG(_trace, status, http_bad_status_code, "Found: ", code, _httpcli->get_url());
+
+      const auto iter = stream.response.headers().find(U("Last-Modified"));
+      if ( iter == stream.response.headers().end() )
+        RETURN_ERROR_ARG(_trace, status, last_modified_not_found, _httpcli->get_url());
+      last_modified = ::utility::datetime::from_string(iter->second);
+
+      stream.body = stream.response.body().streambuf();
+      stream.read = stream.body.getn(stream.chunk.data(), stream.chunk.size()).get();
+    }
+    catch ( const std::exception& e ) {
+      RETURN_ERROR_LS(_trace, status, exception_during_http_req) << e.what() << "\n URL: " << _httpcli->get_url();
+    }
+    return error_code::success;
+  }
+
+  pplx::task<void> restapi_data_transport::forward_body(std::shared_ptr<body_stream> stream) {
+    if ( stream->read == 0 )
+      return pplx::task_from_result();
+    if ( !stream->pipe->write(reinterpret_cast<const char*>(stream->chunk.data()), stream->read) ) {
+      stream->cancelled = true;
+      return pplx::task_from_result();
+    }
+    stream->total += stream->read;
+
+    return stream->body.getn(stream->chunk.data(), stream->chunk.size())
+      .then([stream](size_t read) {
+      stream->read = read;
+      return forward_body(stream);
+    });
+  }
+
+  bool restapi_data_transport::use_ranges(bool accepts_ranges, uint64_t datasz) const {
+    return _max_ranges > 1 && accepts_ranges && !_ranges_ignored && datasz >= 2 * _min_range_size;
+  }
+
+  int restapi_data_transport::get_data_ranges(model_data& ret, const ::utility::datetime& last_modified, uint64_t datasz, api_status* status) {
+    const auto range_count = static_cast<size_t>((std::min)(static_cast<uint64_t>(_max_ranges), datasz / _min_range_size));
+    const uint64_t range_size = (datasz + range_count - 1) / range_count;
+
+    // Every range is written in place into the final buffer
+    const auto buff = ret.alloc(datasz);
+    if ( buff == nullptr ) {
+      RETURN_ERROR_LS(_trace, status, model_range_download_error) << "Unable to allocate " << datasz << " bytes";
+    }
+
+    std::vector<int> results(range_count, error_code::success);
+    std::vector<api_status> range_status(range_count);
+    std::atomic<bool> ranges_ignored{ false };
+    std::vector<std::thread> workers;
+    try {
+      for ( size_t i = 0; i < range_count; ++i ) {
+        const uint64_t begin = i * range_size;
+        const uint64_t end = (std::min)(begin + range_size, datasz) - 1;
+        workers.emplace_back([&, i, begin, end]() {
+          results[i] = get_range(buff, begin, end, last_modified, ranges_ignored, &range_status[i]);
+        });
+      }
+    }
+    catch ( const std::exception& e ) {
+      for ( auto& w : workers ) w.join();
+      ret.free();
+      RETURN_ERROR_LS(_trace, status, background_thread_start) << "(model range download) " << e.what();
+    }
+
+    for ( auto& w : workers ) w.join();
+
+    if ( ranges_ignored ) {
+      ret.free();
+      _ranges_ignored = true;
+      TRACE_INFO(_trace, u::concat("Server ignored the Range header, downloading the model in one request. URL: ", _httpcli->get_url()));
+      return error_code::success;
+    }
+
+    for ( size_t i = 0; i < range_count; ++i ) {
+      if ( results[i] != error_code::success ) {
+        ret.free();
+        api_status::try_update(status, results[i], range_status[i].get_error_msg());
+        return results[i];
+      }
+    }
+
+    ret.increment_refresh_count();
+    _datasz = datasz;
+    _last_modified = last_modified;
+    return error_code::success;
+  }
+
+  int restapi_data_transport::get_range(char* buff, uint64_t begin, uint64_t end, const ::utility::datetime& last_modified,
+    std::atomic<bool>& ranges_ignored, api_status* status) {
+    const uint64_t expected = end - begin + 1;
+    const auto range = ::utility::conversions::to_string_t(u::concat("bytes=", begin, "-", end));
+    std::chrono::milliseconds delay{ 0 };
+
+    for ( size_t attempt = 0; ; ++attempt ) {
+      std::string error;
+      try {
+        http_request request(methods::GET);
+        request.headers().add(U("Range"), range);
+        auto response = _httpcli->request(request).get();
+
+        // The whole blob instead of the range, retrying will not change that
+        if ( response.status_code() == status_codes::OK ) {
+          ranges_ignored = true;
+          return error_code::model_range_download_error;
+        }
+        if ( response.status_code() != status_codes::PartialContent ) {
+          error = u::concat("Range ", begin, "-", end, " returned status code ", response.status_code());
+        }
+        else {
+          // All ranges must come from the blob version announced by the HEAD request
+          const auto iter = response.headers().find(U("Last-Modified"));
+          if ( iter == response.headers().end() || ::utility::datetime::from_string(iter->second) != last_modified ) {
+            RETURN_ERROR_LS(_trace, status, model_changed_during_download) << " Range " << begin << "-" << end << " URL: " << _httpcli->get_url();
+          }
+
+          const Concurrency::streams::rawptr_buffer<char> rb(buff + begin, static_cast<size_t>(expected), std::ios::out);
+          const auto readval = response.body().read_to_end(rb).get();
+          if ( readval == expected ) {
+            return error_code::success;
+          }
+          error = u::concat("Range ", begin, "-", end, " returned ", readval, " of ", expected, " bytes");
+        }
+      }
+      catch ( const std::exception& e ) {
+        error = u::concat("Range ", begin, "-", end, " failed: ", e.what());
+      }
+
+      if ( attempt >= _max_range_retries || !wait_for_retry(delay) ) {
+        RETURN_ERROR_LS(_trace, status, model_range_download_error) << error << " URL: " << _httpcli->get_url();
+      }
+      TRACE_WARN(_trace, u::concat(error, ". Retrying."));
+    }
+  }
+
   int restapi_data_transport::check(api_status* status) {
     ::utility::datetime last_modified;
     ::utility::size64_t datasz;
-    return get_data_info(last_modified, datasz, status);
+    bool accepts_ranges;
+    return get_data_info(last_modified, datasz, accepts_ranges, status);
   }
 }}
@@ -1,8 +1,11 @@
 #pragma once
 #include "model_mgmt.h"
 #include "utility/http_client.h"
+#include "utility/retry_scheduler.h"
 
+#include <atomic>
 #include <chrono>
+#include <memory>
 #include <string>
 
 namespace reinforcement_learning {
@@ -11,16 +14,46 @@ namespace reinforcement_learning {
   class restapi_data_transport : public i_data_transport {
   public:
     // Takes the ownership of the i_http_client and delete it at the end of lifetime
-    restapi_data_transport(i_http_client* httpcli, i_trace* trace);
+    // When max_ranges > 1 and the server accepts byte ranges, models of at least 2 * min_range_size bytes are
+    // fetched with up to max_ranges concurrent Range requests.  Each range is retried up to max_range_retries times.
+    // A server that answers a Range request with the whole blob gets single GET requests from then on.
+    // HEAD and GET requests failing with a server error are retried up to max_retries times.  Retries back off as
+    // dictated by retry_policy (immediate when not set) and wait on retry_scheduler (the shared one when not set).
+    restapi_data_transport(i_http_client* httpcli, i_trace* trace, size_t max_ranges = 1, size_t max_range_retries = 3, uint64_t min_range_size = 1024 * 1024,
+      size_t max_retries = 0, std::shared_ptr<utility::retry_policy> retry_policy = nullptr, std::shared_ptr<utility::retry_scheduler> retry_scheduler = nullptr);
 
-    int get_data(model_data& data, api_status* status) override;
+    int get_data(model_data& data, api_status* status = nullptr) override;
+    // Streams from a single GET, retried like get_data until the first bytes arrive.  Ranged downloads fill the whole
+    // buffer first.
+    int get_data_streamed(const std::shared_ptr<byte_pipe>& pipe, bool& updated, api_status* status = nullptr) override;
     int check(api_status* status);
+    utility::retry_stats get_retry_stats() const;
   private:
     using time_t = std::chrono::time_point<std::chrono::system_clock>;
-    int get_data_info(::utility::datetime& last_modified, ::utility::size64_t& sz, api_status* status);
+    struct body_stream;
+    int get_data_info(::utility::datetime& last_modified, ::utility::size64_t& sz, bool& accepts_ranges, api_status* status);
+    int request_data_info(::utility::datetime& last_modified, ::utility::size64_t& sz, bool& accepts_ranges, web::http::status_code& code, api_status* status);
+    int request_data(model_data& ret, web::http::status_code& code, api_status* status);
+    // Sends the GET of a streamed download and reads the first chunk of its body
+    int request_stream(body_stream& stream, ::utility::datetime& last_modified, web::http::status_code& code, api_status* status);
+    // Forwards the rest of the body into the pipe, each read continuing the previous one
+    static pplx::task<void> forward_body(std::shared_ptr<body_stream> stream);
+    // Waits out the backoff of the next retry, delay carries the previous backoff.  False if the policy refused it.
+    bool wait_for_retry(std::chrono::milliseconds& delay);
+    // Leaves ret empty and sets _ranges_ignored when the server ignored the Range header
+    int get_data_ranges(model_data& ret, const ::utility::datetime& last_modified, uint64_t datasz, api_status* status);
+    int get_range(char* buff, uint64_t begin, uint64_t end, const ::utility::datetime& last_modified, std::atomic<bool>& ranges_ignored, api_status* status);
+    bool use_ranges(bool accepts_ranges, uint64_t datasz) const;
     std::unique_ptr<i_http_client> _httpcli;
     ::utility::datetime _last_modified;
     uint64_t _datasz;
+    bool _ranges_ignored = false;
+    const size_t _max_ranges;
+    const size_t _max_range_retries;
+    const uint64_t _min_range_size;
+    const size_t _max_retries;
+    const std::shared_ptr<utility::retry_policy> _retry_policy;
+    const std::shared_ptr<utility::retry_scheduler> _retry_scheduler;
     i_trace* _trace;
   };
 }}
@@ -9,17 +9,19 @@ namespace reinforcement_learning {
   event::event(const char* seed_id, const timestamp& ts, float pass_prob)
     : _seed_id(seed_id), _pass_prob(pass_prob), _client_time_gmt(ts) {}
 
-  bool event::try_drop(float pass_prob, int drop_pass) {
+  bool event::try_drop(float pass_prob) {
     _pass_prob *= pass_prob;
-    return prg(drop_pass) > pass_prob;
+    return pass_prob <= 0.f || prg() > pass_prob;
   }
 
   float event::get_pass_prob() const { return _pass_prob; }
   timestamp event::get_client_time_gmt() const { return _client_time_gmt; }
 
-  float event::prg(int drop_pass) const {
-    const auto seed_str = _seed_id + std::to_string(drop_pass);
-    const auto seed = uniform_hash(seed_str.c_str(), seed_str.length(), 0);
+  // A hash seed of its own keeps the drop draw independent of the exploration draw, which hashes the same id
+  const uint64_t drop_hash_seed = 0x6a09e667;
+
+  float event::prg() const {
+    const auto seed = uniform_hash(_seed_id.c_str(), _seed_id.length(), drop_hash_seed);
     return exploration::uniform_random_merand48(seed);
   }
 
@@ -21,13 +21,14 @@ namespace reinforcement_learning {
     virtual ~event() = default;
     float get_pass_prob() const;
     timestamp get_client_time_gmt() const; ;
-    virtual bool try_drop(float pass_prob, int drop_pass);
+    // Scales the pass probability by pass_prob and decides whether the event is dropped
+    virtual bool try_drop(float pass_prob);
     const std::string& get_seed_id() const {
       return _seed_id;
     }
 
   protected:
-    float prg(int drop_pass) const;
+    float prg() const;
 
   protected:
     std::string _seed_id;
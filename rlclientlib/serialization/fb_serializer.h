@@ -205,6 +205,27 @@ namespace reinforcement_learning { namespace logger {
     }
   };
 
+  // A FlatBufferBuilder that can drop everything serialized after a mark
+  class rewindable_builder : public flatbuffers::FlatBufferBuilder {
+  public:
+    using flatbuffers::FlatBufferBuilder::FlatBufferBuilder;
+
+    struct mark_t {
+      size_t size;
+      size_t scratch_size;
+    };
+
+    mark_t mark() const {
+      return { GetSize(), buf_.scratch_size() };
+    }
+
+    // Also forgets the vtables written since the mark, later tables must not share them
+    void rewind(const mark_t& mark) {
+      buf_.pop(GetSize() - mark.size);
+      buf_.scratch_pop(buf_.scratch_size() - mark.scratch_size);
+    }
+  };
+
   template <typename event_t>
   struct fb_collection_serializer {
     using serializer_t = fb_event_serializer<event_t>;
@@ -216,6 +237,7 @@ namespace reinforcement_learning { namespace logger {
 
     int add(event_t& evt, api_status* status = nullptr) {
       flatbuffers::Offset<typename serializer_t::fb_event_t> offset;
+      _last_event_mark = _builder.mark();
       RETURN_IF_FAIL(serializer_t::serialize(evt, _builder, offset, status));
       _event_offsets.push_back(offset);
       return error_code::success;
@@ -223,6 +245,17 @@ namespace reinforcement_learning { namespace logger {
 
     uint64_t size() const { return _builder.GetSize(); }
 
+    // Upper bound of the body size after finalize, it is over by the alignment padding at most
+    uint64_t finalized_size() const {
+      return size() + _event_offsets.size() * sizeof(flatbuffers::uoffset_t) + FINALIZE_OVERHEAD;
+    }
+
+    // Drops the event of the last add
+    void remove_last() {
+      _builder.rewind(_last_event_mark);
+      _event_offsets.pop_back();
+    }
+
     void finalize() {
       auto event_offsets = _builder.CreateVector(_event_offsets);
       typename serializer_t::batch_builder_t batch_builder(_builder);
@@ -236,10 +269,14 @@ namespace reinforcement_learning { namespace logger {
       _buffer.set_body_beginoffset(offset);
     }
 
+    // The length of the offset vector, the batch table and its vtable, the root offset and their padding
+    static constexpr size_t FINALIZE_OVERHEAD = 32;
+
     typename serializer_t::offset_vector_t _event_offsets;
     flatbuffer_allocator _allocator;
-    flatbuffers::FlatBufferBuilder _builder;
+    rewindable_builder _builder;
     buffer_t& _buffer;
+    rewindable_builder::mark_t _last_event_mark{ 0, 0 };
   };
 
   template <>
@@ -95,6 +95,7 @@ namespace reinforcement_learning { namespace logger {
     }
 
     int add(event_t& evt, api_status* status=nullptr) {
+      _last_event_begin = size();
       RETURN_IF_FAIL(serializer_t::serialize(evt, _ostream, status));
       _ostream << "\n";
       return error_code::success;
@@ -104,6 +105,16 @@ namespace reinforcement_learning { namespace logger {
       return _buffer.body_filled_size();
     }
 
+    // Size of the body after finalize, the terminator it writes is not part of it
+    uint64_t finalized_size() const {
+      return size();
+    }
+
+    // Drops the event of the last add
+    void remove_last() {
+      _streambuf.truncate(_last_event_begin);
+    }
+
     void reset() {
       _buffer.reset();
     }
@@ -115,6 +126,7 @@ namespace reinforcement_learning { namespace logger {
     buffer_t& _buffer;
     streambuf_t _streambuf;
     std::ostream _ostream;
+    uint64_t _last_event_begin = 0;
   };
 
   template<>
@@ -0,0 +1,210 @@
+#include "shadow_scorer.h"
+#include "api_status.h"
+#include "err_constants.h"
+#include "ranking_response.h"
+#include "sampling.h"
+#include "trace_logger.h"
+#include "explore_internal.h"
+#include "hash.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace reinforcement_learning {
+  namespace {
+    // Shadow scoring must never compete with request threads for CPU.
+    void lower_current_thread_priority() {
+#ifdef _WIN32
+      SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+#elif defined(__linux__)
+      // On Linux the nice value is per thread when addressed by thread id.
+      setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 19);
+#endif
+    }
+
+    // A hash seed of its own keeps the sample independent of the primary decision, which hashes the same id
+    const uint64_t sample_hash_seed = 0xbb67ae85;
+  }
+
+  shadow_scorer::shadow_scorer(model_management::i_model* model, size_t thread_count, size_t queue_max_size, float sample_rate, i_trace* trace)
+    : _model(model)
+    , _thread_count(thread_count)
+    , _queue_max_size(queue_max_size)
+    , _sample_rate(sample_rate)
+    , _trace(trace)
+  {}
+
+  shadow_scorer::~shadow_scorer() {
+    stop();
+  }
+
+  int shadow_scorer::init(api_status* status) {
+    if (_thread_count == 0 || _queue_max_size == 0) {
+      RETURN_ERROR_LS(_trace, status, invalid_argument) << " Shadow scorer needs at least one thread and a non empty queue.";
+    }
+
+    std::lock_guard<std::mutex> lock(_queue_mutex);
+    if (_running) {
+      return error_code::success;
+    }
+
+    _running = true;
+    try {
+      for (size_t i = 0; i < _thread_count; ++i) {
+        _workers.emplace_back(&shadow_scorer::worker_loop, this);
+      }
+    }
+    catch (const std::exception& e) {
+      RETURN_ERROR_LS(_trace, status, background_thread_start) << " (shadow scorer)" << e.what();
+    }
+    return error_code::success;
+  }
+
+  void shadow_scorer::stop() {
+    {
+      std::lock_guard<std::mutex> lock(_queue_mutex);
+      if (!_running) return;
+      _running = false;
+    }
+    _cv.notify_all();
+    for (auto& worker : _workers) {
+      worker.join();
+    }
+    _workers.clear();
+  }
+
+  int shadow_scorer::update_model(const model_management::model_data& data, api_status* status) {
+    bool model_ready = false;
+    RETURN_IF_FAIL(_model->update(data, model_ready, status));
+    _model_ready = model_ready;
+    return error_code::success;
+  }
+
+  bool shadow_scorer::try_enqueue(const char* event_id, uint64_t seed, const char* context, const ranking_response& primary) {
+    if (!_model_ready) {
+      return false;
+    }
+
+    // Sampling is a deterministic function of the event id so that the same event is always either in or out.
+    if (_sample_rate < 1.f &&
+      exploration::uniform_random_merand48(uniform_hash(event_id, strlen(event_id), sample_hash_seed)) >= _sample_rate) {
+      return false;
+    }
+
+    // Cheap early out without touching the lock when the workers are behind.
+    if (_queue_size.load(std::memory_order_relaxed) >= _queue_max_size) {
+      ++_dropped;
+      return false;
+    }
+
+    work_item item;
+    item.seed = seed;
+    item.context = context;
+    size_t max_action_id = 0;
+    for (const auto& ap : primary) {
+      max_action_id = (std::max)(max_action_id, ap.action_id);
+    }
+    item.primary_pdf.assign(primary.size() > 0 ? max_action_id + 1 : 0, 0.f);
+    for (const auto& ap : primary) {
+      item.primary_pdf[ap.action_id] = ap.probability;
+    }
+    if (primary.get_chosen_action_id(item.primary_chosen_action) != error_code::success) {
+      return false;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(_queue_mutex);
+      if (!_running || _queue.size() >= _queue_max_size) {
+        ++_dropped;
+        return false;
+      }
+      _queue.push_back(std::move(item));
+      _queue_size = _queue.size();
+    }
+    ++_enqueued;
+    _cv.notify_one();
+    return true;
+  }
+
+  shadow_stats shadow_scorer::get_stats() const {
+    shadow_stats stats;
+    {
+      std::lock_guard<std::mutex> lock(_stats_mutex);
+      stats = _stats;
+    }
+    stats.enqueued = _enqueued;
+    stats.dropped = _dropped;
+    return stats;
+  }
+
+  void shadow_scorer::worker_loop() {
+    lower_current_thread_priority();
+
+    while (true) {
+      work_item item;
+      {
+        std::unique_lock<std::mutex> lock(_queue_mutex);
+        _cv.wait(lock, [this] { return !_running || !_queue.empty(); });
+        // Pending shadow work is abandoned on shutdown.
+        if (!_running) return;
+        item = std::move(_queue.front());
+        _queue.pop_front();
+        _queue_size = _queue.size();
+      }
+      score(item);
+    }
+  }
+
+  void shadow_scorer::score(const work_item& item) {
+    std::vector<int> action_ids;
+    std::vector<float> action_pdf;
+    std::string model_version;
+    ranking_response shadow_response;
+    api_status status;
+
+    if (_model->choose_rank(item.seed, item.context.c_str(), action_ids, action_pdf, model_version, &status) != error_code::success ||
+      sample_and_populate_response(item.seed, action_ids, action_pdf, std::move(model_version), shadow_response, _trace, &status) != error_code::success) {
+      TRACE_WARN(_trace, status.get_error_msg());
+      std::lock_guard<std::mutex> lock(_stats_mutex);
+      ++_stats.failed;
+      return;
+    }
+
+    size_t shadow_chosen_action = 0;
+    shadow_response.get_chosen_action_id(shadow_chosen_action);
+
+    // Total variation distance between the two pdfs, aligned by action id.
+    std::vector<float> shadow_pdf(item.primary_pdf.size(), 0.f);
+    float unmatched_mass = 0.f;
+    for (const auto& ap : shadow_response) {
+      if (ap.action_id < shadow_pdf.size()) {
+        shadow_pdf[ap.action_id] = ap.probability;
+      }
+      else {
+        unmatched_mass += ap.probability;
+      }
+    }
+    float distance = unmatched_mass;
+    for (size_t i = 0; i < shadow_pdf.size(); ++i) {
+      distance += std::fabs(shadow_pdf[i] - item.primary_pdf[i]);
+    }
+    distance *= 0.5f;
+
+    std::lock_guard<std::mutex> lock(_stats_mutex);
+    ++_stats.scored;
+    if (shadow_chosen_action == item.primary_chosen_action) {
+      ++_stats.chosen_action_matches;
+    }
+    _stats.total_variation_sum += distance;
+    _stats.total_variation_max = (std::max)(_stats.total_variation_max, distance);
+  }
+}
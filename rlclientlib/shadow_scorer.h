@@ -0,0 +1,78 @@
+#pragma once
+#include "model_mgmt.h"
+#include "shadow_stats.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace reinforcement_learning {
+  class api_status;
+  class i_trace;
+  class ranking_response;
+
+  // Scores a sample of live contexts with a shadow model on low priority background threads and records how far
+  // its decisions diverge from the active model.  The request path only pays for a sampling check and a copy of
+  // the context; when the bounded queue is full the work is dropped instead of accumulated.
+  class shadow_scorer {
+  public:
+    // Takes ownership of the model
+    shadow_scorer(model_management::i_model* model, size_t thread_count, size_t queue_max_size, float sample_rate, i_trace* trace);
+    ~shadow_scorer();
+
+    int init(api_status* status = nullptr);
+    void stop();
+
+    // Model data is applied to the shadow model only
+    int update_model(const model_management::model_data& data, api_status* status = nullptr);
+
+    // Never blocks.  Returns true if the request was queued for shadow scoring.  The seed is the one the primary
+    // decision was drawn with; the sample is drawn from the event id.
+    bool try_enqueue(const char* event_id, uint64_t seed, const char* context, const ranking_response& primary);
+
+    shadow_stats get_stats() const;
+
+    shadow_scorer(const shadow_scorer&) = delete;
+    shadow_scorer(shadow_scorer&&) = delete;
+    shadow_scorer& operator=(const shadow_scorer&) = delete;
+    shadow_scorer& operator=(shadow_scorer&&) = delete;
+
+  private:
+    struct work_item {
+      uint64_t seed;
+      std::string context;
+      std::vector<float> primary_pdf;     // indexed by action id
+      size_t primary_chosen_action;
+    };
+
+    void worker_loop();
+    void score(const work_item& item);
+
+  private:
+    std::unique_ptr<model_management::i_model> _model;
+    std::atomic<bool> _model_ready{ false };
+
+    const size_t _thread_count;
+    const size_t _queue_max_size;
+    const float _sample_rate;
+
+    std::deque<work_item> _queue;
+    std::mutex _queue_mutex;
+    std::condition_variable _cv;
+    std::atomic<size_t> _queue_size{ 0 };
+    bool _running = false;
+    std::vector<std::thread> _workers;
+
+    std::atomic<uint64_t> _enqueued{ 0 };
+    std::atomic<uint64_t> _dropped{ 0 };
+    mutable std::mutex _stats_mutex;
+    shadow_stats _stats;
+
+    i_trace* _trace;
+  };
+}
@@ -14,7 +14,7 @@ namespace reinforcement_learning
     ts.hour = time.hours().count();
 	  ts.minute = time.minutes().count();
 	  ts.second = time.seconds().count();
-    ts.sub_second = time.subseconds().count();
+    ts.sub_second = std::chrono::duration_cast<sub_second_ticks>(time.subseconds()).count();
     return ts;
   }
 }
\ No newline at end of file
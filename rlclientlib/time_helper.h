@@ -1,6 +1,9 @@
 #pragma once
+#include <chrono>
 #include <cstdint>
 namespace reinforcement_learning {
+  // Unit of timestamp::sub_second, whatever the precision of the system clock
+  using sub_second_ticks = std::chrono::duration<uint32_t, std::ratio<1, 10000000>>;
 
   struct timestamp {
     uint16_t year = 0;    // year 
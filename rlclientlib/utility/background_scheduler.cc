@@ -0,0 +1,190 @@
+#include "background_scheduler.h"
+#include "api_status.h"
+#include "err_constants.h"
+#include "str_util.h"
+#include "trace_logger.h"
+
+#include <algorithm>
+#include <sstream>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace reinforcement_learning { namespace utility {
+  background_scheduler::background_scheduler(const background_scheduler_options& options, i_trace* trace)
+    : _options(options), _trace(trace), _epoch(clock::now())
+  {}
+
+  background_scheduler::~background_scheduler() {
+    stop();
+  }
+
+  int background_scheduler::init(api_status* status) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_timer_thread.joinable()) return error_code::success;
+    try {
+      _timer_thread = std::thread(&background_scheduler::run_timer, this);
+      pin(_timer_thread, 0);
+      for (size_t i = 0; i < (std::max)(_options.threads, static_cast<size_t>(1)); ++i) {
+        _workers.emplace_back(&background_scheduler::run_worker, this);
+        pin(_workers.back(), i + 1);
+      }
+    }
+    catch (const std::exception& e) {
+      RETURN_ERROR_LS(_trace, status, background_thread_start) << " (background scheduler)" << e.what();
+    }
+    return error_code::success;
+  }
+
+  void background_scheduler::stop() {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _timer_cv.notify_all();
+    _worker_cv.notify_all();
+    if (_timer_thread.joinable()) _timer_thread.join();
+    for (auto& worker : _workers) worker.join();
+    _workers.clear();
+  }
+
+  background_scheduler::task_id background_scheduler::add(std::function<void()> fn, std::chrono::milliseconds interval) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto id = _next_id++;
+    auto& t = _tasks[id];
+    t.fn = std::move(fn);
+    t.interval = interval;
+    _ready.push_back(id);
+    _worker_cv.notify_one();
+    return id;
+  }
+
+  void background_scheduler::remove(task_id id) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    const auto it = _tasks.find(id);
+    if (it == _tasks.end()) return;
+    auto& t = it->second;
+    t.removed = true;
+    if (t.timer != 0) {
+      _wheel.cancel(t.timer);
+      _timers.erase(t.timer);
+    }
+    _ready.erase(std::remove(_ready.begin(), _ready.end(), id), _ready.end());
+    _done_cv.wait(lock, [&t] { return !t.running; });
+    _tasks.erase(it);
+  }
+
+  background_scheduler_stats background_scheduler::get_stats() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+  }
+
+  uint64_t background_scheduler::tick(clock::time_point t) const {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(t - _epoch).count());
+  }
+
+  void background_scheduler::schedule(task_id id, task& t, uint64_t expires) {
+    t.timer = _wheel.schedule(expires);
+    _timers[t.timer] = id;
+    if (_wheel.next_event() < _timer_wake) _timer_cv.notify_one();
+  }
+
+  void background_scheduler::run_timer() {
+    std::vector<timer_wheel::timer_id> expired;
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (!_stop) {
+      expired.clear();
+      _wheel.advance(tick(clock::now()), expired);
+      for (const auto timer : expired) {
+        const auto it = _timers.find(timer);
+        if (it == _timers.end()) continue;
+        _tasks[it->second].timer = 0;
+        _ready.push_back(it->second);
+        _timers.erase(it);
+      }
+      if (!expired.empty()) _worker_cv.notify_all();
+
+      _timer_wake = _wheel.next_event();
+      if (_timer_wake == timer_wheel::never) {
+        _timer_cv.wait(lock);
+      }
+      else {
+        _timer_cv.wait_until(lock, _epoch + std::chrono::milliseconds(_timer_wake));
+      }
+      ++_stats.wakeups;
+    }
+  }
+
+  void background_scheduler::run_worker() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+      _worker_cv.wait(lock, [this] { return _stop || !_ready.empty(); });
+      if (_stop) break;
+      const auto id = _ready.front();
+      _ready.pop_front();
+      auto& t = _tasks[id];
+      t.running = true;
+      ++_stats.runs;
+
+      lock.unlock();
+      t.fn();
+      lock.lock();
+
+      t.running = false;
+      if (t.removed) {
+        _done_cv.notify_all();
+        continue;
+      }
+      schedule(id, t, tick(clock::now()) + static_cast<uint64_t>(t.interval.count()));
+    }
+  }
+
+  // Pinned from init, so that failures are traced while the trace of the caller is known to be alive
+  void background_scheduler::pin(std::thread& thread, size_t thread_index) {
+    if (_options.cpus.empty()) return;
+    const auto cpu = _options.cpus[thread_index % _options.cpus.size()];
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) != 0) {
+      TRACE_WARN(_trace, concat("Unable to pin a background scheduler thread to cpu ", cpu));
+    }
+#else
+    TRACE_WARN(_trace, concat("Pinning background scheduler threads is only supported on Linux, cpu ", cpu, " ignored"));
+#endif
+  }
+
+  std::shared_ptr<background_scheduler> background_scheduler::shared(const background_scheduler_options& options, i_trace* trace) {
+    static std::mutex shared_mutex;
+    static std::weak_ptr<background_scheduler> instance;
+    std::lock_guard<std::mutex> lock(shared_mutex);
+    auto scheduler = instance.lock();
+    if (!scheduler) {
+      scheduler = std::make_shared<background_scheduler>(options, trace);
+      instance = scheduler;
+    }
+    else if (options.threads != scheduler->_options.threads || options.cpus != scheduler->_options.cpus) {
+      TRACE_WARN(trace, concat("The shared background scheduler keeps the settings of the live model that created it (",
+        scheduler->_options.threads, " workers), scheduler.threads and scheduler.pin_cpus of this one are ignored"));
+    }
+    return scheduler;
+  }
+
+  std::vector<int> background_scheduler::parse_cpus(const std::string& cpus) {
+    std::vector<int> result;
+    std::istringstream in(cpus);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+      str_util::trim(item);
+      if (item.empty()) continue;
+      try {
+        result.push_back(std::stoi(item));
+      }
+      catch (const std::exception&) {}
+    }
+    return result;
+  }
+}}
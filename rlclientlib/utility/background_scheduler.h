@@ -0,0 +1,102 @@
+#pragma once
+#include "timer_wheel.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace reinforcement_learning {
+  class api_status;
+  class i_trace;
+}
+
+namespace reinforcement_learning { namespace utility {
+  struct background_scheduler_options {
+    size_t threads = 2;     // workers that run the tasks
+    std::vector<int> cpus;  // the timer and worker threads are pinned round robin to these, empty leaves them alone
+  };
+
+  struct background_scheduler_stats {
+    uint64_t wakeups = 0;  // times the timer thread woke up
+    uint64_t runs = 0;     // task runs
+  };
+
+  // Runs periodic tasks for any number of live models on a timer wheel with 1ms ticks and a small pool of workers,
+  // instead of a sleeping thread per task.  A task runs once right away and then an interval after each run
+  // finished, never twice at the same time.  Tasks that block for long, such as model downloads, hold a worker
+  // and delay every other task, so they belong on a thread of their own.
+  // The trace is only used by init.
+  class background_scheduler {
+  public:
+    using task_id = uint64_t;
+
+    background_scheduler(const background_scheduler_options& options, i_trace* trace);
+    ~background_scheduler();
+
+    // Starts the threads, later calls do nothing
+    int init(api_status* status);
+
+    task_id add(std::function<void()> fn, std::chrono::milliseconds interval);
+    // When this returns the task is not running and will not run again.  Must not be called from the task.
+    void remove(task_id id);
+
+    background_scheduler_stats get_stats();
+
+    // The scheduler shared by everyone who asks while it is alive, created with the options of the first caller.
+    // Callers that ask with other options get it as it is, with a warning on their trace.
+    static std::shared_ptr<background_scheduler> shared(const background_scheduler_options& options, i_trace* trace);
+
+    // Parses a comma separated list of cpu numbers
+    static std::vector<int> parse_cpus(const std::string& cpus);
+
+    background_scheduler(const background_scheduler&) = delete;
+    background_scheduler& operator=(const background_scheduler&) = delete;
+
+  private:
+    using clock = std::chrono::steady_clock;
+
+    struct task {
+      std::function<void()> fn;
+      std::chrono::milliseconds interval;
+      timer_wheel::timer_id timer = 0;  // 0 while queued or running
+      bool running = false;
+      bool removed = false;
+    };
+
+    void run_timer();
+    void run_worker();
+    void stop();
+    void pin(std::thread& thread, size_t thread_index);
+    uint64_t tick(clock::time_point t) const;
+    // The caller holds _mutex
+    void schedule(task_id id, task& t, uint64_t expires);
+
+    const background_scheduler_options _options;
+    i_trace* _trace;
+    const clock::time_point _epoch;
+
+    std::mutex _mutex;
+    std::condition_variable _timer_cv;
+    std::condition_variable _worker_cv;
+    std::condition_variable _done_cv;
+    timer_wheel _wheel;
+    uint64_t _timer_wake = timer_wheel::never;  // tick the timer thread sleeps until
+    std::map<task_id, task> _tasks;
+    std::map<timer_wheel::timer_id, task_id> _timers;
+    std::deque<task_id> _ready;
+    task_id _next_id = 1;
+    bool _stop = false;
+    background_scheduler_stats _stats;
+
+    std::thread _timer_thread;
+    std::vector<std::thread> _workers;
+  };
+}}
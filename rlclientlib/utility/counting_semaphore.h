@@ -0,0 +1,73 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+namespace reinforcement_learning { namespace utility {
+  // Counting semaphore guarding a fixed number of slots.  Any holder may release a slot, so waiters are woken by
+  // whichever owner finishes first.
+  class counting_semaphore {
+  public:
+    explicit counting_semaphore(size_t count);
+
+    counting_semaphore(const counting_semaphore&) = delete;
+    counting_semaphore& operator=(const counting_semaphore&) = delete;
+
+    // blocks until a slot is available
+    void acquire();
+    // returns false if no slot is available
+    bool try_acquire();
+    void release();
+    // blocks until every acquired slot has been released
+    void wait_all();
+
+    size_t available();
+    size_t in_use();
+    size_t capacity() const { return _count; }
+
+  private:
+    const size_t _count;
+    size_t _available;
+    std::mutex _mutex;
+    std::condition_variable _cv;
+  };
+
+  inline counting_semaphore::counting_semaphore(size_t count)
+    : _count(count), _available(count)
+  {}
+
+  inline void counting_semaphore::acquire() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _cv.wait(lock, [this] { return _available > 0; });
+    --_available;
+  }
+
+  inline bool counting_semaphore::try_acquire() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_available == 0) return false;
+    --_available;
+    return true;
+  }
+
+  inline void counting_semaphore::release() {
+    // Notify under the lock so that a waiter in wait_all() cannot destroy the semaphore before notify returns.
+    std::lock_guard<std::mutex> lock(_mutex);
+    ++_available;
+    _cv.notify_all();
+  }
+
+  inline void counting_semaphore::wait_all() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _cv.wait(lock, [this] { return _available == _count; });
+  }
+
+  inline size_t counting_semaphore::available() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _available;
+  }
+
+  inline size_t counting_semaphore::in_use() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _count - _available;
+  }
+}}
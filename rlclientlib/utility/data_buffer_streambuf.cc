@@ -22,39 +22,50 @@ namespace reinforcement_learning { namespace utility {
 
   std::streambuf::int_type data_buffer_streambuf::overflow(int_type ch)
   {
-    // save the overflow character
-    char* loc = pptr();
-    *loc = ch;
-    const auto old_body_size = _db->body_filled_size() + _db->body_capacity();
-    _db->set_body_endoffset(_db->preamble_size() + old_body_size);
-    
-    // We are at the end of buffer, increase size
-    try {
-      _db->resize_body_region(old_body_size + GROW_BY);
-
-      setp(
-        reinterpret_cast<char*> (_db->body_begin() + old_body_size),
-        reinterpret_cast<char*> (_db->body_begin() + old_body_size + GROW_BY));
+    if (traits_type::eq_int_type(ch, traits_type::eof())) {
+      return traits_type::not_eof(ch);
+    }
 
-      return ch;
+    // We are at the end of buffer, increase size.  The body may move, so continue at the same offset from its start.
+    const auto used = written();
+    try {
+      _db->resize_body_region(used + GROW_BY);
     }
     catch(...) {
       return EOF;
     }
+
+    // Again reserve one byte, for the terminator written by finalize
+    const auto begin = reinterpret_cast<char*>(_db->body_begin());
+    setp(begin, begin + used + GROW_BY - 1);
+    pbump(static_cast<int>(used));
+    *pptr() = traits_type::to_char_type(ch);
+    pbump(1);
+    return ch;
   }
 
   std::basic_streambuf<char>::int_type data_buffer_streambuf::sync() {
-    auto offset = _db->preamble_size() + (pptr() - pbase());
-    _db->set_body_endoffset(offset);
+    _db->set_body_endoffset(_db->preamble_size() + written());
     return 0;
   }
 
+  size_t data_buffer_streambuf::written() {
+    return pptr() - reinterpret_cast<char*>(_db->body_begin());
+  }
+
+  void data_buffer_streambuf::truncate(size_t size) {
+    assert(size <= written());
+    setp(pbase(), epptr());
+    pbump(static_cast<int>(size));
+    sync();
+  }
+
   void data_buffer_streambuf::finalize() {
     if(!_finalized) {
       _finalized = true;
       //Null terminate but don't include that in the size
       *pptr() = '\0';
-      const auto used_bytes = _db->preamble_size() + (pptr() - pbase());
+      const auto used_bytes = _db->preamble_size() + written();
       _db->set_body_endoffset(used_bytes);
     }
   }
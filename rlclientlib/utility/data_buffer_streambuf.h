@@ -1,4 +1,5 @@
 #pragma once
+#include <cstddef>
 #include <streambuf>
 namespace reinforcement_learning { namespace utility {
   class data_buffer; 
@@ -15,8 +16,13 @@ namespace reinforcement_learning { namespace utility {
     int_type overflow(int_type) override;
     int_type sync() override;
     void finalize();
+    // Drops what was written past the first size bytes of the body
+    void truncate(size_t size);
     ~data_buffer_streambuf();
   private:
+    // Bytes from the start of the body to the put pointer
+    size_t written();
+
     data_buffer* _db;
     const size_t GROW_BY = 2048;
     bool _finalized = false;
@@ -0,0 +1,93 @@
+#ifdef __linux__
+#include "epoll_http_client.h"
+#include "http_helper.h"
+#include "constants.h"
+
+#include <chrono>
+
+namespace reinforcement_learning {
+  namespace {
+    utility::http_engine_options engine_options(const utility::configuration& cfg) {
+      // Timeout and certificate validation follow the cpprest client configuration.
+      const auto config = utility::get_http_config(cfg);
+      utility::http_engine_options options;
+      options.timeout = std::chrono::duration_cast<std::chrono::milliseconds>(config.timeout());
+      options.validate_certificates = config.validate_certificates();
+      const auto max_connections = cfg.get_int(name::HTTP_CLIENT_MAX_CONNECTIONS, value::DEFAULT_HTTP_CLIENT_MAX_CONNECTIONS);
+      options.max_connections = max_connections > 0 ? max_connections : 1;
+      return options;
+    }
+
+    // The request uri is relative to the client url, like with the cpprest client.
+    std::string request_target(const std::string& base, const std::string& relative) {
+      if (relative.empty() || relative == "/") return base;
+      auto path = base.substr(0, base.find('?'));
+      if (!path.empty() && path.back() == '/') path.pop_back();
+      return relative[0] == '/' ? path + relative : path + "/" + relative;
+    }
+  }
+
+  epoll_http_client::epoll_http_client(const char* url, const utility::configuration& cfg, i_trace* trace)
+    : _url(url), _engine(url, engine_options(cfg), trace)
+  {}
+
+  int epoll_http_client::init(api_status* status) {
+    return _engine.init(status);
+  }
+
+  epoll_http_client::response_t epoll_http_client::request(method_t method) {
+    return submit(request_t(method), nullptr, 0, nullptr);
+  }
+
+  epoll_http_client::response_t epoll_http_client::request(request_t request) {
+    if (request.headers().content_length() == 0) {
+      return submit(request, nullptr, 0, nullptr);
+    }
+    // Stream bodies have to be read into memory first, request_with_body avoids this copy.
+    auto body = std::make_shared<std::vector<unsigned char>>(request.extract_vector().get());
+    return submit(request, body->data(), body->size(), body);
+  }
+
+  epoll_http_client::response_t epoll_http_client::request_with_body(request_t request, const body_t& body) {
+    return submit(request, body->preamble_begin(), body->buffer_filled_size(), body);
+  }
+
+  epoll_http_client::response_t epoll_http_client::submit(const request_t& request, const unsigned char* body,
+    size_t body_size, std::shared_ptr<void> owner) {
+    utility::http_engine_request req;
+    req.method = ::utility::conversions::to_utf8string(request.method());
+    req.target = request_target(_engine.target(), ::utility::conversions::to_utf8string(request.request_uri().to_string()));
+    for (const auto& header : request.headers()) {
+      req.headers.emplace_back(::utility::conversions::to_utf8string(header.first),
+        ::utility::conversions::to_utf8string(header.second));
+    }
+    req.body = body;
+    req.body_size = body_size;
+    req.body_owner = std::move(owner);
+
+    pplx::task_completion_event<web::http::http_response> tce;
+    _engine.submit(std::move(req), [tce](const std::string& error, utility::http_engine_response& response) {
+      if (!error.empty()) {
+        tce.set_exception(std::make_exception_ptr(web::http::http_exception(::utility::conversions::to_string_t(error))));
+        return;
+      }
+      web::http::http_response result(static_cast<web::http::status_code>(response.status_code));
+      for (const auto& header : response.headers) {
+        result.headers().add(::utility::conversions::to_string_t(header.first),
+          ::utility::conversions::to_string_t(header.second));
+      }
+      result.set_body(std::move(response.body));
+      tce.set(result);
+    });
+    return pplx::create_task(tce);
+  }
+
+  const std::string& epoll_http_client::get_url() const {
+    return _url;
+  }
+
+  utility::http_engine_stats epoll_http_client::get_stats() const {
+    return _engine.get_stats();
+  }
+}
+#endif
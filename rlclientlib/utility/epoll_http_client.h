@@ -0,0 +1,36 @@
+#pragma once
+#ifdef __linux__
+#include "http_client.h"
+#include "http_engine.h"
+
+namespace reinforcement_learning {
+  class i_trace;
+  class api_status;
+
+  // i_http_client on top of the epoll http_engine.  Bodies handed to request_with_body are written from the batch
+  // buffer itself, responses are read in full before the task completes.  Linux only.
+  class epoll_http_client : public i_http_client {
+  public:
+    epoll_http_client(const char* url, const utility::configuration& cfg, i_trace* trace);
+
+    epoll_http_client(const epoll_http_client&) = delete;
+    epoll_http_client& operator=(const epoll_http_client&) = delete;
+
+    int init(api_status* status);
+
+    virtual response_t request(method_t method) override;
+    virtual response_t request(request_t request) override;
+    virtual response_t request_with_body(request_t request, const body_t& body) override;
+
+    virtual const std::string& get_url() const override;
+
+    utility::http_engine_stats get_stats() const;
+
+  private:
+    response_t submit(const request_t& request, const unsigned char* body, size_t body_size, std::shared_ptr<void> owner);
+
+    const std::string _url;
+    utility::http_engine _engine;
+  };
+}
+#endif
@@ -1,9 +1,21 @@
 #include "http_client.h"
 #include "utility/http_helper.h"
 
+#include <cpprest/rawptrstream.h>
+
 #include <chrono>
 
 namespace reinforcement_learning {
+  i_http_client::response_t i_http_client::request_with_body(request_t request, const body_t& body) {
+    const auto size = body->buffer_filled_size();
+    const concurrency::streams::rawptr_buffer<uint8_t> buffer(body->preamble_begin(), size, std::ios::in);
+    request.set_body(buffer.create_istream(), size);
+    return this->request(request).then([body](web::http::http_response response) {
+      // Holds the data buffer until the request is done with it.
+      return response;
+    });
+  }
+
   http_client::http_client(const char* url, const utility::configuration& cfg)
     : _url(url)
     , _impl(::utility::conversions::to_string_t(url), utility::get_http_config(cfg)) {
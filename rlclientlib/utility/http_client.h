@@ -1,6 +1,9 @@
 #pragma once
 #include <cpprest/http_client.h>
 #include "configuration.h"
+#include "data_buffer.h"
+
+#include <memory>
 
 namespace reinforcement_learning {
   class i_http_client {
@@ -8,6 +11,7 @@ namespace reinforcement_learning {
     typedef web::http::http_request request_t;
     typedef pplx::task<web::http::http_response> response_t;
     typedef web::http::method method_t;
+    typedef std::shared_ptr<utility::data_buffer> body_t;
 
   public:
     virtual ~i_http_client() = default;
@@ -15,6 +19,13 @@ namespace reinforcement_learning {
     virtual response_t request(method_t) = 0;
     virtual response_t request(request_t) = 0;
 
+    // Sends the filled region of body (preamble and body) as the request body.  The buffer is kept alive until the
+    // response arrives.  The default reads it in place through a raw pointer stream and calls request(request_t),
+    // which saves the copy into a container stream, but the cpprest client still copies the body into its own send
+    // buffer.  Clients able to write a contiguous buffer directly, like epoll_http_client, override this to send
+    // the batch from where it is.
+    virtual response_t request_with_body(request_t request, const body_t& body);
+
     virtual const std::string& get_url() const = 0;
   };
 
@@ -0,0 +1,817 @@
+#ifdef __linux__
+#include "http_engine.h"
+#include "api_status.h"
+#include "err_constants.h"
+#include "trace_logger.h"
+
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+#include <openssl/x509v3.h>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+
+namespace reinforcement_learning { namespace utility {
+  struct http_engine::pending {
+    http_engine_request request;
+    http_engine_callback callback;
+    std::string head;
+    size_t written = 0;  // bytes of head and body written so far
+    std::chrono::steady_clock::time_point deadline;
+    bool retried = false;
+  };
+
+  struct http_engine::connection {
+    int fd = -1;
+    SSL* ssl = nullptr;
+    conn_state state = conn_state::connecting;
+    std::unique_ptr<pending> request;
+    bool reused = false;
+    bool closed = false;
+
+    // Response being parsed
+    std::string in;
+    size_t body_start = 0;  // 0 until the head is parsed
+    size_t chunk_pos = 0;
+    long long content_length = -1;
+    bool chunked = false;
+    bool keep_alive = true;
+    http_engine_response response;
+
+    void reset_response() {
+      in.clear();
+      body_start = 0;
+      chunk_pos = 0;
+      content_length = -1;
+      chunked = false;
+      keep_alive = true;
+      response = http_engine_response();
+    }
+  };
+
+  struct http_engine::address_list {
+    struct entry {
+      int family;
+      sockaddr_storage address;
+      socklen_t length;
+    };
+    std::vector<entry> entries;
+    std::string error;  // why entries is empty
+  };
+
+  namespace {
+    const int PARSE_BAD = -1;
+    const int PARSE_INCOMPLETE = 0;
+    const int PARSE_DONE = 1;
+    const int MAX_EVENTS = 64;
+    const int TICK_MS = 50;
+    // Cached addresses are looked up again after this long, or when a connect fails but not more often than that
+    const std::chrono::seconds RESOLVE_INTERVAL(60);
+    const std::chrono::seconds MIN_RESOLVE_INTERVAL(1);
+
+    bool iequals(const std::string& a, const char* b) {
+      const size_t len = strlen(b);
+      if (a.size() != len) return false;
+      for (size_t i = 0; i < len; ++i) {
+        if (tolower(static_cast<unsigned char>(a[i])) != tolower(static_cast<unsigned char>(b[i]))) return false;
+      }
+      return true;
+    }
+
+    std::string trim(const std::string& s) {
+      const auto begin = s.find_first_not_of(" \t");
+      if (begin == std::string::npos) return "";
+      const auto end = s.find_last_not_of(" \t\r");
+      return s.substr(begin, end - begin + 1);
+    }
+
+    bool parse_url(const std::string& url, bool& tls, std::string& host, std::string& port, std::string& target,
+      std::string& host_header) {
+      std::string rest;
+      if (url.compare(0, 7, "http://") == 0) {
+        tls = false;
+        rest = url.substr(7);
+      }
+      else if (url.compare(0, 8, "https://") == 0) {
+        tls = true;
+        rest = url.substr(8);
+      }
+      else {
+        return false;
+      }
+
+      const auto path = rest.find_first_of("/?");
+      const auto authority = rest.substr(0, path);
+      if (authority.empty()) return false;
+      target = path == std::string::npos ? "/" : rest.substr(path);
+      if (target[0] == '?') target.insert(0, "/");
+
+      size_t port_sep;
+      if (authority[0] == '[') {
+        const auto close = authority.find(']');
+        if (close == std::string::npos) return false;
+        host = authority.substr(1, close - 1);
+        port_sep = authority.find(':', close);
+      }
+      else {
+        port_sep = authority.find(':');
+        host = authority.substr(0, port_sep);
+      }
+      port = port_sep == std::string::npos ? (tls ? "443" : "80") : authority.substr(port_sep + 1);
+      host_header = authority;
+      return !host.empty() && !port.empty();
+    }
+
+    std::string ssl_error() {
+      char buf[256] = { 0 };
+      const auto code = ERR_get_error();
+      if (code == 0) return "unknown TLS error";
+      ERR_error_string_n(code, buf, sizeof(buf));
+      return buf;
+    }
+
+    std::string sys_error(const char* what, int err) {
+      return std::string(what) + ": " + strerror(err);
+    }
+
+    // Safe to send again after the server may have acted on it, RFC 7231 4.2.2
+    bool idempotent(const std::string& method) {
+      return method == "GET" || method == "HEAD" || method == "PUT" || method == "DELETE" || method == "OPTIONS";
+    }
+
+    void init_openssl() {
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+      static std::once_flag flag;
+      std::call_once(flag, [] {
+        SSL_library_init();
+        SSL_load_error_strings();
+      });
+#endif
+    }
+  }
+
+  http_engine::http_engine(const std::string& url, const http_engine_options& options, i_trace* trace)
+    : _url(url), _options(options), _trace(trace)
+  {}
+
+  http_engine::~http_engine() {
+    {
+      // Under the lock the resolver is either waiting or yet to check _stop
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _resolve_cv.notify_all();
+    wake();
+    if (_thread.joinable()) _thread.join();
+    if (_resolver.joinable()) _resolver.join();
+    if (_wake_fd >= 0) ::close(_wake_fd);
+    if (_epoll_fd >= 0) ::close(_epoll_fd);
+    if (_ssl_ctx != nullptr) SSL_CTX_free(_ssl_ctx);
+  }
+
+  int http_engine::init(api_status* status) {
+    if (!parse_url(_url, _tls, _host, _port, _target, _host_header)) {
+      RETURN_ERROR_LS(_trace, status, invalid_argument) << "Unable to parse url: " << _url;
+    }
+
+    if (_tls) {
+      init_openssl();
+      _ssl_ctx = SSL_CTX_new(SSLv23_client_method());
+      if (_ssl_ctx == nullptr) {
+        RETURN_ERROR_LS(_trace, status, http_client_init_error) << "SSL_CTX_new failed: " << ssl_error();
+      }
+      SSL_CTX_set_options(_ssl_ctx, SSL_OP_NO_SSLv2 | SSL_OP_NO_SSLv3 | SSL_OP_NO_COMPRESSION);
+      SSL_CTX_set_mode(_ssl_ctx, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+      if (_options.validate_certificates) {
+        if (SSL_CTX_set_default_verify_paths(_ssl_ctx) != 1) {
+          RETURN_ERROR_LS(_trace, status, http_client_init_error) << "Unable to load CA certificates: " << ssl_error();
+        }
+        SSL_CTX_set_verify(_ssl_ctx, SSL_VERIFY_PEER, nullptr);
+      }
+    }
+
+    _epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (_epoll_fd < 0) {
+      RETURN_ERROR_LS(_trace, status, http_client_init_error) << sys_error("epoll_create1", errno);
+    }
+    _wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_wake_fd < 0) {
+      RETURN_ERROR_LS(_trace, status, http_client_init_error) << sys_error("eventfd", errno);
+    }
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.ptr = nullptr;
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _wake_fd, &ev) != 0) {
+      RETURN_ERROR_LS(_trace, status, http_client_init_error) << sys_error("epoll_ctl", errno);
+    }
+
+    try {
+      _resolver = std::thread(&http_engine::resolve_loop, this);
+      _thread = std::thread(&http_engine::run, this);
+    }
+    catch (const std::exception& e) {
+      RETURN_ERROR_LS(_trace, status, background_thread_start) << "http engine: " << e.what();
+    }
+    return error_code::success;
+  }
+
+  void http_engine::submit(http_engine_request request, http_engine_callback callback) {
+    std::unique_ptr<pending> p(new pending());
+    p->request = std::move(request);
+    p->callback = std::move(callback);
+    p->deadline = std::chrono::steady_clock::now() + _options.timeout;
+
+    if (!_thread.joinable() || _stop) {
+      finish(p, "http engine is not running");
+      return;
+    }
+
+    auto& req = p->request;
+    auto& head = p->head;
+    head.reserve(256);
+    head.append(req.method).append(" ").append(req.target.empty() ? _target : req.target).append(" HTTP/1.1\r\n");
+    bool has_host = false;
+    for (const auto& h : req.headers) {
+      if (iequals(h.first, "Content-Length")) continue;
+      if (iequals(h.first, "Host")) has_host = true;
+      head.append(h.first).append(": ").append(h.second).append("\r\n");
+    }
+    if (!has_host) head.append("Host: ").append(_host_header).append("\r\n");
+    if (req.body_size > 0 || req.method == "POST" || req.method == "PUT") {
+      head.append("Content-Length: ").append(std::to_string(req.body_size)).append("\r\n");
+    }
+    head.append("\r\n");
+
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _submitted.push_back(std::move(p));
+    }
+    ++_requests;
+    wake();
+  }
+
+  const std::string& http_engine::target() const {
+    return _target;
+  }
+
+  http_engine_stats http_engine::get_stats() const {
+    http_engine_stats stats;
+    stats.requests = _requests;
+    stats.connections_opened = _connections_opened;
+    stats.connections_reused = _connections_reused;
+    return stats;
+  }
+
+  void http_engine::run() {
+    // Writing to a socket the server reset raises SIGPIPE, keep it pending on this thread and handle EPIPE instead.
+    sigset_t sigpipe;
+    sigemptyset(&sigpipe);
+    sigaddset(&sigpipe, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &sigpipe, nullptr);
+
+    epoll_event events[MAX_EVENTS];
+    while (!_stop) {
+      const int n = epoll_wait(_epoll_fd, events, MAX_EVENTS, TICK_MS);
+      for (int i = 0; i < n; ++i) {
+        if (events[i].data.ptr == nullptr) {
+          uint64_t value;
+          if (::read(_wake_fd, &value, sizeof(value)) < 0) {}
+          continue;
+        }
+        auto& conn = *static_cast<connection*>(events[i].data.ptr);
+        if (!conn.closed) on_event(conn, events[i].events);
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto& p : _submitted) _queue.push_back(std::move(p));
+        _submitted.clear();
+        _addresses = _latest_addresses;
+      }
+      dispatch();
+      expire_requests();
+      // Closed connections are only released here, after every event that may still point at them was handled.
+      _connections.remove_if([](const std::unique_ptr<connection>& c) { return c->closed; });
+    }
+    fail_all("http engine is shutting down");
+  }
+
+  void http_engine::resolve_loop() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (!_stop) {
+      _resolve_requested = false;
+      lock.unlock();
+
+      std::shared_ptr<address_list> addresses(new address_list());
+      addrinfo hints{};
+      hints.ai_family = AF_UNSPEC;
+      hints.ai_socktype = SOCK_STREAM;
+      addrinfo* results = nullptr;
+      const int rc = getaddrinfo(_host.c_str(), _port.c_str(), &hints, &results);
+      if (rc != 0) {
+        addresses->error = std::string("Unable to resolve ") + _host + ": " + gai_strerror(rc);
+      }
+      else {
+        for (auto ai = results; ai != nullptr; ai = ai->ai_next) {
+          address_list::entry entry;
+          entry.family = ai->ai_family;
+          memcpy(&entry.address, ai->ai_addr, ai->ai_addrlen);
+          entry.length = ai->ai_addrlen;
+          addresses->entries.push_back(entry);
+        }
+        freeaddrinfo(results);
+        if (addresses->entries.empty()) addresses->error = "No address for " + _host;
+      }
+
+      const auto next_lookup = std::chrono::steady_clock::now() + MIN_RESOLVE_INTERVAL;
+      lock.lock();
+      _latest_addresses = std::move(addresses);
+      // Requests waiting for the first lookup can go now
+      wake();
+      _resolve_cv.wait_for(lock, RESOLVE_INTERVAL, [this] { return _stop || _resolve_requested; });
+      _resolve_cv.wait_until(lock, next_lookup, [this] { return _stop.load(); });
+    }
+  }
+
+  void http_engine::request_resolve() {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _resolve_requested = true;
+    }
+    _resolve_cv.notify_one();
+  }
+
+  void http_engine::wake() {
+    if (_wake_fd < 0) return;
+    const uint64_t one = 1;
+    if (::write(_wake_fd, &one, sizeof(one)) < 0) {}
+  }
+
+  void http_engine::dispatch() {
+    while (!_queue.empty()) {
+      connection* idle = nullptr;
+      size_t open = 0;
+      for (auto& c : _connections) {
+        if (c->closed) continue;
+        ++open;
+        if (idle == nullptr && c->state == conn_state::idle) idle = c.get();
+      }
+
+      if (idle != nullptr) {
+        idle->request = std::move(_queue.front());
+        _queue.pop_front();
+        idle->reused = true;
+        ++_connections_reused;
+        start_request(*idle);
+      }
+      else if (open < _options.max_connections) {
+        // New connections wait for the first lookup of the host
+        if (!_addresses) return;
+        auto p = std::move(_queue.front());
+        _queue.pop_front();
+        open_connection(std::move(p));
+      }
+      else {
+        return;
+      }
+    }
+  }
+
+  void http_engine::open_connection(std::unique_ptr<pending> request) {
+    if (_addresses->entries.empty()) {
+      request_resolve();
+      finish(request, _addresses->error);
+      return;
+    }
+
+    int fd = -1;
+    int last_error = 0;
+    for (const auto& address : _addresses->entries) {
+      fd = socket(address.family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+      if (fd < 0) {
+        last_error = errno;
+        continue;
+      }
+      const int one = 1;
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+      if (connect(fd, reinterpret_cast<const sockaddr*>(&address.address), address.length) == 0 || errno == EINPROGRESS) break;
+      last_error = errno;
+      ::close(fd);
+      fd = -1;
+    }
+    if (fd < 0) {
+      // The host may have moved to other addresses
+      request_resolve();
+      finish(request, sys_error("connect", last_error));
+      return;
+    }
+
+    std::unique_ptr<connection> conn(new connection());
+    conn->fd = fd;
+    conn->request = std::move(request);
+    epoll_event ev{};
+    ev.events = EPOLLOUT;
+    ev.data.ptr = conn.get();
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+      const int err = errno;
+      ::close(fd);
+      finish(conn->request, sys_error("epoll_ctl", err));
+      return;
+    }
+    ++_connections_opened;
+    _connections.push_back(std::move(conn));
+  }
+
+  void http_engine::start_request(connection& conn) {
+    conn.reset_response();
+    conn.state = conn_state::writing;
+    write(conn);
+  }
+
+  void http_engine::on_event(connection& conn, uint32_t events) {
+    switch (conn.state) {
+    case conn_state::connecting: {
+      int err = 0;
+      socklen_t len = sizeof(err);
+      getsockopt(conn.fd, SOL_SOCKET, SO_ERROR, &err, &len);
+      if (err != 0) {
+        request_resolve();
+        fail(conn, sys_error("connect", err), false);
+        return;
+      }
+      if (!_tls) {
+        conn.state = conn_state::writing;
+        write(conn);
+        return;
+      }
+      conn.ssl = SSL_new(_ssl_ctx);
+      if (conn.ssl == nullptr) {
+        fail(conn, "SSL_new failed: " + ssl_error(), false);
+        return;
+      }
+      SSL_set_fd(conn.ssl, conn.fd);
+      SSL_set_tlsext_host_name(conn.ssl, _host.c_str());
+      if (_options.validate_certificates) {
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+        SSL_set1_host(conn.ssl, _host.c_str());
+#elif OPENSSL_VERSION_NUMBER >= 0x10002000L
+        X509_VERIFY_PARAM_set1_host(SSL_get0_param(conn.ssl), _host.c_str(), 0);
+#endif
+      }
+      conn.state = conn_state::handshaking;
+      if (handshake(conn)) write(conn);
+      return;
+    }
+    case conn_state::handshaking:
+      if (handshake(conn)) write(conn);
+      return;
+    case conn_state::writing:
+      write(conn);
+      return;
+    case conn_state::reading:
+      read(conn);
+      return;
+    case conn_state::idle:
+      // Nothing is expected on an idle connection, this is the server closing it.
+      close(conn);
+      return;
+    }
+    (void)events;
+  }
+
+  bool http_engine::handshake(connection& conn) {
+    ERR_clear_error();
+    const int rc = SSL_connect(conn.ssl);
+    if (rc == 1) {
+      conn.state = conn_state::writing;
+      return true;
+    }
+    switch (SSL_get_error(conn.ssl, rc)) {
+    case SSL_ERROR_WANT_READ:
+      watch(conn, EPOLLIN);
+      return false;
+    case SSL_ERROR_WANT_WRITE:
+      watch(conn, EPOLLOUT);
+      return false;
+    default:
+      fail(conn, "TLS handshake failed: " + ssl_error(), false);
+      return false;
+    }
+  }
+
+  bool http_engine::write(connection& conn) {
+    auto& p = *conn.request;
+    const size_t head_size = p.head.size();
+    const size_t total = head_size + p.request.body_size;
+    const auto body = reinterpret_cast<const char*>(p.request.body);
+
+    while (p.written < total) {
+      size_t n;
+      if (conn.ssl != nullptr) {
+        const char* data;
+        size_t len;
+        if (p.written < head_size) {
+          data = p.head.data() + p.written;
+          len = head_size - p.written;
+        }
+        else {
+          data = body + (p.written - head_size);
+          len = total - p.written;
+        }
+        ERR_clear_error();
+        const int rc = SSL_write(conn.ssl, data, static_cast<int>((std::min)(len, static_cast<size_t>(INT_MAX))));
+        if (rc <= 0) {
+          switch (SSL_get_error(conn.ssl, rc)) {
+          case SSL_ERROR_WANT_WRITE:
+            watch(conn, EPOLLOUT);
+            return false;
+          case SSL_ERROR_WANT_READ:
+            watch(conn, EPOLLIN);
+            return false;
+          default:
+            fail(conn, "TLS write failed: " + ssl_error());
+            return false;
+          }
+        }
+        n = static_cast<size_t>(rc);
+      }
+      else {
+        iovec iov[2];
+        int count = 0;
+        if (p.written < head_size) {
+          iov[count].iov_base = const_cast<char*>(p.head.data() + p.written);
+          iov[count++].iov_len = head_size - p.written;
+          if (p.request.body_size > 0) {
+            iov[count].iov_base = const_cast<char*>(body);
+            iov[count++].iov_len = p.request.body_size;
+          }
+        }
+        else {
+          iov[count].iov_base = const_cast<char*>(body + (p.written - head_size));
+          iov[count++].iov_len = total - p.written;
+        }
+        const ssize_t rc = ::writev(conn.fd, iov, count);
+        if (rc < 0) {
+          if (errno == EINTR) continue;
+          if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            watch(conn, EPOLLOUT);
+            return false;
+          }
+          fail(conn, sys_error("write", errno));
+          return false;
+        }
+        n = static_cast<size_t>(rc);
+      }
+      p.written += n;
+    }
+
+    conn.state = conn_state::reading;
+    watch(conn, EPOLLIN);
+    return true;
+  }
+
+  bool http_engine::read(connection& conn) {
+    char buf[16 * 1024];
+    while (true) {
+      size_t n;
+      if (conn.ssl != nullptr) {
+        ERR_clear_error();
+        const int rc = SSL_read(conn.ssl, buf, sizeof(buf));
+        if (rc > 0) {
+          n = static_cast<size_t>(rc);
+        }
+        else {
+          const int err = SSL_get_error(conn.ssl, rc);
+          if (err == SSL_ERROR_WANT_READ) {
+            watch(conn, EPOLLIN);
+            return false;
+          }
+          if (err == SSL_ERROR_WANT_WRITE) {
+            watch(conn, EPOLLOUT);
+            return false;
+          }
+          // A peer closing without close_notify is treated as a plain end of stream.
+          if (err != SSL_ERROR_ZERO_RETURN && !(err == SSL_ERROR_SYSCALL && ERR_peek_error() == 0)) {
+            fail(conn, "TLS read failed: " + ssl_error());
+            return false;
+          }
+          n = 0;
+        }
+      }
+      else {
+        const ssize_t rc = ::read(conn.fd, buf, sizeof(buf));
+        if (rc < 0) {
+          if (errno == EINTR) continue;
+          if (errno == EAGAIN || errno == EWOULDBLOCK) return false;
+          fail(conn, sys_error("read", errno));
+          return false;
+        }
+        n = static_cast<size_t>(rc);
+      }
+
+      if (n == 0) {
+        if (parse(conn, true) == PARSE_DONE) {
+          complete(conn);
+          return true;
+        }
+        fail(conn, "Connection closed before the response was complete");
+        return false;
+      }
+
+      conn.in.append(buf, n);
+      const int parsed = parse(conn, false);
+      if (parsed == PARSE_DONE) {
+        complete(conn);
+        return true;
+      }
+      if (parsed == PARSE_BAD) {
+        fail(conn, "Malformed HTTP response", false);
+        return false;
+      }
+    }
+  }
+
+  int http_engine::parse(connection& conn, bool eof) {
+    auto& in = conn.in;
+    auto& response = conn.response;
+
+    if (conn.body_start == 0) {
+      const auto head_end = in.find("\r\n\r\n");
+      if (head_end == std::string::npos) return eof ? PARSE_BAD : PARSE_INCOMPLETE;
+      if (in.compare(0, 5, "HTTP/") != 0 || head_end < 12) return PARSE_BAD;
+
+      // HTTP/1.0 closes by default, HTTP/1.1 keeps the connection alive
+      conn.keep_alive = in.compare(5, 3, "1.0") != 0;
+      response.status_code = atoi(in.c_str() + 9);
+      if (response.status_code < 100) return PARSE_BAD;
+
+      auto line = in.find("\r\n") + 2;
+      while (line < head_end + 2) {
+        const auto line_end = in.find("\r\n", line);
+        const auto colon = in.find(':', line);
+        if (colon != std::string::npos && colon < line_end) {
+          auto name = in.substr(line, colon - line);
+          auto value = trim(in.substr(colon + 1, line_end - colon - 1));
+          if (iequals(name, "Content-Length")) {
+            conn.content_length = strtoll(value.c_str(), nullptr, 10);
+          }
+          else if (iequals(name, "Transfer-Encoding")) {
+            conn.chunked = value.find("chunked") != std::string::npos;
+          }
+          else if (iequals(name, "Connection")) {
+            if (iequals(value, "close")) conn.keep_alive = false;
+            else if (iequals(value, "keep-alive")) conn.keep_alive = true;
+          }
+          response.headers.emplace_back(std::move(name), std::move(value));
+        }
+        line = line_end + 2;
+      }
+      conn.body_start = head_end + 4;
+      conn.chunk_pos = conn.body_start;
+
+      const auto status = response.status_code;
+      if (conn.request->request.method == "HEAD" || status == 204 || status == 304 || status < 200) {
+        return PARSE_DONE;
+      }
+    }
+
+    if (conn.chunked) {
+      while (true) {
+        const auto line_end = in.find("\r\n", conn.chunk_pos);
+        if (line_end == std::string::npos) return eof ? PARSE_BAD : PARSE_INCOMPLETE;
+        char* parsed_end = nullptr;
+        const auto size = strtoull(in.c_str() + conn.chunk_pos, &parsed_end, 16);
+        if (parsed_end == in.c_str() + conn.chunk_pos) return PARSE_BAD;
+        if (size == 0) {
+          // Last chunk, wait for the (usually empty) trailer section
+          if (in.compare(line_end, 4, "\r\n\r\n") == 0 || in.find("\r\n\r\n", line_end) != std::string::npos) {
+            return PARSE_DONE;
+          }
+          return eof ? PARSE_BAD : PARSE_INCOMPLETE;
+        }
+        const auto data = line_end + 2;
+        if (in.size() < data + size + 2) return eof ? PARSE_BAD : PARSE_INCOMPLETE;
+        response.body.insert(response.body.end(), in.begin() + data, in.begin() + data + size);
+        conn.chunk_pos = data + size + 2;
+      }
+    }
+
+    const auto received = in.size() - conn.body_start;
+    if (conn.content_length >= 0) {
+      if (received < static_cast<size_t>(conn.content_length)) return eof ? PARSE_BAD : PARSE_INCOMPLETE;
+      response.body.assign(in.begin() + conn.body_start, in.begin() + conn.body_start + conn.content_length);
+      return PARSE_DONE;
+    }
+
+    // No length, the body runs until the server closes the connection
+    if (!eof) return PARSE_INCOMPLETE;
+    response.body.assign(in.begin() + conn.body_start, in.end());
+    conn.keep_alive = false;
+    return PARSE_DONE;
+  }
+
+  void http_engine::complete(connection& conn) {
+    auto p = std::move(conn.request);
+    auto response = std::move(conn.response);
+    if (conn.keep_alive) {
+      conn.reset_response();
+      conn.state = conn_state::idle;
+      watch(conn, EPOLLIN);
+    }
+    else {
+      close(conn);
+    }
+    finish(p, "", &response);
+  }
+
+  void http_engine::fail(connection& conn, const std::string& error, bool may_retry) {
+    auto p = std::move(conn.request);
+    // A pooled connection may have been closed by the server while idle.  The request goes out once more on a fresh
+    // connection only if the server cannot have acted on it: none of it was written, or it is idempotent and not a
+    // response byte arrived.  Anything else, like a POST that went out, fails to the caller, whose retry policy
+    // decides whether a duplicate is acceptable.
+    const bool unsent = p && p->written == 0;
+    const bool replayable = p && idempotent(p->request.method) && conn.in.empty();
+    const bool retry = may_retry && p && conn.reused && (unsent || replayable) && !p->retried && !_stop;
+    close(conn);
+    if (!p) return;
+    if (retry) {
+      TRACE_INFO(_trace, "Reused http connection failed, retrying the request on a new connection: " + error);
+      p->retried = true;
+      p->written = 0;
+      _queue.push_front(std::move(p));
+      return;
+    }
+    finish(p, error);
+  }
+
+  void http_engine::close(connection& conn) {
+    if (conn.closed) return;
+    epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, conn.fd, nullptr);
+    if (conn.ssl != nullptr) {
+      SSL_free(conn.ssl);
+      conn.ssl = nullptr;
+    }
+    ::close(conn.fd);
+    conn.fd = -1;
+    conn.closed = true;
+  }
+
+  void http_engine::watch(connection& conn, uint32_t events) {
+    epoll_event ev{};
+    ev.events = events;
+    ev.data.ptr = &conn;
+    epoll_ctl(_epoll_fd, EPOLL_CTL_MOD, conn.fd, &ev);
+  }
+
+  void http_engine::expire_requests() {
+    const auto now = std::chrono::steady_clock::now();
+    for (auto& c : _connections) {
+      if (!c->closed && c->request && c->request->deadline <= now) {
+        fail(*c, "Request timed out", false);
+      }
+    }
+    while (!_queue.empty() && _queue.front()->deadline <= now) {
+      auto p = std::move(_queue.front());
+      _queue.pop_front();
+      finish(p, "Request timed out waiting for a connection");
+    }
+  }
+
+  void http_engine::finish(std::unique_ptr<pending>& p, const std::string& error, http_engine_response* response) {
+    http_engine_response empty;
+    // The callback is user code, it must not take the engine thread down.
+    try {
+      p->callback(error, response != nullptr ? *response : empty);
+    }
+    catch (...) {}
+  }
+
+  void http_engine::fail_all(const std::string& error) {
+    for (auto& c : _connections) fail(*c, error, false);
+    _connections.clear();
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      for (auto& p : _submitted) _queue.push_back(std::move(p));
+      _submitted.clear();
+    }
+    for (auto& p : _queue) finish(p, error);
+    _queue.clear();
+  }
+}}
+#endif
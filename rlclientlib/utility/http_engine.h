@@ -0,0 +1,135 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+typedef struct ssl_ctx_st SSL_CTX;
+
+namespace reinforcement_learning {
+  class api_status;
+  class i_trace;
+namespace utility {
+  struct http_engine_options {
+    size_t max_connections = 16;
+    std::chrono::milliseconds timeout{ 30000 };
+    bool validate_certificates = true;
+  };
+
+  using http_header_list = std::vector<std::pair<std::string, std::string>>;
+
+  struct http_engine_request {
+    std::string method;
+    std::string target;             // origin form, e.g. /hub/messages?timeout=60
+    http_header_list headers;       // Host and Content-Length are added by the engine
+    const unsigned char* body = nullptr;
+    size_t body_size = 0;
+    std::shared_ptr<void> body_owner;  // keeps body alive until the callback has run
+  };
+
+  struct http_engine_response {
+    int status_code = 0;
+    http_header_list headers;
+    std::vector<unsigned char> body;
+  };
+
+  // Called once per request on the engine thread.  error is empty on success.
+  using http_engine_callback = std::function<void(const std::string& error, http_engine_response& response)>;
+
+  struct http_engine_stats {
+    uint64_t requests = 0;
+    uint64_t connections_opened = 0;
+    uint64_t connections_reused = 0;
+  };
+
+  // Minimal non-blocking HTTP/1.1 client for a single origin.  One thread drives all sockets with epoll, connections
+  // are kept alive and pooled up to max_connections, request heads and bodies go out with a single writev (or
+  // SSL_write for https) straight from the caller's memory.  The host name is resolved on a second thread, so a slow
+  // lookup never stalls the sockets, and the addresses are cached until a connect fails or they are a minute old.
+  // Linux only.
+  class http_engine {
+  public:
+    http_engine(const std::string& url, const http_engine_options& options, i_trace* trace);
+    ~http_engine();
+
+    http_engine(const http_engine&) = delete;
+    http_engine& operator=(const http_engine&) = delete;
+
+    // Parses the url, sets up TLS and starts the engine thread
+    int init(api_status* status);
+
+    void submit(http_engine_request request, http_engine_callback callback);
+
+    // Path and query of the url, the default request target
+    const std::string& target() const;
+    http_engine_stats get_stats() const;
+
+  private:
+    struct pending;
+    struct connection;
+    struct address_list;
+    enum class conn_state { connecting, handshaking, writing, reading, idle };
+
+    void run();
+    void resolve_loop();
+    void request_resolve();
+    void wake();
+    void dispatch();
+    void open_connection(std::unique_ptr<pending> request);
+    void start_request(connection& conn);
+    void on_event(connection& conn, uint32_t events);
+    bool handshake(connection& conn);
+    bool write(connection& conn);
+    bool read(connection& conn);
+    int parse(connection& conn, bool eof);
+    void complete(connection& conn);
+    void fail(connection& conn, const std::string& error, bool may_retry = true);
+    void close(connection& conn);
+    void watch(connection& conn, uint32_t events);
+    void expire_requests();
+    void fail_all(const std::string& error);
+    static void finish(std::unique_ptr<pending>& p, const std::string& error, http_engine_response* response = nullptr);
+
+  private:
+    const std::string _url;
+    const http_engine_options _options;
+    i_trace* _trace;
+
+    std::string _host;
+    std::string _port;
+    std::string _target;
+    std::string _host_header;
+    bool _tls = false;
+    SSL_CTX* _ssl_ctx = nullptr;
+
+    int _epoll_fd = -1;
+    int _wake_fd = -1;
+    std::thread _thread;
+    std::atomic<bool> _stop{ false };
+
+    std::mutex _mutex;
+    std::deque<std::unique_ptr<pending>> _submitted;  // guarded by _mutex
+
+    std::thread _resolver;
+    std::condition_variable _resolve_cv;
+    bool _resolve_requested = false;                       // guarded by _mutex
+    std::shared_ptr<const address_list> _latest_addresses; // guarded by _mutex, null until the first lookup is done
+
+    // Engine thread only
+    std::shared_ptr<const address_list> _addresses;
+    std::deque<std::unique_ptr<pending>> _queue;
+    std::list<std::unique_ptr<connection>> _connections;
+
+    std::atomic<uint64_t> _requests{ 0 };
+    std::atomic<uint64_t> _connections_opened{ 0 };
+    std::atomic<uint64_t> _connections_reused{ 0 };
+  };
+}}
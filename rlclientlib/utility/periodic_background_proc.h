@@ -4,6 +4,7 @@
 #include "api_status.h"
 #include "interruptable_sleeper.h"
 
+#include "utility/background_scheduler.h"
 #include "utility/watchdog.h"
 
 #include <thread>
@@ -21,9 +22,9 @@ namespace reinforcement_learning {
     template <typename BgProc>
     class periodic_background_proc {
     public:
-      // Construction and init
+      // Construction and init.  With a scheduler the iterations run on its workers instead of a thread of their own.
       explicit periodic_background_proc(const int interval_ms, utility::watchdog& watchdog,
-        std::string const& proc_name, error_callback_fn* perror_cb = nullptr);
+        std::string const& proc_name, error_callback_fn* perror_cb = nullptr, background_scheduler* scheduler = nullptr);
       int init(BgProc* bgproc, api_status* status = nullptr);
 
       // Shutdown and Destructor
@@ -39,6 +40,7 @@ namespace reinforcement_learning {
     private:
       // Implementation methods
       void time_loop();
+      void run_once();
 
     private:
       // Internal state
@@ -46,6 +48,8 @@ namespace reinforcement_learning {
       int _interval_ms;
       std::thread _background_thread;
       interruptable_sleeper _sleeper;
+      background_scheduler* _scheduler;
+      background_scheduler::task_id _task;
 
       watchdog& _watchdog;
       std::string _proc_name;
@@ -57,9 +61,11 @@ namespace reinforcement_learning {
 
     template <typename BgProc>
     periodic_background_proc<BgProc>::periodic_background_proc(const int interval_ms, watchdog& watchdog,
-      std::string const& proc_name, error_callback_fn* perror_cb)
+      std::string const& proc_name, error_callback_fn* perror_cb, background_scheduler* scheduler)
       : _thread_is_running {false},
         _interval_ms{interval_ms},
+        _scheduler(scheduler),
+        _task(0),
         _watchdog(watchdog),
         _proc_name(proc_name),
         _proc(nullptr),
@@ -74,7 +80,13 @@ namespace reinforcement_learning {
 
       _proc = bgproc;
 
-      if (!_thread_is_running) {
+      if (!_thread_is_running && _scheduler != nullptr) {
+        RETURN_IF_FAIL(_scheduler->init(status));
+        _thread_is_running = true;
+        _watchdog.register_task(this, _proc_name, static_cast<long long>(_interval_ms * timeout_grace_multiplier_c));
+        _task = _scheduler->add([this] { run_once(); }, std::chrono::milliseconds(_interval_ms));
+      }
+      else if (!_thread_is_running) {
         try {
           _thread_is_running = true;
           _background_thread = std::thread(&periodic_background_proc::time_loop, this);
@@ -89,7 +101,12 @@ namespace reinforcement_learning {
 
     template <typename BgProc>
     void periodic_background_proc<BgProc>::stop() {
-      if (_thread_is_running) {
+      if (_thread_is_running && _scheduler != nullptr) {
+        _thread_is_running = false;
+        _scheduler->remove(_task);
+        _watchdog.unregister_task(this);
+      }
+      else if (_thread_is_running) {
         _thread_is_running = false;
         _sleeper.interrupt();
 
@@ -123,5 +140,14 @@ namespace reinforcement_learning {
         // Cancelable sleep for interval
       } while (_sleeper.sleep(std::chrono::milliseconds(_interval_ms)));
     }
+
+    template <typename BGProc>
+    void periodic_background_proc<BGProc>::run_once() {
+      api_status status;
+      _watchdog.check_in(static_cast<void const*>(this));
+      if (_proc->run_iteration(&status) != error_code::success) {
+        ERROR_CALLBACK(_perror_cb, status);
+      }
+    }
   }
 }
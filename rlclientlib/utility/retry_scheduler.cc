@@ -0,0 +1,117 @@
+#include "retry_scheduler.h"
+
+#include <algorithm>
+
+namespace reinforcement_learning { namespace utility {
+  retry_policy::retry_policy(duration base_delay, duration max_delay, size_t budget, duration budget_window)
+    : _base_delay(base_delay)
+    , _max_delay((std::max)(base_delay, max_delay))
+    , _budget(budget)
+    , _budget_window(budget_window)
+    , _window_start(std::chrono::steady_clock::now())
+    , _rand(std::random_device{}())
+  {}
+
+  std::shared_ptr<retry_policy> retry_policy::immediate() {
+    return std::make_shared<retry_policy>(duration::zero(), duration::zero(), 0, duration::zero());
+  }
+
+  bool retry_policy::next_retry(duration previous, duration& delay) {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_budget > 0) {
+      const auto now = std::chrono::steady_clock::now();
+      if (now - _window_start >= _budget_window) {
+        _window_start = now;
+        _window_retries = 0;
+      }
+      if (_window_retries >= _budget) {
+        ++_stats.budget_exhausted;
+        return false;
+      }
+      ++_window_retries;
+    }
+
+    // Decorrelated jitter, grows from the previous delay rather than from the attempt number.
+    const auto low = _base_delay.count();
+    const auto high = (std::max)(low, 3 * (std::max)(previous, _base_delay).count());
+    std::uniform_int_distribution<long long> dist(low, high);
+    delay = (std::min)(_max_delay, duration(dist(_rand)));
+
+    ++_stats.retries;
+    _stats.total_delay_ms += delay.count();
+    return true;
+  }
+
+  retry_stats retry_policy::get_stats() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+  }
+
+  retry_scheduler::retry_scheduler() {
+    _thread = std::thread(&retry_scheduler::run, this);
+  }
+
+  retry_scheduler::~retry_scheduler() {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _cv.notify_all();
+    _thread.join();
+  }
+
+  void retry_scheduler::schedule(std::chrono::milliseconds delay, task_fn fn) {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _queue.push({ clock::now() + delay, _seq++, std::move(fn) });
+    }
+    _cv.notify_all();
+  }
+
+  size_t retry_scheduler::pending() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _queue.size();
+  }
+
+  void retry_scheduler::run() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+      if (_queue.empty()) {
+        if (_stop) return;
+        _cv.wait(lock);
+        continue;
+      }
+      if (!_stop && clock::now() < _queue.top().due) {
+        _cv.wait_until(lock, _queue.top().due);
+        continue;
+      }
+
+      {
+        auto fn = std::move(const_cast<item&>(_queue.top()).fn);
+        _queue.pop();
+        lock.unlock();
+        try {
+          fn();
+        }
+        catch (...) {
+          // Callbacks handle their own failures, the timer thread must keep going.
+        }
+      }
+      lock.lock();
+    }
+  }
+
+  std::shared_ptr<retry_scheduler> retry_scheduler::shared() {
+    static std::mutex mutex;
+    static std::weak_ptr<retry_scheduler> instance;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto scheduler = instance.lock();
+    if (!scheduler) {
+      scheduler = std::make_shared<retry_scheduler>();
+      instance = scheduler;
+    }
+    return scheduler;
+  }
+}}
@@ -0,0 +1,95 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace reinforcement_learning { namespace utility {
+  struct retry_stats {
+    uint64_t retries = 0;           // retries granted by the policy
+    uint64_t budget_exhausted = 0;  // retries refused because the budget of the current window was spent
+    uint64_t total_delay_ms = 0;    // sum of the backoff delays handed out
+  };
+
+  // Backoff and budget shared by all requests of one client.  Delays follow exponential backoff with decorrelated
+  // jitter: next = min(max_delay, random(base_delay, 3 * previous)), so clients that failed together spread out.
+  // At most budget retries are granted per budget_window, which caps the extra load sent to a struggling endpoint.
+  // Thread safe.
+  class retry_policy {
+  public:
+    using duration = std::chrono::milliseconds;
+
+    // A budget of 0 means unlimited retries.
+    retry_policy(duration base_delay, duration max_delay, size_t budget, duration budget_window);
+
+    // Retries right away with no budget, the behaviour before backoff was introduced.
+    static std::shared_ptr<retry_policy> immediate();
+
+    // Returns false if the budget is exhausted.  Otherwise sets delay from the previous delay of the same request,
+    // pass zero for the first retry.
+    bool next_retry(duration previous, duration& delay);
+
+    retry_stats get_stats();
+
+  private:
+    const duration _base_delay;
+    const duration _max_delay;
+    const size_t _budget;
+    const duration _budget_window;
+
+    std::mutex _mutex;
+    std::chrono::steady_clock::time_point _window_start;
+    size_t _window_retries = 0;
+    std::minstd_rand _rand;
+    retry_stats _stats;
+  };
+
+  // Delay queue running short callbacks on a single timer thread once they are due.  Callbacks are expected to
+  // only kick off the next asynchronous attempt, never to block, and must not hold the last reference to the
+  // scheduler.  A process wide instance is shared by every client so retries cost no pool thread while they wait.
+  class retry_scheduler {
+  public:
+    using task_fn = std::function<void()>;
+
+    retry_scheduler();
+    // Runs the remaining callbacks right away so that nobody waits on a retry that will never happen.
+    ~retry_scheduler();
+
+    retry_scheduler(const retry_scheduler&) = delete;
+    retry_scheduler& operator=(const retry_scheduler&) = delete;
+
+    void schedule(std::chrono::milliseconds delay, task_fn fn);
+    size_t pending();
+
+    // The instance lives as long as one client holds it.
+    static std::shared_ptr<retry_scheduler> shared();
+
+  private:
+    using clock = std::chrono::steady_clock;
+    struct item {
+      clock::time_point due;
+      uint64_t seq;
+      task_fn fn;
+    };
+    struct later {
+      bool operator()(const item& a, const item& b) const {
+        return a.due > b.due || (a.due == b.due && a.seq > b.seq);
+      }
+    };
+
+    void run();
+
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    std::priority_queue<item, std::vector<item>, later> _queue;
+    uint64_t _seq = 0;
+    bool _stop = false;
+    std::thread _thread;
+  };
+}}
@@ -0,0 +1,90 @@
+#include "timer_wheel.h"
+
+#include <algorithm>
+
+namespace reinforcement_learning { namespace utility {
+  const uint64_t timer_wheel::never;
+
+  timer_wheel::timer_wheel(uint64_t now) : _now(now) {}
+
+  timer_wheel::timer_id timer_wheel::schedule(uint64_t expires) {
+    const entry e{ _next_id++, (std::max)(expires, _now + 1) };
+    place(e);
+    return e.id;
+  }
+
+  bool timer_wheel::cancel(timer_id id) {
+    const auto it = _locations.find(id);
+    if (it == _locations.end()) return false;
+    _slots[it->second.level][it->second.slot].erase(it->second.it);
+    _locations.erase(it);
+    return true;
+  }
+
+  void timer_wheel::place(const entry& e) {
+    const auto delta = e.expires - _now;
+    int level = 0;
+    while (level < LEVELS - 1 && delta >= (uint64_t(1) << (SLOT_BITS * (level + 1)))) ++level;
+    // Beyond the last level the timer waits in the furthest slot and is placed again from there
+    const auto horizon = _now + (uint64_t(1) << (SLOT_BITS * LEVELS)) - 1;
+    const auto index = ((std::min)(e.expires, horizon) >> (SLOT_BITS * level)) & SLOT_MASK;
+    auto& s = _slots[level][index];
+    s.push_back(e);
+    _locations[e.id] = location{ level, index, std::prev(s.end()) };
+  }
+
+  void timer_wheel::cascade(int level) {
+    const auto index = (_now >> (SLOT_BITS * level)) & SLOT_MASK;
+    slot moving;
+    moving.swap(_slots[level][index]);
+    for (const auto& e : moving) {
+      _locations.erase(e.id);
+      place(e);
+    }
+  }
+
+  void timer_wheel::advance(uint64_t now, std::vector<timer_id>& expired) {
+    while (_now < now) {
+      ++_now;
+      // Higher levels first, their timers may land in the lower level slot cascading next
+      int top = 0;
+      while (top < LEVELS - 1 && ((_now >> (SLOT_BITS * (top + 1))) << (SLOT_BITS * (top + 1))) == _now) ++top;
+      for (int level = top; level > 0; --level) cascade(level);
+
+      auto& s = _slots[0][_now & SLOT_MASK];
+      for (const auto& e : s) {
+        expired.push_back(e.id);
+        _locations.erase(e.id);
+      }
+      s.clear();
+
+      // Nothing can happen before the next event, skip the empty ticks
+      if (_now < now) {
+        const auto next = next_event();
+        if (next > _now + 1) _now = (std::min)(next, now) - 1;
+      }
+    }
+  }
+
+  uint64_t timer_wheel::next_event() const {
+    if (_locations.empty()) return never;
+    uint64_t next = never;
+    for (uint64_t j = 1; j <= SLOTS; ++j) {
+      if (!_slots[0][(_now + j) & SLOT_MASK].empty()) {
+        next = _now + j;
+        break;
+      }
+    }
+    for (int level = 1; level < LEVELS; ++level) {
+      const auto shift = SLOT_BITS * level;
+      const auto base = _now >> shift;
+      for (uint64_t j = 1; j <= SLOTS; ++j) {
+        if (!_slots[level][(base + j) & SLOT_MASK].empty()) {
+          next = (std::min)(next, (base + j) << shift);
+          break;
+        }
+      }
+    }
+    return next;
+  }
+}}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+namespace reinforcement_learning { namespace utility {
+  // Hierarchical timing wheel: four levels of 64 slots, a slot of level n spans 64^n ticks.  Scheduling and
+  // cancelling are O(1), advancing costs one slot per tick plus the cascade of a higher level slot every 64 ticks.
+  // Timers further out than 64^4 ticks wait in the last level and are placed again when it comes around.
+  // Not thread safe.
+  class timer_wheel {
+  public:
+    using timer_id = uint64_t;
+    static const uint64_t never = UINT64_MAX;
+
+    explicit timer_wheel(uint64_t now = 0);
+
+    // Expires is an absolute tick, a tick that has passed expires on the next one
+    timer_id schedule(uint64_t expires);
+    bool cancel(timer_id id);
+
+    // Moves the wheel forward to now and appends the timers that expired, earliest first
+    void advance(uint64_t now, std::vector<timer_id>& expired);
+
+    // Earliest tick at which advance has work to do, an expiry or a cascade.  never when the wheel is empty.
+    uint64_t next_event() const;
+
+    uint64_t now() const { return _now; }
+    size_t size() const { return _locations.size(); }
+
+  private:
+    static const int LEVELS = 4;
+    static const int SLOT_BITS = 6;
+    static const uint64_t SLOTS = 1 << SLOT_BITS;
+    static const uint64_t SLOT_MASK = SLOTS - 1;
+
+    struct entry {
+      timer_id id;
+      uint64_t expires;
+    };
+    using slot = std::list<entry>;
+
+    struct location {
+      int level;
+      uint64_t slot;
+      slot::iterator it;
+    };
+
+    void place(const entry& e);
+    void cascade(int level);
+
+    uint64_t _now;
+    timer_id _next_id = 1;
+    slot _slots[LEVELS][SLOTS];
+    std::unordered_map<timer_id, location> _locations;
+  };
+}}
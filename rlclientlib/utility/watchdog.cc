@@ -18,10 +18,7 @@ watchdog::~watchdog() {
 
 void watchdog::register_thread(std::thread::id const& thread_id, std::string const& thread_name, long long const timeout) {
   std::lock_guard<std::mutex> lock(_watchdog_mutex);
-
-  // Watchdog timeout should reflect the thread with the tightest time requirement.
-  auto const long_long_duration = std::chrono::duration_cast<std::chrono::duration<long long>>(_timeout_in_ms);
-  _timeout_in_ms = std::chrono::milliseconds(std::min(timeout, long_long_duration.count()));
+  tighten_timeout(timeout);
 
   _thread_infos.emplace(thread_id, thread_info{
     thread_id,
@@ -35,6 +32,26 @@ void watchdog::register_thread(std::thread::id const& thread_id, std::string con
   _sleeper.interrupt();
 }
 
+void watchdog::register_task(void const* task, std::string const& task_name, long long const timeout) {
+  std::lock_guard<std::mutex> lock(_watchdog_mutex);
+  tighten_timeout(timeout);
+
+  _task_infos.emplace(task, thread_info{
+    std::thread::id(),
+    task_name,
+    clock_t::now(),
+    clock_t::now(),
+    std::chrono::milliseconds{ timeout }
+  });
+  _sleeper.interrupt();
+}
+
+void watchdog::tighten_timeout(long long const timeout) {
+  // Watchdog timeout should reflect the thread with the tightest time requirement.
+  auto const long_long_duration = std::chrono::duration_cast<std::chrono::duration<long long>>(_timeout_in_ms);
+  _timeout_in_ms = std::chrono::milliseconds(std::min(timeout, long_long_duration.count()));
+}
+
 void watchdog::unregister_thread(std::thread::id const& thread_id) {
   std::lock_guard<std::mutex> lock(_watchdog_mutex);
 
@@ -56,6 +73,21 @@ void watchdog::check_in(std::thread::id const& thread_id) {
   thread_info.last_check_in_time = clock_t::now();
 }
 
+void watchdog::unregister_task(void const* task) {
+  std::lock_guard<std::mutex> lock(_watchdog_mutex);
+  _task_infos.erase(task);
+}
+
+void watchdog::check_in(void const* task) {
+  std::lock_guard<std::mutex> lock(_watchdog_mutex);
+
+  auto const it = _task_infos.find(task);
+  if (it == _task_infos.end()) {
+    throw std::runtime_error(concat("Task ", task, " must be registered before being used."));
+  }
+  it->second.last_check_in_time = clock_t::now();
+}
+
 void watchdog::set_trace_log(i_trace* trace_logger) { _trace_logger = trace_logger; }
 
 int watchdog::start(api_status* status) {
@@ -88,22 +120,16 @@ void watchdog::loop() {
     // If enough time has passed to be beyond the timeout, check the state of all registered threads.
     // If a thread hasn't checking in during this timeout period it is assumed to be unresponsive and an error is generated.
     std::vector<std::string> failed_thread_names;
+    std::chrono::milliseconds timeout;
 
     {
       std::unique_lock<std::mutex> lock(_watchdog_mutex);
+      timeout = _timeout_in_ms;
       for (auto& kv : _thread_infos) {
-        auto& thread_info = kv.second;
-
-        thread_info.last_verify_time = clock_t::now();
-
-        if(thread_info.last_verify_time - thread_info.last_check_in_time > thread_info.timeout) {
-          if (_error_callback) {
-            failed_thread_names.push_back(thread_info.thread_name);
-          }
-          else {
-            set_unhandled_background_error(true);
-          }
-        }
+        verify(kv.second, failed_thread_names);
+      }
+      for (auto& kv : _task_infos) {
+        verify(kv.second, failed_thread_names);
       }
     }
 
@@ -115,7 +141,20 @@ void watchdog::loop() {
       _error_callback->report_error(status);
     }
 
-    _sleeper.sleep(std::chrono::milliseconds{ _timeout_in_ms });
+    _sleeper.sleep(timeout);
+  }
+}
+
+void watchdog::verify(thread_info& thread_info, std::vector<std::string>& failed_thread_names) {
+  thread_info.last_verify_time = clock_t::now();
+
+  if(thread_info.last_verify_time - thread_info.last_check_in_time > thread_info.timeout) {
+    if (_error_callback) {
+      failed_thread_names.push_back(thread_info.thread_name);
+    }
+    else {
+      set_unhandled_background_error(true);
+    }
   }
 }
 
@@ -2,6 +2,8 @@
 #include <thread>
 #include <map>
 #include <mutex>
+#include <string>
+#include <vector>
 
 #include "api_status.h"
 #include "error_callback_fn.h"
@@ -23,6 +25,11 @@ namespace reinforcement_learning {
       void unregister_thread(std::thread::id const& thread_id);
       void check_in(std::thread::id const& thread_id);
 
+      // Work that does not own a thread, such as a task on the background scheduler, is watched by its address
+      void register_task(void const* task, std::string const& task_name, long long const timeout);
+      void unregister_task(void const* task);
+      void check_in(void const* task);
+
       void set_trace_log(i_trace* trace_logger);
       int start(api_status* status);
       void stop();
@@ -48,6 +55,9 @@ namespace reinforcement_learning {
         std::chrono::milliseconds timeout;
       };
 
+      void tighten_timeout(long long const timeout);
+      void verify(thread_info& info, std::vector<std::string>& failed_thread_names);
+
       std::mutex _watchdog_mutex;
       interruptable_sleeper _sleeper;
       std::thread _watchdog_thread;
@@ -55,6 +65,7 @@ namespace reinforcement_learning {
 
       std::chrono::milliseconds _timeout_in_ms{10000};
       std::map<std::thread::id, thread_info> _thread_infos;
+      std::map<void const*, thread_info> _task_infos;
 
       error_callback_fn* _error_callback;
       std::atomic<bool> _unhandled_background_error_occurred{false};
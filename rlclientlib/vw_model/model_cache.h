@@ -0,0 +1,120 @@
+#pragma once
+#include <cstdint>
+#include <list>
+#include <string>
+#include <vector>
+
+namespace reinforcement_learning { namespace model_management {
+  // Keeps the most recently loaded model versions, newest first.  Entries are evicted oldest first once either the
+  // entry count or the byte budget is exceeded.  The newest and the active versions are always retained.
+  // !!!!THREAD-UNSAFE!!!! callers serialize access.
+  template<typename TModel>
+  class model_cache {
+    struct entry {
+      std::string version;
+      TModel model;
+      size_t bytes;
+    };
+
+  public:
+    model_cache(size_t max_count, size_t max_bytes)
+      : _max_count(max_count), _max_bytes(max_bytes)
+    {}
+
+    // Versions are "<model id>@<load sequence>", so that models carrying the same id, such as the default "N/A",
+    // are kept apart
+    static std::string make_version(const std::string& model_id, uint64_t sequence) {
+      return model_id + "@" + std::to_string(sequence);
+    }
+
+    // A version already in the cache is replaced and becomes the newest entry
+    void add(const std::string& version, TModel model, size_t bytes) {
+      erase(version);
+      _entries.push_front({ version, std::move(model), bytes });
+      _bytes += bytes;
+      evict();
+    }
+
+    bool get(const std::string& version, TModel& model) const {
+      const auto it = find(version);
+      if (it == _entries.end()) return false;
+      model = it->model;
+      return true;
+    }
+
+    // Returns the version loaded right before the given one
+    bool get_previous(const std::string& version, std::string& previous) const {
+      auto it = find(version);
+      if (it == _entries.end() || ++it == _entries.end()) return false;
+      previous = it->version;
+      return true;
+    }
+
+    // Returns the newest version loaded from a model with the given id
+    bool get_latest_of(const std::string& model_id, std::string& version) const {
+      for (const auto& e : _entries) {
+        if (e.version.substr(0, e.version.rfind('@')) == model_id) {
+          version = e.version;
+          return true;
+        }
+      }
+      return false;
+    }
+
+    bool get_latest(std::string& version) const {
+      if (_entries.empty()) return false;
+      version = _entries.front().version;
+      return true;
+    }
+
+    void set_active(const std::string& version) {
+      _active = version;
+      evict();
+    }
+
+    const std::string& active() const { return _active; }
+
+    std::vector<std::string> versions() const {
+      std::vector<std::string> result;
+      for (const auto& e : _entries) result.push_back(e.version);
+      return result;
+    }
+
+    size_t size() const { return _entries.size(); }
+    size_t bytes() const { return _bytes; }
+
+  private:
+    using iterator = typename std::list<entry>::const_iterator;
+
+    iterator find(const std::string& version) const {
+      for (auto it = _entries.begin(); it != _entries.end(); ++it) {
+        if (it->version == version) return it;
+      }
+      return _entries.end();
+    }
+
+    void erase(const std::string& version) {
+      const auto it = find(version);
+      if (it == _entries.end()) return;
+      _bytes -= it->bytes;
+      _entries.erase(it);
+    }
+
+    void evict() {
+      auto it = _entries.end();
+      while ((_entries.size() > _max_count || _bytes > _max_bytes) && it != _entries.begin()) {
+        --it;
+        if (it == _entries.begin() || it->version == _active) continue;
+        _bytes -= it->bytes;
+        it = _entries.erase(it);
+      }
+    }
+
+  private:
+    const size_t _max_count;
+    const size_t _max_bytes;
+    std::list<entry> _entries;
+    size_t _bytes = 0;
+    std::string _active;
+  };
+}}
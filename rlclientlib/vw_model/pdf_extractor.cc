@@ -0,0 +1,188 @@
+#include "pdf_extractor.h"
+#include "api_status.h"
+#include "err_constants.h"
+#include "trace_logger.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace reinforcement_learning { namespace model_management {
+  namespace {
+    const char* const MULTI_KEY = "_multi";
+    const char* const PDF_KEY = "p";
+
+    // Forward only scanner over a null terminated json string.  It understands just enough json to walk
+    // the root object and skip over values it is not interested in.
+    class json_scanner {
+    public:
+      explicit json_scanner(const char* json) : _begin(json), _pos(json) {}
+
+      void skip_ws() {
+        while (*_pos == ' ' || *_pos == '\t' || *_pos == '\n' || *_pos == '\r') ++_pos;
+      }
+
+      bool consume(char c) {
+        skip_ws();
+        if (*_pos != c) return false;
+        ++_pos;
+        return true;
+      }
+
+      bool peek(char c) {
+        skip_ws();
+        return *_pos == c;
+      }
+
+      // Reads a string token.  Escapes are skipped but not decoded since keys of interest contain none.
+      bool read_string(const char*& str, size_t& len) {
+        if (!consume('"')) return false;
+        str = _pos;
+        while (*_pos != '"') {
+          if (*_pos == '\0') return false;
+          if (*_pos == '\\' && *(++_pos) == '\0') return false;
+          ++_pos;
+        }
+        len = _pos - str;
+        ++_pos;
+        return true;
+      }
+
+      bool read_float(float& value) {
+        skip_ws();
+        char* end = nullptr;
+        value = std::strtof(_pos, &end);
+        if (end == _pos) return false;
+        _pos = end;
+        return true;
+      }
+
+      // Skip a complete value of any type.
+      bool skip_value() {
+        skip_ws();
+        if (*_pos == '"') {
+          const char* str;
+          size_t len;
+          return read_string(str, len);
+        }
+        if (*_pos == '{' || *_pos == '[') {
+          int depth = 0;
+          do {
+            switch (*_pos) {
+            case '\0': return false;
+            case '{': case '[': ++depth; ++_pos; break;
+            case '}': case ']': --depth; ++_pos; break;
+            case '"': {
+              const char* str;
+              size_t len;
+              if (!read_string(str, len)) return false;
+              break;
+            }
+            default: ++_pos;
+            }
+          } while (depth > 0);
+          return true;
+        }
+        // number, true, false or null
+        const char* const start = _pos;
+        while (*_pos != '\0' && *_pos != ',' && *_pos != '}' && *_pos != ']' &&
+          *_pos != ' ' && *_pos != '\t' && *_pos != '\n' && *_pos != '\r') ++_pos;
+        return _pos != start;
+      }
+
+      // Count the elements of an array without looking into them.
+      bool count_array(size_t& count) {
+        count = 0;
+        if (!consume('[')) return false;
+        if (consume(']')) return true;
+        do {
+          if (!skip_value()) return false;
+          ++count;
+        } while (consume(','));
+        return consume(']');
+      }
+
+      bool read_float_array(std::vector<float>& values) {
+        values.clear();
+        if (!consume('[')) return false;
+        if (consume(']')) return true;
+        do {
+          float value;
+          if (!read_float(value)) return false;
+          values.push_back(value);
+        } while (consume(','));
+        return consume(']');
+      }
+
+      size_t offset() const { return _pos - _begin; }
+
+    private:
+      const char* const _begin;
+      const char* _pos;
+    };
+
+    bool key_equals(const char* key, size_t len, const char* expected) {
+      return std::strlen(expected) == len && std::strncmp(key, expected, len) == 0;
+    }
+  }
+
+  int extract_pdf(const char* context, std::vector<int>& action_ids, std::vector<float>& action_pdf, i_trace* trace, api_status* status) {
+    if (context == nullptr) {
+      RETURN_ERROR_LS(trace, status, invalid_argument) << " (context)";
+    }
+
+    json_scanner scanner(context);
+    size_t action_count = 0;
+    bool multi_found = false;
+    bool pdf_found = false;
+
+    if (!scanner.consume('{')) {
+      RETURN_ERROR_LS(trace, status, json_parse_error) << " Expected '{' at offset " << scanner.offset();
+    }
+
+    if (!scanner.peek('}')) {
+      do {
+        const char* key;
+        size_t key_len;
+        if (!scanner.read_string(key, key_len) || !scanner.consume(':')) {
+          RETURN_ERROR_LS(trace, status, json_parse_error) << " Expected key at offset " << scanner.offset();
+        }
+
+        bool ok;
+        if (key_equals(key, key_len, MULTI_KEY) && scanner.peek('[')) {
+          ok = scanner.count_array(action_count);
+          multi_found = true;
+        }
+        else if (key_equals(key, key_len, PDF_KEY) && scanner.peek('[')) {
+          ok = scanner.read_float_array(action_pdf);
+          pdf_found = true;
+        }
+        else {
+          ok = scanner.skip_value();
+        }
+
+        if (!ok) {
+          RETURN_ERROR_LS(trace, status, json_parse_error) << " Malformed value at offset " << scanner.offset();
+        }
+      } while (scanner.consume(','));
+    }
+
+    if (!scanner.consume('}')) {
+      RETURN_ERROR_LS(trace, status, json_parse_error) << " Expected '}' at offset " << scanner.offset();
+    }
+
+    if (!pdf_found || action_pdf.empty()) {
+      RETURN_ERROR_LS(trace, status, json_no_pdf_found);
+    }
+
+    if (multi_found && action_count != action_pdf.size()) {
+      RETURN_ERROR_LS(trace, status, json_pdf_size_mismatch) << " Found " << action_count << " actions and " << action_pdf.size() << " probabilities";
+    }
+
+    action_ids.resize(action_pdf.size());
+    for (size_t i = 0; i < action_ids.size(); ++i) {
+      action_ids[i] = static_cast<int>(i);
+    }
+
+    return error_code::success;
+  }
+}}
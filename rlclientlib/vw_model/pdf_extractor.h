@@ -0,0 +1,23 @@
+#pragma once
+#include <vector>
+
+namespace reinforcement_learning {
+  class api_status;
+  class i_trace;
+}
+
+namespace reinforcement_learning { namespace model_management {
+  /**
+   * \brief Pull the passthrough pdf out of a dsjson context without running the VW parser.
+   *
+   * Only the root object is inspected: "_multi" gives the action count and "p" gives the pdf.  Every other
+   * field is skipped without being materialized.  The function keeps no state so it is safe to call from
+   * any number of threads concurrently.
+   *
+   * \param context    : Context json, e.g. {"_multi":[{...},{...}],"p":[0.4,0.6]}
+   * \param action_ids : Return value. Action ids in context order [0, 1, ..., n-1]
+   * \param action_pdf : Return value. Probability for each action
+   * \return error_code::success if there are no errors.  If there are errors then the error code is returned.
+   */
+  int extract_pdf(const char* context, std::vector<int>& action_ids, std::vector<float>& action_pdf, i_trace* trace, api_status* status = nullptr);
+}}
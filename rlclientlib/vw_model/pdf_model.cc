@@ -1,4 +1,5 @@
 #include "pdf_model.h"
+#include "pdf_extractor.h"
 #include "err_constants.h"
 #include "object_factory.h"
 #include "ranking_response.h"
@@ -7,10 +8,10 @@
 
 namespace reinforcement_learning { namespace model_management {
 
-  // We construct a VW object here to use the example parser to parse joined dsjson-style examples
-  // to extract the PDF.
+  // The PDF is pulled out of the dsjson context by extract_pdf, which holds no state and can be called
+  // concurrently from all request threads.
   pdf_model::pdf_model(i_trace* trace_logger, const utility::configuration&) :
-    _trace_logger(trace_logger), _vw(new safe_vw("--json --quiet --cb_adf"))
+    _trace_logger(trace_logger)
   { }
 
   int pdf_model::update(const model_data& data, bool& model_ready, api_status* status) {
@@ -28,7 +29,7 @@ namespace reinforcement_learning { namespace model_management {
     try
     {
       // Get a ranked list of action_ids and corresponding pdf
-      _vw->parse_context_with_pdf(features, action_ids, action_pdf);
+      RETURN_IF_FAIL(extract_pdf(features, action_ids, action_pdf, _trace_logger, status));
 
       model_version = _model_version.c_str();
 
@@ -1,16 +1,38 @@
 #include "safe_vw.h"
+#include "model_mgmt/byte_pipe.h"
 
 // VW headers
 #include "example.h"
+#include "io/io_adapter.h"
 #include "parse_example_json.h"
 #include "parser.h"
 #include "v_array.h"
 
 #include <iostream>
+#include <stdexcept>
 
 namespace reinforcement_learning {
   static const std::string SEED_TAG = "seed=";
 
+  namespace {
+    // Lets VW read model bytes straight from a byte_pipe, blocking until the transport delivers more.
+    class pipe_reader : public VW::io::reader {
+      model_management::byte_pipe& _pipe;
+
+    public:
+      explicit pipe_reader(model_management::byte_pipe& pipe)
+        : VW::io::reader(false), _pipe(pipe) {}
+
+      ssize_t read(char* buffer, size_t num_bytes) override {
+        const auto n = _pipe.read(buffer, num_bytes);
+        if (n < 0) {
+          throw std::runtime_error("Model stream failed: " + _pipe.error());
+        }
+        return static_cast<ssize_t>(n);
+      }
+    };
+  }
+
   safe_vw::safe_vw(const std::shared_ptr<safe_vw>& master) : _master(master)
   {
     _vw = VW::seed_vw_model(_master->_vw, "", nullptr, nullptr);
@@ -24,6 +46,14 @@ namespace reinforcement_learning {
     _vw = VW::initialize("--quiet --json", &buf, false, nullptr, nullptr);
   }
 
+  safe_vw::safe_vw(model_management::byte_pipe& model_stream)
+  {
+    io_buf buf;
+    buf.add_file(std::unique_ptr<VW::io::reader>(new pipe_reader(model_stream)));
+
+    _vw = VW::initialize("--quiet --json", &buf, false, nullptr, nullptr);
+  }
+
   safe_vw::safe_vw(std::string vw_commandline)
   {
 	  _vw = VW::initialize(vw_commandline);
@@ -238,9 +268,21 @@ namespace reinforcement_learning {
   }
 
 const char* safe_vw::id() const {
+  // The model id lives in the model file header, which seeded instances never read.
+  if (_master) {
+    return _master->id();
+  }
   return _vw->id.c_str();
 }
 
+size_t safe_vw::weights_bytes() const {
+  // Seeded instances share the weights of their master, sparse weights grow with the features seen
+  if (_master || _vw->weights.sparse) {
+    return 0;
+  }
+  return (static_cast<size_t>(_vw->weights.dense_weights.mask()) + 1) * sizeof(float);
+}
+
 enum class model_type_t
 {
   UNKNOWN,
@@ -321,9 +363,17 @@ safe_vw_factory::safe_vw_factory(const model_management::model_data&& master_dat
   : _master_data(master_data)
   {}
 
+safe_vw_factory::safe_vw_factory(const std::shared_ptr<safe_vw>& master)
+  : _master(master)
+  {}
+
   safe_vw* safe_vw_factory::operator()()
   {
-    if (_master_data.data())
+    if (_master)
+    {
+      return new safe_vw(_master);
+    }
+    else if (_master_data.data())
     {
       // Construct new vw object from raw model data.
       return new safe_vw(_master_data.data(), _master_data.data_sz());
@@ -19,6 +19,8 @@ namespace reinforcement_learning {
   public:
     safe_vw(const std::shared_ptr<safe_vw>& master);
     safe_vw(const char* model_data, size_t len);
+    // Loads the model while it is still being written to the pipe.  Throws if the pipe fails.
+    safe_vw(model_management::byte_pipe& model_stream);
     safe_vw(std::string vw_parameters);
 
     ~safe_vw();
@@ -31,6 +33,8 @@ namespace reinforcement_learning {
     void rank_slates_decisions(const char* event_id, uint32_t slot_count, const char* context, std::vector<std::vector<uint32_t>>& actions, std::vector<std::vector<float>>& scores);
 
     const char* id() const;
+    // Memory held by the weights of a loaded model, zero for seeded instances and sparse weights
+    size_t weights_bytes() const;
 
     bool is_compatible(const std::string& args) const;
 
@@ -40,12 +44,15 @@ namespace reinforcement_learning {
   class safe_vw_factory {
     model_management::model_data _master_data;
     std::string _command_line;
+    std::shared_ptr<safe_vw> _master;
 
   public:
     // model_data is copied and stored in the factory object.
     safe_vw_factory(const std::string& command_line);
     safe_vw_factory(const model_management::model_data& master_data);
     safe_vw_factory(const model_management::model_data&& master_data);
+    // Objects are seeded from an already loaded master and share its weights, so no model parsing is involved.
+    safe_vw_factory(const std::shared_ptr<safe_vw>& master);
 
     safe_vw* operator()();
   };
@@ -5,12 +5,17 @@
 #include "ranking_response.h"
 #include "trace_logger.h"
 #include "str_util.h"
+#include "model_mgmt/byte_pipe.h"
+
+#include <algorithm>
 
 namespace reinforcement_learning { namespace model_management {
 
   vw_model::vw_model(i_trace* trace_logger, const utility::configuration& config)
     : _initial_command_line(config.get(name::MODEL_VW_INITIAL_COMMAND_LINE, "--cb_explore_adf --json --quiet --epsilon 0.0 --first_only --id N/A"))
     , _vw_pool(new safe_vw_factory(_initial_command_line), config.get_int(name::VW_POOL_INIT_SIZE, value::DEFAULT_VW_POOL_INIT_SIZE))
+    , _cache(config.get_int(name::MODEL_CACHE_SIZE, value::DEFAULT_MODEL_CACHE_SIZE),
+        static_cast<size_t>(config.get_int(name::MODEL_CACHE_MAX_MB, value::DEFAULT_MODEL_CACHE_MAX_MB)) * 1024 * 1024)
     , _trace_logger(trace_logger) {
   }
 
@@ -20,17 +25,10 @@ namespace reinforcement_learning { namespace model_management {
 
       if (data.data_sz() > 0)
       {
-        std::unique_ptr<safe_vw_factory> factory(new safe_vw_factory(std::move(data)));
-        std::unique_ptr<safe_vw> test_vw((*factory)());
-        if (test_vw->is_compatible(_initial_command_line)) {
-          // safe_vw_factory will create a copy of the model data to use for vw object construction.
-          _vw_pool.update_factory(factory.release());
-          model_ready = true;
-        }
-        else {
-          RETURN_ERROR_LS(_trace_logger, status, model_update_error)
-            << "Received model is incompatible with initial configuration " << _initial_command_line;
-        }
+        // The model is parsed once into a master.  Pool objects, now and on any later rollback, are seeded from it.
+        vw_ptr master(new safe_vw(data.data(), data.data_sz()));
+        RETURN_IF_FAIL(add_master(master, data.data_sz(), status));
+        model_ready = true;
       }
     }
     catch(const std::exception& e) {
@@ -43,6 +41,99 @@ namespace reinforcement_learning { namespace model_management {
     return error_code::success;
   }
 
+  int vw_model::update_streamed(byte_pipe& pipe, bool& model_ready, api_status* status) {
+    try {
+      TRACE_INFO(_trace_logger, "Loading model while it downloads");
+      vw_ptr master(new safe_vw(pipe));
+
+      // Drain what vw did not consume so that the transport completes the download
+      char rest[4096];
+      int64_t n;
+      while ((n = pipe.read(rest, sizeof(rest))) > 0) {}
+      if (n < 0) {
+        RETURN_ERROR_LS(_trace_logger, status, model_update_error) << pipe.error();
+      }
+
+      TRACE_INFO(_trace_logger, utility::concat("Received new model data. With size ", pipe.bytes_read()));
+      RETURN_IF_FAIL(add_master(master, pipe.bytes_read(), status));
+      model_ready = true;
+    }
+    catch(const std::exception& e) {
+      RETURN_ERROR_LS(_trace_logger, status, model_update_error) << e.what();
+    }
+    catch ( ... ) {
+      RETURN_ERROR_LS(_trace_logger, status, model_update_error) << "Unknown error";
+    }
+
+    return error_code::success;
+  }
+
+  int vw_model::add_master(const vw_ptr& master, size_t bytes, api_status* status) {
+    if (!master->is_compatible(_initial_command_line)) {
+      RETURN_ERROR_LS(_trace_logger, status, model_update_error)
+        << "Received model is incompatible with initial configuration " << _initial_command_line;
+    }
+
+    // Dense weights are allocated whole, however few of them the model file carries.  The file size stands in for
+    // sparse weights and the rest of the model state.
+    const size_t loaded_bytes = (std::max)(bytes, master->weights_bytes());
+
+    std::lock_guard<std::mutex> lock(_cache_mutex);
+    const auto version = model_cache<vw_ptr>::make_version(master->id(), ++_load_sequence);
+    _cache.add(version, master, loaded_bytes);
+    if (_pinned) {
+      TRACE_INFO(_trace_logger, utility::concat("Model version ", version, " cached. Active version stays pinned to ", _cache.active()));
+      return error_code::success;
+    }
+    return activate(version, status);
+  }
+
+  int vw_model::pin_version(const char* version, api_status* status) {
+    std::lock_guard<std::mutex> lock(_cache_mutex);
+    // A model id as reported in the ranking response selects the newest version loaded from that model
+    std::string cached = version;
+    vw_ptr master;
+    if (!_cache.get(cached, master)) {
+      _cache.get_latest_of(version, cached);
+    }
+    RETURN_IF_FAIL(activate(cached, status));
+    _pinned = true;
+    return error_code::success;
+  }
+
+  int vw_model::unpin_version(api_status* status) {
+    std::lock_guard<std::mutex> lock(_cache_mutex);
+    _pinned = false;
+    std::string latest;
+    if (_cache.get_latest(latest) && latest != _cache.active()) {
+      RETURN_IF_FAIL(activate(latest, status));
+    }
+    return error_code::success;
+  }
+
+  int vw_model::get_versions(std::vector<std::string>& versions, std::string& active_version, api_status* status) {
+    std::lock_guard<std::mutex> lock(_cache_mutex);
+    versions = _cache.versions();
+    active_version = _cache.active();
+    return error_code::success;
+  }
+
+  int vw_model::activate(const std::string& version, api_status* status) {
+    vw_ptr master;
+    if (!_cache.get(version, master)) {
+      RETURN_ERROR_LS(_trace_logger, status, model_version_not_cached) << version;
+    }
+    try {
+      // Objects checked out from the previous pool are discarded when they are returned.
+      _vw_pool.update_factory(new safe_vw_factory(master));
+    }
+    catch (const std::exception& e) {
+      RETURN_ERROR_LS(_trace_logger, status, model_update_error) << e.what();
+    }
+    _cache.set_active(version);
+    return error_code::success;
+  }
+
   int vw_model::choose_rank(
     uint64_t rnd_seed,
     const char* features,
@@ -1,8 +1,11 @@
 #pragma once
 #include "model_mgmt.h"
 #include "safe_vw.h"
+#include "model_cache.h"
 #include "../utility/versioned_object_pool.h"
 
+#include <mutex>
+
 namespace reinforcement_learning {
   class i_trace;
   namespace utility {
@@ -16,16 +19,33 @@ namespace reinforcement_learning { namespace model_management {
     vw_model(i_trace* trace_logger, const utility::configuration& config);
 
     int update(const model_data& data, bool& model_ready, api_status* status = nullptr) override;
+    int update_streamed(byte_pipe& pipe, bool& model_ready, api_status* status = nullptr) override;
     int choose_rank(uint64_t rnd_seed, const char* features, std::vector<int>& action_ids, std::vector<float>& action_pdf, std::string& model_version, api_status* status = nullptr) override;
     int request_decision(const std::vector<const char*>& event_ids, const char* features, std::vector<std::vector<uint32_t>>& actions_ids, std::vector<std::vector<float>>& action_pdfs, std::string& model_version, api_status* status = nullptr) override;
     int request_slates_decision(const char *event_id, uint32_t slot_count, const char* features, std::vector<std::vector<uint32_t>>& actions_ids, std::vector<std::vector<float>>& action_pdfs, std::string& model_version, api_status* status = nullptr) override;
+    int pin_version(const char* version, api_status* status = nullptr) override;
+    int unpin_version(api_status* status = nullptr) override;
+    int get_versions(std::vector<std::string>& versions, std::string& active_version, api_status* status = nullptr) override;
+
+  private:
+    using vw_ptr = std::shared_ptr<safe_vw>;
+
+    // Caches a freshly loaded master and activates it unless a version is pinned
+    int add_master(const vw_ptr& master, size_t bytes, api_status* status);
+    // Swaps the pool over to a cached version.  Caller holds _cache_mutex.
+    int activate(const std::string& version, api_status* status);
 
   private:
     const std::string _initial_command_line;
 
-    using vw_ptr = std::shared_ptr<safe_vw>;
     using pooled_vw = utility::pooled_object_guard<safe_vw, safe_vw_factory>;
     utility::versioned_object_pool<safe_vw, safe_vw_factory> _vw_pool;
+
+    // Loaded masters of recent model versions.  Pool objects are seeded from the active master.
+    std::mutex _cache_mutex;
+    model_cache<vw_ptr> _cache;
+    bool _pinned = false;
+    uint64_t _load_sequence = 0;
     i_trace* _trace_logger;
   };
 }}
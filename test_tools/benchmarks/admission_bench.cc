@@ -0,0 +1,155 @@
+#include "benchmarks.h"
+#include "bench_util.h"
+
+#include "explore_internal.h"
+#include "hash.h"
+#include "logger/event_queue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace r = reinforcement_learning;
+namespace po = boost::program_options;
+
+namespace {
+  const size_t EVENT_SIZE = 100;
+  const size_t QUEUE_CAPACITY = 4 * 1024 * 1024;
+  const size_t DRAIN_PER_MS = 2000;  // what the sender keeps up with, 2M events/s
+
+  class bench_event : public r::event {
+  public:
+    bench_event() {}
+    explicit bench_event(const std::string& id) : event(id.c_str(), r::timestamp{}) {}
+    bench_event(bench_event&& other) : event(std::move(other)) {}
+    bench_event& operator=(bench_event&& other) {
+      if (&other != this) event::operator=(std::move(other));
+      return *this;
+    }
+
+    // The drop decision the queue used to make for every queued event on each prune pass
+    bool try_drop_pass(float pass_prob, int drop_pass) {
+      _pass_prob *= pass_prob;
+      const auto seed_str = _seed_id + std::to_string(drop_pass);
+      const auto seed = uniform_hash(seed_str.c_str(), seed_str.length(), 0);
+      return exploration::uniform_random_merand48(seed) > pass_prob;
+    }
+  };
+
+  // The queue as it was: append everything, and once full walk the whole list dropping each event with probability 1/2
+  class prune_queue {
+  public:
+    void push(bench_event&& evt) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _capacity += EVENT_SIZE;
+      _queue.push_back(std::move(evt));
+      if (_capacity < QUEUE_CAPACITY) return;
+      for (auto it = _queue.begin(); it != _queue.end();) {
+        if (it->try_drop_pass(0.5f, _drop_pass)) {
+          _capacity -= EVENT_SIZE;
+          it = _queue.erase(it);
+          ++_dropped;
+        }
+        else ++it;
+      }
+      ++_drop_pass;
+    }
+
+    bool pop(bench_event* evt) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (_queue.empty()) return false;
+      *evt = std::move(_queue.front());
+      _queue.pop_front();
+      _capacity -= EVENT_SIZE;
+      return true;
+    }
+
+    size_t dropped() {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return _dropped;
+    }
+
+  private:
+    std::mutex _mutex;
+    std::list<bench_event> _queue;
+    size_t _capacity = 0;
+    size_t _dropped = 0;
+    int _drop_pass = 0;
+  };
+
+  class admission_queue {
+  public:
+    void push(bench_event&& evt) { _queue.try_push(std::move(evt), EVENT_SIZE); }
+    bool pop(bench_event* evt) { return _queue.pop(evt); }
+    size_t dropped() { return _queue.shed_count(); }
+
+  private:
+    r::event_queue<bench_event> _queue{ QUEUE_CAPACITY };
+  };
+
+  // Producers append as fast as they can while a sender drains at a fixed rate, so the queue stays overloaded
+  template <typename Queue>
+  void run(const char* name, size_t threads, size_t iterations) {
+    Queue queue;
+    std::atomic<bool> done{ false };
+    size_t sent = 0;
+    double pass_prob_sum = 0;
+    std::thread sender([&] {
+      bench_event evt;
+      auto next = bench::bench_clock::now();
+      while (!done) {
+        for (size_t i = 0; i < DRAIN_PER_MS && queue.pop(&evt); ++i) {
+          ++sent;
+          pass_prob_sum += 1 / evt.get_pass_prob();
+        }
+        next += std::chrono::milliseconds(1);
+        std::this_thread::sleep_until(next);
+      }
+      while (queue.pop(&evt)) {
+        ++sent;
+        pass_prob_sum += 1 / evt.get_pass_prob();
+      }
+    });
+
+    std::vector<std::vector<long long>> samples(threads);
+    const auto duration = bench::run_threads(threads, [&](size_t t) {
+      auto& mine = samples[t];
+      mine.reserve(iterations);
+      const auto prefix = "event-" + std::to_string(t) + "-";
+      for (size_t i = 0; i < iterations; ++i) {
+        bench_event evt(prefix + std::to_string(i));
+        const auto start = bench::bench_clock::now();
+        queue.push(std::move(evt));
+        mine.push_back(bench::elapsed_us(start));
+      }
+    });
+    done = true;
+    sender.join();
+
+    std::vector<long long> all;
+    for (auto& s : samples) all.insert(all.end(), s.begin(), s.end());
+    const auto total = threads * iterations;
+    bench::report(name, threads, total, duration);
+    bench::report_latency(name, threads, all);
+    std::cout << "  kept: " << sent << " dropped: " << queue.dropped()
+      << " weighted count (sum of 1/pass_prob): " << static_cast<size_t>(pass_prob_sum) << " of " << total << std::endl;
+  }
+}
+
+int admission_bench(const po::variables_map& vm) {
+  const auto max_threads = vm["threads"].as<size_t>();
+  const auto iterations = vm["iterations"].as<size_t>() * 10;
+  std::cout << "Queue of " << QUEUE_CAPACITY / EVENT_SIZE << " events drained at " << DRAIN_PER_MS * 1000
+    << " events/s, producers append " << iterations << " events each" << std::endl;
+  for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+    run<prune_queue>("prune when full", threads, iterations);
+    run<admission_queue>("admission control", threads, iterations);
+  }
+  return 0;
+}
@@ -0,0 +1,208 @@
+#include "benchmarks.h"
+#include "bench_util.h"
+
+#include "err_constants.h"
+#include "logger/async_batcher.h"
+#include "utility/watchdog.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace r = reinforcement_learning;
+namespace l = reinforcement_learning::logger;
+namespace u = reinforcement_learning::utility;
+namespace po = boost::program_options;
+
+namespace {
+  class bench_event : public r::event {
+  public:
+    bench_event() {}
+    explicit bench_event(const std::string& id) : event(id.c_str(), r::timestamp{}) {}
+    bench_event(bench_event&& other) : event(std::move(other)) {}
+    bench_event& operator=(bench_event&& other) {
+      if (&other != this) event::operator=(std::move(other));
+      return *this;
+    }
+  };
+}
+
+namespace reinforcement_learning { namespace logger {
+  template <>
+  struct json_event_serializer<bench_event> {
+    using serializer_t = json_event_serializer<bench_event>;
+    static int serialize(bench_event& evt, std::ostream& out, api_status*) {
+      out << evt.get_seed_id();
+      return error_code::success;
+    }
+    static size_t size_estimate(const bench_event& evt) { return evt.get_seed_id().size(); }
+  };
+}}
+
+namespace {
+  const size_t EVENT_SIZE = 200;
+  // The simulated sink: a fixed cost per request plus the transfer at 1 MB/s, one request at a time
+  const std::chrono::milliseconds SEND_OVERHEAD(5);
+  const size_t BYTES_PER_MS = 1024;
+  // Requests in flight at most, like the tasks limit of eventhub_client
+  const size_t WINDOW = 4;
+
+  struct phase {
+    const char* name;
+    size_t events_per_sec;
+    std::chrono::milliseconds duration;
+  };
+  const phase PHASES[] = {
+    { "quiet", 200, std::chrono::milliseconds(3000) },
+    { "peak", 3000, std::chrono::milliseconds(5000) },
+    { "quiet", 200, std::chrono::milliseconds(3000) },
+  };
+
+  struct send_log {
+    std::mutex mutex;
+    std::vector<long long> latencies_us;
+    size_t bytes = 0;
+  };
+
+  // Asynchronous like eventhub_client: send takes a slot of the in-flight window, waiting while all are taken, and
+  // returns.  The requests complete later, in order, on the simulated link.  The latency of a request runs from its
+  // send to its completion, so it includes waiting for the requests ahead of it.
+  class simulated_sender : public l::i_message_sender {
+  public:
+    explicit simulated_sender(send_log& log) : _log(log), _link([this] { run_link(); }) {}
+
+    ~simulated_sender() {
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+      }
+      _changed.notify_all();
+      _link.join();
+    }
+
+    int send(const uint16_t, const buffer& db, r::api_status*) override {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _changed.wait(lock, [this] { return _requests.size() < WINDOW; });
+      _requests.push_back({ db->body_filled_size(), bench::bench_clock::now() });
+      _changed.notify_all();
+      return r::error_code::success;
+    }
+    int init(r::api_status*) override { return r::error_code::success; }
+
+    float window_occupancy() const override {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return static_cast<float>(_requests.size()) / WINDOW;
+    }
+    std::chrono::microseconds completion_latency() const override {
+      return std::chrono::microseconds(_completion_latency_us.load());
+    }
+
+  private:
+    struct request {
+      size_t bytes;
+      bench::bench_clock::time_point start;
+    };
+
+    void run_link() {
+      std::unique_lock<std::mutex> lock(_mutex);
+      while (true) {
+        _changed.wait(lock, [this] { return _stop || !_requests.empty(); });
+        if (_requests.empty()) return;
+        const auto next = _requests.front();
+        lock.unlock();
+        std::this_thread::sleep_for(SEND_OVERHEAD + std::chrono::milliseconds(next.bytes / BYTES_PER_MS));
+        const auto latency = bench::elapsed_us(next.start);
+        const auto smoothed = _completion_latency_us.load();
+        _completion_latency_us = smoothed < 0 ? latency : (3 * smoothed + latency) / 4;
+        {
+          std::lock_guard<std::mutex> log_lock(_log.mutex);
+          _log.latencies_us.push_back(latency);
+          _log.bytes += next.bytes;
+        }
+        lock.lock();
+        // The slot is freed once the request completed
+        _requests.pop_front();
+        _changed.notify_all();
+      }
+    }
+
+    send_log& _log;
+    mutable std::mutex _mutex;
+    std::condition_variable _changed;
+    std::deque<request> _requests;
+    std::atomic<long long> _completion_latency_us{ -1 };
+    bool _stop = false;
+    std::thread _link;
+  };
+
+  // One producer paced through the phases, printing the batching state every half second
+  void run(const char* name, const l::batch_controller_options* adaptive) {
+    using batcher = l::async_batcher<bench_event>;
+    u::watchdog watchdog(nullptr);
+    send_log log;
+    r::queue_pressure last;
+    std::cout << name << std::endl
+      << "  time(s)  phase   batch(KB)  interval(ms)  send(ms)  fill" << std::endl;
+    {
+      batcher logger(new simulated_sender(log), watchdog, nullptr, 198 * 1024, 1000, 16 * 1024 * 1024, r::DROP,
+        nullptr, l::logging_priority::interaction, nullptr, nullptr, 1000, adaptive);
+      logger.init(nullptr);
+
+      const std::string padding(EVENT_SIZE - 16, 'x');
+      const auto start = bench::bench_clock::now();
+      auto phase_start = start;
+      auto next_report = start + std::chrono::milliseconds(500);
+      size_t sent = 0;
+      for (const auto& p : PHASES) {
+        const auto phase_end = phase_start + p.duration;
+        size_t phase_sent = 0;
+        for (auto now = bench::bench_clock::now(); now < phase_end; now = bench::bench_clock::now()) {
+          const auto due = static_cast<size_t>(std::chrono::duration_cast<std::chrono::milliseconds>(now - phase_start).count())
+            * p.events_per_sec / 1000;
+          for (; phase_sent < due; ++phase_sent, ++sent) {
+            logger.append(bench_event(std::to_string(sent) + padding));
+          }
+          if (now >= next_report) {
+            last = logger.get_pressure();
+            std::cout << "  " << std::right << std::setw(7) << std::fixed << std::setprecision(1)
+              << std::chrono::duration_cast<std::chrono::milliseconds>(now - start).count() / 1000.0
+              << "  " << std::setw(5) << p.name
+              << "  " << std::setw(9) << last.batch_size / 1024
+              << "  " << std::setw(12) << last.batch_interval_ms
+              << "  " << std::setw(8) << std::setprecision(1) << last.send_latency_us / 1000.0
+              << "  " << std::setprecision(2) << last.fill_ratio << std::endl;
+            next_report += std::chrono::milliseconds(500);
+          }
+          std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        phase_start = phase_end;
+      }
+    }
+
+    auto& latencies = log.latencies_us;
+    std::cout << "  batches: " << latencies.size()
+      << " mean batch KB: " << (latencies.empty() ? 0 : log.bytes / latencies.size() / 1024)
+      << " dropped: " << last.dropped
+      << " adjustments: " << last.batching_adjustments << std::endl;
+    bench::report_latency(std::string(name) + " send", 1, latencies);
+  }
+}
+
+int batching_bench(const po::variables_map&) {
+  std::cout << "Simulated asynchronous sender: " << SEND_OVERHEAD.count() << "ms per request plus " << BYTES_PER_MS
+    << " bytes/ms, " << WINDOW << " requests in flight, " << EVENT_SIZE << " byte events at 200/s, 3000/s then 200/s"
+    << std::endl;
+  run("fixed 198KB / 1000ms", nullptr);
+
+  l::batch_controller_options adaptive;
+  adaptive.target_latency = std::chrono::milliseconds(100);
+  run("adaptive, 100ms target latency", &adaptive);
+  return 0;
+}
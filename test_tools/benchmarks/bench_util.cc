@@ -0,0 +1,46 @@
+#include "bench_util.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace bench {
+  long long run_threads(size_t threads, const std::function<void(size_t)>& fn) {
+    std::vector<std::thread> workers;
+    const auto start = bench_clock::now();
+    for (size_t t = 0; t < threads; ++t) {
+      workers.emplace_back(fn, t);
+    }
+    for (auto& w : workers) {
+      w.join();
+    }
+    return elapsed_us(start);
+  }
+
+  long long elapsed_us(const bench_clock::time_point& start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(bench_clock::now() - start).count();
+  }
+
+  void report(const std::string& name, size_t threads, size_t ops, long long duration_us) {
+    const double ops_per_sec = duration_us > 0 ? (static_cast<double>(ops) * 1000000) / duration_us : 0;
+    std::cout << std::left << std::setw(32) << name
+      << " threads: " << std::setw(4) << threads
+      << " ops: " << std::setw(10) << ops
+      << " time(us): " << std::setw(12) << duration_us
+      << " ops/s: " << std::fixed << std::setprecision(0) << ops_per_sec << std::endl;
+  }
+
+  void report_latency(const std::string& name, size_t threads, std::vector<long long>& samples_us) {
+    if (samples_us.empty()) return;
+    std::sort(samples_us.begin(), samples_us.end());
+    const auto at = [&samples_us](double q) { return samples_us[static_cast<size_t>(q * (samples_us.size() - 1))]; };
+    std::cout << std::left << std::setw(32) << name
+      << " threads: " << std::setw(4) << threads
+      << " p50(us): " << std::setw(10) << at(0.5)
+      << " p99(us): " << std::setw(10) << at(0.99)
+      << " p99.9(us): " << std::setw(10) << at(0.999)
+      << " max(us): " << samples_us.back() << std::endl;
+  }
+}
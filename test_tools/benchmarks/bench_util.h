@@ -0,0 +1,22 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace bench {
+  using bench_clock = std::chrono::high_resolution_clock;
+
+  // Run fn(thread_index) on the given number of threads and return the wall time in microseconds.
+  long long run_threads(size_t threads, const std::function<void(size_t)>& fn);
+
+  // Elapsed microseconds since start.
+  long long elapsed_us(const bench_clock::time_point& start);
+
+  // Print one row of a result table.  ops_per_sec is computed from ops and duration_us.
+  void report(const std::string& name, size_t threads, size_t ops, long long duration_us);
+
+  // Print p50, p99, p99.9 and max of latency samples in microseconds.  Sorts the samples.
+  void report_latency(const std::string& name, size_t threads, std::vector<long long>& samples_us);
+}
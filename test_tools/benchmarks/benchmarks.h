@@ -0,0 +1,22 @@
+#pragma once
+#include <boost/program_options.hpp>
+
+// Each benchmark receives the parsed command line and returns 0 on success.
+int pdf_model_bench(const boost::program_options::variables_map& vm);
+int model_cache_bench(const boost::program_options::variables_map& vm);
+int model_download_bench(const boost::program_options::variables_map& vm);
+int model_stream_bench(const boost::program_options::variables_map& vm);
+int admission_bench(const boost::program_options::variables_map& vm);
+int batching_bench(const boost::program_options::variables_map& vm);
+int body_copy_bench(const boost::program_options::variables_map& vm);
+int coalesce_bench(const boost::program_options::variables_map& vm);
+int compression_bench(const boost::program_options::variables_map& vm);
+int eventhub_bench(const boost::program_options::variables_map& vm);
+int eventhub_shards_bench(const boost::program_options::variables_map& vm);
+int http_retry_bench(const boost::program_options::variables_map& vm);
+int http_client_bench(const boost::program_options::variables_map& vm);
+int logging_engine_bench(const boost::program_options::variables_map& vm);
+int scheduler_bench(const boost::program_options::variables_map& vm);
+int file_sender_bench(const boost::program_options::variables_map& vm);
+int shm_ring_bench(const boost::program_options::variables_map& vm);
+int stream_sender_bench(const boost::program_options::variables_map& vm);
@@ -0,0 +1,163 @@
+#include "benchmarks.h"
+#include "bench_util.h"
+
+#include "utility/data_buffer_streambuf.h"
+#include "utility/http_client.h"
+#include "utility/stl_container_adapter.h"
+
+#include <cpprest/containerstream.h>
+
+#ifdef __linux__
+#include "configuration.h"
+#include "err_constants.h"
+#include "utility/epoll_http_client.h"
+#include "loopback_http_server.h"
+
+#include <sys/resource.h>
+#endif
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace r = reinforcement_learning;
+namespace u = reinforcement_learning::utility;
+namespace po = boost::program_options;
+
+namespace {
+  const size_t BATCH_SIZE = 256 * 1024;
+  // Chunk size cpprest uses to move request bodies into its socket buffers
+  const size_t CHUNK_SIZE = 64 * 1024;
+
+  // Stands in for the HTTP layer and counts the body bytes copied on their way to the socket.  Stream bodies are
+  // drained chunk by chunk like cpprest does.
+  class copy_counting_client : public r::i_http_client {
+  public:
+    copy_counting_client() : _chunk(CHUNK_SIZE) {}
+
+    response_t request(method_t method) override {
+      request_t req(method);
+      return request(req);
+    }
+
+    response_t request(request_t req) override {
+      auto body = req.body().streambuf();
+      size_t read;
+      while ((read = body.getn(_chunk.data(), _chunk.size()).get()) > 0) {
+        copied += read;
+        sent += read;
+      }
+      return response_t::task_from_result(web::http::http_response(web::http::status_codes::Created));
+    }
+
+    const std::string& get_url() const override { return _url; }
+
+    size_t copied = 0;
+    size_t sent = 0;
+
+  private:
+    std::vector<uint8_t> _chunk;
+    const std::string _url = "http://localhost/eventhub";
+  };
+
+  void report_copies(const char* name, const copy_counting_client& client, size_t batches, long long duration_us) {
+    bench::report(name, 1, batches, duration_us);
+    std::cout << "  bytes copied per MB sent: " << (client.sent > 0 ? client.copied * 1024 * 1024 / client.sent : 0)
+      << " MB/s: " << (duration_us > 0 ? static_cast<double>(client.sent) / duration_us : 0) << std::endl;
+  }
+
+#ifdef __linux__
+  long long cpu_us() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000LL + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+  }
+
+  // Posts the batch through a real client to a loopback server, the CPU time includes the server threads
+  void run_loopback(const char* name, const std::function<void()>& post, size_t batches, size_t batch_bytes) {
+    const auto cpu_start = cpu_us();
+    const auto start = bench::bench_clock::now();
+    for (size_t i = 0; i < batches; ++i) {
+      post();
+    }
+    const auto duration_us = bench::elapsed_us(start);
+    const auto cpu = cpu_us() - cpu_start;
+    bench::report(name, 1, batches, duration_us);
+    std::cout << "  MB/s: " << (duration_us > 0 ? static_cast<double>(batches * batch_bytes) / duration_us : 0)
+      << " CPU us per request: " << static_cast<double>(cpu) / batches << std::endl;
+  }
+#endif
+}
+
+// Bytes copied per MB of request bodies for the container stream used before and the raw pointer stream used by
+// default now.  On Linux the same bodies are then posted to a loopback server through the cpprest client, with
+// both stream bodies, and through the epoll client, which writes the batch buffer to the socket where it is.  The
+// cpprest client copies every body into its own send buffer either way, which the copy counts above leave out.
+int body_copy_bench(const po::variables_map& vm) {
+  const auto batches = (std::min)(vm["iterations"].as<size_t>(), size_t(4000));
+
+  auto db = std::make_shared<u::data_buffer>();
+  {
+    std::vector<char> payload(BATCH_SIZE, 'x');
+    u::data_buffer_streambuf sbuff(db.get());
+    std::ostream message(&sbuff);
+    message.write(payload.data(), payload.size());
+    sbuff.finalize();
+  }
+
+  {
+    copy_counting_client client;
+    const auto start = bench::bench_clock::now();
+    for (size_t i = 0; i < batches; ++i) {
+      web::http::http_request request(web::http::methods::POST);
+      u::stl_container_adapter container(db.get());
+      request.set_body(concurrency::streams::bytestream::open_istream(container), container.size());
+      client.request(request).get();
+    }
+    report_copies("container stream body (before)", client, batches, bench::elapsed_us(start));
+  }
+
+  {
+    copy_counting_client client;
+    const auto start = bench::bench_clock::now();
+    for (size_t i = 0; i < batches; ++i) {
+      client.request_with_body(web::http::http_request(web::http::methods::POST), db).get();
+    }
+    report_copies("raw pointer stream body", client, batches, bench::elapsed_us(start));
+  }
+
+#ifdef __linux__
+  const auto loopback_batches = (std::min)(batches, size_t(1000));
+  const auto batch_bytes = db->buffer_filled_size();
+  {
+    bench::loopback_http_server server;
+    u::configuration cfg;
+    r::http_client client(server.url().c_str(), cfg);
+    run_loopback("cpprest, container stream body", [&] {
+      web::http::http_request request(web::http::methods::POST);
+      u::stl_container_adapter container(db.get());
+      request.set_body(concurrency::streams::bytestream::open_istream(container), container.size());
+      client.request(request).get();
+    }, loopback_batches, batch_bytes);
+    run_loopback("cpprest, raw pointer stream body", [&] {
+      client.request_with_body(web::http::http_request(web::http::methods::POST), db).get();
+    }, loopback_batches, batch_bytes);
+  }
+  {
+    bench::loopback_http_server server;
+    u::configuration cfg;
+    r::epoll_http_client client(server.url().c_str(), cfg, nullptr);
+    if (client.init(nullptr) != r::error_code::success) {
+      std::cerr << "epoll_http_client init failed" << std::endl;
+      return -1;
+    }
+    run_loopback("epoll client, contiguous body", [&] {
+      client.request_with_body(web::http::http_request(web::http::methods::POST), db).get();
+    }, loopback_batches, batch_bytes);
+  }
+#endif
+
+  return 0;
+}
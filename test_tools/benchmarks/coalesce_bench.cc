@@ -0,0 +1,126 @@
+#include "benchmarks.h"
+#include "bench_util.h"
+
+#include "err_constants.h"
+#include "logger/coalescing_sender.h"
+#include "logger/preamble.h"
+#include "utility/data_buffer_streambuf.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace r = reinforcement_learning;
+namespace u = reinforcement_learning::utility;
+namespace l = reinforcement_learning::logger;
+namespace po = boost::program_options;
+
+namespace {
+  // Stands in for the event hub: counts requests and measures how long each frame waited for its request.
+  class counting_sender : public r::i_sender {
+  public:
+    int init(r::api_status*) override { return r::error_code::success; }
+
+    size_t requests() const { return _requests; }
+    std::vector<long long> waits() {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return _waits_us;
+    }
+
+  protected:
+    int v_send(const buffer& data, r::api_status*) override {
+      const auto now = bench::bench_clock::now().time_since_epoch().count();
+      ++_requests;
+      std::lock_guard<std::mutex> lock(_mutex);
+      auto frame = data->preamble_begin();
+      const auto end = frame + data->buffer_filled_size();
+      while (frame < end) {
+        l::preamble pre;
+        pre.read_from_bytes(frame, l::preamble::size());
+        long long sent;
+        memcpy(&sent, frame + l::preamble::size(), sizeof(sent));
+        _waits_us.push_back(std::chrono::duration_cast<std::chrono::microseconds>(
+          bench::bench_clock::duration(now - sent)).count());
+        frame += l::preamble::size() + pre.msg_size;
+      }
+      return r::error_code::success;
+    }
+
+  private:
+    std::atomic<size_t> _requests{ 0 };
+    std::mutex _mutex;
+    std::vector<long long> _waits_us;
+  };
+
+  // A small batch stamped with the time it was handed to the sender
+  r::i_sender::buffer make_batch(size_t size) {
+    r::i_sender::buffer db(new u::data_buffer());
+    u::data_buffer_streambuf sbuff(db.get());
+    std::ostream message(&sbuff);
+    const long long sent = bench::bench_clock::now().time_since_epoch().count();
+    message.write(reinterpret_cast<const char*>(&sent), sizeof(sent));
+    const std::vector<char> payload(size - sizeof(sent), 'x');
+    message.write(payload.data(), payload.size());
+    sbuff.finalize();
+    l::preamble pre;
+    pre.msg_type = 1;
+    pre.msg_size = static_cast<uint32_t>(db->body_filled_size());
+    pre.write_to_bytes(db->preamble_begin(), db->preamble_size());
+    return db;
+  }
+
+  // Each logger flushes a lone small batch at a low rate, the way batchers do when traffic is too thin to fill
+  // batches before their interval runs out.
+  int run_window(size_t loggers, int window_ms, std::chrono::milliseconds interval, std::chrono::milliseconds duration) {
+    auto destination = new counting_sender();
+    std::vector<std::unique_ptr<r::i_sender>> senders;
+    if (window_ms > 0) {
+      l::coalescing_options options;
+      options.window = std::chrono::milliseconds(window_ms);
+      auto coalescer = std::make_shared<l::batch_coalescer>(destination, options, nullptr, nullptr);
+      for (size_t i = 0; i < loggers; ++i) senders.emplace_back(new l::coalescing_sender(coalescer));
+    }
+    else {
+      senders.emplace_back(destination);
+    }
+    for (auto& sender : senders) sender->init(nullptr);
+
+    std::atomic<size_t> batches{ 0 };
+    bench::run_threads(loggers, [&](size_t index) {
+      auto& sender = senders[std::min(index, senders.size() - 1)];
+      std::mt19937 rng(static_cast<unsigned>(index));
+      std::uniform_int_distribution<long long> jitter(0, interval.count() * 1000);
+      const auto stop = bench::bench_clock::now() + duration;
+      while (bench::bench_clock::now() < stop) {
+        std::this_thread::sleep_for(std::chrono::microseconds(interval.count() * 500 + jitter(rng)));
+        sender->send(make_batch(512));
+        ++batches;
+      }
+    });
+    auto waits = destination->waits();
+    const auto requests = destination->requests();
+    senders.clear();
+
+    std::cout << "window " << window_ms << "ms: batches " << batches << " posts " << requests
+      << " reduction " << (requests > 0 ? static_cast<double>(batches) / requests : 0) << "x" << std::endl;
+    bench::report_latency("  batch wait", loggers, waits);
+    return 0;
+  }
+}
+
+int coalesce_bench(const po::variables_map& vm) {
+  const auto loggers = std::max<size_t>(vm["threads"].as<size_t>(), 1);
+  const auto interval = std::chrono::milliseconds(20);
+  const auto duration = std::chrono::milliseconds(1000);
+  std::cout << loggers << " loggers, one 512 byte batch every " << interval.count() << "ms each on average" << std::endl;
+  for (const int window_ms : { 0, 5, 20, 50, 100 }) {
+    if (run_window(loggers, window_ms, interval, duration) != 0) return -1;
+  }
+  return 0;
+}
@@ -0,0 +1,162 @@
+#include "benchmarks.h"
+#include "bench_util.h"
+
+#include "test_data_provider.h"
+
+#include "err_constants.h"
+#include "logger/compression.h"
+#include "ranking_event.h"
+#include "ranking_response.h"
+#include "serialization/fb_serializer.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace r = reinforcement_learning;
+namespace l = reinforcement_learning::logger;
+namespace u = reinforcement_learning::utility;
+namespace po = boost::program_options;
+
+namespace {
+  struct codec_setting {
+    const char* name;
+    l::compression_codec codec;
+    int level;
+  };
+  const codec_setting SETTINGS[] = {
+    { "lz4", l::compression_codec::lz4, 0 },
+    { "lz4 accel 8", l::compression_codec::lz4, 8 },
+    { "zstd 1", l::compression_codec::zstd, 1 },
+    { "zstd 3", l::compression_codec::zstd, 3 },
+    { "zstd 9", l::compression_codec::zstd, 9 },
+  };
+  const size_t BATCH_EVENTS[] = { 10, 100, 1000 };
+  const size_t DICTIONARY_BATCH_EVENTS[] = { 1, 10, 100 };
+  const size_t DICTIONARY_SIZE = 112 * 1024;
+  // test_data_provider repeats its contexts after this many examples
+  const size_t PROVIDER_CONTEXTS = 100;
+  // Compressed per setting and batch size, so that short runs are still timed over a few milliseconds
+  const size_t BYTES_PER_RUN = 64 * 1024 * 1024;
+
+  // An interaction batch as the client sends it, the contexts of the test_cpp example in a flatbuffer
+  std::shared_ptr<u::data_buffer> make_batch(const test_data_provider& data, size_t thread, size_t first, size_t events,
+    size_t actions) {
+    auto db = std::make_shared<u::data_buffer>();
+    l::fb_collection_serializer<r::ranking_event> serializer(*db);
+    r::ranking_response response;
+    response.set_model_id("20190901000000/model");
+    for (size_t a = 0; a < actions; ++a) response.push_back(a, 1.f / actions);
+    for (size_t i = first; i < first + events; ++i) {
+      const auto event_id = data.create_event_id(thread, i);
+      auto evt = r::ranking_event::choose_rank(event_id.c_str(), data.get_context(thread, i), 0, response, r::timestamp{});
+      serializer.add(evt);
+    }
+    serializer.finalize();
+    return db;
+  }
+
+  size_t compressed_size(l::batch_compressor& compressor, u::data_buffer& batch) {
+    u::data_buffer out;
+    if (compressor.compress(1, batch.body_begin(), batch.body_filled_size(), out, nullptr) != r::error_code::success) return 0;
+    return out.body_filled_size();
+  }
+
+  // Small batches have little repetition of their own, a dictionary trained on the batches of another thread brings
+  // the namespace names and action features they share
+  int dictionary_bench(const test_data_provider& data, size_t actions) {
+    std::vector<std::string> samples;
+    for (size_t i = 0; i < PROVIDER_CONTEXTS; ++i) {
+      const auto batch = make_batch(data, 1, i, 1, actions);
+      samples.emplace_back(reinterpret_cast<const char*>(batch->body_begin()), batch->body_filled_size());
+    }
+    std::vector<uint8_t> dictionary;
+    r::api_status status;
+    if (l::train_dictionary(samples, DICTIONARY_SIZE, dictionary, &status) != r::error_code::success) {
+      std::cout << status.get_error_msg() << std::endl;
+      return -1;
+    }
+    l::batch_compressor plain(l::compression_codec::zstd, 3);
+    l::batch_compressor trained(l::compression_codec::zstd, 3);
+    if (trained.set_dictionary(dictionary, &status) != r::error_code::success) {
+      std::cout << status.get_error_msg() << std::endl;
+      return -1;
+    }
+
+    std::cout << std::endl << "zstd 3 with a " << dictionary.size() / 1024 << " KB dictionary trained on "
+      << samples.size() << " 1-event batches of other contexts" << std::endl
+      << "  events  batch(KB)  zstd ratio  dictionary ratio" << std::endl;
+    for (const auto events : DICTIONARY_BATCH_EVENTS) {
+      // Averaged over batches from different offsets
+      size_t batches = 0;
+      size_t size = 0;
+      size_t plain_size = 0;
+      size_t trained_size = 0;
+      for (size_t first = 0; first < PROVIDER_CONTEXTS; first += 10) {
+        const auto batch = make_batch(data, 0, first, events, actions);
+        ++batches;
+        size += batch->body_filled_size();
+        plain_size += compressed_size(plain, *batch);
+        trained_size += compressed_size(trained, *batch);
+      }
+      if (plain_size == 0 || trained_size == 0) return -1;
+      std::cout << "  " << std::setw(6) << events
+        << "  " << std::setw(9) << std::fixed << std::setprecision(1) << size / batches / 1024.0
+        << "  " << std::setw(10) << static_cast<double>(size) / plain_size
+        << "  " << std::setw(16) << static_cast<double>(size) / trained_size << std::endl;
+    }
+    return 0;
+  }
+}
+
+// CPU cost against bytes saved for each codec and level, on interaction batches of realistic contexts
+int compression_bench(const po::variables_map&) {
+  const size_t features = 10;
+  const size_t actions = 10;
+  const test_data_provider data("compression_bench", 2, features, actions, 0, true, 1);
+
+  std::cout << features << " features, " << actions << " actions per context" << std::endl
+    << "  events  codec         batch(KB)  ratio  compress(MB/s)  decompress(MB/s)" << std::endl;
+  for (const auto events : BATCH_EVENTS) {
+    const auto batch = make_batch(data, 0, 0, events, actions);
+    const auto size = batch->body_filled_size();
+    const auto runs = (std::max)(BYTES_PER_RUN / size, size_t(1));
+
+    for (const auto& setting : SETTINGS) {
+      if (!l::compression_available(setting.codec)) {
+        std::cout << "  " << std::setw(6) << events << "  " << std::left << std::setw(12) << setting.name << std::right
+          << "  not built in" << std::endl;
+        continue;
+      }
+      l::batch_compressor compressor(setting.codec, setting.level);
+      u::data_buffer out;
+      auto start = bench::bench_clock::now();
+      for (size_t i = 0; i < runs; ++i) {
+        out.reset();
+        if (compressor.compress(1, batch->body_begin(), size, out, nullptr) != r::error_code::success) return -1;
+      }
+      const auto compress_us = bench::elapsed_us(start);
+
+      uint16_t msg_type;
+      std::vector<uint8_t> body;
+      start = bench::bench_clock::now();
+      for (size_t i = 0; i < runs; ++i) {
+        if (l::decompress_message(out.body_begin(), out.body_filled_size(), nullptr, msg_type, body, nullptr) != r::error_code::success) return -1;
+      }
+      const auto decompress_us = bench::elapsed_us(start);
+
+      const double mb = static_cast<double>(size) * runs / (1024 * 1024);
+      std::cout << "  " << std::setw(6) << events << "  " << std::left << std::setw(12) << setting.name << std::right
+        << "  " << std::setw(9) << std::fixed << std::setprecision(1) << size / 1024.0
+        << "  " << std::setw(5) << std::setprecision(1) << static_cast<double>(size) / out.body_filled_size()
+        << "  " << std::setw(14) << std::setprecision(0) << mb / (compress_us / 1e6)
+        << "  " << std::setw(16) << mb / (decompress_us / 1e6) << std::endl;
+    }
+  }
+
+  if (!l::compression_available(l::compression_codec::zstd)) return 0;
+  return dictionary_bench(data, actions);
+}
@@ -0,0 +1,60 @@
+#include "benchmarks.h"
+#include "bench_util.h"
+
+#include "err_constants.h"
+#include "logger/eventhub_client.h"
+#include "utility/data_buffer_streambuf.h"
+#include "eventhub_endpoint.h"
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+namespace r = reinforcement_learning;
+namespace u = reinforcement_learning::utility;
+namespace po = boost::program_options;
+
+namespace {
+  const size_t BATCH_SIZE = 64 * 1024;
+  const int FAST_MS = 2;
+  const int SLOW_MS = 200;
+  // One POST in SLOW_EVERY hits the slow tail of the endpoint
+  const size_t SLOW_EVERY = 100;
+}
+
+// Time the batcher thread spends in eventhub_client::send against an endpoint with injected tail latency, for
+// in-flight windows of 1, 2, 4 ... up to --threads.
+int eventhub_bench(const po::variables_map& vm) {
+  const auto max_window = vm["threads"].as<size_t>();
+  const auto sends = (std::min)(vm["iterations"].as<size_t>(), size_t(2000));
+
+  std::vector<char> payload(BATCH_SIZE, 'x');
+  for (size_t window = 1; window <= max_window; window *= 2) {
+    std::vector<long long> latencies;
+    latencies.reserve(sends);
+    long long total_us = 0;
+    {
+      r::eventhub_client eh(new bench::eventhub_endpoint(FAST_MS, SLOW_MS, SLOW_EVERY), "localhost", "", "", "", window, 1, nullptr, nullptr);
+      const auto start = bench::bench_clock::now();
+      for (size_t i = 0; i < sends; ++i) {
+        std::shared_ptr<u::data_buffer> db(new u::data_buffer());
+        u::data_buffer_streambuf sbuff(db.get());
+        std::ostream message(&sbuff);
+        message.write(payload.data(), payload.size());
+        sbuff.finalize();
+
+        const auto send_start = bench::bench_clock::now();
+        if (eh.send(db) != r::error_code::success) {
+          std::cerr << "Send failed" << std::endl;
+          return -1;
+        }
+        latencies.push_back(bench::elapsed_us(send_start));
+      }
+      total_us = bench::elapsed_us(start);
+    }
+    bench::report("eventhub send (window)", window, sends, total_us);
+    bench::report_latency("eventhub send latency (window)", window, latencies);
+  }
+
+  return 0;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include "utility/http_client.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace bench {
+  // Counters outliving the endpoint, which is owned by its sender.
+  struct endpoint_stats {
+    std::atomic<size_t> requests{ 0 };
+    std::atomic<size_t> rejected{ 0 };
+  };
+
+  // Stand-in for an event hub endpoint.  Every POST is answered with 201 after fast_ms, except for an injected tail
+  // where one request in slow_every takes slow_ms.  During the first brownout_ms the endpoint answers 503 instead.
+  // With a bandwidth set, request bodies are transferred one after the other like on a single connection.
+  // Responses complete from a timer thread so no pool thread is held while waiting.
+  class eventhub_endpoint : public reinforcement_learning::i_http_client {
+  public:
+    eventhub_endpoint(int fast_ms, int slow_ms, size_t slow_every, int brownout_ms = 0,
+      std::shared_ptr<endpoint_stats> stats = std::make_shared<endpoint_stats>())
+      : _fast_ms(fast_ms), _slow_ms(slow_ms), _slow_every(slow_every)
+      , _brownout_end(std::chrono::steady_clock::now() + std::chrono::milliseconds(brownout_ms))
+      , _stats(std::move(stats)) {}
+
+    response_t request(method_t method) override {
+      request_t req(method);
+      return request(req);
+    }
+
+    response_t request(request_t req) override {
+      const auto n = _stats->requests++;
+      const bool unavailable = std::chrono::steady_clock::now() < _brownout_end;
+      if (unavailable) ++_stats->rejected;
+      const auto delay = std::chrono::milliseconds(_slow_every > 0 && n % _slow_every == _slow_every - 1 ? _slow_ms : _fast_ms);
+      const auto code = unavailable ? web::http::status_codes::ServiceUnavailable : web::http::status_codes::Created;
+
+      auto due = std::chrono::steady_clock::now();
+      if (_bytes_per_ms > 0) {
+        const auto transfer = std::chrono::microseconds(req.headers().content_length() * 1000 / _bytes_per_ms);
+        std::lock_guard<std::mutex> lock(_mutex);
+        _busy_until = (std::max)(_busy_until, due) + transfer;
+        due = _busy_until;
+      }
+      due += delay;
+
+      pplx::task_completion_event<web::http::http_response> done;
+      std::thread([done, due, code]() {
+        std::this_thread::sleep_until(due);
+        web::http::http_response resp(code);
+        done.set(resp);
+      }).detach();
+      return response_t(done);
+    }
+
+    const std::string& get_url() const override { return _url; }
+
+    void set_bandwidth(size_t bytes_per_ms) { _bytes_per_ms = bytes_per_ms; }
+
+  private:
+    const int _fast_ms;
+    const int _slow_ms;
+    const size_t _slow_every;
+    const std::chrono::steady_clock::time_point _brownout_end;
+    const std::shared_ptr<endpoint_stats> _stats;
+    size_t _bytes_per_ms = 0;
+    std::mutex _mutex;
+    std::chrono::steady_clock::time_point _busy_until;
+    const std::string _url = "http://localhost/eventhub";
+  };
+}
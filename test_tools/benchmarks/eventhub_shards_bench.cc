@@ -0,0 +1,72 @@
+#include "benchmarks.h"
+#include "bench_util.h"
+
+#include "err_constants.h"
+#include "logger/sharded_eventhub_client.h"
+#include "utility/data_buffer_streambuf.h"
+#include "eventhub_endpoint.h"
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace r = reinforcement_learning;
+namespace u = reinforcement_learning::utility;
+namespace po = boost::program_options;
+
+namespace {
+  const size_t BATCH_SIZE = 256 * 1024;
+  // Emulated throughput of one connection, in bytes per millisecond (~10 MB/s)
+  const size_t BYTES_PER_MS = 10 * 1024;
+  const int LATENCY_MS = 5;
+  const size_t TASKS_LIMIT = 16;
+
+  int run_shards(size_t connections, r::shard_selection selection, const char* name, size_t batches) {
+    std::vector<std::unique_ptr<r::eventhub_client>> shards;
+    for (size_t i = 0; i < connections; ++i) {
+      auto endpoint = new bench::eventhub_endpoint(LATENCY_MS, LATENCY_MS, 0);
+      endpoint->set_bandwidth(BYTES_PER_MS);
+      shards.emplace_back(new r::eventhub_client(endpoint, "localhost", "", "", "", TASKS_LIMIT, 1, nullptr, nullptr));
+    }
+    std::unique_ptr<r::sharded_eventhub_client> sender(new r::sharded_eventhub_client(std::move(shards), selection, nullptr));
+
+    std::vector<char> payload(BATCH_SIZE, 'x');
+    const auto start = bench::bench_clock::now();
+    for (size_t i = 0; i < batches; ++i) {
+      std::shared_ptr<u::data_buffer> db(new u::data_buffer());
+      u::data_buffer_streambuf sbuff(db.get());
+      std::ostream message(&sbuff);
+      message.write(payload.data(), payload.size());
+      sbuff.finalize();
+      if (sender->send(db) != r::error_code::success) {
+        std::cerr << "Send failed" << std::endl;
+        return -1;
+      }
+    }
+    const auto stats = sender->get_shard_stats();
+    // Waits for the requests still in flight
+    sender.reset();
+    const auto duration = bench::elapsed_us(start);
+
+    bench::report(name, connections, batches, duration);
+    std::cout << "  MB/s: " << (duration > 0 ? static_cast<double>(batches * BATCH_SIZE) / duration : 0) << " batches per connection:";
+    for (const auto& s : stats) std::cout << " " << s.batches;
+    std::cout << std::endl;
+    return 0;
+  }
+}
+
+// Throughput of 256 KB batches sent through 1, 2, 4 ... up to --threads connections, each capped at ~10 MB/s by the
+// stand-in endpoint.
+int eventhub_shards_bench(const po::variables_map& vm) {
+  const auto max_connections = vm["threads"].as<size_t>();
+  const auto batches = (std::min)(vm["iterations"].as<size_t>(), size_t(400));
+
+  int result = 0;
+  for (size_t connections = 1; connections <= max_connections; connections *= 2) {
+    result |= run_shards(connections, r::shard_selection::round_robin, "eventhub shards round robin", batches);
+    result |= run_shards(connections, r::shard_selection::least_outstanding, "eventhub shards least outstanding", batches);
+  }
+  return result;
+}
@@ -0,0 +1,100 @@
+#include "benchmarks.h"
+#include "bench_util.h"
+
+#include "err_constants.h"
+#include "logger/file/async_file_logger.h"
+#include "logger/file/file_logger.h"
+#include "utility/data_buffer_streambuf.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace r = reinforcement_learning;
+namespace u = reinforcement_learning::utility;
+namespace f = reinforcement_learning::logger::file;
+namespace po = boost::program_options;
+
+namespace {
+  const char* const FILE_NAME = "file_sender_bench.data";
+
+  std::vector<r::i_sender::buffer> make_batches(size_t count, size_t size) {
+    std::vector<char> payload(size, 'x');
+    std::vector<r::i_sender::buffer> batches;
+    for (size_t i = 0; i < count; ++i) {
+      r::i_sender::buffer db(new u::data_buffer());
+      u::data_buffer_streambuf sbuff(db.get());
+      std::ostream message(&sbuff);
+      message.write(payload.data(), payload.size());
+      sbuff.finalize();
+      batches.push_back(db);
+    }
+    return batches;
+  }
+
+  // Sends every batch from one thread, like the batcher does, and reports the time until the data is written.
+  int run_sender(const char* name, r::i_sender* sender, const std::vector<r::i_sender::buffer>& batches) {
+    std::unique_ptr<r::i_sender> owner(sender);
+    if (sender->init(nullptr) != r::error_code::success) {
+      std::cerr << "Unable to open " << FILE_NAME << std::endl;
+      return -1;
+    }
+
+    std::vector<long long> send_us;
+    send_us.reserve(batches.size());
+    const auto start = bench::bench_clock::now();
+    for (const auto& batch : batches) {
+      const auto send_start = bench::bench_clock::now();
+      sender->send(batch);
+      send_us.push_back(bench::elapsed_us(send_start));
+    }
+    // The async sender is done once the writer has drained its queue
+    const auto async = dynamic_cast<f::async_file_logger*>(sender);
+    f::async_file_stats stats;
+    while (async != nullptr && (stats = async->get_stats()).batches < batches.size()) {
+      std::this_thread::yield();
+    }
+    const auto duration = bench::elapsed_us(start);
+    owner.reset();
+
+    const auto bytes = batches.size() * batches.front()->buffer_filled_size();
+    bench::report(name, 1, batches.size(), duration);
+    std::cout << "  MB/s: " << (duration > 0 ? static_cast<double>(bytes) / duration : 0);
+    if (async != nullptr) {
+      std::cout << " batches per write: " << (stats.writes > 0 ? static_cast<double>(stats.batches) / stats.writes : 0)
+        << " fsyncs: " << stats.syncs << " blocked sends: " << stats.blocked_sends;
+    }
+    std::cout << std::endl;
+    bench::report_latency(std::string(name) + " send", 1, send_us);
+    remove(FILE_NAME);
+    return 0;
+  }
+
+  f::async_file_options with_sync(f::fsync_policy policy) {
+    f::async_file_options options;
+    options.sync = policy;
+    options.sync_interval = std::chrono::milliseconds(100);
+    return options;
+  }
+}
+
+// Batches per second written by the synchronous file sender, which makes one write call per batch on the sending
+// thread, and by the asynchronous sender with each fsync policy, for small and large batches.
+int file_sender_bench(const po::variables_map& vm) {
+  for (const size_t batch_size : { size_t(1024), size_t(64 * 1024) }) {
+    const auto count = (std::min)(vm["iterations"].as<size_t>(), size_t(256 * 1024 * 1024) / batch_size);
+    const auto batches = make_batches(count, batch_size);
+    std::cout << "--- " << batch_size / 1024 << " KB batches ---" << std::endl;
+
+    int result = 0;
+    result |= run_sender("file_logger (one write per batch)", new f::file_logger(FILE_NAME, nullptr), batches);
+    result |= run_sender("async, fsync never", new f::async_file_logger(FILE_NAME, with_sync(f::fsync_policy::never), nullptr, nullptr), batches);
+    result |= run_sender("async, fsync every 100 ms", new f::async_file_logger(FILE_NAME, with_sync(f::fsync_policy::interval), nullptr, nullptr), batches);
+    result |= run_sender("async, fsync every 16 MB", new f::async_file_logger(FILE_NAME, with_sync(f::fsync_policy::bytes), nullptr, nullptr), batches);
+    if (result != 0) return result;
+  }
+  return 0;
+}
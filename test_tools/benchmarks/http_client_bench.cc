@@ -0,0 +1,106 @@
+#include "benchmarks.h"
+#include "bench_util.h"
+
+#include <iostream>
+
+namespace po = boost::program_options;
+
+#ifdef __linux__
+#include "configuration.h"
+#include "err_constants.h"
+#include "utility/data_buffer_streambuf.h"
+#include "utility/epoll_http_client.h"
+#include "utility/http_client.h"
+#include "loopback_http_server.h"
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace r = reinforcement_learning;
+namespace u = reinforcement_learning::utility;
+
+namespace {
+  const size_t BATCH_SIZE = 16 * 1024;
+
+  long long cpu_us() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000LL + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+  }
+
+  void run_client(const char* name, r::i_http_client& client, const std::shared_ptr<u::data_buffer>& batch,
+    size_t threads, size_t per_thread) {
+    std::mutex mutex;
+    std::vector<long long> samples;
+    samples.reserve(threads * per_thread);
+
+    const auto cpu_start = cpu_us();
+    const auto duration = bench::run_threads(threads, [&](size_t) {
+      std::vector<long long> local;
+      local.reserve(per_thread);
+      for (size_t i = 0; i < per_thread; ++i) {
+        const auto start = bench::bench_clock::now();
+        web::http::http_request request(web::http::methods::POST);
+        request.headers().add(U("Content-Type"), U("application/atom+xml;type=entry;charset=utf-8"));
+        client.request_with_body(request, batch).get();
+        local.push_back(bench::elapsed_us(start));
+      }
+      std::lock_guard<std::mutex> lock(mutex);
+      samples.insert(samples.end(), local.begin(), local.end());
+    });
+    const auto cpu = cpu_us() - cpu_start;
+
+    bench::report(name, threads, threads * per_thread, duration);
+    bench::report_latency(name, threads, samples);
+    std::cout << "  CPU us per request: " << static_cast<double>(cpu) / (threads * per_thread) << std::endl;
+  }
+}
+
+// Synchronous 16 KB POSTs from 1, 2, 4 ... up to --threads threads against a keep-alive server on the loopback
+// interface, through the cpprest client and through the epoll client.  Loopback takes the network out of the
+// picture, what remains is the per request cost of the client itself.
+int http_client_bench(const po::variables_map& vm) {
+  const auto max_threads = vm["threads"].as<size_t>();
+  const auto per_thread = (std::min)(vm["iterations"].as<size_t>(), size_t(5000));
+
+  auto batch = std::make_shared<u::data_buffer>();
+  {
+    std::vector<char> payload(BATCH_SIZE, 'x');
+    u::data_buffer_streambuf sbuff(batch.get());
+    std::ostream message(&sbuff);
+    message.write(payload.data(), payload.size());
+    sbuff.finalize();
+  }
+
+  for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+    {
+      bench::loopback_http_server server;
+      u::configuration cfg;
+      r::http_client client(server.url().c_str(), cfg);
+      run_client("cpprest http_client", client, batch, threads, per_thread);
+      std::cout << "  connections: " << server.connections() << std::endl;
+    }
+    {
+      bench::loopback_http_server server;
+      u::configuration cfg;
+      r::epoll_http_client client(server.url().c_str(), cfg, nullptr);
+      if (client.init(nullptr) != r::error_code::success) {
+        std::cerr << "epoll_http_client init failed" << std::endl;
+        return -1;
+      }
+      run_client("epoll_http_client", client, batch, threads, per_thread);
+      std::cout << "  connections: " << server.connections() << " reused: " << client.get_stats().connections_reused << std::endl;
+    }
+  }
+  return 0;
+}
+#else
+int http_client_bench(const po::variables_map&) {
+  std::cout << "The epoll http client is only available on Linux" << std::endl;
+  return 0;
+}
+#endif
@@ -0,0 +1,82 @@
+#include "benchmarks.h"
+#include "bench_util.h"
+
+#include "err_constants.h"
+#include "logger/eventhub_client.h"
+#include "utility/data_buffer_streambuf.h"
+#include "eventhub_endpoint.h"
+
+#include <atomic>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace r = reinforcement_learning;
+namespace u = reinforcement_learning::utility;
+namespace po = boost::program_options;
+
+namespace {
+  const int BROWNOUT_MS = 300;
+  const size_t SENDS_PER_CLIENT = 50;
+  const size_t WINDOW = 4;
+  const size_t MAX_RETRIES = 8;
+
+  int run_brownout(const char* name, size_t clients, const std::function<std::shared_ptr<u::retry_policy>()>& make_policy) {
+    const auto endpoint = std::make_shared<bench::endpoint_stats>();
+    std::vector<std::shared_ptr<u::retry_policy>> policies;
+    std::vector<std::unique_ptr<r::eventhub_client>> senders;
+    for (size_t c = 0; c < clients; ++c) {
+      policies.push_back(make_policy());
+      senders.emplace_back(new r::eventhub_client(new bench::eventhub_endpoint(2, 2, 0, BROWNOUT_MS, endpoint),
+        "localhost", "", "", "", WINDOW, MAX_RETRIES, nullptr, nullptr, policies.back()));
+    }
+
+    std::atomic<bool> failed{ false };
+    const auto start = bench::bench_clock::now();
+    bench::run_threads(clients, [&](size_t c) {
+      for (size_t i = 0; i < SENDS_PER_CLIENT; ++i) {
+        std::shared_ptr<u::data_buffer> db(new u::data_buffer());
+        u::data_buffer_streambuf sbuff(db.get());
+        std::ostream message(&sbuff);
+        message << "batch " << i;
+        sbuff.finalize();
+        if (senders[c]->send(db) != r::error_code::success) failed = true;
+      }
+    });
+
+    // Waits for outstanding requests and their retries
+    senders.clear();
+    const auto duration = bench::elapsed_us(start);
+
+    u::retry_stats stats;
+    for (const auto& policy : policies) {
+      const auto s = policy->get_stats();
+      stats.retries += s.retries;
+      stats.budget_exhausted += s.budget_exhausted;
+      stats.total_delay_ms += s.total_delay_ms;
+    }
+
+    if (failed) {
+      std::cerr << "Send failed" << std::endl;
+      return -1;
+    }
+    bench::report(name, clients, clients * SENDS_PER_CLIENT, duration);
+    std::cout << "  requests: " << endpoint->requests.load() << " 503s: " << endpoint->rejected.load()
+      << " retries: " << stats.retries << " budget exhausted: " << stats.budget_exhausted
+      << " backoff(ms): " << stats.total_delay_ms << std::endl;
+    return 0;
+  }
+}
+
+// Clients sending through a 300 ms brownout where the endpoint answers 503.  Immediate retries hammer the
+// endpoint, backoff with decorrelated jitter and a retry budget spread the retries out and cap them.
+int http_retry_bench(const po::variables_map& vm) {
+  const auto clients = vm["threads"].as<size_t>();
+  int result = 0;
+  result |= run_brownout("brownout immediate retries", clients, []() { return u::retry_policy::immediate(); });
+  result |= run_brownout("brownout backoff + budget", clients, []() {
+    return std::make_shared<u::retry_policy>(std::chrono::milliseconds(20), std::chrono::milliseconds(1000), 20, std::chrono::milliseconds(1000));
+  });
+  return result;
+}
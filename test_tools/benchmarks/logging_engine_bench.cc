@@ -0,0 +1,148 @@
+#include "benchmarks.h"
+#include "bench_util.h"
+
+#include <iostream>
+
+namespace po = boost::program_options;
+
+#ifdef __linux__
+#include "err_constants.h"
+#include "logger/async_batcher.h"
+#include "logger/logging_engine.h"
+#include "utility/watchdog.h"
+
+#include <sys/resource.h>
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace r = reinforcement_learning;
+namespace l = reinforcement_learning::logger;
+namespace u = reinforcement_learning::utility;
+
+namespace {
+  class bench_event : public r::event {
+  public:
+    bench_event() {}
+    explicit bench_event(const std::string& id) : event(id.c_str(), r::timestamp{}) {}
+    bench_event(bench_event&& other) : event(std::move(other)) {}
+    bench_event& operator=(bench_event&& other) {
+      if (&other != this) event::operator=(std::move(other));
+      return *this;
+    }
+  };
+}
+
+namespace reinforcement_learning { namespace logger {
+  template <>
+  struct json_event_serializer<bench_event> {
+    using serializer_t = json_event_serializer<bench_event>;
+    static int serialize(bench_event& evt, std::ostream& out, api_status*) {
+      out << evt.get_seed_id();
+      return error_code::success;
+    }
+    static size_t size_estimate(const bench_event& evt) { return evt.get_seed_id().size(); }
+  };
+}}
+
+namespace {
+  const size_t LOGGERS = 4;
+  const size_t BATCH_INTERVAL_MS = 10;
+
+  class null_message_sender : public l::i_message_sender {
+  public:
+    explicit null_message_sender(std::atomic<size_t>& batches) : _batches(batches) {}
+    int send(const uint16_t, const buffer&, r::api_status*) override { ++_batches; return r::error_code::success; }
+    int init(r::api_status*) override { return r::error_code::success; }
+  private:
+    std::atomic<size_t>& _batches;
+  };
+
+  size_t thread_count() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+      if (line.compare(0, 8, "Threads:") == 0) return std::stoul(line.substr(8));
+    }
+    return 0;
+  }
+
+  struct usage {
+    long long cpu_us;
+    long long switches;
+  };
+
+  // What the background threads used: the process minus the calling thread
+  usage background_usage() {
+    rusage self{};
+    rusage thread{};
+    getrusage(RUSAGE_SELF, &self);
+    getrusage(RUSAGE_THREAD, &thread);
+    const auto cpu = [](const rusage& ru) {
+      return (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000LL + ru.ru_utime.tv_usec + ru.ru_stime.tv_usec;
+    };
+    return { cpu(self) - cpu(thread), (self.ru_nvcsw + self.ru_nivcsw) - (thread.ru_nvcsw + thread.ru_nivcsw) };
+  }
+
+  // Four loggers fed a steady trickle of events for about two seconds, drained either by a thread each or by one
+  // engine thread.  Context switches and CPU are those of the draining threads, the feeding thread is left out.
+  int run(const char* name, bool consolidated, size_t events) {
+    using batcher = l::async_batcher<bench_event>;
+    u::watchdog watchdog(nullptr);
+    std::atomic<size_t> batches{ 0 };
+    const auto threads_before = thread_count();
+    const auto before = background_usage();
+    const auto start = bench::bench_clock::now();
+    size_t threads_running;
+    {
+      std::unique_ptr<l::logging_engine> engine(consolidated ? new l::logging_engine(watchdog) : nullptr);
+      if (engine) engine->init(nullptr);
+      std::vector<std::unique_ptr<batcher>> loggers;
+      for (size_t i = 0; i < LOGGERS; ++i) {
+        loggers.emplace_back(new batcher(new null_message_sender(batches), watchdog, nullptr, 198 * 1024, BATCH_INTERVAL_MS,
+          16 * 1024 * 1024, r::DROP, engine.get(), static_cast<l::logging_priority>(i)));
+        loggers.back()->init(nullptr);
+      }
+      threads_running = thread_count();
+
+      const size_t ticks = 2000;
+      const auto per_tick = (std::max)(events / ticks, static_cast<size_t>(1));
+      size_t sent = 0;
+      for (size_t tick = 0; sent < events; ++tick) {
+        for (size_t i = 0; i < per_tick && sent < events; ++i, ++sent) {
+          loggers[sent % LOGGERS]->append(bench_event("event-" + std::to_string(sent)));
+        }
+        std::this_thread::sleep_until(start + std::chrono::milliseconds(tick + 1));
+      }
+    }
+    const auto duration = bench::elapsed_us(start);
+    const auto after = background_usage();
+
+    const auto per_100k = 100000.0 / events;
+    bench::report(name, threads_running - threads_before, events, duration);
+    std::cout << "  threads: " << threads_running - threads_before
+      << " batches: " << batches
+      << " context switches per 100k events: " << (after.switches - before.switches) * per_100k
+      << " CPU ms per 100k events: " << (after.cpu_us - before.cpu_us) * per_100k / 1000 << std::endl;
+    return 0;
+  }
+}
+
+int logging_engine_bench(const po::variables_map& vm) {
+  const auto events = vm["iterations"].as<size_t>();
+  std::cout << LOGGERS << " loggers, " << BATCH_INTERVAL_MS << "ms batch interval, " << events << " events over ~2s" << std::endl;
+  int result = run("thread per logger", false, events);
+  result |= run("consolidated engine", true, events);
+  return result;
+}
+#else
+int logging_engine_bench(const po::variables_map&) {
+  std::cout << "The logging engine benchmark reads /proc and is only available on Linux" << std::endl;
+  return 0;
+}
+#endif
@@ -0,0 +1,120 @@
+#pragma once
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace bench {
+  // Keep-alive HTTP/1.1 server on 127.0.0.1 answering every request with 201 and an empty body, one thread per
+  // connection.  Only reads Content-Length framed requests, which is all the clients under test send.
+  class loopback_http_server {
+  public:
+    loopback_http_server() {
+      _listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+      const int one = 1;
+      setsockopt(_listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+      sockaddr_in addr{};
+      addr.sin_family = AF_INET;
+      addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+      bind(_listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+      socklen_t len = sizeof(addr);
+      getsockname(_listen_fd, reinterpret_cast<sockaddr*>(&addr), &len);
+      _port = ntohs(addr.sin_port);
+      listen(_listen_fd, 128);
+      _accept_thread = std::thread([this] { accept_loop(); });
+    }
+
+    ~loopback_http_server() {
+      _stop = true;
+      shutdown(_listen_fd, SHUT_RDWR);
+      ::close(_listen_fd);
+      _accept_thread.join();
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto fd : _client_fds) shutdown(fd, SHUT_RDWR);
+      }
+      for (auto& t : _client_threads) t.join();
+    }
+
+    std::string url() const {
+      return "http://127.0.0.1:" + std::to_string(_port) + "/eventhub/messages?timeout=60";
+    }
+
+    size_t connections() const { return _accepted; }
+    size_t requests() const { return _requests; }
+
+  private:
+    void accept_loop() {
+      while (!_stop) {
+        const int fd = accept(_listen_fd, nullptr, nullptr);
+        if (fd < 0) return;
+        const int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        ++_accepted;
+        std::lock_guard<std::mutex> lock(_mutex);
+        _client_fds.push_back(fd);
+        _client_threads.emplace_back([this, fd] { serve(fd); });
+      }
+    }
+
+    void serve(int fd) {
+      static const std::string response = "HTTP/1.1 201 Created\r\nContent-Length: 0\r\n\r\n";
+      std::string in;
+      std::vector<char> buf(64 * 1024);
+      while (true) {
+        const auto head_end = in.find("\r\n\r\n");
+        if (head_end == std::string::npos) {
+          const auto n = ::read(fd, buf.data(), buf.size());
+          if (n <= 0) break;
+          in.append(buf.data(), n);
+          continue;
+        }
+        size_t length = 0;
+        const auto cl = find_header(in, head_end, "content-length:");
+        if (cl != std::string::npos) length = strtoul(in.c_str() + cl, nullptr, 10);
+        const auto total = head_end + 4 + length;
+        while (in.size() < total) {
+          const auto n = ::read(fd, buf.data(), buf.size());
+          if (n <= 0) break;
+          in.append(buf.data(), n);
+        }
+        if (in.size() < total) break;
+        in.erase(0, total);
+        ++_requests;
+        if (send(fd, response.data(), response.size(), MSG_NOSIGNAL) < 0) break;
+      }
+      ::close(fd);
+    }
+
+    // Position of the value of a header, the name is matched case insensitively.
+    static size_t find_header(const std::string& in, size_t head_end, const char* name) {
+      const size_t len = strlen(name);
+      for (size_t line = in.find("\r\n"); line != std::string::npos && line < head_end; line = in.find("\r\n", line + 2)) {
+        size_t i = 0;
+        while (i < len && tolower(static_cast<unsigned char>(in[line + 2 + i])) == name[i]) ++i;
+        if (i == len) return line + 2 + len;
+      }
+      return std::string::npos;
+    }
+
+    int _listen_fd = -1;
+    int _port = 0;
+    std::atomic<bool> _stop{ false };
+    std::atomic<size_t> _accepted{ 0 };
+    std::atomic<size_t> _requests{ 0 };
+    std::thread _accept_thread;
+    std::mutex _mutex;
+    std::vector<int> _client_fds;
+    std::vector<std::thread> _client_threads;
+  };
+}
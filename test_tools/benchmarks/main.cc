@@ -0,0 +1,80 @@
+#include "benchmarks.h"
+
+#include <iostream>
+#include <map>
+#include <string>
+
+namespace po = boost::program_options;
+
+using bench_fn = int(*)(const po::variables_map&);
+
+const std::map<std::string, bench_fn>& benchmarks() {
+  static const std::map<std::string, bench_fn> all = {
+    { "admission", admission_bench },
+    { "batching", batching_bench },
+    { "body_copy", body_copy_bench },
+    { "coalesce", coalesce_bench },
+    { "compression", compression_bench },
+    { "eventhub", eventhub_bench },
+    { "eventhub_shards", eventhub_shards_bench },
+    { "file_sender", file_sender_bench },
+    { "http_client", http_client_bench },
+    { "http_retry", http_retry_bench },
+    { "logging_engine", logging_engine_bench },
+    { "model_cache", model_cache_bench },
+    { "model_download", model_download_bench },
+    { "model_stream", model_stream_bench },
+    { "pdf_model", pdf_model_bench },
+    { "scheduler", scheduler_bench },
+    { "shm_ring", shm_ring_bench },
+    { "stream_sender", stream_sender_bench },
+  };
+  return all;
+}
+
+bool is_help(const po::variables_map& vm) {
+  return vm.count("help") > 0;
+}
+
+po::variables_map process_cmd_line(const int argc, char** argv) {
+  std::string names;
+  for (const auto& b : benchmarks()) names.append(names.empty() ? "" : ", ").append(b.first);
+
+  po::options_description desc("Options");
+  desc.add_options()
+    ("help", "produce help message")
+    ("bench,b", po::value<std::string>()->default_value("all"), ("Benchmark to run: all, " + names).c_str())
+    ("threads,t", po::value<size_t>()->default_value(8), "Maximum number of threads, benchmarks scale 1, 2, 4 ... up to this value")
+    ("iterations,n", po::value<size_t>()->default_value(100000), "Operations per thread")
+    ("model,m", po::value<std::string>()->default_value(""), "VW model file used by model benchmarks")
+    ;
+
+  po::variables_map vm;
+  store(parse_command_line(argc, argv, desc), vm);
+
+  if (is_help(vm))
+    std::cout << desc << std::endl;
+
+  return vm;
+}
+
+int main(int argc, char** argv) {
+  try {
+    const auto vm = process_cmd_line(argc, argv);
+    if (is_help(vm)) return 0;
+
+    const auto name = vm["bench"].as<std::string>();
+    int result = 0;
+    for (const auto& b : benchmarks()) {
+      if (name != "all" && name != b.first) continue;
+      std::cout << "=== " << b.first << " ===" << std::endl;
+      result |= b.second(vm);
+      std::cout << std::endl;
+    }
+    return result;
+  }
+  catch (const std::exception& e) {
+    std::cout << "Error: " << e.what() << std::endl;
+    return -1;
+  }
+}
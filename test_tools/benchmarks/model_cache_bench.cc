@@ -0,0 +1,69 @@
+#include "benchmarks.h"
+#include "bench_util.h"
+
+#include "model_mgmt.h"
+#include "utility/versioned_object_pool.h"
+#include "vw_model/safe_vw.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+namespace r = reinforcement_learning;
+namespace m = reinforcement_learning::model_management;
+namespace po = boost::program_options;
+
+namespace {
+  const char* const COMMAND_LINE = "--cb_explore_adf --json --quiet --epsilon 0.0 --first_only --id N/A";
+
+  bool load_model(const std::string& path, m::model_data& data) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.good()) return false;
+    const std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::memcpy(data.alloc(bytes.size()), bytes.data(), bytes.size());
+    return true;
+  }
+}
+
+// Compares a model switch that has to rebuild the vw pool from the model (what a rollback through a re-upload costs,
+// download excluded) with a switch to a cached, already loaded master.  The pool holds one object per thread.
+int model_cache_bench(const po::variables_map& vm) {
+  const auto max_threads = vm["threads"].as<size_t>();
+  const size_t swaps = (std::max)(static_cast<size_t>(10), vm["iterations"].as<size_t>() / 1000);
+  const auto model_path = vm["model"].as<std::string>();
+
+  m::model_data data;
+  if (!model_path.empty() && !load_model(model_path, data)) {
+    std::cerr << "Unable to read model file " << model_path << std::endl;
+    return -1;
+  }
+  if (data.data_sz() == 0) {
+    std::cout << "No --model given, the baseline initializes vw from the command line instead of parsing a model" << std::endl;
+  }
+
+  std::shared_ptr<r::safe_vw> master(data.data_sz() > 0
+    ? new r::safe_vw(data.data(), data.data_sz())
+    : new r::safe_vw(COMMAND_LINE));
+
+  for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+    r::utility::versioned_object_pool<r::safe_vw, r::safe_vw_factory> pool(new r::safe_vw_factory(master), static_cast<int>(threads));
+
+    auto start = bench::bench_clock::now();
+    for (size_t i = 0; i < swaps; ++i) {
+      pool.update_factory(data.data_sz() > 0 ? new r::safe_vw_factory(data) : new r::safe_vw_factory(COMMAND_LINE));
+    }
+    bench::report("pool rebuild from model", threads, swaps, bench::elapsed_us(start));
+
+    start = bench::bench_clock::now();
+    for (size_t i = 0; i < swaps; ++i) {
+      pool.update_factory(new r::safe_vw_factory(master));
+    }
+    bench::report("swap to cached master", threads, swaps, bench::elapsed_us(start));
+  }
+
+  return 0;
+}
@@ -0,0 +1,48 @@
+#include "benchmarks.h"
+#include "bench_util.h"
+
+#include "err_constants.h"
+#include "model_mgmt.h"
+#include "model_mgmt/restapi_data_transport.h"
+#include "throttled_blob_client.h"
+
+#include <iostream>
+#include <vector>
+
+namespace r = reinforcement_learning;
+namespace m = reinforcement_learning::model_management;
+namespace po = boost::program_options;
+
+namespace {
+  const size_t BLOB_SIZE = 32 * 1024 * 1024;
+  // Emulated per connection throughput of the blob store, in bytes per millisecond (~100 MB/s)
+  const size_t BYTES_PER_MS = 100 * 1024;
+}
+
+// Downloads a 32 MB blob from a throttled stand-in with 1, 2, 4 ... concurrent Range requests.
+// One range is the single stream GET used before ranged downloads.
+int model_download_bench(const po::variables_map& vm) {
+  const auto max_ranges = vm["threads"].as<size_t>();
+  const size_t downloads = 3;
+
+  std::vector<unsigned char> blob(BLOB_SIZE);
+  for (size_t i = 0; i < blob.size(); ++i) blob[i] = static_cast<unsigned char>(i);
+
+  for (size_t ranges = 1; ranges <= max_ranges; ranges *= 2) {
+    long long total_us = 0;
+    for (size_t i = 0; i < downloads; ++i) {
+      // A fresh transport each time, otherwise the unchanged blob is not downloaded again
+      m::restapi_data_transport transport(new bench::throttled_blob_client(blob, BYTES_PER_MS), nullptr, ranges, 3, 1024 * 1024);
+      m::model_data md;
+      const auto start = bench::bench_clock::now();
+      if (transport.get_data(md) != r::error_code::success || md.data_sz() != blob.size()) {
+        std::cerr << "Model download failed" << std::endl;
+        return -1;
+      }
+      total_us += bench::elapsed_us(start);
+    }
+    bench::report("model download (ranges)", ranges, downloads, total_us);
+  }
+
+  return 0;
+}
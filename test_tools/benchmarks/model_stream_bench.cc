@@ -0,0 +1,83 @@
+#include "benchmarks.h"
+#include "bench_util.h"
+
+#include "configuration.h"
+#include "err_constants.h"
+#include "model_mgmt.h"
+#include "model_mgmt/byte_pipe.h"
+#include "model_mgmt/restapi_data_transport.h"
+#include "throttled_blob_client.h"
+#include "vw_model/vw_model.h"
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+namespace r = reinforcement_learning;
+namespace m = reinforcement_learning::model_management;
+namespace po = boost::program_options;
+
+namespace {
+  // Emulated throughput of the blob store, in bytes per millisecond (~50 MB/s)
+  const size_t BYTES_PER_MS = 50 * 1024;
+}
+
+// Time to ready for a model downloaded from a throttled stand-in: full download followed by the vw load, against
+// the streamed path where vw reads the model while it downloads.
+int model_stream_bench(const po::variables_map& vm) {
+  const auto model_path = vm["model"].as<std::string>();
+  if (model_path.empty()) {
+    std::cout << "Skipped, needs a VW model file passed with --model" << std::endl;
+    return 0;
+  }
+  std::ifstream file(model_path, std::ios::binary);
+  if (!file.good()) {
+    std::cerr << "Unable to read model file " << model_path << std::endl;
+    return -1;
+  }
+  const std::vector<unsigned char> blob((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  const size_t loads = 5;
+
+  r::utility::configuration config;
+  long long full_us = 0;
+  long long streamed_us = 0;
+  for (size_t i = 0; i < loads; ++i) {
+    {
+      m::restapi_data_transport transport(new bench::throttled_blob_client(blob, BYTES_PER_MS), nullptr);
+      m::vw_model model(nullptr, config);
+      m::model_data md;
+      bool ready = false;
+      const auto start = bench::bench_clock::now();
+      if (transport.get_data(md) != r::error_code::success || model.update(md, ready) != r::error_code::success) {
+        std::cerr << "Full buffer model load failed" << std::endl;
+        return -1;
+      }
+      full_us += bench::elapsed_us(start);
+    }
+    {
+      m::restapi_data_transport transport(new bench::throttled_blob_client(blob, BYTES_PER_MS), nullptr);
+      m::vw_model model(nullptr, config);
+      const auto pipe = std::make_shared<m::byte_pipe>(4 * 1024 * 1024);
+      bool updated = false;
+      bool ready = false;
+      const auto start = bench::bench_clock::now();
+      const auto scode = transport.get_data_streamed(pipe, updated) == r::error_code::success
+        ? model.update_streamed(*pipe, ready)
+        : r::error_code::model_update_error;
+      pipe->cancel();
+      pipe->wait_closed();
+      if (scode != r::error_code::success) {
+        std::cerr << "Streamed model load failed" << std::endl;
+        return -1;
+      }
+      streamed_us += bench::elapsed_us(start);
+    }
+  }
+
+  std::cout << "Model size: " << blob.size() << " bytes" << std::endl;
+  bench::report("download then load", 1, loads, full_us);
+  bench::report("load while downloading", 1, loads, streamed_us);
+  return 0;
+}
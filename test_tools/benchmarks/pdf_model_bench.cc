@@ -0,0 +1,74 @@
+#include "benchmarks.h"
+#include "bench_util.h"
+
+#include "configuration.h"
+#include "err_constants.h"
+#include "vw_model/pdf_model.h"
+#include "vw_model/safe_vw.h"
+
+#include <iostream>
+#include <mutex>
+#include <sstream>
+
+namespace r = reinforcement_learning;
+namespace m = reinforcement_learning::model_management;
+namespace po = boost::program_options;
+
+namespace {
+  std::string create_context(size_t actions) {
+    std::ostringstream oss;
+    oss << R"({"GUser":{"id":"a","major":"eng","hobby":"hiking"},"_multi":[)";
+    for (size_t a = 0; a < actions; ++a) {
+      oss << R"({"TAction":{"a1":"f)" << a << R"(","a2":"value_)" << a << R"("}})";
+      if (a + 1 < actions) oss << ",";
+    }
+    oss << R"(],"p":[)";
+    for (size_t a = 0; a < actions; ++a) {
+      oss << (1.f / actions);
+      if (a + 1 < actions) oss << ",";
+    }
+    oss << "]}";
+    return oss.str();
+  }
+}
+
+// Compares the VW backed pdf parsing (one shared safe_vw, which has to be locked to be used from several threads)
+// with the lock free pdf_model.
+int pdf_model_bench(const po::variables_map& vm) {
+  const auto max_threads = vm["threads"].as<size_t>();
+  const auto iterations = vm["iterations"].as<size_t>();
+  const auto context = create_context(10);
+
+  r::safe_vw vw("--json --quiet --cb_adf");
+  std::mutex vw_mutex;
+
+  r::utility::configuration config;
+  m::pdf_model model(nullptr, config);
+
+  for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+    const auto vw_us = bench::run_threads(threads, [&](size_t) {
+      std::vector<int> action_ids;
+      std::vector<float> pdf;
+      for (size_t i = 0; i < iterations; ++i) {
+        std::lock_guard<std::mutex> lock(vw_mutex);
+        vw.parse_context_with_pdf(context.c_str(), action_ids, pdf);
+      }
+    });
+    bench::report("safe_vw::parse_context_with_pdf", threads, threads * iterations, vw_us);
+
+    const auto model_us = bench::run_threads(threads, [&](size_t) {
+      std::vector<int> action_ids;
+      std::vector<float> pdf;
+      std::string model_version;
+      for (size_t i = 0; i < iterations; ++i) {
+        if (model.choose_rank(i, context.c_str(), action_ids, pdf, model_version) != r::error_code::success) {
+          std::cerr << "pdf_model::choose_rank failed" << std::endl;
+          return;
+        }
+      }
+    });
+    bench::report("pdf_model::choose_rank", threads, threads * iterations, model_us);
+  }
+
+  return 0;
+}
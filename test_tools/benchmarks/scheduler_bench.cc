@@ -0,0 +1,120 @@
+#include "benchmarks.h"
+#include "bench_util.h"
+
+#include <iostream>
+
+namespace po = boost::program_options;
+
+#ifdef __linux__
+#include "err_constants.h"
+#include "utility/background_scheduler.h"
+#include "utility/periodic_background_proc.h"
+#include "utility/watchdog.h"
+
+#include <sys/resource.h>
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace r = reinforcement_learning;
+namespace u = reinforcement_learning::utility;
+
+namespace {
+  // A live model runs four logger batchers and a model downloader in the background
+  const int BATCH_INTERVAL_MS = 10;
+  const int MODEL_INTERVAL_MS = 100;
+  const size_t PROCS_PER_MODEL = 5;
+  const auto DURATION = std::chrono::seconds(2);
+
+  struct null_proc {
+    std::atomic<size_t>& runs;
+    int run_iteration(r::api_status*) {
+      ++runs;
+      return r::error_code::success;
+    }
+  };
+
+  size_t thread_count() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+      if (line.compare(0, 8, "Threads:") == 0) return std::stoul(line.substr(8));
+    }
+    return 0;
+  }
+
+  struct usage {
+    long long cpu_us;
+    long long switches;
+  };
+
+  // What the background threads used: the process minus the calling thread
+  usage background_usage() {
+    rusage self{};
+    rusage thread{};
+    getrusage(RUSAGE_SELF, &self);
+    getrusage(RUSAGE_THREAD, &thread);
+    const auto cpu = [](const rusage& ru) {
+      return (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000LL + ru.ru_utime.tv_usec + ru.ru_stime.tv_usec;
+    };
+    return { cpu(self) - cpu(thread), (self.ru_nvcsw + self.ru_nivcsw) - (thread.ru_nvcsw + thread.ru_nivcsw) };
+  }
+
+  // The background procedures of a number of live models left to run for two seconds, each on a thread of its own
+  // or all on one shared scheduler
+  int run(const char* name, size_t models, u::background_scheduler* scheduler) {
+    using proc = u::periodic_background_proc<null_proc>;
+    u::watchdog watchdog(nullptr);
+    std::atomic<size_t> runs{ 0 };
+    std::vector<std::unique_ptr<null_proc>> bodies;
+    std::vector<std::unique_ptr<proc>> procs;
+    const auto threads_before = thread_count();
+    const auto before = background_usage();
+    const auto start = bench::bench_clock::now();
+
+    for (size_t m = 0; m < models; ++m) {
+      for (size_t i = 0; i < PROCS_PER_MODEL; ++i) {
+        const auto interval = i + 1 < PROCS_PER_MODEL ? BATCH_INTERVAL_MS : MODEL_INTERVAL_MS;
+        bodies.emplace_back(new null_proc{ runs });
+        procs.emplace_back(new proc(interval, watchdog, "Bench proc", nullptr, scheduler));
+        procs.back()->init(bodies.back().get());
+      }
+    }
+    const auto threads_running = thread_count();
+    std::this_thread::sleep_for(DURATION);
+    procs.clear();
+
+    const auto duration = bench::elapsed_us(start);
+    const auto after = background_usage();
+    bench::report(name, threads_running - threads_before, runs, duration);
+    std::cout << "  threads: " << threads_running - threads_before
+      << " context switches per 1k runs: " << (after.switches - before.switches) * 1000.0 / runs
+      << " CPU us per run: " << static_cast<double>(after.cpu_us - before.cpu_us) / runs;
+    if (scheduler != nullptr) std::cout << " timer wakeups: " << scheduler->get_stats().wakeups;
+    std::cout << std::endl;
+    return 0;
+  }
+}
+
+int scheduler_bench(const po::variables_map& vm) {
+  const auto models = vm["threads"].as<size_t>();
+  std::cout << models << " live models with " << PROCS_PER_MODEL << " background procedures each ("
+    << BATCH_INTERVAL_MS << "ms batchers, " << MODEL_INTERVAL_MS << "ms model refresh)" << std::endl;
+  int result = run("thread per procedure", models, nullptr);
+
+  u::background_scheduler_options options;
+  u::background_scheduler scheduler(options, nullptr);
+  result |= run("shared scheduler", models, &scheduler);
+  return result;
+}
+#else
+int scheduler_bench(const po::variables_map&) {
+  std::cout << "The scheduler benchmark reads /proc and is only available on Linux" << std::endl;
+  return 0;
+}
+#endif
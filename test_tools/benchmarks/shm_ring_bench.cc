@@ -0,0 +1,121 @@
+#include "benchmarks.h"
+#include "bench_util.h"
+
+#include <iostream>
+
+namespace po = boost::program_options;
+
+#ifdef __linux__
+#include "err_constants.h"
+#include "logger/shm/shm_ring.h"
+#include "logger/shm/shm_sender.h"
+#include "utility/data_buffer_streambuf.h"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace r = reinforcement_learning;
+namespace u = reinforcement_learning::utility;
+namespace shm = reinforcement_learning::logger::shm;
+
+namespace {
+  const size_t BATCH_SIZE = 1024;
+  const size_t RING_SIZE = 4 * 1024 * 1024;
+
+  long long now_ns() {
+    // CLOCK_MONOTONIC, comparable between processes
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  // A worker process: sends batches stamped with their send time through its own shm_sender.
+  int produce(const std::string& ring_name, size_t batches) {
+    shm::shm_sender sender(ring_name, RING_SIZE, std::chrono::milliseconds(10000), nullptr);
+    if (sender.init(nullptr) != r::error_code::success) return 1;
+    std::vector<char> payload(BATCH_SIZE, 'x');
+    for (size_t i = 0; i < batches; ++i) {
+      auto db = std::make_shared<u::data_buffer>(BATCH_SIZE);
+      u::data_buffer_streambuf sbuff(db.get());
+      std::ostream message(&sbuff);
+      const auto stamp = now_ns();
+      memcpy(payload.data(), &stamp, sizeof(stamp));
+      message.write(payload.data(), payload.size());
+      sbuff.finalize();
+      if (sender.send(db) != r::error_code::success) return 2;
+    }
+    return 0;
+  }
+
+  // Forks one process per producer and drains all rings from this one, the way shm_collector does.
+  int run_processes(size_t processes, size_t per_process) {
+    const auto prefix = "rlbench." + std::to_string(getpid()) + "." + std::to_string(processes);
+    std::vector<pid_t> children;
+    const auto start = bench::bench_clock::now();
+    for (size_t p = 0; p < processes; ++p) {
+      const auto child = fork();
+      if (child == 0) _exit(produce(prefix + "." + std::to_string(p), per_process));
+      children.push_back(child);
+    }
+
+    std::vector<std::unique_ptr<shm::shm_ring>> rings(processes);
+    std::vector<long long> samples;
+    samples.reserve(processes * per_process);
+    size_t received = 0;
+    size_t idle = 0;
+    while (received < processes * per_process) {
+      size_t drained = 0;
+      for (size_t p = 0; p < processes; ++p) {
+        if (rings[p] == nullptr && shm::shm_ring::open(prefix + "." + std::to_string(p), rings[p], nullptr, nullptr) != r::error_code::success) continue;
+        drained += rings[p]->read([&samples](const uint8_t* data, size_t size) {
+          long long stamp;
+          memcpy(&stamp, data + 8, sizeof(stamp));
+          samples.push_back((now_ns() - stamp) / 1000);
+        });
+      }
+      received += drained;
+      if (drained == 0 && ++idle > 1000000) break;  // a producer failed
+      if (drained > 0) idle = 0;
+    }
+    const auto duration = bench::elapsed_us(start);
+
+    int result = 0;
+    for (const auto child : children) {
+      int status = 0;
+      waitpid(child, &status, 0);
+      if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) result = -1;
+    }
+    for (size_t p = 0; p < processes; ++p) shm::shm_ring::unlink(prefix + "." + std::to_string(p));
+    if (result != 0 || received < processes * per_process) {
+      std::cerr << "A producer process failed" << std::endl;
+      return -1;
+    }
+
+    bench::report("shm ring (processes)", processes, received, duration);
+    bench::report_latency("shm ring (processes)", processes, samples);
+    std::cout << "  MB/s: " << static_cast<double>(received) * BATCH_SIZE / duration << std::endl;
+    return 0;
+  }
+}
+
+int shm_ring_bench(const po::variables_map& vm) {
+  const auto max_processes = vm["threads"].as<size_t>();
+  const auto per_process = vm["iterations"].as<size_t>();
+  std::cout << BATCH_SIZE << " byte batches, " << RING_SIZE / 1024 << " KB ring per process, one collector" << std::endl;
+
+  int result = 0;
+  for (size_t processes = 1; processes <= max_processes; processes *= 2) {
+    result |= run_processes(processes, per_process);
+  }
+  return result;
+}
+#else
+int shm_ring_bench(const po::variables_map&) {
+  std::cout << "The shared memory ring is only available on Linux" << std::endl;
+  return 0;
+}
+#endif
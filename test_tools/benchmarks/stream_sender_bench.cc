@@ -0,0 +1,144 @@
+#include "benchmarks.h"
+#include "bench_util.h"
+
+#include <iostream>
+
+namespace po = boost::program_options;
+
+#ifdef __linux__
+#include "err_constants.h"
+#include "logger/stream/stream_sender.h"
+#include "utility/data_buffer_streambuf.h"
+
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace r = reinforcement_learning;
+namespace u = reinforcement_learning::utility;
+namespace stream = reinforcement_learning::logger::stream;
+
+namespace {
+  const size_t BATCH_SIZE = 4 * 1024;
+
+  long long cpu_us() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000LL + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+  }
+
+  // Accepts one connection and counts the bytes read from it.
+  class sink {
+  public:
+    explicit sink(bool tcp) {
+      if (tcp) {
+        _fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        socklen_t len = sizeof(addr);
+        getsockname(_fd, reinterpret_cast<sockaddr*>(&addr), &len);
+        _address = "tcp:127.0.0.1:" + std::to_string(ntohs(addr.sin_port));
+      }
+      else {
+        _path = "/tmp/rl_stream_bench_" + std::to_string(getpid()) + ".sock";
+        unlink(_path.c_str());
+        _fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, _path.c_str(), sizeof(addr.sun_path) - 1);
+        bind(_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        _address = "unix:" + _path;
+      }
+      listen(_fd, 1);
+      _thread = std::thread([this] {
+        const int fd = accept(_fd, nullptr, nullptr);
+        std::vector<char> buf(256 * 1024);
+        ssize_t n;
+        while (fd >= 0 && (n = ::read(fd, buf.data(), buf.size())) > 0) _bytes += n;
+        if (fd >= 0) ::close(fd);
+      });
+    }
+
+    ~sink() {
+      _thread.join();
+      ::close(_fd);
+      if (!_path.empty()) unlink(_path.c_str());
+    }
+
+    const std::string& address() const { return _address; }
+    size_t bytes() const { return _bytes; }
+
+  private:
+    int _fd;
+    std::string _path;
+    std::string _address;
+    std::atomic<size_t> _bytes{ 0 };
+    std::thread _thread;
+  };
+
+  void run(const char* name, bool tcp, bool cork, const std::vector<r::i_sender::buffer>& batches) {
+    size_t expected = 0;
+    for (const auto& b : batches) expected += b->buffer_filled_size();
+
+    sink receiver(tcp);
+    stream::stream_sender_stats stats;
+    const auto cpu_start = cpu_us();
+    const auto start = bench::bench_clock::now();
+    long long duration;
+    {
+      stream::stream_sender_options options;
+      options.cork = cork;
+      options.max_buffered_bytes = 256 * 1024 * 1024;
+      stream::stream_sender sender(receiver.address(), options, nullptr, nullptr);
+      if (sender.init(nullptr) != r::error_code::success) return;
+      for (const auto& batch : batches) sender.send(batch);
+      while (receiver.bytes() < expected) std::this_thread::sleep_for(std::chrono::microseconds(100));
+      duration = bench::elapsed_us(start);
+      // The writer updates its stats after the write returns
+      while ((stats = sender.get_stats()).batches < batches.size()) std::this_thread::yield();
+    }
+    const auto cpu = cpu_us() - cpu_start;
+
+    bench::report(name, 1, batches.size(), duration);
+    std::cout << "  sendmsg calls: " << stats.writes
+      << ", batches per call: " << static_cast<double>(stats.batches) / (std::max)(stats.writes, uint64_t(1))
+      << ", CPU us per batch (both ends): " << static_cast<double>(cpu) / batches.size() << std::endl;
+  }
+}
+
+int stream_sender_bench(const po::variables_map& vm) {
+  const auto count = vm["iterations"].as<size_t>();
+  std::vector<char> payload(BATCH_SIZE, 'x');
+  std::vector<r::i_sender::buffer> batches;
+  for (size_t i = 0; i < count; ++i) {
+    r::i_sender::buffer db(new u::data_buffer());
+    u::data_buffer_streambuf sbuff(db.get());
+    std::ostream message(&sbuff);
+    message.write(payload.data(), payload.size());
+    sbuff.finalize();
+    batches.push_back(db);
+  }
+
+  std::cout << BATCH_SIZE << " byte batches from one thread" << std::endl;
+  run("stream unix", false, false, batches);
+  run("stream tcp nodelay", true, false, batches);
+  run("stream tcp cork", true, true, batches);
+  return 0;
+}
+#else
+int stream_sender_bench(const po::variables_map&) {
+  std::cout << "The stream sender is only available on Linux" << std::endl;
+  return 0;
+}
+#endif
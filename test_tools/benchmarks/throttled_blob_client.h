@@ -0,0 +1,71 @@
+#pragma once
+#include "utility/http_client.h"
+
+#include <cpprest/producerconsumerstream.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace bench {
+  // Serves a blob from memory as a stand-in for blob storage.  Response bodies trickle out at bytes_per_ms on
+  // their own thread, so concurrent requests behave like separate throttled connections and readers can consume
+  // a body while it is still arriving.  HEAD advertises Accept-Ranges and GET honours Range headers.
+  class throttled_blob_client : public reinforcement_learning::i_http_client {
+  public:
+    throttled_blob_client(const std::vector<unsigned char>& blob, size_t bytes_per_ms)
+      : _blob(blob), _bytes_per_ms(bytes_per_ms), _last_modified(::utility::datetime::utc_now().to_string()) {}
+
+    response_t request(method_t method) override {
+      request_t req(method);
+      return request(req);
+    }
+
+    response_t request(request_t req) override {
+      return response_t([this, req]() {
+        web::http::http_response resp;
+        resp.headers().add(U("Last-Modified"), _last_modified);
+        if (req.method() == web::http::methods::HEAD) {
+          resp.set_status_code(web::http::status_codes::OK);
+          resp.headers().add(U("Accept-Ranges"), U("bytes"));
+          resp.headers().set_content_length(_blob.size());
+          return resp;
+        }
+
+        size_t begin = 0;
+        size_t end = _blob.size() - 1;
+        const auto range = req.headers().find(U("Range"));
+        if (range != req.headers().end()) {
+          sscanf(::utility::conversions::to_utf8string(range->second).c_str(), "bytes=%zu-%zu", &begin, &end);
+          resp.set_status_code(web::http::status_codes::PartialContent);
+        }
+        else {
+          resp.set_status_code(web::http::status_codes::OK);
+        }
+
+        concurrency::streams::producer_consumer_buffer<uint8_t> body;
+        resp.set_body(body.create_istream(), end - begin + 1);
+        const auto data = _blob.data();
+        const auto bytes_per_ms = _bytes_per_ms;
+        std::thread([body, data, begin, end, bytes_per_ms]() mutable {
+          for (size_t pos = begin; pos <= end; pos += bytes_per_ms) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            body.putn_nocopy(data + pos, (std::min)(bytes_per_ms, end + 1 - pos)).wait();
+          }
+          body.close(std::ios_base::out).wait();
+        }).detach();
+        return resp;
+      });
+    }
+
+    const std::string& get_url() const override { return _url; }
+
+  private:
+    const std::vector<unsigned char>& _blob;
+    const size_t _bytes_per_ms;
+    const ::utility::string_t _last_modified;
+    const std::string _url = "http://localhost/model";
+  };
+}
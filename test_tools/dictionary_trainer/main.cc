@@ -0,0 +1,137 @@
+// Trains a zstd dictionary for logging.compression.dictionary from sample logs, files written by the file sender
+// or the stream receiver.  Each message body is a sample, bodies compressed without a dictionary are decompressed
+// first.  Train on logs of the same application: a dictionary holds the namespace names and action catalogs its
+// contexts share, which is what small batches cannot find repeated within themselves.
+#include "api_status.h"
+#include "err_constants.h"
+#include "logger/compression.h"
+#include "logger/file/segment_index.h"
+#include "logger/message_type.h"
+#include "logger/preamble.h"
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace po = boost::program_options;
+namespace r = reinforcement_learning;
+namespace rlog = reinforcement_learning::logger;
+
+namespace {
+  struct sample_stats {
+    size_t messages = 0;
+    size_t skipped = 0;  // compressed with a dictionary, or corrupt
+  };
+
+  void add_sample(const uint8_t* body, size_t size, size_t max_sample_bytes, std::vector<std::string>& samples) {
+    // Large batches are cut, the trainer looks for content shared between samples rather than within them
+    for (size_t offset = 0; offset < size; offset += max_sample_bytes) {
+      const auto length = (std::min)(max_sample_bytes, size - offset);
+      samples.emplace_back(reinterpret_cast<const char*>(body) + offset, length);
+    }
+  }
+
+  void read_samples(const std::string& file, size_t max_sample_bytes, std::vector<std::string>& samples, sample_stats& stats) {
+    std::ifstream in(file, std::ios_base::binary);
+    if (!in.good()) {
+      std::cerr << "Unable to open file: " << file << std::endl;
+      return;
+    }
+    // Closed segments end with an index, the messages stop where it starts
+    std::streamoff end = -1;
+    rlog::file::segment_trailer trailer;
+    std::vector<rlog::file::index_entry> entries;
+    if (rlog::file::read_segment_index(in, trailer, entries)) end = static_cast<std::streamoff>(trailer.index_offset);
+    in.clear();
+    in.seekg(0);
+
+    std::vector<uint8_t> body;
+    std::vector<uint8_t> original;
+    while (end < 0 || in.tellg() < end) {
+      uint8_t raw_preamble[8];
+      if (!in.read(reinterpret_cast<char*>(raw_preamble), sizeof(raw_preamble))) break;
+      rlog::preamble pre;
+      pre.read_from_bytes(raw_preamble, sizeof(raw_preamble));
+      body.resize(pre.msg_size);
+      if (!in.read(reinterpret_cast<char*>(body.data()), body.size())) break;
+
+      ++stats.messages;
+      if (pre.msg_type != rlog::message_type::compressed) {
+        add_sample(body.data(), body.size(), max_sample_bytes, samples);
+        continue;
+      }
+      uint16_t msg_type;
+      if (rlog::decompress_message(body.data(), body.size(), nullptr, msg_type, original, nullptr) != r::error_code::success) {
+        ++stats.skipped;
+        continue;
+      }
+      add_sample(original.data(), original.size(), max_sample_bytes, samples);
+    }
+  }
+}
+
+bool is_help(const po::variables_map& vm) {
+  return vm.count("help") > 0;
+}
+
+po::variables_map process_cmd_line(const int argc, char** argv) {
+  po::options_description desc("Options");
+  desc.add_options()
+    ("help", "produce help message")
+    ("input,i", po::value<std::vector<std::string>>()->multitoken()->required(),
+      "Log files, a segmented log by its base name")
+    ("output,o", po::value<std::string>()->default_value("logging.dict"), "Dictionary file")
+    ("size_kb", po::value<size_t>()->default_value(112), "Largest dictionary size")
+    ("max_sample_kb", po::value<size_t>()->default_value(16), "Message bodies are cut into samples of this size")
+    ;
+
+  po::variables_map vm;
+  store(parse_command_line(argc, argv, desc), vm);
+
+  if (is_help(vm))
+    std::cout << desc << std::endl;
+  else
+    po::notify(vm);
+
+  return vm;
+}
+
+int main(int argc, char** argv) {
+  try {
+    const auto vm = process_cmd_line(argc, argv);
+    if (is_help(vm)) return 0;
+
+    const auto max_sample_bytes = (std::max)(vm["max_sample_kb"].as<size_t>(), size_t(1)) * 1024;
+    std::vector<std::string> samples;
+    sample_stats stats;
+    for (const auto& file : vm["input"].as<std::vector<std::string>>()) {
+      if (!std::ifstream(file).good() && std::ifstream(rlog::file::segment_file_name(file, 0)).good()) {
+        for (size_t seq = 0; std::ifstream(rlog::file::segment_file_name(file, seq)).good(); ++seq) {
+          read_samples(rlog::file::segment_file_name(file, seq), max_sample_bytes, samples, stats);
+        }
+        continue;
+      }
+      read_samples(file, max_sample_bytes, samples, stats);
+    }
+    std::cout << "messages: " << stats.messages << ", skipped: " << stats.skipped << ", samples: " << samples.size() << std::endl;
+
+    std::vector<uint8_t> dictionary;
+    r::api_status status;
+    if (rlog::train_dictionary(samples, vm["size_kb"].as<size_t>() * 1024, dictionary, &status) != r::error_code::success ||
+      rlog::write_dictionary_file(vm["output"].as<std::string>(), dictionary, &status) != r::error_code::success) {
+      std::cerr << status.get_error_msg() << std::endl;
+      return -1;
+    }
+    std::cout << "dictionary " << rlog::dictionary_id(dictionary) << ", " << dictionary.size() << " bytes, written to "
+      << vm["output"].as<std::string>() << std::endl;
+  }
+  catch (const std::exception& e) {
+    std::cout << "Error: " << e.what() << std::endl;
+    return -1;
+  }
+  return 0;
+}
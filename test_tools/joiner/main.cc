@@ -39,7 +39,9 @@ void parse_and_run(int argc, char** argv) {
     ("print,p", po::value<bool>()->default_value(false),
       "Print out contents of raw log files.  (interaction.fb.data, observation.fb.data)")
     ("join,j", po::value<bool>()->default_value(false),
-        "Join the interaction and observation files and create a file to be consumed by vw for training");
+        "Join the interaction and observation files and create a file to be consumed by vw for training")
+    ("dictionary,d", po::value<std::vector<std::string>>()->multitoken()->default_value({}, ""),
+      "zstd dictionary files of the logging.compression.dictionary setting, for printing messages compressed with them");
 
   po::variables_map vm;
   store(parse_command_line(argc, argv, desc), vm);
@@ -49,7 +51,8 @@ void parse_and_run(int argc, char** argv) {
   }
   else if (vm["print"].as<bool>()) {
     joiner::convert_to_text({ "interaction.fb.data",
-                              "observation.fb.data" });
+                              "observation.fb.data" },
+                            vm["dictionary"].as<std::vector<std::string>>());
   }
   else if (vm["join"].as<bool>()) {
     std::cout << "Coming soon..." << std::endl;
@@ -5,20 +5,32 @@
 #include <iostream>
 #include <iomanip>
 #include <sstream>
+#include "../../rlclientlib/logger/compression.h"
 #include "../../rlclientlib/logger/preamble.h"
 #include "../../rlclientlib/logger/message_type.h"
+#include "../../rlclientlib/logger/file/segment_index.h"
 #include "../../rlclientlib/generated/v1/RankingEvent_generated.h"
 #include "../../rlclientlib/generated/v1/OutcomeEvent_generated.h"
+#include "api_status.h"
+#include "err_constants.h"
+#include "text_converter.h"
 // namespace aliases
 namespace rlog = reinforcement_learning::logger;
 namespace flat = reinforcement_learning::messages::flatbuff;
 ////
 
+namespace {
+  // Loaded once for all files
+  reinforcement_learning::logger::compression_dictionaries dictionaries;
+}
+
 namespace reinforcement_learning { namespace joiner {
 
   // forward declarations 
-  void convert_to_text(const std::string& file);
-  void convert_to_text(std::istream& in_strm, std::ostream& out_strm);
+  void convert_to_text(const std::string& file, std::ostream& out_strm);
+  void convert_to_text(std::istream& in_strm, std::ostream& out_strm, std::streamoff end = -1);
+  void print_segment_index(const rlog::file::segment_trailer& trailer, const std::vector<rlog::file::index_entry>& entries, std::ostream& out_strm);
+  void print_message(uint16_t msg_type, void* buff, size_t size, std::ostream& out_strm);
   void print_ranking_event(void* buff, std::ostream& out_strm);
   void print_outcome_event(void* buff, std::ostream& out_strm);
   void print_numeric_outcome(const flat::OutcomeEventHolder* evt, std::ostream& out_strm);
@@ -26,25 +38,69 @@ namespace reinforcement_learning { namespace joiner {
   void print_action_outcome(const flat::OutcomeEventHolder* evt, std::ostream& out_strm);
   ////
 
-  void convert_to_text(const std::vector<std::string>& files) {
+  void convert_to_text(const std::vector<std::string>& files, const std::vector<std::string>& dictionary_files) {
+    for (const auto& file : dictionary_files) {
+      std::vector<uint8_t> dictionary;
+      api_status status;
+      if (rlog::read_dictionary_file(file, dictionary, &status) != error_code::success ||
+        dictionaries.add(dictionary, &status) != error_code::success) {
+        std::cerr << "Unable to load a dictionary: " << status.get_error_msg() << std::endl;
+      }
+    }
     for(const auto& file : files) {
-      convert_to_text(file);
+      convert_to_text(file, std::cout);
+    }
+  }
+
+  void convert_to_text(const std::string& file, std::ostream& out_strm){
+    // A segmented log is passed by its base name, the segments are file.000000, file.000001 ...
+    if (!std::ifstream(file).good() && std::ifstream(rlog::file::segment_file_name(file, 0)).good()) {
+      for (size_t seq = 0; std::ifstream(rlog::file::segment_file_name(file, seq)).good(); ++seq) {
+        convert_segment_to_text(rlog::file::segment_file_name(file, seq), out_strm);
+      }
+      return;
     }
+    convert_segment_to_text(file, out_strm);
   }
 
-  void convert_to_text(const std::string& file){
+  void convert_segment_to_text(const std::string& file, std::ostream& out_strm){
     std::ifstream infile;
     infile.open(file, std::ios_base::binary);
     if (infile.fail() || infile.bad()){
       std::cout << "Unable to open file: " << file << std::endl;
+      return;
+    }
+    out_strm << "File:" << file << std::endl;
+
+    // Closed segments end with an index, the messages stop where it starts
+    rlog::file::segment_trailer trailer;
+    std::vector<rlog::file::index_entry> entries;
+    if (rlog::file::read_segment_index(infile, trailer, entries)) {
+      print_segment_index(trailer, entries, out_strm);
+      infile.seekg(0);
+      convert_to_text(infile, out_strm, static_cast<std::streamoff>(trailer.index_offset));
+      return;
     }
-    std::cout << "File:" << file << std::endl;
+    infile.seekg(0);
+    convert_to_text(infile, out_strm);
+  }
 
-    convert_to_text(infile, std::cout);
+  void print_segment_index(const rlog::file::segment_trailer& trailer, const std::vector<rlog::file::index_entry>& entries, std::ostream& out_strm) {
+    uint64_t events = 0;
+    int64_t min_time = 0;
+    int64_t max_time = 0;
+    for (const auto& entry : entries) {
+      events += entry.event_count;
+      if (entry.min_client_time != 0 && (min_time == 0 || entry.min_client_time < min_time)) min_time = entry.min_client_time;
+      if (entry.max_client_time > max_time) max_time = entry.max_client_time;
+    }
+    out_strm << "Segment: messages [" << trailer.entry_count << "], events [" << events << "]";
+    out_strm << ", client time [" << min_time << ", " << max_time << "] us" << std::endl;
   }
 
-  void convert_to_text(std::istream& in_strm, std::ostream& out_strm) {
+  void convert_to_text(std::istream& in_strm, std::ostream& out_strm, std::streamoff end) {
     do {
+      if (end >= 0 && in_strm.tellg() >= end) return;
       if (in_strm.fail() || in_strm.bad()) {
         std::cerr << "Error in input stream." << std::endl;
         return;
@@ -61,17 +117,32 @@ namespace reinforcement_learning { namespace joiner {
         return;
       }
 
-      switch (p.msg_type) {
-      case rlog::message_type::fb_ranking_learning_mode_event_collection:
-        print_ranking_event(msg_data.get(), out_strm);
-        break;
-      case rlog::message_type::fb_outcome_event_collection:
-        print_outcome_event(msg_data.get(), out_strm);
-        break;
-      default:
+      print_message(p.msg_type, msg_data.get(), p.msg_size, out_strm);
+    } while (!in_strm.fail() && !in_strm.bad());
+  }
+
+  void print_message(uint16_t msg_type, void* buff, size_t size, std::ostream& out_strm) {
+    switch (msg_type) {
+    case rlog::message_type::fb_ranking_learning_mode_event_collection:
+      print_ranking_event(buff, out_strm);
+      break;
+    case rlog::message_type::fb_outcome_event_collection:
+      print_outcome_event(buff, out_strm);
+      break;
+    case rlog::message_type::compressed: {
+      uint16_t original_type;
+      std::vector<uint8_t> body;
+      api_status status;
+      if (rlog::decompress_message(static_cast<const uint8_t*>(buff), size, &dictionaries, original_type, body, &status) != error_code::success) {
+        std::cerr << "Unable to decompress a message: " << status.get_error_msg() << std::endl;
         break;
       }
-    } while (!in_strm.fail() && !in_strm.bad());
+      print_message(original_type, body.data(), body.size(), out_strm);
+      break;
+    }
+    default:
+      break;
+    }
   }
 
   inline std::string to_str(const flatbuffers::String* pstr) {
@@ -1,4 +1,10 @@
 #pragma once
+#include <ostream>
+#include <string>
+#include <vector>
 namespace reinforcement_learning { namespace joiner {
-    void convert_to_text(const std::vector<std::string>& files);
+    // dictionaries are zstd dictionary files for messages compressed with one
+    void convert_to_text(const std::vector<std::string>& files, const std::vector<std::string>& dictionaries);
+    // One file or segment, prefixed with a summary of its index if it has one
+    void convert_segment_to_text(const std::string& file, std::ostream& out_strm);
 }}
\ No newline at end of file
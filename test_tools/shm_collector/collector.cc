@@ -0,0 +1,158 @@
+#include "collector.h"
+
+#include "api_status.h"
+#include "constants.h"
+#include "err_constants.h"
+#include "factory_resolver.h"
+#include "data_buffer.h"
+#include "logger/preamble.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+namespace r = reinforcement_learning;
+namespace u = r::utility;
+namespace shm = r::logger::shm;
+namespace chrono = std::chrono;
+
+namespace {
+  const chrono::milliseconds SCAN_INTERVAL(100);
+  const chrono::seconds REPORT_INTERVAL(10);
+  // Records per ring before moving on to the next one, keeps a busy process from starving the others
+  const size_t DRAIN_BATCH = 256;
+
+  void on_error(const r::api_status& status, void*) {
+    std::cerr << status.get_error_msg() << std::endl;
+  }
+}
+
+collector::collector(const u::configuration& config, const std::string& prefix, chrono::microseconds max_idle_wait)
+  : _config(config), _prefix(prefix), _max_idle_wait(max_idle_wait), _error_callback(&on_error, nullptr)
+{}
+
+bool collector::init() {
+  return create_sender(r::name::INTERACTION_SENDER_IMPLEMENTATION, r::value::INTERACTION_EH_SENDER, _interaction_sender) &&
+    create_sender(r::name::OBSERVATION_SENDER_IMPLEMENTATION, r::value::OBSERVATION_EH_SENDER, _observation_sender);
+}
+
+bool collector::create_sender(const char* implementation_key, const char* default_implementation,
+  std::unique_ptr<r::i_sender>& sender) {
+  const std::string implementation = _config.get(implementation_key, default_implementation);
+  if (implementation == r::value::INTERACTION_SHM_SENDER || implementation == r::value::OBSERVATION_SHM_SENDER) {
+    std::cerr << implementation_key << " must name a real sender, not " << implementation << std::endl;
+    return false;
+  }
+
+  r::api_status status;
+  r::i_sender* created = nullptr;
+  if (r::sender_factory.create(&created, implementation, _config, &_error_callback, nullptr, &status) != r::error_code::success) {
+    std::cerr << status.get_error_msg() << std::endl;
+    return false;
+  }
+  sender.reset(created);
+  if (sender->init(&status) != r::error_code::success) {
+    std::cerr << status.get_error_msg() << std::endl;
+    return false;
+  }
+  std::cout << "Forwarding " << implementation_key << " through " << implementation << std::endl;
+  return true;
+}
+
+void collector::run(const std::atomic<bool>& stop) {
+  auto next_scan = chrono::steady_clock::now();
+  auto next_report = next_scan + REPORT_INTERVAL;
+  chrono::microseconds idle_wait(0);
+
+  while (!stop) {
+    const auto now = chrono::steady_clock::now();
+    if (now >= next_scan) {
+      scan();
+      next_scan = now + SCAN_INTERVAL;
+    }
+    if (now >= next_report) {
+      report();
+      next_report = now + REPORT_INTERVAL;
+    }
+
+    size_t drained = 0;
+    for (auto it = _rings.begin(); it != _rings.end();) {
+      auto& state = it->second;
+      drained += drain(state);
+      // A ring is done once its process closed it or died and everything published has been read.  A producer
+      // that died between claiming and publishing leaves a hole that can never be read past.
+      if ((state.ring->producer_closed() && state.ring->empty()) || !state.ring->owner_alive()) {
+        drained += drain_all(state);
+        std::cout << "Removing " << it->first << std::endl;
+        shm::shm_ring::unlink(it->first);
+        it = _rings.erase(it);
+      }
+      else {
+        ++it;
+      }
+    }
+
+    // Back off while idle, the ceiling bounds the extra latency of the first batch after a pause
+    if (drained > 0) {
+      idle_wait = chrono::microseconds(0);
+    }
+    else {
+      idle_wait = (std::min)(_max_idle_wait, (std::max)(chrono::microseconds(10), idle_wait * 2));
+      std::this_thread::sleep_for(idle_wait);
+    }
+  }
+
+  for (auto& ring : _rings) drain_all(ring.second);
+  report();
+}
+
+void collector::scan() {
+  for (const auto& name : shm::shm_ring::list(_prefix + ".")) {
+    if (_rings.count(name) > 0) continue;
+
+    // <prefix>.<channel>.<pid>.<n>
+    const auto channel = name.substr(_prefix.size() + 1, name.find('.', _prefix.size() + 1) - _prefix.size() - 1);
+    r::i_sender* sender = channel == "interaction" ? _interaction_sender.get() :
+      channel == "observation" ? _observation_sender.get() : nullptr;
+    if (sender == nullptr) continue;
+
+    ring_state state;
+    r::api_status status;
+    // Fails while the producer is still setting the ring up, the next scan tries again
+    if (shm::shm_ring::open(name, state.ring, nullptr, &status) != r::error_code::success) continue;
+    state.sender = sender;
+    std::cout << "Collecting " << name << " (" << state.ring->capacity() << " bytes)" << std::endl;
+    _rings.emplace(name, std::move(state));
+  }
+}
+
+size_t collector::drain(ring_state& state) {
+  return state.ring->read([this, &state](const uint8_t* data, size_t size) {
+    // The record is the preamble and body exactly as the worker's sender got them
+    const size_t preamble_size = r::logger::preamble::size();
+    auto batch = std::make_shared<u::data_buffer>((std::max)(size, preamble_size + 1) - preamble_size);
+    memcpy(batch->preamble_begin(), data, size);
+    batch->set_body_endoffset(size);
+
+    r::api_status status;
+    if (state.sender->send(batch, &status) != r::error_code::success) {
+      ++_errors;
+      std::cerr << status.get_error_msg() << std::endl;
+      return;
+    }
+    ++_batches;
+    _bytes += size;
+  }, DRAIN_BATCH);
+}
+
+size_t collector::drain_all(ring_state& state) {
+  size_t total = 0;
+  while (const auto drained = drain(state)) total += drained;
+  return total;
+}
+
+void collector::report() {
+  std::cout << "rings: " << _rings.size() << ", batches: " << _batches << ", bytes: " << _bytes
+    << ", errors: " << _errors << std::endl;
+}
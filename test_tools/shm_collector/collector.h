@@ -0,0 +1,50 @@
+#pragma once
+#include "sender.h"
+#include "configuration.h"
+#include "error_callback_fn.h"
+#include "logger/shm/shm_ring.h"
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+
+// Drains the shared memory rings of every process on the host that logs through the SHM senders and forwards their
+// batches through one interaction and one observation sender.  Rings are picked up as they appear and removed once
+// their process closed them or exited and nothing is left to read.
+class collector {
+public:
+  collector(const reinforcement_learning::utility::configuration& config, const std::string& prefix,
+    std::chrono::microseconds max_idle_wait);
+
+  bool init();
+  // Runs until stop is set, then drains what is left
+  void run(const std::atomic<bool>& stop);
+
+private:
+  struct ring_state {
+    std::unique_ptr<reinforcement_learning::logger::shm::shm_ring> ring;
+    reinforcement_learning::i_sender* sender;
+  };
+
+  bool create_sender(const char* implementation_key, const char* default_implementation,
+    std::unique_ptr<reinforcement_learning::i_sender>& sender);
+  void scan();
+  size_t drain(ring_state& state);
+  // Drains until nothing published is left
+  size_t drain_all(ring_state& state);
+  void report();
+
+  const reinforcement_learning::utility::configuration _config;
+  const std::string _prefix;
+  const std::chrono::microseconds _max_idle_wait;
+  reinforcement_learning::error_callback_fn _error_callback;
+  std::unique_ptr<reinforcement_learning::i_sender> _interaction_sender;
+  std::unique_ptr<reinforcement_learning::i_sender> _observation_sender;
+  std::map<std::string, ring_state> _rings;
+
+  uint64_t _batches = 0;
+  uint64_t _bytes = 0;
+  uint64_t _errors = 0;
+};
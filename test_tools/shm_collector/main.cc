@@ -0,0 +1,85 @@
+#include "collector.h"
+#include "api_status.h"
+#include "config_utility.h"
+#include "constants.h"
+#include "err_constants.h"
+
+#include <boost/program_options.hpp>
+
+#include <atomic>
+#include <csignal>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace po = boost::program_options;
+namespace r = reinforcement_learning;
+namespace cfg = reinforcement_learning::utility::config;
+
+namespace {
+  std::atomic<bool> stop{ false };
+
+  void on_signal(int) {
+    stop = true;
+  }
+}
+
+bool is_help(const po::variables_map& vm) {
+  return vm.count("help") > 0;
+}
+
+po::variables_map process_cmd_line(const int argc, char** argv) {
+  po::options_description desc("Options");
+  desc.add_options()
+    ("help", "produce help message")
+    ("json_config,j", po::value<std::string>()->
+      default_value("client.json"), "JSON file with the config of the senders batches are forwarded through")
+    ("prefix,p", po::value<std::string>()->default_value(r::value::DEFAULT_SHM_RING_PREFIX), "Ring name prefix, shm.ring.prefix of the workers")
+    ("max_idle_wait_us", po::value<size_t>()->default_value(1000), "Longest sleep between polls while all rings are empty")
+    ;
+
+  po::variables_map vm;
+  store(parse_command_line(argc, argv, desc), vm);
+
+  if (is_help(vm))
+    std::cout << desc << std::endl;
+
+  return vm;
+}
+
+int load_config(const std::string& file_name, r::utility::configuration& config, r::api_status* status) {
+  std::ifstream fs(file_name);
+  if (!fs.good()) {
+    r::api_status::try_update(status, r::error_code::invalid_argument, ("Unable to read " + file_name).c_str());
+    return r::error_code::invalid_argument;
+  }
+  std::stringstream buffer;
+  buffer << fs.rdbuf();
+  return cfg::create_from_json(buffer.str(), config, nullptr, status);
+}
+
+int main(int argc, char** argv) {
+  try {
+    const auto vm = process_cmd_line(argc, argv);
+    if (is_help(vm)) return 0;
+
+    r::utility::configuration config;
+    r::api_status status;
+    if (load_config(vm["json_config"].as<std::string>(), config, &status) != r::error_code::success) {
+      std::cerr << status.get_error_msg() << std::endl;
+      return -1;
+    }
+
+    collector c(config, vm["prefix"].as<std::string>(), std::chrono::microseconds(vm["max_idle_wait_us"].as<size_t>()));
+    if (!c.init()) return -1;
+
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+    c.run(stop);
+  }
+  catch (const std::exception& e) {
+    std::cout << "Error: " << e.what() << std::endl;
+    return -1;
+  }
+  return 0;
+}
@@ -0,0 +1,190 @@
+// Receiving end of the stream senders for tests: accepts any number of connections on a unix or tcp address, splits
+// the streams into batches by their preamble and optionally appends the batches to a file in the file sender layout,
+// so that the joiner can read it.
+#include "api_status.h"
+#include "err_constants.h"
+#include "logger/preamble.h"
+#include "logger/stream/stream_sender.h"
+
+#include <boost/program_options.hpp>
+
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace po = boost::program_options;
+namespace r = reinforcement_learning;
+namespace stream = reinforcement_learning::logger::stream;
+
+namespace {
+  std::atomic<bool> stop{ false };
+  std::atomic<uint64_t> batches{ 0 };
+  std::atomic<uint64_t> bytes{ 0 };
+  std::atomic<uint64_t> connections{ 0 };
+  std::mutex output_mutex;
+
+  void on_signal(int) {
+    stop = true;
+  }
+
+  bool read_exact(int fd, uint8_t* data, size_t size) {
+    while (size > 0) {
+      const auto n = ::read(fd, data, size);
+      if (n < 0 && errno == EINTR) continue;
+      if (n <= 0) return false;
+      data += n;
+      size -= n;
+    }
+    return true;
+  }
+
+  void serve(int fd, std::ofstream* output) {
+    std::vector<uint8_t> batch;
+    while (true) {
+      batch.resize(r::logger::preamble::size());
+      if (!read_exact(fd, batch.data(), batch.size())) break;
+      r::logger::preamble pre;
+      pre.read_from_bytes(batch.data(), batch.size());
+      batch.resize(r::logger::preamble::size() + pre.msg_size);
+      // A batch cut off by a closed connection is sent again on the next one
+      if (!read_exact(fd, batch.data() + r::logger::preamble::size(), pre.msg_size)) break;
+
+      ++batches;
+      bytes += batch.size();
+      if (output != nullptr) {
+        std::lock_guard<std::mutex> lock(output_mutex);
+        output->write(reinterpret_cast<const char*>(batch.data()), batch.size());
+      }
+    }
+    ::close(fd);
+  }
+
+  int listen_on(const stream::stream_address& address) {
+    if (address.is_unix) {
+      const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+      sockaddr_un addr{};
+      addr.sun_family = AF_UNIX;
+      strncpy(addr.sun_path, address.path.c_str(), sizeof(addr.sun_path) - 1);
+      unlink(address.path.c_str());
+      if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(fd, 128) != 0) return -1;
+      return fd;
+    }
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    addrinfo* addresses = nullptr;
+    if (getaddrinfo(address.host.c_str(), address.port.c_str(), &hints, &addresses) != 0) return -1;
+    int fd = -1;
+    for (auto ai = addresses; ai != nullptr && fd < 0; ai = ai->ai_next) {
+      fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+      if (fd < 0) continue;
+      const int reuse = 1;
+      setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+      if (bind(fd, ai->ai_addr, ai->ai_addrlen) != 0 || listen(fd, 128) != 0) {
+        ::close(fd);
+        fd = -1;
+      }
+    }
+    freeaddrinfo(addresses);
+    return fd;
+  }
+
+  void report() {
+    std::cout << "connections: " << connections << ", batches: " << batches << ", bytes: " << bytes << std::endl;
+  }
+}
+
+bool is_help(const po::variables_map& vm) {
+  return vm.count("help") > 0;
+}
+
+po::variables_map process_cmd_line(const int argc, char** argv) {
+  po::options_description desc("Options");
+  desc.add_options()
+    ("help", "produce help message")
+    ("address,a", po::value<std::string>()->default_value("unix:/tmp/rl_stream.sock"), "unix:/path or tcp:host:port to listen on")
+    ("output,o", po::value<std::string>()->default_value(""), "File the batches are appended to, nothing is written if empty")
+    ("report_interval_s", po::value<size_t>()->default_value(10), "Seconds between statistics lines")
+    ;
+
+  po::variables_map vm;
+  store(parse_command_line(argc, argv, desc), vm);
+
+  if (is_help(vm))
+    std::cout << desc << std::endl;
+
+  return vm;
+}
+
+int main(int argc, char** argv) {
+  try {
+    const auto vm = process_cmd_line(argc, argv);
+    if (is_help(vm)) return 0;
+
+    stream::stream_address address;
+    r::api_status status;
+    if (stream::parse_stream_address(vm["address"].as<std::string>(), address, nullptr, &status) != r::error_code::success) {
+      std::cerr << status.get_error_msg() << std::endl;
+      return -1;
+    }
+    const int listen_fd = listen_on(address);
+    if (listen_fd < 0) {
+      std::cerr << "Unable to listen on " << vm["address"].as<std::string>() << ": " << strerror(errno) << std::endl;
+      return -1;
+    }
+
+    std::unique_ptr<std::ofstream> output;
+    const auto output_name = vm["output"].as<std::string>();
+    if (!output_name.empty()) output.reset(new std::ofstream(output_name, std::ios::binary));
+
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+    std::thread reporter([&vm] {
+      const auto interval = std::chrono::seconds(vm["report_interval_s"].as<size_t>());
+      auto next = std::chrono::steady_clock::now() + interval;
+      while (!stop) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (std::chrono::steady_clock::now() < next) continue;
+        report();
+        next += interval;
+      }
+    });
+
+    std::cout << "Listening on " << vm["address"].as<std::string>() << std::endl;
+    while (!stop) {
+      const int fd = accept(listen_fd, nullptr, nullptr);
+      if (fd < 0) {
+        if (errno == EINTR) continue;
+        break;
+      }
+      ++connections;
+      std::thread(serve, fd, output.get()).detach();
+    }
+
+    stop = true;
+    reporter.join();
+    ::close(listen_fd);
+    if (address.is_unix) unlink(address.path.c_str());
+    std::lock_guard<std::mutex> lock(output_mutex);
+    report();
+    if (output != nullptr) output->flush();
+  }
+  catch (const std::exception& e) {
+    std::cout << "Error: " << e.what() << std::endl;
+    return -1;
+  }
+  return 0;
+}
@@ -3,12 +3,17 @@
 #   define BOOST_TEST_MODULE Main
 #endif
 #include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <set>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 #include "data_buffer.h"
 #include "err_constants.h"
 #include "serialization/json_serializer.h"
 #include "logger/async_batcher.h"
+#include "logger/preamble.h"
 #include "sender.h"
 using namespace reinforcement_learning;
 //This class simply implement a 'send' method, in order to be used as a template in the async_batcher
@@ -40,7 +45,7 @@ public:
     return *this;
   }
 
-  bool try_drop(float drop_prob, int _drop_pass) override { return false; }
+  bool try_drop(float drop_prob) override { return false; }
   std::string get_event_id() { return _seed_id; }
 };
 class test_droppable_event : public event {
@@ -58,7 +63,7 @@ public:
     return *this;
   }
 
-  bool try_drop(float drop_prob, int _drop_pass) override { return true; }
+  bool try_drop(float drop_prob) override { return true; }
 };
 namespace reinforcement_learning { namespace logger {
   template <>
@@ -85,6 +90,29 @@ namespace reinforcement_learning { namespace logger {
   };
 }}
 
+// Dropped by the regular pass probability draw on its id
+class test_joined_event : public event {
+public:
+  test_joined_event() {}
+  test_joined_event(const std::string& id) : event(id.c_str(), timestamp{}) {}
+  test_joined_event(test_joined_event&& other) : event(std::move(other)) {}
+  test_joined_event& operator=(test_joined_event&& other) {
+    if (&other != this) event::operator=(std::move(other));
+    return *this;
+  }
+};
+namespace reinforcement_learning { namespace logger {
+  template <>
+  struct json_event_serializer<test_joined_event> {
+    using serializer_t = json_event_serializer<test_joined_event>;
+    static int serialize(test_joined_event& evt, std::ostream& out, api_status* status) {
+      out << evt.get_seed_id();
+      return error_code::success;
+    }
+    static size_t size_estimate(const test_joined_event& evt) { return 10; }
+  };
+}}
+
 void expect_no_error(const api_status& s, void* cntxt) {
   BOOST_ASSERT(s.get_error_code() == error_code::success);
   BOOST_FAIL("Should not get background error notifications");
@@ -190,3 +218,351 @@ BOOST_AUTO_TEST_CASE(convert_to_queue_mode_enum) {
   BOOST_CHECK_EQUAL(BLOCK, to_queue_mode_enum("BLOCK")); //default is DROP
   BOOST_CHECK_EQUAL(DROP, to_queue_mode_enum("something_else"));
 }
+
+//test that one engine thread drains several batchers, each on its own interval
+BOOST_AUTO_TEST_CASE(logging_engine_drains_batchers) {
+  std::vector<std::string> fast_items;
+  std::vector<std::string> slow_items;
+  error_callback_fn error_fn(expect_no_error, nullptr);
+  utility::watchdog watchdog(nullptr);
+  logger::logging_engine engine(watchdog, &error_fn);
+  BOOST_REQUIRE_EQUAL(engine.init(nullptr), error_code::success);
+  {
+    logger::async_batcher<test_undroppable_event> fast(new message_sender(fast_items), watchdog, &error_fn, 262143, 50,
+      8192, DROP, &engine, logger::logging_priority::interaction);
+    logger::async_batcher<test_undroppable_event> slow(new message_sender(slow_items), watchdog, &error_fn, 262143, 100000,
+      8192, DROP, &engine, logger::logging_priority::observation);
+    BOOST_REQUIRE_EQUAL(fast.init(nullptr), error_code::success);
+    BOOST_REQUIRE_EQUAL(slow.init(nullptr), error_code::success);
+
+    fast.append(test_undroppable_event(std::string("foo")));
+    slow.append(test_undroppable_event(std::string("bar")));
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    // Only the fast batcher was due, each pass ran it alone
+    const auto stats = engine.get_stats();
+    BOOST_CHECK_GT(stats.passes, 0);
+    BOOST_CHECK_EQUAL(stats.iterations, stats.passes);
+  }
+  BOOST_REQUIRE_EQUAL(fast_items.size(), 1);
+  BOOST_CHECK_EQUAL(fast_items[0], "foo\n");
+  // The slow batcher sent its event when it was deleted
+  BOOST_REQUIRE_EQUAL(slow_items.size(), 1);
+  BOOST_CHECK_EQUAL(slow_items[0], "bar\n");
+}
+
+//test that a batcher leaves the engine and flushes when it is deleted
+BOOST_AUTO_TEST_CASE(logging_engine_batcher_flushes_on_deletion) {
+  std::vector<std::string> items;
+  utility::watchdog watchdog(nullptr);
+  logger::logging_engine engine(watchdog);
+  BOOST_REQUIRE_EQUAL(engine.init(nullptr), error_code::success);
+
+  for (int i = 0; i < 20; ++i) {
+    auto batcher = new logger::async_batcher<test_undroppable_event>(new message_sender(items), watchdog, nullptr,
+      262143, 1, 8192, DROP, &engine);
+    batcher->init(nullptr);
+    batcher->append(test_undroppable_event(std::to_string(i)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(i % 3));
+    delete batcher;
+  }
+  BOOST_REQUIRE_EQUAL(items.size(), 20);
+  for (int i = 0; i < 20; ++i) BOOST_CHECK_EQUAL(items[i], std::to_string(i) + "\n");
+}
+
+namespace {
+  std::set<std::string> shipped_ids(const std::vector<std::string>& items) {
+    std::set<std::string> ids;
+    for (const auto& item : items) {
+      std::istringstream lines(item);
+      std::string id;
+      while (std::getline(lines, id)) ids.insert(id);
+    }
+    return ids;
+  }
+
+  // Interactions and their outcomes through batchers that cannot keep up, the observation queue being the smaller.
+  // Returns the fraction of shipped events that have their other half shipped too.
+  float joinable_fraction(logger::drop_level* level, size_t& orphan_outcomes) {
+    std::vector<std::string> interaction_items;
+    std::vector<std::string> observation_items;
+    utility::watchdog watchdog(nullptr);
+    {
+      logger::async_batcher<test_joined_event> interactions(new message_sender(interaction_items), watchdog, nullptr,
+        262143, 5, 2000, DROP, nullptr, logger::logging_priority::interaction, nullptr, level);
+      logger::async_batcher<test_joined_event> observations(new message_sender(observation_items), watchdog, nullptr,
+        262143, 5, 500, DROP, nullptr, logger::logging_priority::observation, nullptr, level);
+      interactions.init(nullptr);
+      observations.init(nullptr);
+      for (int i = 0; i < 20000; ++i) {
+        const auto id = "event-" + std::to_string(i);
+        interactions.append(test_joined_event(id));
+        observations.append(test_joined_event(id));
+        if (i % 200 == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    }
+
+    const auto interaction_ids = shipped_ids(interaction_items);
+    const auto observation_ids = shipped_ids(observation_items);
+    size_t joined = 0;
+    orphan_outcomes = 0;
+    for (const auto& id : observation_ids) {
+      if (interaction_ids.count(id) > 0) ++joined;
+      else ++orphan_outcomes;
+    }
+    BOOST_CHECK_LT(observation_ids.size(), 20000);
+    return 2.f * joined / (interaction_ids.size() + observation_ids.size());
+  }
+}
+
+//test that loggers sharing a drop level shed the same event ids
+BOOST_AUTO_TEST_CASE(shared_drop_level_keeps_events_joinable) {
+  size_t independent_orphans;
+  const auto independent = joinable_fraction(nullptr, independent_orphans);
+
+  logger::drop_level level;
+  size_t joined_orphans;
+  const auto joined = joinable_fraction(&level, joined_orphans);
+
+  // No outcome is shipped without its interaction, and most of what is shipped can be joined
+  BOOST_CHECK_EQUAL(joined_orphans, 0);
+  BOOST_CHECK_GT(independent_orphans, 0);
+  BOOST_CHECK_GT(joined, independent);
+  BOOST_CHECK_GT(joined, 0.8f);
+  BOOST_TEST_MESSAGE("joinable fraction independent " << independent << ", shared drop level " << joined);
+}
+
+BOOST_AUTO_TEST_CASE(drop_level_follows_the_lowest_source) {
+  logger::drop_level level(std::chrono::milliseconds(100));
+  const auto a = level.add_source();
+  const auto b = level.add_source();
+  BOOST_CHECK_EQUAL(level.level(), 1.f);
+
+  level.set(a, 0.4f);
+  level.set(b, 0.8f);
+  BOOST_CHECK_EQUAL(level.level(), 0.4f);
+  level.set(a, 1.f);
+  BOOST_CHECK_EQUAL(level.level(), 0.8f);
+
+  // Shed ids are remembered for at least half the join window
+  BOOST_CHECK(!level.was_shed("event-1"));
+  level.remember_shed("event-1");
+  BOOST_CHECK(level.was_shed("event-1"));
+  BOOST_CHECK(!level.was_shed("event-2"));
+  std::this_thread::sleep_for(std::chrono::milliseconds(60));
+  level.remember_shed("event-2");
+  BOOST_CHECK(level.was_shed("event-1"));
+  std::this_thread::sleep_for(std::chrono::milliseconds(60));
+  BOOST_CHECK(!level.was_shed("event-1"));
+  BOOST_CHECK(level.was_shed("event-2"));
+}
+
+BOOST_AUTO_TEST_CASE(drop_level_grows_its_filter_with_the_shed_rate) {
+  // Far more ids than the smallest filter holds are shed within the window
+  const auto shed = [](logger::drop_level& level, const char* prefix, int count) {
+    for (int i = 0; i < count; ++i) level.remember_shed(prefix + std::to_string(i));
+  };
+  const auto remembered = [](logger::drop_level& level, const char* prefix, int from, int to) {
+    int found = 0;
+    for (int i = from; i < to; ++i) found += level.was_shed(prefix + std::to_string(i)) ? 1 : 0;
+    return found;
+  };
+
+  logger::drop_level level(std::chrono::minutes(10));
+  BOOST_CHECK(level.remembered_window() == std::chrono::minutes(5));
+  shed(level, "a-", 120000);
+  shed(level, "b-", 300000);
+  // The first generation filled up early, the next one was sized for the rate and still holds its first ids
+  BOOST_CHECK(level.remembered_window() < std::chrono::minutes(5));
+  BOOST_CHECK_EQUAL(remembered(level, "a-", 110000, 111000), 1000);
+  BOOST_CHECK_EQUAL(remembered(level, "b-", 0, 1000), 1000);
+  BOOST_CHECK_EQUAL(remembered(level, "b-", 299000, 300000), 1000);
+
+  // Capped at the smallest filter, generations keep filling up and ids are forgotten within the window
+  logger::drop_level capped(std::chrono::minutes(10), 0);
+  shed(capped, "a-", 120000);
+  shed(capped, "b-", 300000);
+  BOOST_CHECK(capped.remembered_window() < std::chrono::minutes(5));
+  BOOST_CHECK_LT(remembered(capped, "a-", 110000, 111000), 100);
+  BOOST_CHECK_EQUAL(remembered(capped, "b-", 299000, 300000), 1000);
+}
+
+namespace {
+  // Holds every batch until released, as a sender stuck on a dead connection would
+  class stuck_sender : public logger::i_message_sender {
+  public:
+    stuck_sender(std::atomic<bool>& released, std::vector<std::string>& items)
+      : _released(released), _items(items) {}
+
+    int send(const uint16_t msg_type, const buffer& db, api_status* status = nullptr) override {
+      while (!_released) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      _items.emplace_back(reinterpret_cast<char*>(db->body_begin()));
+      return error_code::success;
+    }
+    int init(api_status* status) override { return error_code::success; }
+
+  private:
+    std::atomic<bool>& _released;
+    std::vector<std::string>& _items;
+  };
+}
+
+//test that BLOCK mode appends give up after the block timeout while the sender is stuck, and report the pressure
+BOOST_AUTO_TEST_CASE(block_mode_times_out_when_sender_is_stuck) {
+  std::atomic<bool> released{ false };
+  std::vector<std::string> items;
+  utility::watchdog watchdog(nullptr);
+  const size_t block_timeout_ms = 50;
+  auto batcher = new logger::async_batcher<test_undroppable_event>(new stuck_sender(released, items), watchdog, nullptr,
+    8, 5, 50, BLOCK, nullptr, logger::logging_priority::interaction, nullptr, nullptr, block_timeout_ms);
+  BOOST_REQUIRE_EQUAL(batcher->init(nullptr), error_code::success);
+
+  std::atomic<int> succeeded{ 0 };
+  std::atomic<int> timed_out{ 0 };
+  std::atomic<long long> longest_wait_ms{ 0 };
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < 40; ++i) {
+        api_status status;
+        const auto start = std::chrono::steady_clock::now();
+        const auto code = batcher->append(test_undroppable_event(std::to_string(t * 1000 + i)), &status);
+        const long long waited = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        if (code == error_code::success) ++succeeded;
+        else if (code == error_code::logging_queue_timeout && status.get_error_code() == code) ++timed_out;
+        long long longest = longest_wait_ms;
+        while (waited > longest && !longest_wait_ms.compare_exchange_weak(longest, waited)) {}
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  // No request thread is held much past the timeout, the appends that gave up are visible in the pressure
+  BOOST_CHECK_EQUAL(succeeded + timed_out, 8 * 40);
+  BOOST_CHECK_GT(timed_out, 0);
+  BOOST_CHECK_LT(longest_wait_ms, block_timeout_ms * 5);
+  auto pressure = batcher->get_pressure();
+  BOOST_CHECK_EQUAL(pressure.fill_ratio, 1.f);
+  BOOST_CHECK_EQUAL(pressure.block_timeouts, timed_out);
+  BOOST_CHECK_EQUAL(pressure.dropped, timed_out);
+
+  // Once the sender recovers the queue drains and appends go through again
+  released = true;
+  for (int i = 0; i < 100 && batcher->get_pressure().fill_ratio > 0.5f; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  BOOST_CHECK_EQUAL(batcher->append(test_undroppable_event("after")), error_code::success);
+  delete batcher;
+
+  // Every event that was accepted was shipped
+  BOOST_CHECK_EQUAL(shipped_ids(items).size(), succeeded + 1);
+}
+
+//test that the drop rate and fill ratio report an overloaded DROP mode queue
+BOOST_AUTO_TEST_CASE(drop_mode_reports_pressure) {
+  std::atomic<bool> released{ false };
+  std::vector<std::string> items;
+  utility::watchdog watchdog(nullptr);
+  const size_t batch_timeout_ms = 20;
+  logger::async_batcher<test_joined_event> batcher(new stuck_sender(released, items), watchdog, nullptr,
+    100, batch_timeout_ms, 1000, DROP);
+  BOOST_REQUIRE_EQUAL(batcher.init(nullptr), error_code::success);
+  BOOST_CHECK_EQUAL(batcher.get_pressure().fill_ratio, 0.f);
+  // Wait for the background thread to get stuck sending a first batch
+  batcher.append(test_joined_event("first"));
+  std::this_thread::sleep_for(std::chrono::milliseconds(3 * batch_timeout_ms));
+
+  // Dropped events are not an error for the caller
+  std::atomic<int> failed{ 0 };
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&batcher, &failed, t] {
+      for (int i = 0; i < 2000; ++i) {
+        if (batcher.append(test_joined_event(std::to_string(t * 10000 + i))) != error_code::success) ++failed;
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  BOOST_CHECK_EQUAL(failed, 0);
+  std::this_thread::sleep_for(std::chrono::milliseconds(2 * batch_timeout_ms));
+
+  // The rate is current even though the background thread is stuck in the sender
+  const auto pressure = batcher.get_pressure();
+  BOOST_CHECK_GT(pressure.fill_ratio, 0.75f);
+  BOOST_CHECK_GT(pressure.dropped, 4 * 2000 / 2);
+  BOOST_CHECK_GT(pressure.drop_rate, 0.25f);
+  BOOST_CHECK_EQUAL(pressure.block_timeouts, 0);
+  released = true;
+}
+
+//test that batches are packed up to the maximum message size, and that the event crossing it starts the next batch
+BOOST_AUTO_TEST_CASE(exact_packing_fills_batches_to_the_max_message_size) {
+  std::vector<std::string> items;
+  utility::watchdog watchdog(nullptr);
+  const size_t max_body_size = 100;
+  auto batcher = new logger::async_batcher<test_undroppable_event>(new message_sender(items), watchdog, nullptr,
+    1024 * 1024, 100000, 16 * 1024 * 1024, DROP, nullptr, logger::logging_priority::interaction, nullptr, nullptr, 1000,
+    nullptr, max_body_size + logger::preamble::size());
+  BOOST_REQUIRE_EQUAL(batcher->init(nullptr), error_code::success);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+  // Lines of 1 to 40 bytes, a long one that fits no batch in the middle
+  std::vector<std::string> sent;
+  for (size_t i = 0; i < 60; ++i) {
+    sent.push_back(std::string(1 + i * 7 % 40, static_cast<char>('a' + i % 26)) + "\n");
+  }
+  sent[30] = std::string(2 * max_body_size, 'z') + "\n";
+  for (const auto& line : sent) {
+    batcher->append(test_undroppable_event(line.substr(0, line.size() - 1)));
+  }
+  delete batcher;
+
+  // Nothing lost or reordered, every batch but the oversized one within the limit, and each cut only because the
+  // next event did not fit
+  std::string shipped;
+  size_t next = 0;
+  for (size_t b = 0; b < items.size(); ++b) {
+    shipped += items[b];
+    size_t batch_size = 0;
+    while (batch_size < items[b].size()) batch_size += sent[next++].size();
+    BOOST_REQUIRE_EQUAL(batch_size, items[b].size());
+    if (items[b] == sent[30]) continue;
+    BOOST_CHECK_LE(items[b].size(), max_body_size);
+    if (b + 1 < items.size()) {
+      BOOST_CHECK_GT(items[b].size() + sent[next].size(), max_body_size);
+    }
+  }
+  std::string expected;
+  for (const auto& line : sent) expected += line;
+  BOOST_CHECK_EQUAL(shipped, expected);
+}
+
+//test that adaptive batching backs off on the completion latency of an asynchronous sender, not on the time send takes
+BOOST_AUTO_TEST_CASE(adaptive_batching_follows_the_completion_latency) {
+  // Returns right away like eventhub_client, its requests take half a second to complete
+  class async_sender : public message_sender {
+  public:
+    using message_sender::message_sender;
+    std::chrono::microseconds completion_latency() const override { return std::chrono::milliseconds(500); }
+  };
+
+  std::vector<std::string> items;
+  utility::watchdog watchdog(nullptr);
+  logger::batch_controller_options adaptive;
+  adaptive.min_batch_size = 64;
+  adaptive.max_batch_size = 1024;
+  adaptive.min_interval = std::chrono::milliseconds(5);
+  adaptive.max_interval = std::chrono::milliseconds(20);
+  adaptive.target_latency = std::chrono::milliseconds(100);
+  logger::async_batcher<test_undroppable_event> batcher(new async_sender(items), watchdog, nullptr,
+    1024, 10, 16 * 1024 * 1024, DROP, nullptr, logger::logging_priority::interaction, nullptr, nullptr, 1000, &adaptive);
+  BOOST_REQUIRE_EQUAL(batcher.init(nullptr), error_code::success);
+
+  for (int i = 0; i < 50 && batcher.get_pressure().batch_size >= 1024; ++i) {
+    batcher.append(test_undroppable_event(std::string(100, 'x')));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  const auto pressure = batcher.get_pressure();
+  BOOST_CHECK_LT(pressure.batch_size, 1024);
+  BOOST_CHECK_GE(pressure.send_latency_us, 500 * 1000);
+}
@@ -0,0 +1,220 @@
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE Main
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include "utility/background_scheduler.h"
+#include "utility/periodic_background_proc.h"
+#include "utility/timer_wheel.h"
+#include "utility/watchdog.h"
+#include "api_status.h"
+#include "err_constants.h"
+#include "trace_logger.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace r = reinforcement_learning;
+namespace u = reinforcement_learning::utility;
+
+BOOST_AUTO_TEST_CASE(timer_wheel_expires_in_order) {
+  u::timer_wheel wheel;
+  const auto late = wheel.schedule(300);
+  const auto soon = wheel.schedule(5);
+  const auto mid = wheel.schedule(70);
+  BOOST_CHECK_EQUAL(wheel.size(), 3);
+  BOOST_CHECK_EQUAL(wheel.next_event(), 5);
+
+  std::vector<u::timer_wheel::timer_id> expired;
+  wheel.advance(4, expired);
+  BOOST_CHECK(expired.empty());
+  wheel.advance(1000, expired);
+  BOOST_REQUIRE_EQUAL(expired.size(), 3);
+  BOOST_CHECK_EQUAL(expired[0], soon);
+  BOOST_CHECK_EQUAL(expired[1], mid);
+  BOOST_CHECK_EQUAL(expired[2], late);
+  BOOST_CHECK_EQUAL(wheel.size(), 0);
+  BOOST_CHECK_EQUAL(wheel.next_event(), u::timer_wheel::never);
+}
+
+BOOST_AUTO_TEST_CASE(timer_wheel_cancel_and_past_timers) {
+  u::timer_wheel wheel(100);
+  const auto cancelled = wheel.schedule(150);
+  const auto past = wheel.schedule(50);
+  BOOST_CHECK(wheel.cancel(cancelled));
+  BOOST_CHECK(!wheel.cancel(cancelled));
+
+  // A timer in the past expires on the next tick
+  std::vector<u::timer_wheel::timer_id> expired;
+  wheel.advance(101, expired);
+  BOOST_REQUIRE_EQUAL(expired.size(), 1);
+  BOOST_CHECK_EQUAL(expired[0], past);
+  wheel.advance(200, expired);
+  BOOST_CHECK_EQUAL(expired.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(timer_wheel_matches_sorted_reference) {
+  // Timers across all levels and beyond the horizon, advanced in random steps
+  std::mt19937_64 rng(7);
+  u::timer_wheel wheel(12345);
+  std::map<u::timer_wheel::timer_id, uint64_t> reference;
+  for (int i = 0; i < 2000; ++i) {
+    const uint64_t range = uint64_t(1) << (rng() % 27);
+    const auto expires = wheel.now() + 1 + rng() % range;
+    reference[wheel.schedule(expires)] = expires;
+  }
+  for (auto it = reference.begin(); it != reference.end();) {
+    if (rng() % 10 == 0) {
+      BOOST_CHECK(wheel.cancel(it->first));
+      it = reference.erase(it);
+    }
+    else ++it;
+  }
+
+  std::vector<u::timer_wheel::timer_id> expired;
+  while (!reference.empty()) {
+    const auto now = wheel.now() + rng() % (uint64_t(1) << (rng() % 24));
+    expired.clear();
+    wheel.advance(now, expired);
+    uint64_t last = 0;
+    for (const auto id : expired) {
+      const auto it = reference.find(id);
+      BOOST_REQUIRE(it != reference.end());
+      BOOST_CHECK_LE(it->second, now);
+      BOOST_CHECK_LE(last, it->second);
+      last = it->second;
+      reference.erase(it);
+    }
+    for (const auto& kv : reference) BOOST_REQUIRE_GT(kv.second, now);
+    BOOST_CHECK_EQUAL(wheel.size(), reference.size());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(background_scheduler_runs_tasks_periodically) {
+  u::background_scheduler_options options;
+  options.threads = 2;
+  u::background_scheduler scheduler(options, nullptr);
+  BOOST_REQUIRE_EQUAL(scheduler.init(nullptr), r::error_code::success);
+
+  std::atomic<int> fast{ 0 };
+  std::atomic<int> slow{ 0 };
+  std::atomic<int> running{ 0 };
+  std::atomic<bool> overlapped{ false };
+  const auto fast_id = scheduler.add([&] {
+    if (running++ > 0) overlapped = true;
+    ++fast;
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    --running;
+  }, std::chrono::milliseconds(10));
+  const auto slow_id = scheduler.add([&] { ++slow; }, std::chrono::milliseconds(100000));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+  scheduler.remove(fast_id);
+  const auto after_remove = fast.load();
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  // Runs right away and then every interval after the previous run finished, never on two workers at once
+  BOOST_CHECK_GE(after_remove, 10);
+  BOOST_CHECK_LE(after_remove, 30);
+  BOOST_CHECK(!overlapped);
+  BOOST_CHECK_EQUAL(fast, after_remove);
+  BOOST_CHECK_EQUAL(slow, 1);
+  scheduler.remove(slow_id);
+
+  const auto stats = scheduler.get_stats();
+  BOOST_CHECK_EQUAL(stats.runs, static_cast<uint64_t>(after_remove + 1));
+  BOOST_CHECK_GE(stats.wakeups, static_cast<uint64_t>(after_remove - 1));
+}
+
+namespace {
+  struct vector_tracer : r::i_trace {
+    void log(int log_level, const std::string& msg) override {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (log_level == r::LEVEL_WARN) ++warning_count;
+    }
+    int warnings() {
+      std::lock_guard<std::mutex> lock(mutex);
+      return warning_count;
+    }
+    int warning_count = 0;
+    std::mutex mutex;
+  };
+}
+
+BOOST_AUTO_TEST_CASE(background_scheduler_shared_instance_and_cpus) {
+  auto first = u::background_scheduler::shared(u::background_scheduler_options(), nullptr);
+  auto second = u::background_scheduler::shared(u::background_scheduler_options(), nullptr);
+  BOOST_CHECK(first == second);
+
+  // Other options get the same instance, and a warning
+  vector_tracer trace;
+  u::background_scheduler_options other;
+  other.threads = 4;
+  auto third = u::background_scheduler::shared(other, &trace);
+  BOOST_CHECK(first == third);
+  BOOST_CHECK_EQUAL(trace.warnings(), 1);
+  u::background_scheduler::shared(u::background_scheduler_options(), &trace);
+  BOOST_CHECK_EQUAL(trace.warnings(), 1);
+
+  const auto cpus = u::background_scheduler::parse_cpus("0, 2,x,3");
+  BOOST_REQUIRE_EQUAL(cpus.size(), 3);
+  BOOST_CHECK_EQUAL(cpus[0], 0);
+  BOOST_CHECK_EQUAL(cpus[1], 2);
+  BOOST_CHECK_EQUAL(cpus[2], 3);
+
+  u::background_scheduler_options pinned;
+  pinned.cpus = { 0 };
+  u::background_scheduler scheduler(pinned, nullptr);
+  BOOST_REQUIRE_EQUAL(scheduler.init(nullptr), r::error_code::success);
+  std::atomic<int> runs{ 0 };
+  const auto id = scheduler.add([&] { ++runs; }, std::chrono::milliseconds(1000));
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  scheduler.remove(id);
+  BOOST_CHECK_EQUAL(runs, 1);
+}
+
+namespace {
+  struct counting_proc {
+    std::atomic<int> runs{ 0 };
+    std::chrono::milliseconds delay{ 0 };
+    int run_iteration(r::api_status*) {
+      ++runs;
+      std::this_thread::sleep_for(delay);
+      return r::error_code::success;
+    }
+  };
+}
+
+BOOST_AUTO_TEST_CASE(periodic_background_proc_on_scheduler_checks_in) {
+  u::watchdog watchdog(nullptr);
+  BOOST_REQUIRE_EQUAL(watchdog.start(nullptr), r::error_code::success);
+  u::background_scheduler scheduler(u::background_scheduler_options(), nullptr);
+
+  counting_proc healthy;
+  counting_proc stuck;
+  {
+    u::periodic_background_proc<counting_proc> proc(20, watchdog, "Scheduled proc", nullptr, &scheduler);
+    BOOST_REQUIRE_EQUAL(proc.init(&healthy), r::error_code::success);
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+  }
+  BOOST_CHECK_GE(healthy.runs, 5);
+  BOOST_CHECK(!watchdog.has_background_error_been_reported());
+
+  // A task that stops coming back is reported like a hung thread
+  stuck.delay = std::chrono::milliseconds(400);
+  {
+    u::periodic_background_proc<counting_proc> proc(20, watchdog, "Stuck proc", nullptr, &scheduler);
+    BOOST_REQUIRE_EQUAL(proc.init(&stuck), r::error_code::success);
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    BOOST_CHECK(watchdog.has_background_error_been_reported());
+  }
+  BOOST_CHECK_EQUAL(stuck.runs, 1);
+}
@@ -0,0 +1,90 @@
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE Main
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include "logger/batch_controller.h"
+
+#include <chrono>
+
+namespace rlog = reinforcement_learning::logger;
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+
+namespace {
+  rlog::batch_controller_options test_options() {
+    rlog::batch_controller_options options;
+    options.min_batch_size = 10 * 1024;
+    options.max_batch_size = 100 * 1024;
+    options.min_interval = milliseconds(10);
+    options.max_interval = milliseconds(200);
+    options.target_latency = milliseconds(50);
+    return options;
+  }
+
+  // One flush of queued_bytes sent in batches that each took latency_ms
+  void flush(rlog::batch_controller& controller, size_t queued_bytes, int latency_ms, float occupancy = -1.f) {
+    controller.on_send(milliseconds(latency_ms), occupancy);
+    controller.on_flush(queued_bytes);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(batch_controller_starts_within_bounds) {
+  const auto options = test_options();
+  rlog::batch_controller large(options, 1024 * 1024, milliseconds(5000));
+  BOOST_CHECK_EQUAL(large.batch_size(), options.max_batch_size);
+  BOOST_CHECK(large.interval() == options.max_interval);
+
+  rlog::batch_controller small(options, 1, milliseconds(1));
+  BOOST_CHECK_EQUAL(small.batch_size(), options.min_batch_size);
+  BOOST_CHECK(small.interval() == options.min_interval);
+}
+
+BOOST_AUTO_TEST_CASE(batch_controller_batch_size_follows_aimd) {
+  const auto options = test_options();
+  rlog::batch_controller controller(options, 20 * 1024, milliseconds(100));
+
+  // Full batches sent fast grow by one step per flush, up to the maximum
+  flush(controller, 40 * 1024, 5);
+  BOOST_CHECK_EQUAL(controller.batch_size(), 30 * 1024);
+  for (int i = 0; i < 20; ++i) flush(controller, 200 * 1024, 5);
+  BOOST_CHECK_EQUAL(controller.batch_size(), options.max_batch_size);
+
+  // A slow send halves it, down to the minimum
+  flush(controller, 200 * 1024, 80);
+  BOOST_CHECK_EQUAL(controller.batch_size(), 50 * 1024);
+  for (int i = 0; i < 10; ++i) flush(controller, 200 * 1024, 80);
+  BOOST_CHECK_EQUAL(controller.batch_size(), options.min_batch_size);
+
+  // Batches that are not full do not need to grow
+  flush(controller, 5 * 1024, 5);
+  BOOST_CHECK_EQUAL(controller.batch_size(), options.min_batch_size);
+
+  const auto stats = controller.get_stats();
+  BOOST_CHECK_EQUAL(stats.size_increases, 8);
+  BOOST_CHECK_EQUAL(stats.size_decreases, 4);
+}
+
+BOOST_AUTO_TEST_CASE(batch_controller_interval_follows_the_queue) {
+  const auto options = test_options();
+  rlog::batch_controller controller(options, 50 * 1024, milliseconds(100));
+
+  // More than a batch queued between flushes, the sender has room: flush sooner
+  flush(controller, 120 * 1024, 5, 0.2f);
+  BOOST_CHECK(controller.interval() == milliseconds(50));
+
+  // The in-flight window is saturated: fewer, fuller batches
+  flush(controller, 120 * 1024, 5, 0.95f);
+  BOOST_CHECK(controller.interval() == milliseconds(60));
+
+  // Light traffic, and nothing queued at all, lengthen it up to the maximum
+  flush(controller, 1024, 5);
+  BOOST_CHECK(controller.interval() == milliseconds(70));
+  for (int i = 0; i < 30; ++i) controller.on_flush(0);
+  BOOST_CHECK(controller.interval() == options.max_interval);
+
+  // No shortening while sends are slow, that would only add requests
+  flush(controller, 200 * 1024, 80);
+  BOOST_CHECK(controller.interval() == options.max_interval);
+}
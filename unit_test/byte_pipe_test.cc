@@ -0,0 +1,102 @@
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE Main
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include "model_mgmt/byte_pipe.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace reinforcement_learning::model_management;
+
+namespace {
+  std::string read_all(byte_pipe& pipe, size_t chunk_size, int64_t& last) {
+    std::string result;
+    std::vector<char> chunk(chunk_size);
+    while ((last = pipe.read(chunk.data(), chunk.size())) > 0) {
+      result.append(chunk.data(), static_cast<size_t>(last));
+    }
+    return result;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(byte_pipe_transfers_in_order) {
+  byte_pipe pipe(16);
+  std::string expected;
+  for (int i = 0; i < 1000; ++i) expected += std::to_string(i);
+
+  bool all_written = true;
+  std::thread producer([&]() {
+    // Writes of uneven sizes, some larger than the capacity
+    size_t pos = 0;
+    size_t len = 1;
+    while (pos < expected.size()) {
+      const auto n = (std::min)(len, expected.size() - pos);
+      all_written &= pipe.write(expected.data() + pos, n);
+      pos += n;
+      len = (len * 7) % 41 + 1;
+    }
+    pipe.close();
+  });
+
+  int64_t last = 0;
+  const auto actual = read_all(pipe, 5, last);
+  producer.join();
+
+  BOOST_CHECK(all_written);
+  BOOST_CHECK_EQUAL(last, 0);
+  BOOST_CHECK_EQUAL(actual, expected);
+  BOOST_CHECK_EQUAL(pipe.bytes_read(), expected.size());
+}
+
+BOOST_AUTO_TEST_CASE(byte_pipe_failure_reaches_reader) {
+  byte_pipe pipe(1024);
+  pipe.write("abc", 3);
+  pipe.fail("connection reset");
+
+  // Buffered data is still delivered before the error
+  int64_t last = 0;
+  const auto actual = read_all(pipe, 2, last);
+  BOOST_CHECK_EQUAL(actual, "abc");
+  BOOST_CHECK_EQUAL(last, -1);
+  BOOST_CHECK_EQUAL(pipe.error(), "connection reset");
+}
+
+BOOST_AUTO_TEST_CASE(byte_pipe_writer_blocks_when_full) {
+  byte_pipe pipe(4);
+  BOOST_CHECK(pipe.write("1234", 4));
+
+  bool written = false;
+  std::thread producer([&]() {
+    written = pipe.write("5", 1);
+    pipe.close();
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  BOOST_CHECK(!written);
+
+  int64_t last = 0;
+  const auto actual = read_all(pipe, 3, last);
+  producer.join();
+  BOOST_CHECK(written);
+  BOOST_CHECK_EQUAL(actual, "12345");
+}
+
+BOOST_AUTO_TEST_CASE(byte_pipe_cancel_releases_writer) {
+  byte_pipe pipe(4);
+  BOOST_CHECK(pipe.write("1234", 4));
+
+  bool written = true;
+  std::thread producer([&]() {
+    written = pipe.write("5678", 4);
+    pipe.fail("cancelled");
+  });
+  pipe.cancel();
+  pipe.wait_closed();
+  producer.join();
+  BOOST_CHECK(!written);
+}
@@ -0,0 +1,192 @@
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE Main
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include "logger/coalescing_sender.h"
+#include "logger/preamble.h"
+#include "utility/data_buffer_streambuf.h"
+#include "api_status.h"
+#include "err_constants.h"
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace rl = reinforcement_learning;
+namespace rlog = reinforcement_learning::logger;
+namespace rerr = reinforcement_learning::error_code;
+namespace rutil = reinforcement_learning::utility;
+
+namespace {
+  // Keeps every request it is handed as the bytes that would go over the wire
+  class recording_sender : public rl::i_sender {
+  public:
+    struct log {
+      std::mutex mutex;
+      std::vector<std::string> requests;
+      int inits = 0;
+
+      std::vector<std::string> get() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return requests;
+      }
+    };
+
+    explicit recording_sender(std::shared_ptr<log> log) : _log(std::move(log)) {}
+
+    int init(rl::api_status*) override {
+      std::lock_guard<std::mutex> lock(_log->mutex);
+      ++_log->inits;
+      return rerr::success;
+    }
+
+  protected:
+    int v_send(const buffer& data, rl::api_status*) override {
+      std::lock_guard<std::mutex> lock(_log->mutex);
+      _log->requests.emplace_back(reinterpret_cast<const char*>(data->preamble_begin()), data->buffer_filled_size());
+      return rerr::success;
+    }
+
+  private:
+    std::shared_ptr<log> _log;
+  };
+
+  rl::i_sender::buffer make_message(uint16_t msg_type, const std::string& content) {
+    rl::i_sender::buffer db(new rutil::data_buffer());
+    rutil::data_buffer_streambuf sbuff(db.get());
+    std::ostream message(&sbuff);
+    message << content;
+    sbuff.finalize();
+    rlog::preamble pre;
+    pre.msg_type = msg_type;
+    pre.msg_size = static_cast<uint32_t>(db->body_filled_size());
+    pre.write_to_bytes(db->preamble_begin(), db->preamble_size());
+    return db;
+  }
+
+  std::string wire(const rl::i_sender::buffer& db) {
+    return std::string(reinterpret_cast<const char*>(db->preamble_begin()), db->buffer_filled_size());
+  }
+
+  // Splits a request body into its preamble framed messages
+  std::vector<std::string> split(const std::string& request) {
+    std::vector<std::string> frames;
+    size_t offset = 0;
+    while (offset < request.size()) {
+      std::string head = request.substr(offset, rlog::preamble::size());
+      rlog::preamble pre;
+      pre.read_from_bytes(reinterpret_cast<uint8_t*>(&head[0]), head.size());
+      const auto frame = rlog::preamble::size() + pre.msg_size;
+      frames.push_back(request.substr(offset, frame));
+      offset += frame;
+    }
+    BOOST_CHECK_EQUAL(offset, request.size());
+    return frames;
+  }
+
+  std::vector<std::string> wait_for_requests(recording_sender::log& log, size_t count) {
+    for (int i = 0; i < 200 && log.get().size() < count; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return log.get();
+  }
+}
+
+BOOST_AUTO_TEST_CASE(coalescer_packs_batches_of_a_window_into_one_request) {
+  auto log = std::make_shared<recording_sender::log>();
+  rlog::coalescing_options options;
+  options.window = std::chrono::milliseconds(100);
+  rlog::batch_coalescer coalescer(new recording_sender(log), options, nullptr, nullptr);
+  BOOST_REQUIRE_EQUAL(coalescer.init(nullptr), rerr::success);
+
+  std::vector<std::string> expected;
+  for (int i = 0; i < 3; ++i) {
+    const auto msg = make_message(static_cast<uint16_t>(i + 1), "batch " + std::to_string(i));
+    expected.push_back(wire(msg));
+    BOOST_CHECK_EQUAL(coalescer.send(msg, nullptr), rerr::success);
+  }
+
+  const auto requests = wait_for_requests(*log, 1);
+  BOOST_REQUIRE_EQUAL(requests.size(), 1);
+  BOOST_CHECK(split(requests[0]) == expected);
+
+  const auto stats = coalescer.get_stats();
+  BOOST_CHECK_EQUAL(stats.batches, 3);
+  BOOST_CHECK_EQUAL(stats.posts, 1);
+  BOOST_CHECK_EQUAL(stats.bytes, requests[0].size());
+}
+
+BOOST_AUTO_TEST_CASE(coalescer_passes_a_lone_batch_through) {
+  auto log = std::make_shared<recording_sender::log>();
+  rlog::coalescing_options options;
+  options.window = std::chrono::milliseconds(10);
+  rlog::batch_coalescer coalescer(new recording_sender(log), options, nullptr, nullptr);
+  BOOST_REQUIRE_EQUAL(coalescer.init(nullptr), rerr::success);
+
+  const auto first = make_message(1, "first");
+  BOOST_CHECK_EQUAL(coalescer.send(first, nullptr), rerr::success);
+  BOOST_REQUIRE_EQUAL(wait_for_requests(*log, 1).size(), 1);
+  const auto second = make_message(2, "second");
+  BOOST_CHECK_EQUAL(coalescer.send(second, nullptr), rerr::success);
+
+  const auto requests = wait_for_requests(*log, 2);
+  BOOST_REQUIRE_EQUAL(requests.size(), 2);
+  BOOST_CHECK(requests[0] == wire(first));
+  BOOST_CHECK(requests[1] == wire(second));
+}
+
+BOOST_AUTO_TEST_CASE(coalescer_respects_the_request_size_limit) {
+  auto log = std::make_shared<recording_sender::log>();
+  rlog::coalescing_options options;
+  options.window = std::chrono::milliseconds(1000);
+  options.max_bytes = 250;
+  std::vector<std::string> expected;
+  {
+    rlog::batch_coalescer coalescer(new recording_sender(log), options, nullptr, nullptr);
+    BOOST_REQUIRE_EQUAL(coalescer.init(nullptr), rerr::success);
+    // 8 byte preamble and 100 byte body, two fit into a request
+    for (int i = 0; i < 5; ++i) {
+      const auto msg = make_message(1, std::string(100, 'a' + i));
+      expected.push_back(wire(msg));
+      BOOST_CHECK_EQUAL(coalescer.send(msg, nullptr), rerr::success);
+    }
+    // The full requests went out on the callers' threads, the destructor sends the rest
+    BOOST_CHECK_EQUAL(log->get().size(), 2);
+  }
+
+  const auto requests = log->get();
+  BOOST_REQUIRE_EQUAL(requests.size(), 3);
+  std::vector<std::string> frames;
+  for (const auto& request : requests) {
+    BOOST_CHECK_LE(request.size(), options.max_bytes);
+    const auto parts = split(request);
+    frames.insert(frames.end(), parts.begin(), parts.end());
+  }
+  BOOST_CHECK(frames == expected);
+}
+
+BOOST_AUTO_TEST_CASE(coalescing_senders_share_a_coalescer) {
+  auto log = std::make_shared<recording_sender::log>();
+  rlog::coalescing_options options;
+  options.window = std::chrono::milliseconds(100);
+  auto coalescer = std::make_shared<rlog::batch_coalescer>(new recording_sender(log), options, nullptr, nullptr);
+  rlog::coalescing_sender interactions(coalescer);
+  rlog::coalescing_sender decisions(coalescer);
+  BOOST_REQUIRE_EQUAL(interactions.init(nullptr), rerr::success);
+  BOOST_REQUIRE_EQUAL(decisions.init(nullptr), rerr::success);
+  BOOST_CHECK_EQUAL(log->inits, 1);
+
+  const auto interaction = make_message(1, "interaction");
+  const auto decision = make_message(3, "decision");
+  BOOST_CHECK_EQUAL(interactions.send(interaction), rerr::success);
+  BOOST_CHECK_EQUAL(decisions.send(decision), rerr::success);
+
+  const auto requests = wait_for_requests(*log, 1);
+  BOOST_REQUIRE_EQUAL(requests.size(), 1);
+  BOOST_CHECK(requests[0] == wire(interaction) + wire(decision));
+}
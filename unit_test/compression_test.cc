@@ -0,0 +1,255 @@
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE Main
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include "logger/compressing_sender.h"
+#include "logger/compression.h"
+#include "logger/message_type.h"
+#include "data_buffer.h"
+#include "api_status.h"
+#include "err_constants.h"
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace rl = reinforcement_learning;
+namespace rlog = reinforcement_learning::logger;
+namespace rerr = reinforcement_learning::error_code;
+namespace rutil = reinforcement_learning::utility;
+
+namespace {
+  struct sent_message {
+    uint16_t msg_type;
+    std::string body;
+  };
+
+  class recording_message_sender : public rlog::i_message_sender {
+  public:
+    explicit recording_message_sender(std::vector<sent_message>& sent) : _sent(sent) {}
+    int send(const uint16_t msg_type, const buffer& db, rl::api_status*) override {
+      _sent.push_back({ msg_type, std::string(reinterpret_cast<const char*>(db->body_begin()), db->body_filled_size()) });
+      return rerr::success;
+    }
+    int init(rl::api_status*) override { return rerr::success; }
+
+  private:
+    std::vector<sent_message>& _sent;
+  };
+
+  // Repetitive like a batch of contexts
+  std::string make_contexts(size_t count) {
+    std::string contexts;
+    for (size_t i = 0; i < count; ++i) {
+      contexts += R"({"GUser":{"f_int":)" + std::to_string(i) + R"(,"f_str_0":"value_)" + std::to_string(i % 7)
+        + R"("},"_multi":[{"TAction":{"a_f_0":"value_1"}},{"TAction":{"a_f_0":"value_2"}}]})";
+    }
+    return contexts;
+  }
+
+  rlog::i_message_sender::buffer make_buffer(const std::string& body) {
+    rlog::i_message_sender::buffer db(new rutil::data_buffer(body.size()));
+    memcpy(db->body_begin(), body.data(), body.size());
+    db->set_body_endoffset(db->preamble_size() + body.size());
+    return db;
+  }
+
+  // One context per sample, like the batches of a client at low QPS
+  std::vector<std::string> make_samples(size_t count) {
+    std::vector<std::string> samples;
+    for (size_t i = 0; i < count; ++i) samples.push_back(make_contexts(i + 1).substr(make_contexts(i).size()));
+    return samples;
+  }
+
+  std::vector<rlog::compression_codec> available_codecs() {
+    std::vector<rlog::compression_codec> codecs;
+    for (const auto codec : { rlog::compression_codec::lz4, rlog::compression_codec::zstd }) {
+      if (rlog::compression_available(codec)) codecs.push_back(codec);
+    }
+    return codecs;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(compression_header_round_trip) {
+  rlog::compression_header header;
+  header.codec = static_cast<uint8_t>(rlog::compression_codec::zstd);
+  header.msg_type = rlog::message_type::fb_ranking_learning_mode_event_collection;
+  header.uncompressed_size = 0x01020304;
+  uint8_t bytes[rlog::compression_header::size()];
+  BOOST_CHECK(header.write_to_bytes(bytes, sizeof(bytes)));
+  BOOST_CHECK(!header.write_to_bytes(bytes, sizeof(bytes) - 1));
+
+  rlog::compression_header read;
+  BOOST_CHECK(read.read_from_bytes(bytes, sizeof(bytes)));
+  BOOST_CHECK_EQUAL(read.codec, header.codec);
+  BOOST_CHECK_EQUAL(read.msg_type, header.msg_type);
+  BOOST_CHECK_EQUAL(read.uncompressed_size, header.uncompressed_size);
+  BOOST_CHECK_EQUAL(bytes[4], 0x01);
+
+  // The dictionary id follows for the dictionary codec only
+  header.codec = static_cast<uint8_t>(rlog::compression_codec::zstd_dictionary);
+  header.dictionary_id = 0x0a0b0c0d;
+  uint8_t dictionary_bytes[rlog::compression_header::size() + 4];
+  BOOST_CHECK_EQUAL(header.encoded_size(), sizeof(dictionary_bytes));
+  BOOST_CHECK(!header.write_to_bytes(dictionary_bytes, rlog::compression_header::size()));
+  BOOST_CHECK(header.write_to_bytes(dictionary_bytes, sizeof(dictionary_bytes)));
+  BOOST_CHECK(!read.read_from_bytes(dictionary_bytes, rlog::compression_header::size()));
+  BOOST_CHECK(read.read_from_bytes(dictionary_bytes, sizeof(dictionary_bytes)));
+  BOOST_CHECK_EQUAL(read.dictionary_id, header.dictionary_id);
+  BOOST_CHECK_EQUAL(dictionary_bytes[8], 0x0a);
+}
+
+BOOST_AUTO_TEST_CASE(compressed_messages_decompress_to_the_original) {
+  const auto contexts = make_contexts(100);
+  for (const auto codec : available_codecs()) {
+    rlog::batch_compressor compressor(codec, 0);
+    rutil::data_buffer out;
+    BOOST_REQUIRE_EQUAL(compressor.compress(rlog::message_type::fb_outcome_event_collection,
+      reinterpret_cast<const uint8_t*>(contexts.data()), contexts.size(), out, nullptr), rerr::success);
+    BOOST_CHECK_LT(out.body_filled_size(), contexts.size() / 4);
+
+    uint16_t msg_type = 0;
+    std::vector<uint8_t> body;
+    BOOST_REQUIRE_EQUAL(rlog::decompress_message(out.body_begin(), out.body_filled_size(), nullptr, msg_type, body, nullptr), rerr::success);
+    BOOST_CHECK(msg_type == rlog::message_type::fb_outcome_event_collection);
+    BOOST_CHECK(std::string(body.begin(), body.end()) == contexts);
+
+    // The pooled buffer is reused by later batches
+    out.reset();
+    BOOST_REQUIRE_EQUAL(compressor.compress(rlog::message_type::fb_outcome_event_collection,
+      reinterpret_cast<const uint8_t*>(contexts.data()), 100, out, nullptr), rerr::success);
+    BOOST_REQUIRE_EQUAL(rlog::decompress_message(out.body_begin(), out.body_filled_size(), nullptr, msg_type, body, nullptr), rerr::success);
+    BOOST_CHECK(std::string(body.begin(), body.end()) == contexts.substr(0, 100));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(decompress_rejects_corrupt_messages) {
+  const auto contexts = make_contexts(10);
+  for (const auto codec : available_codecs()) {
+    rlog::batch_compressor compressor(codec, 0);
+    rutil::data_buffer out;
+    BOOST_REQUIRE_EQUAL(compressor.compress(1, reinterpret_cast<const uint8_t*>(contexts.data()), contexts.size(), out, nullptr), rerr::success);
+
+    uint16_t msg_type = 0;
+    std::vector<uint8_t> body;
+    rl::api_status status;
+    // Truncated
+    BOOST_CHECK_EQUAL(rlog::decompress_message(out.body_begin(), out.body_filled_size() / 2, nullptr, msg_type, body, &status), rerr::compression_error);
+    // Claims a different size
+    out.body_begin()[7] ^= 0x10;
+    BOOST_CHECK_EQUAL(rlog::decompress_message(out.body_begin(), out.body_filled_size(), nullptr, msg_type, body, &status), rerr::compression_error);
+  }
+
+  const uint8_t unknown_codec[] = { 200, 0, 0, 1, 0, 0, 0, 4, 'a', 'b', 'c', 'd' };
+  uint16_t msg_type = 0;
+  std::vector<uint8_t> body;
+  rl::api_status status;
+  BOOST_CHECK_EQUAL(rlog::decompress_message(unknown_codec, sizeof(unknown_codec), nullptr, msg_type, body, &status), rerr::compression_error);
+  BOOST_CHECK_EQUAL(rlog::decompress_message(unknown_codec, 4, nullptr, msg_type, body, &status), rerr::compression_error);
+}
+
+BOOST_AUTO_TEST_CASE(compressing_sender_sends_small_and_incompressible_batches_as_they_are) {
+  std::string random(4096, ' ');
+  std::mt19937 rng(42);
+  for (auto& c : random) c = static_cast<char>(rng());
+  const auto contexts = make_contexts(50);
+
+  for (const auto codec : available_codecs()) {
+    std::vector<sent_message> sent;
+    rlog::compression_options options;
+    options.codec = codec;
+    options.min_bytes = 64;
+    rlog::compressing_message_sender sender(new recording_message_sender(sent), options, nullptr);
+    BOOST_REQUIRE_EQUAL(sender.init(nullptr), rerr::success);
+
+    BOOST_CHECK_EQUAL(sender.send(9, make_buffer("tiny"), nullptr), rerr::success);
+    BOOST_CHECK_EQUAL(sender.send(9, make_buffer(random), nullptr), rerr::success);
+    BOOST_CHECK_EQUAL(sender.send(9, make_buffer(contexts), nullptr), rerr::success);
+
+    BOOST_REQUIRE_EQUAL(sent.size(), 3);
+    BOOST_CHECK_EQUAL(sent[0].msg_type, 9);
+    BOOST_CHECK(sent[0].body == "tiny");
+    BOOST_CHECK_EQUAL(sent[1].msg_type, 9);
+    BOOST_CHECK(sent[1].body == random);
+    BOOST_CHECK(sent[2].msg_type == rlog::message_type::compressed);
+    BOOST_CHECK_LT(sent[2].body.size(), contexts.size());
+
+    uint16_t msg_type = 0;
+    std::vector<uint8_t> body;
+    BOOST_REQUIRE_EQUAL(rlog::decompress_message(reinterpret_cast<const uint8_t*>(sent[2].body.data()),
+      sent[2].body.size(), nullptr, msg_type, body, nullptr), rerr::success);
+    BOOST_CHECK_EQUAL(msg_type, 9);
+    BOOST_CHECK(std::string(body.begin(), body.end()) == contexts);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(dictionary_compression_needs_the_dictionary_to_decompress) {
+  if (!rlog::compression_available(rlog::compression_codec::zstd)) return;
+
+  std::vector<uint8_t> dictionary;
+  BOOST_REQUIRE_EQUAL(rlog::train_dictionary(make_samples(500), 4096, dictionary, nullptr), rerr::success);
+  const auto id = rlog::dictionary_id(dictionary);
+  BOOST_CHECK_NE(id, 0);
+
+  const auto context = make_contexts(1000).substr(make_contexts(999).size());
+  rlog::batch_compressor plain(rlog::compression_codec::zstd, 0);
+  rutil::data_buffer plain_out;
+  BOOST_REQUIRE_EQUAL(plain.compress(1, reinterpret_cast<const uint8_t*>(context.data()), context.size(), plain_out, nullptr), rerr::success);
+  rlog::batch_compressor compressor(rlog::compression_codec::zstd, 0);
+  BOOST_REQUIRE_EQUAL(compressor.set_dictionary(dictionary, nullptr), rerr::success);
+  rutil::data_buffer out;
+  BOOST_REQUIRE_EQUAL(compressor.compress(1, reinterpret_cast<const uint8_t*>(context.data()), context.size(), out, nullptr), rerr::success);
+  BOOST_CHECK_LT(out.body_filled_size(), plain_out.body_filled_size() / 2);
+
+  rlog::compression_header header;
+  BOOST_REQUIRE(header.read_from_bytes(out.body_begin(), out.body_filled_size()));
+  BOOST_CHECK(header.codec == static_cast<uint8_t>(rlog::compression_codec::zstd_dictionary));
+  BOOST_CHECK_EQUAL(header.dictionary_id, id);
+
+  uint16_t msg_type = 0;
+  std::vector<uint8_t> body;
+  rl::api_status status;
+  rlog::compression_dictionaries dictionaries;
+  BOOST_CHECK_EQUAL(rlog::decompress_message(out.body_begin(), out.body_filled_size(), nullptr, msg_type, body, &status), rerr::compression_error);
+  BOOST_CHECK_EQUAL(rlog::decompress_message(out.body_begin(), out.body_filled_size(), &dictionaries, msg_type, body, &status), rerr::compression_error);
+  BOOST_REQUIRE_EQUAL(dictionaries.add(dictionary, nullptr), rerr::success);
+  BOOST_REQUIRE_EQUAL(rlog::decompress_message(out.body_begin(), out.body_filled_size(), &dictionaries, msg_type, body, nullptr), rerr::success);
+  BOOST_CHECK_EQUAL(msg_type, 1);
+  BOOST_CHECK(std::string(body.begin(), body.end()) == context);
+
+  // Only zstd takes a dictionary, and only a trained one
+  rlog::batch_compressor lz4(rlog::compression_codec::lz4, 0);
+  BOOST_CHECK_EQUAL(lz4.set_dictionary(dictionary, &status), rerr::compression_error);
+  BOOST_CHECK_EQUAL(compressor.set_dictionary(std::vector<uint8_t>(100, 'x'), &status), rerr::compression_error);
+}
+
+BOOST_AUTO_TEST_CASE(compressing_sender_loads_the_dictionary_or_falls_back_to_plain_zstd) {
+  if (!rlog::compression_available(rlog::compression_codec::zstd)) return;
+
+  const std::string file("compressing_sender_test.dict");
+  std::vector<uint8_t> dictionary;
+  BOOST_REQUIRE_EQUAL(rlog::train_dictionary(make_samples(500), 4096, dictionary, nullptr), rerr::success);
+  BOOST_REQUIRE_EQUAL(rlog::write_dictionary_file(file, dictionary, nullptr), rerr::success);
+  const auto contexts = make_contexts(3);
+
+  for (const auto& dictionary_file : { file, std::string("missing.dict") }) {
+    std::vector<sent_message> sent;
+    rlog::compression_options options;
+    options.codec = rlog::compression_codec::zstd;
+    options.min_bytes = 64;
+    options.dictionary_file = dictionary_file;
+    rlog::compressing_message_sender sender(new recording_message_sender(sent), options, nullptr);
+    BOOST_REQUIRE_EQUAL(sender.init(nullptr), rerr::success);
+    BOOST_CHECK_EQUAL(sender.send(9, make_buffer(contexts), nullptr), rerr::success);
+
+    BOOST_REQUIRE_EQUAL(sent.size(), 1);
+    BOOST_REQUIRE(sent[0].msg_type == rlog::message_type::compressed);
+    const auto expected = dictionary_file == file ? rlog::compression_codec::zstd_dictionary : rlog::compression_codec::zstd;
+    BOOST_CHECK(static_cast<uint8_t>(sent[0].body[0]) == static_cast<uint8_t>(expected));
+  }
+  remove(file.c_str());
+}
@@ -82,6 +82,24 @@ BOOST_AUTO_TEST_CASE(data_buffer_reset_rewrite) {
   BOOST_CHECK_EQUAL(buffer.buffer_filled_size(), 10);
 }
 
+BOOST_AUTO_TEST_CASE(large_output_to_data_buffer) {
+  data_buffer buffer;
+  data_buffer_streambuf sbuff(&buffer);
+  ostream out(&sbuff);
+  out << unitbuf;
+  // Several times the growth step, written in pieces that straddle it
+  string expected;
+  for (int i = 0; i < 2000; ++i) {
+    const auto line = to_string(i) + "\n";
+    out << line;
+    expected += line;
+    BOOST_REQUIRE_EQUAL(buffer.body_filled_size(), expected.size());
+  }
+  sbuff.finalize();
+  BOOST_CHECK_EQUAL(buffer.body_filled_size(), expected.size());
+  BOOST_CHECK(string(reinterpret_cast<char *>(buffer.body_begin())) == expected);
+}
+
 BOOST_AUTO_TEST_CASE(data_buffer_init_tests) {
   data_buffer db(1);
   BOOST_CHECK_EQUAL(db.preamble_size(), 8);
@@ -22,7 +22,7 @@ public:
     return *this;
   }
 
-  bool try_drop(float drop_prob, int _drop_pass) override {
+  bool try_drop(float drop_prob) override {
     return _seed_id.substr(0, 4) == "drop";
   }
 
@@ -53,38 +53,75 @@ BOOST_AUTO_TEST_CASE(push_pop_test) {
   BOOST_CHECK_EQUAL(queue.size(), 0);
 }
 
-BOOST_AUTO_TEST_CASE(prune_test) {
-  event_queue<test_event> queue(30);
-  queue.push(test_event("no_drop_1"),10);
-  queue.push(test_event("drop_1"),10);
+BOOST_AUTO_TEST_CASE(admission_test) {
+  event_queue<test_event> queue(40);
+  BOOST_CHECK(queue.try_push(test_event("no_drop_1"),10));
+  BOOST_CHECK(queue.try_push(test_event("drop_1"),10));
+  BOOST_CHECK(queue.try_push(test_event("no_drop_2"),10));
 
-  BOOST_CHECK_EQUAL(queue.size(), 2);
-  BOOST_CHECK_EQUAL(queue.capacity(), 20);
-  queue.prune(1.0); // drop should not work since current capacity is less than limit (20 < 30)
-  BOOST_CHECK_EQUAL(queue.size(), 2);
-  BOOST_CHECK_EQUAL(queue.capacity(), 20);
+  // Everything is admitted up to the shed threshold (30 of 40)
+  BOOST_CHECK_EQUAL(queue.size(), 3);
+  BOOST_CHECK_EQUAL(queue.capacity(), 30);
+  BOOST_CHECK_EQUAL(queue.shed_count(), 0);
 
-  queue.push(test_event("no_drop_2"),10);
-  queue.push(test_event("drop_2"),10);
-  queue.push(test_event("no_drop_3"),10);
+  // Past it events are dropped on arrival, nothing already queued is touched
+  queue.push(test_event("no_drop_3"),5);
+  BOOST_CHECK(!queue.try_push(test_event("drop_2"),10));
+  BOOST_CHECK(queue.try_push(test_event("no_drop_4"),10));
+  BOOST_CHECK_EQUAL(queue.size(), 5);
+  BOOST_CHECK_EQUAL(queue.capacity(), 45);
+  BOOST_CHECK_EQUAL(queue.shed_count(), 1);
 
   test_event val;
+  const char* expected[] = { "no_drop_1", "drop_1", "no_drop_2", "no_drop_3", "no_drop_4" };
+  for (const auto id : expected) {
+    queue.pop(&val);
+    BOOST_CHECK_EQUAL(val.get_event_id(), id);
+  }
+}
 
-  BOOST_CHECK_EQUAL(queue.size(), 5);
-  BOOST_CHECK_EQUAL(queue.capacity(), 50);
-  queue.prune(1.0); // drop should work since current capacity is more than limit (50 > 30)
-  BOOST_CHECK_EQUAL(queue.size(), 3);
-  BOOST_CHECK_EQUAL(queue.capacity(), 30);
+class sampled_event : public event {
+public:
+  sampled_event() {}
+  sampled_event(const string& id) : event(id.c_str(), timestamp{}) {}
+  sampled_event(sampled_event&& other) : event(std::move(other)) {}
+  sampled_event& operator=(sampled_event&& other)
+  {
+    if (&other != this) event::operator=(std::move(other));
+    return *this;
+  }
+};
 
+BOOST_AUTO_TEST_CASE(admission_probability_follows_fill_level) {
+  // Half way between the shed threshold (500) and max capacity (1000) half of the events pass
+  event_queue<sampled_event> queue(1000, 0.5f);
+  queue.push(sampled_event("filler"), 750);
 
-  queue.pop(&val);
-  BOOST_CHECK_EQUAL(val.get_event_id(), "no_drop_1");
+  const int n = 4000;
+  int admitted = 0;
+  for (int i = 0; i < n; ++i) {
+    if (queue.try_push(sampled_event("event-" + std::to_string(i)), 0)) ++admitted;
+  }
+  BOOST_CHECK_CLOSE(static_cast<float>(admitted) / n, 0.5f, 10.f);
+  BOOST_CHECK_EQUAL(queue.shed_count(), static_cast<size_t>(n - admitted));
 
+  // Admitted events carry the probability they were kept with
+  sampled_event val;
   queue.pop(&val);
-  BOOST_CHECK_EQUAL(val.get_event_id(), "no_drop_2");
+  BOOST_CHECK_EQUAL(val.get_pass_prob(), 1.f);
+  while (queue.pop(&val)) BOOST_CHECK_CLOSE(val.get_pass_prob(), 0.5f, 0.001f);
+
+  // The decision only depends on the event id
+  queue.push(sampled_event("filler"), 750);
+  int again = 0;
+  for (int i = 0; i < n; ++i) {
+    if (queue.try_push(sampled_event("event-" + std::to_string(i)), 0)) ++again;
+  }
+  BOOST_CHECK_EQUAL(again, admitted);
 
-  queue.pop(&val);
-  BOOST_CHECK_EQUAL(val.get_event_id(), "no_drop_3");
+  // A full queue admits nothing
+  queue.push(sampled_event("filler"), 250);
+  BOOST_CHECK(!queue.try_push(sampled_event("late"), 0));
 }
 
 BOOST_AUTO_TEST_CASE(queue_push_pop)
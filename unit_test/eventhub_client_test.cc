@@ -5,11 +5,16 @@
 
 #include <boost/test/unit_test.hpp>
 #include "logger/eventhub_client.h"
+#include "logger/sharded_eventhub_client.h"
 #include "mock_http_client.h"
 #include "err_constants.h"
 #include "utility/data_buffer_streambuf.h"
 #include "logger/preamble.h"
 
+#include <atomic>
+#include <chrono>
+#include <thread>
+
 namespace reinforcement_learning {namespace utility {
   class data_buffer_streambuf;
 }}
@@ -210,3 +215,212 @@ BOOST_AUTO_TEST_CASE(http_in_order_after_retry)
   BOOST_CHECK_EQUAL(received_messages[4], "message 5");
   BOOST_CHECK_EQUAL(counter._err_count, 0);
 }
+
+BOOST_AUTO_TEST_CASE(slow_request_does_not_block_send)
+{
+  mock_http_client* http_client = new mock_http_client("localhost:8080");
+
+  std::atomic<bool> release{ false };
+  std::atomic<int> posts{ 0 };
+  http_client->set_responder(methods::POST, [&release, &posts](const http_request& message, http_response& resp) {
+    // Only the first request is slow, it holds one of the two slots until released.
+    if (posts++ == 0) {
+      while (!release) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    }
+    resp.set_status_code(status_codes::Created);
+  });
+
+  // Releases the slow request after a while in case send is blocked behind it.
+  std::atomic<bool> timed_out{ false };
+  std::thread watchdog([&release, &timed_out]() {
+    for (int i = 0; i < 5000 && !release; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (!release) {
+      timed_out = true;
+      release = true;
+    }
+  });
+
+  {
+    r::eventhub_client eh(http_client, "localhost:8080", "", "", "", 2, 1, nullptr, nullptr);
+    r::api_status ret;
+    for (int i = 0; i < 5; ++i) {
+      std::shared_ptr<u::data_buffer> db(new u::data_buffer());
+      u::data_buffer_streambuf sbuff(db.get());
+      std::ostream message(&sbuff);
+      message << "message " << i;
+      sbuff.finalize();
+      BOOST_CHECK_EQUAL(eh.send(db, &ret), r::error_code::success);
+    }
+
+    // All sends went through the second slot while the first request was still pending.
+    BOOST_CHECK(!timed_out);
+    release = true;
+  }
+
+  watchdog.join();
+  BOOST_CHECK_EQUAL(posts, 5);
+}
+
+BOOST_AUTO_TEST_CASE(completion_latency_covers_the_request)
+{
+  mock_http_client* http_client = new mock_http_client("localhost:8080");
+  http_client->set_responder(methods::POST, [](const http_request&, http_response& resp) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    resp.set_status_code(status_codes::Created);
+  });
+
+  r::eventhub_client eh(http_client, "localhost:8080", "", "", "", 2, 1, nullptr, nullptr);
+  BOOST_CHECK_LT(eh.completion_latency().count(), 0);
+  std::shared_ptr<u::data_buffer> db(new u::data_buffer());
+  u::data_buffer_streambuf sbuff(db.get());
+  std::ostream message(&sbuff);
+  message << "message";
+  sbuff.finalize();
+
+  // Sending only starts the request, the latency is known once it completed
+  const auto start = std::chrono::steady_clock::now();
+  BOOST_CHECK_EQUAL(eh.send(db), r::error_code::success);
+  BOOST_CHECK(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(50));
+  for (int i = 0; i < 5000 && eh.in_flight() > 0; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  BOOST_CHECK_GE(eh.completion_latency().count(), 50 * 1000);
+}
+
+BOOST_AUTO_TEST_CASE(retry_backoff_and_budget_on_503)
+{
+  mock_http_client* http_client = new mock_http_client("localhost:8080");
+
+  std::atomic<int> tries{ 0 };
+  http_client->set_responder(methods::POST, [&tries](const http_request& message, http_response& resp) {
+    tries++;
+    resp.set_status_code(status_codes::ServiceUnavailable);
+  });
+
+  error_counter counter;
+  r::error_callback_fn error_callback(&error_counter_func, &counter);
+  // Only 3 retries are granted per window even though the client allows 10.
+  const auto policy = std::make_shared<u::retry_policy>(std::chrono::milliseconds(10), std::chrono::milliseconds(50), 3, std::chrono::seconds(60));
+
+  const auto start = std::chrono::steady_clock::now();
+  {
+    r::eventhub_client eh(http_client, "localhost:8080", "", "", "", 1, 10, nullptr, &error_callback, policy);
+    r::api_status ret;
+    std::shared_ptr<u::data_buffer> db(new u::data_buffer());
+    u::data_buffer_streambuf sbuff(db.get());
+    std::ostream message(&sbuff);
+    message << "message 1";
+    sbuff.finalize();
+    BOOST_CHECK_EQUAL(eh.send(db, &ret), r::error_code::success);
+  }
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  BOOST_CHECK_EQUAL(tries, 4);
+  BOOST_CHECK_EQUAL(counter._err_count, 1);
+  BOOST_CHECK_EQUAL(policy->get_stats().retries, 3);
+  BOOST_CHECK_EQUAL(policy->get_stats().budget_exhausted, 1);
+  // Every retry waited at least the base delay
+  BOOST_CHECK(elapsed >= std::chrono::milliseconds(30));
+}
+
+namespace {
+  std::shared_ptr<u::data_buffer> make_batch(const std::string& content) {
+    std::shared_ptr<u::data_buffer> db(new u::data_buffer());
+    u::data_buffer_streambuf sbuff(db.get());
+    std::ostream message(&sbuff);
+    message << content;
+    sbuff.finalize();
+    return db;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(sharded_send_round_robin)
+{
+  std::vector<std::unique_ptr<r::eventhub_client>> shards;
+  for (int i = 0; i < 2; ++i) {
+    shards.emplace_back(new r::eventhub_client(new mock_http_client("localhost:8080"), "localhost:8080", "", "", "", 1, 1, nullptr, nullptr));
+  }
+  r::sharded_eventhub_client eh(std::move(shards), r::shard_selection::round_robin, nullptr);
+  BOOST_CHECK_EQUAL(eh.init(nullptr), r::error_code::success);
+
+  for (int i = 0; i < 6; ++i) {
+    BOOST_CHECK_EQUAL(eh.send(make_batch("message")), r::error_code::success);
+  }
+
+  const auto stats = eh.get_shard_stats();
+  BOOST_CHECK_EQUAL(stats.size(), 2);
+  BOOST_CHECK_EQUAL(stats[0].batches, 3);
+  BOOST_CHECK_EQUAL(stats[1].batches, 3);
+  BOOST_CHECK_EQUAL(stats[0].bytes, stats[1].bytes);
+}
+
+BOOST_AUTO_TEST_CASE(sharded_send_least_outstanding_avoids_stuck_connection)
+{
+  std::atomic<bool> release{ false };
+  auto stuck = new mock_http_client("localhost:8080");
+  stuck->set_responder(methods::POST, [&release](const http_request& message, http_response& resp) {
+    while (!release) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    resp.set_status_code(status_codes::Created);
+  });
+  auto healthy = new mock_http_client("localhost:8080");
+  healthy->set_responder(methods::POST, [](const http_request& message, http_response& resp) {
+    resp.set_status_code(status_codes::Created);
+  });
+
+  std::vector<std::unique_ptr<r::eventhub_client>> shards;
+  shards.emplace_back(new r::eventhub_client(stuck, "localhost:8080", "", "", "", 4, 1, nullptr, nullptr));
+  shards.emplace_back(new r::eventhub_client(healthy, "localhost:8080", "", "", "", 4, 1, nullptr, nullptr));
+  {
+    r::sharded_eventhub_client eh(std::move(shards), r::shard_selection::least_outstanding, nullptr);
+    for (int i = 0; i < 20; ++i) {
+      BOOST_CHECK_EQUAL(eh.send(make_batch("message")), r::error_code::success);
+      // Let the healthy connection complete so it stays the least loaded one
+      for (int j = 0; j < 1000 && eh.get_shard_stats()[1].in_flight > 0; ++j) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    }
+
+    const auto stats = eh.get_shard_stats();
+    // Only the first batch went to the stuck connection, which is still waiting on it
+    BOOST_CHECK_EQUAL(stats[0].batches, 1);
+    BOOST_CHECK_EQUAL(stats[0].in_flight, 1);
+    BOOST_CHECK_EQUAL(stats[1].batches, 19);
+    release = true;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(send_keeps_batch_alive_until_response)
+{
+  mock_http_client* http_client = new mock_http_client("localhost:8080");
+
+  std::atomic<bool> release{ false };
+  std::string received;
+  http_client->set_responder(methods::POST, [&release, &received](const http_request& message, http_response& resp) {
+    while (!release) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::vector<unsigned char> data = const_cast<http_request&>(message).extract_vector().get();
+    received = std::string(data.begin() + reinforcement_learning::logger::preamble::size(), data.end());
+    resp.set_status_code(status_codes::Created);
+  });
+
+  {
+    r::eventhub_client eh(http_client, "localhost:8080", "", "", "", 1, 1, nullptr, nullptr);
+    auto db = make_batch("message 1");
+    std::weak_ptr<u::data_buffer> weak = db;
+    BOOST_CHECK_EQUAL(eh.send(db), r::error_code::success);
+
+    // The body is read in place, so the request must hold the batch after the caller let it go.
+    db.reset();
+    BOOST_CHECK(!weak.expired());
+    release = true;
+  }
+
+  BOOST_CHECK_EQUAL(received, "message 1");
+}
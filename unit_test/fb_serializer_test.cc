@@ -107,3 +107,35 @@ BOOST_AUTO_TEST_CASE(fb_serializer_ranking_event) {
     }
   }
 }
+
+BOOST_AUTO_TEST_CASE(fb_serializer_remove_last_event) {
+  data_buffer db;
+  fb_collection_serializer<outcome_event> serializer(db);
+  const timestamp ts;
+  auto ro = outcome_event::report_outcome("first_id", 0.75f, ts);
+  serializer.add(ro);
+  const auto size = serializer.size();
+  // The removed event is the first with a string outcome, its vtable must go too
+  ro = outcome_event::report_outcome("removed_id", "{removed}", ts);
+  serializer.add(ro);
+  serializer.remove_last();
+  BOOST_CHECK_EQUAL(serializer.size(), size);
+  ro = outcome_event::report_outcome("second_id", "{kept}", ts);
+  serializer.add(ro);
+  const auto finalized_size = serializer.finalized_size();
+  serializer.finalize();
+
+  // The estimate is only over by the padding
+  BOOST_CHECK_LE(db.body_filled_size(), finalized_size);
+  BOOST_CHECK_GT(db.body_filled_size() + 16, finalized_size);
+
+  flatbuffers::Verifier v(db.body_begin(), db.body_filled_size());
+  const OutcomeEventBatch* outcome_event_batch = GetOutcomeEventBatch(db.body_begin());
+  BOOST_CHECK(outcome_event_batch->Verify(v));
+  const auto& events = (*outcome_event_batch->events());
+  BOOST_REQUIRE_EQUAL(events.size(), 2);
+  BOOST_CHECK_EQUAL(events[0]->event_id()->str(), "first_id");
+  BOOST_CHECK_EQUAL(events[0]->the_event_as_NumericEvent()->value(), 0.75f);
+  BOOST_CHECK_EQUAL(events[1]->event_id()->str(), "second_id");
+  BOOST_CHECK_EQUAL(events[1]->the_event_as_StringEvent()->value()->str(), "{kept}");
+}
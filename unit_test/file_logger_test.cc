@@ -4,9 +4,26 @@
 #endif
 
 #include <boost/test/unit_test.hpp>
+#include "logger/file/async_file_logger.h"
 #include "logger/file/file_logger.h"
+#include "logger/file/segment_index.h"
+#include "logger/preamble.h"
+#include "serialization/fb_serializer.h"
+#include "utility/data_buffer_streambuf.h"
+#include "api_status.h"
 #include "err_constants.h"
+#include "learning_mode.h"
+#include "ranking_event.h"
+#include "ranking_response.h"
+#include "time_helper.h"
+#include "../test_tools/joiner/text_converter.h"
+#include <chrono>
 #include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <thread>
+#include <vector>
 
 namespace rl = reinforcement_learning;
 namespace rlog = reinforcement_learning::logger;
@@ -35,4 +52,322 @@ BOOST_AUTO_TEST_CASE(file_logger_test) {
 
   BOOST_CHECK(file_exists(file));
   remove(file.c_str());
-}
\ No newline at end of file
+}
+
+namespace {
+  rl::i_sender::buffer make_batch(const std::string& content) {
+    rl::i_sender::buffer db(new rutil::data_buffer());
+    rutil::data_buffer_streambuf sbuff(db.get());
+    std::ostream message(&sbuff);
+    message << content;
+    sbuff.finalize();
+    return db;
+  }
+
+  rl::i_sender::buffer make_message(uint16_t msg_type, const std::string& content) {
+    auto db = make_batch(content);
+    rlog::preamble pre;
+    pre.msg_type = msg_type;
+    pre.msg_size = static_cast<uint32_t>(db->body_filled_size());
+    pre.write_to_bytes(db->preamble_begin(), db->preamble_size());
+    return db;
+  }
+
+  std::string read_file(const std::string& file) {
+    std::ifstream f(file, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+  }
+
+  // A ranking batch serialized like the logger does, one event per client time
+  rl::i_sender::buffer make_ranking_batch(const std::string& prefix, const std::vector<rl::timestamp>& times) {
+    rl::i_sender::buffer db(new rutil::data_buffer());
+    rlog::fb_collection_serializer<rl::ranking_event> serializer(*db);
+    rl::ranking_response response;
+    response.set_model_id("a_model_id");
+    response.push_back(0, 1.f);
+    for (size_t i = 0; i < times.size(); ++i) {
+      const auto event_id = prefix + std::to_string(i);
+      auto evt = rl::ranking_event::choose_rank(event_id.c_str(), "{}", 0, response, times[i], 1.f, rl::ONLINE);
+      serializer.add(evt);
+    }
+    serializer.finalize();
+
+    rlog::preamble pre;
+    pre.msg_type = static_cast<uint16_t>(rlog::fb_collection_serializer<rl::ranking_event>::message_id());
+    pre.msg_size = static_cast<uint32_t>(db->body_filled_size());
+    pre.write_to_bytes(db->preamble_begin(), db->preamble_size());
+    return db;
+  }
+
+  // 2020-01-02 03:04:second UTC
+  rl::timestamp make_time(uint8_t second, uint32_t sub_second) {
+    rl::timestamp ts;
+    ts.year = 2020;
+    ts.month = 1;
+    ts.day = 2;
+    ts.hour = 3;
+    ts.minute = 4;
+    ts.second = second;
+    ts.sub_second = sub_second;
+    return ts;
+  }
+  // 2020-01-02 03:04:05 UTC in microseconds since the epoch
+  const int64_t FIRST_SECOND_US = 1577934245LL * 1000000;
+
+  void remove_segments(const std::string& file) {
+    for (size_t i = 0; i < 8; ++i) remove(rlog::file::segment_file_name(file, i).c_str());
+  }
+
+  bool read_index(const std::string& name, std::vector<rlog::file::index_entry>& entries) {
+    std::ifstream in(name, std::ios::binary);
+    rlog::file::segment_trailer trailer;
+    return rlog::file::read_segment_index(in, trailer, entries);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(async_file_logger_writes_batches_in_order) {
+  const std::string file("async_file_logger_test");
+  std::string expected;
+  {
+    rlog::file::async_file_logger logger(file, rlog::file::async_file_options(), nullptr, nullptr);
+    BOOST_REQUIRE_EQUAL(logger.init(nullptr), rerr::success);
+    for (int i = 0; i < 1000; ++i) {
+      const auto batch = make_batch("batch " + std::to_string(i) + ";");
+      expected.append(reinterpret_cast<const char*>(batch->preamble_begin()), batch->buffer_filled_size());
+      BOOST_CHECK_EQUAL(logger.send(batch), rerr::success);
+    }
+    // The destructor writes out whatever is still queued
+  }
+  BOOST_CHECK(read_file(file) == expected);
+  remove(file.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(async_file_logger_backpressure_and_fsync) {
+  const std::string file("async_file_logger_sync_test");
+  rlog::file::async_file_options options;
+  options.sync = rlog::file::fsync_policy::bytes;
+  options.sync_bytes = 4096;
+  options.max_queued_bytes = 1024;
+
+  const std::string payload(200, 'x');
+  size_t total = 0;
+  {
+    rlog::file::async_file_logger logger(file, options, nullptr, nullptr);
+    BOOST_REQUIRE_EQUAL(logger.init(nullptr), rerr::success);
+    for (int i = 0; i < 500; ++i) {
+      const auto batch = make_batch(payload);
+      total += batch->buffer_filled_size();
+      BOOST_CHECK_EQUAL(logger.send(batch), rerr::success);
+    }
+  }
+
+  BOOST_CHECK_EQUAL(read_file(file).size(), total);
+  remove(file.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(async_file_logger_coalesces_and_reports_stats) {
+  const std::string file("async_file_logger_stats_test");
+  rlog::file::async_file_options options;
+  options.sync = rlog::file::fsync_policy::bytes;
+  options.sync_bytes = 16 * 1024;
+  options.max_queued_bytes = 2048;
+
+  const size_t batch_size = make_batch(std::string(100, 'y'))->buffer_filled_size();
+  rlog::file::async_file_stats stats;
+  {
+    rlog::file::async_file_logger logger(file, options, nullptr, nullptr);
+    BOOST_REQUIRE_EQUAL(logger.init(nullptr), rerr::success);
+    // Four senders keep the queue full while the writer is busy writing and syncing
+    std::vector<std::thread> senders;
+    for (int t = 0; t < 4; ++t) {
+      senders.emplace_back([&logger] {
+        for (int i = 0; i < 500; ++i) logger.send(make_batch(std::string(100, 'y')));
+      });
+    }
+    for (auto& sender : senders) sender.join();
+    for (int i = 0; i < 200 && stats.batches < 2000; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      stats = logger.get_stats();
+    }
+  }
+
+  BOOST_CHECK_EQUAL(stats.batches, 2000);
+  BOOST_CHECK_EQUAL(stats.bytes, 2000 * batch_size);
+  // Batches queued during a write share the next one
+  BOOST_CHECK_LT(stats.writes, stats.batches / 2);
+  BOOST_TEST_MESSAGE("batches per write " << static_cast<double>(stats.batches) / stats.writes);
+  BOOST_CHECK_GT(stats.syncs, 0);
+  remove(file.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(async_file_logger_open_failure) {
+  rlog::file::async_file_logger logger("no_such_directory/file", rlog::file::async_file_options(), nullptr, nullptr);
+  rl::api_status status;
+  BOOST_CHECK_EQUAL(logger.init(&status), rerr::file_open_error);
+}
+
+BOOST_AUTO_TEST_CASE(file_logger_rotates_segments_by_size) {
+  const std::string file("segmented_file_logger_test");
+  for (size_t i = 0; i < 8; ++i) remove(rlog::file::segment_file_name(file, i).c_str());
+
+  rlog::file::segment_options segments;
+  segments.max_bytes = 100;
+  std::vector<std::string> messages;
+  {
+    rlog::file::file_logger logger(file, nullptr, segments);
+    BOOST_REQUIRE_EQUAL(logger.init(nullptr), rerr::success);
+    for (int i = 0; i < 5; ++i) {
+      // 8 byte preamble and 40 byte body, two fit into a segment
+      const auto msg = make_message(static_cast<uint16_t>(i + 1), std::string(39, 'a' + i) + ";");
+      messages.emplace_back(reinterpret_cast<const char*>(msg->preamble_begin()), msg->buffer_filled_size());
+      BOOST_CHECK_EQUAL(logger.send(msg), rerr::success);
+    }
+  }
+
+  BOOST_CHECK(!file_exists(file));
+  BOOST_CHECK(!file_exists(rlog::file::segment_file_name(file, 3)));
+  const size_t expected_counts[] = { 2, 2, 1 };
+  size_t next_message = 0;
+  for (size_t seq = 0; seq < 3; ++seq) {
+    const auto name = rlog::file::segment_file_name(file, seq);
+    std::ifstream in(name, std::ios::binary);
+    rlog::file::segment_trailer trailer;
+    std::vector<rlog::file::index_entry> entries;
+    BOOST_REQUIRE(rlog::file::read_segment_index(in, trailer, entries));
+    BOOST_REQUIRE_EQUAL(entries.size(), expected_counts[seq]);
+
+    std::string expected;
+    for (const auto& entry : entries) {
+      BOOST_CHECK_EQUAL(entry.offset, expected.size());
+      BOOST_CHECK_EQUAL(entry.msg_type, next_message + 1);
+      BOOST_CHECK_EQUAL(entry.msg_size, 40);
+      BOOST_CHECK_EQUAL(entry.event_count, 0);
+      expected += messages[next_message++];
+    }
+    BOOST_CHECK_EQUAL(trailer.index_offset, expected.size());
+    BOOST_CHECK(read_file(name).substr(0, expected.size()) == expected);
+    remove(name.c_str());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(async_file_logger_continues_after_existing_segments) {
+  const std::string file("segmented_async_file_logger_test");
+  for (size_t i = 0; i < 8; ++i) remove(rlog::file::segment_file_name(file, i).c_str());
+
+  rlog::file::async_file_options options;
+  options.segments.max_bytes = 1024;
+  for (int run = 0; run < 2; ++run) {
+    rlog::file::async_file_logger logger(file, options, nullptr, nullptr);
+    BOOST_REQUIRE_EQUAL(logger.init(nullptr), rerr::success);
+    for (int i = 0; i < 10; ++i) {
+      BOOST_CHECK_EQUAL(logger.send(make_message(2, std::string(200, 'z'))), rerr::success);
+    }
+  }
+
+  // 208 byte messages, four per segment and three segments per run
+  size_t total = 0;
+  for (size_t seq = 0; seq < 6; ++seq) {
+    const auto name = rlog::file::segment_file_name(file, seq);
+    std::ifstream in(name, std::ios::binary);
+    rlog::file::segment_trailer trailer;
+    std::vector<rlog::file::index_entry> entries;
+    BOOST_REQUIRE(rlog::file::read_segment_index(in, trailer, entries));
+    total += entries.size();
+    in.close();
+    remove(name.c_str());
+  }
+  BOOST_CHECK_EQUAL(total, 20);
+  BOOST_CHECK(!file_exists(rlog::file::segment_file_name(file, 6)));
+}
+
+BOOST_AUTO_TEST_CASE(segment_index_rejects_unindexed_files) {
+  std::istringstream empty("");
+  std::istringstream legacy(std::string(100, 'x'));
+  rlog::file::segment_trailer trailer;
+  std::vector<rlog::file::index_entry> entries;
+  BOOST_CHECK(!rlog::file::read_segment_index(empty, trailer, entries));
+  BOOST_CHECK(!rlog::file::read_segment_index(legacy, trailer, entries));
+}
+
+BOOST_AUTO_TEST_CASE(segment_index_describes_flatbuffer_batches) {
+  const std::string file("indexed_file_logger_test");
+  remove_segments(file);
+
+  rlog::file::segment_options segments;
+  segments.max_bytes = 1 << 20;
+  {
+    rlog::file::file_logger logger(file, nullptr, segments);
+    BOOST_REQUIRE_EQUAL(logger.init(nullptr), rerr::success);
+    // Client times out of order, sub seconds in 0.1 microseconds
+    const auto batch = make_ranking_batch("event-", { make_time(5, 5000000), make_time(5, 1234567), make_time(6, 0) });
+    BOOST_CHECK_EQUAL(logger.send(batch), rerr::success);
+    BOOST_CHECK_EQUAL(logger.send(make_message(2, "not a flatbuffer")), rerr::success);
+  }
+
+  const auto name = rlog::file::segment_file_name(file, 0);
+  std::vector<rlog::file::index_entry> entries;
+  BOOST_REQUIRE(read_index(name, entries));
+  BOOST_REQUIRE_EQUAL(entries.size(), 2);
+  BOOST_CHECK_EQUAL(entries[0].msg_type, rlog::fb_collection_serializer<rl::ranking_event>::message_id());
+  BOOST_CHECK_EQUAL(entries[0].event_count, 3);
+  BOOST_CHECK_EQUAL(entries[0].min_client_time, FIRST_SECOND_US + 123456);
+  BOOST_CHECK_EQUAL(entries[0].max_client_time, FIRST_SECOND_US + 1000000);
+  BOOST_CHECK_EQUAL(entries[1].event_count, 0);
+  BOOST_CHECK_EQUAL(entries[1].min_client_time, 0);
+  remove(name.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(file_logger_rotates_segments_by_age) {
+  const std::string file("aged_file_logger_test");
+  remove_segments(file);
+
+  rlog::file::segment_options segments;
+  segments.max_age = std::chrono::milliseconds(200);
+  {
+    rlog::file::file_logger logger(file, nullptr, segments);
+    BOOST_REQUIRE_EQUAL(logger.init(nullptr), rerr::success);
+    BOOST_CHECK_EQUAL(logger.send(make_message(1, "first")), rerr::success);
+    BOOST_CHECK_EQUAL(logger.send(make_message(1, "second")), rerr::success);
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    // The segment is too old now, the next message starts a new one
+    BOOST_CHECK_EQUAL(logger.send(make_message(1, "third")), rerr::success);
+  }
+
+  const size_t expected_counts[] = { 2, 1 };
+  for (size_t seq = 0; seq < 2; ++seq) {
+    const auto name = rlog::file::segment_file_name(file, seq);
+    std::vector<rlog::file::index_entry> entries;
+    BOOST_REQUIRE(read_index(name, entries));
+    BOOST_CHECK_EQUAL(entries.size(), expected_counts[seq]);
+    remove(name.c_str());
+  }
+  BOOST_CHECK(!file_exists(rlog::file::segment_file_name(file, 2)));
+}
+
+BOOST_AUTO_TEST_CASE(convert_segment_to_text_stops_at_the_index) {
+  const std::string file("converted_file_logger_test");
+  remove_segments(file);
+
+  rlog::file::segment_options segments;
+  segments.max_bytes = 1 << 20;
+  {
+    rlog::file::file_logger logger(file, nullptr, segments);
+    BOOST_REQUIRE_EQUAL(logger.init(nullptr), rerr::success);
+    BOOST_CHECK_EQUAL(logger.send(make_ranking_batch("first-", { make_time(5, 1234567), make_time(5, 2000000) })), rerr::success);
+    BOOST_CHECK_EQUAL(logger.send(make_ranking_batch("second-", { make_time(6, 0) })), rerr::success);
+  }
+
+  const auto name = rlog::file::segment_file_name(file, 0);
+  std::ostringstream text;
+  rl::joiner::convert_segment_to_text(name, text);
+  const auto output = text.str();
+  BOOST_CHECK(output.find("Segment: messages [2], events [3]") != std::string::npos);
+  BOOST_CHECK(output.find("id [first-0]") != std::string::npos);
+  BOOST_CHECK(output.find("id [first-1]") != std::string::npos);
+  BOOST_CHECK(output.find("id [second-0]") != std::string::npos);
+  // The index footer is not read as a message
+  size_t interactions = 0;
+  for (auto pos = output.find("Int: "); pos != std::string::npos; pos = output.find("Int: ", pos + 1)) ++interactions;
+  BOOST_CHECK_EQUAL(interactions, 3);
+  remove(name.c_str());
+}
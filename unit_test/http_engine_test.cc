@@ -0,0 +1,316 @@
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE Main
+#endif
+#include <boost/test/unit_test.hpp>
+
+#ifdef __linux__
+#include "utility/http_engine.h"
+#include "api_status.h"
+#include "err_constants.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace u = reinforcement_learning::utility;
+namespace r = reinforcement_learning;
+
+namespace {
+  // Blocking HTTP/1.1 server on 127.0.0.1, one thread per connection.  The responder returns the raw response for
+  // a request, an empty string closes the connection without answering.  HTTP/1.0 responses close after writing.
+  class loopback_server {
+  public:
+    using responder_fn = std::function<std::string(const std::string& head, const std::string& body)>;
+
+    explicit loopback_server(responder_fn responder) : _responder(std::move(responder)) {
+      _listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+      sockaddr_in addr{};
+      addr.sin_family = AF_INET;
+      addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+      addr.sin_port = 0;
+      bind(_listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+      socklen_t len = sizeof(addr);
+      getsockname(_listen_fd, reinterpret_cast<sockaddr*>(&addr), &len);
+      _port = ntohs(addr.sin_port);
+      listen(_listen_fd, 64);
+      _accept_thread = std::thread([this] { accept_loop(); });
+    }
+
+    ~loopback_server() {
+      _stop = true;
+      shutdown(_listen_fd, SHUT_RDWR);
+      ::close(_listen_fd);
+      _accept_thread.join();
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto fd : _client_fds) shutdown(fd, SHUT_RDWR);
+      }
+      for (auto& t : _client_threads) t.join();
+    }
+
+    std::string url(const std::string& path = "/hub/messages?timeout=60") const {
+      return "http://127.0.0.1:" + std::to_string(_port) + path;
+    }
+
+    int accepted() const { return _accepted; }
+
+    std::vector<std::string> heads() {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return _heads;
+    }
+
+  private:
+    void accept_loop() {
+      while (!_stop) {
+        const int fd = accept(_listen_fd, nullptr, nullptr);
+        if (fd < 0) return;
+        ++_accepted;
+        std::lock_guard<std::mutex> lock(_mutex);
+        _client_fds.push_back(fd);
+        _client_threads.emplace_back([this, fd] { serve(fd); });
+      }
+    }
+
+    void serve(int fd) {
+      std::string in;
+      char buf[4096];
+      while (true) {
+        const auto head_end = in.find("\r\n\r\n");
+        if (head_end == std::string::npos) {
+          const auto n = ::read(fd, buf, sizeof(buf));
+          if (n <= 0) break;
+          in.append(buf, n);
+          continue;
+        }
+        const auto head = in.substr(0, head_end);
+        size_t length = 0;
+        const auto cl = head.find("Content-Length: ");
+        if (cl != std::string::npos) length = std::stoul(head.substr(cl + 16));
+        while (in.size() < head_end + 4 + length) {
+          const auto n = ::read(fd, buf, sizeof(buf));
+          if (n <= 0) break;
+          in.append(buf, n);
+        }
+        if (in.size() < head_end + 4 + length) break;
+        const auto body = in.substr(head_end + 4, length);
+        in.erase(0, head_end + 4 + length);
+        {
+          std::lock_guard<std::mutex> lock(_mutex);
+          _heads.push_back(head);
+        }
+
+        const auto response = _responder(head, body);
+        if (response.empty() || send(fd, response.data(), response.size(), MSG_NOSIGNAL) < 0) break;
+        if (response.compare(0, 8, "HTTP/1.0") == 0) break;
+      }
+      ::close(fd);
+    }
+
+    responder_fn _responder;
+    int _listen_fd = -1;
+    int _port = 0;
+    std::atomic<bool> _stop{ false };
+    std::atomic<int> _accepted{ 0 };
+    std::thread _accept_thread;
+    std::mutex _mutex;
+    std::vector<int> _client_fds;
+    std::vector<std::thread> _client_threads;
+    std::vector<std::string> _heads;
+  };
+
+  struct result {
+    std::string error;
+    u::http_engine_response response;
+  };
+
+  std::future<result> send(u::http_engine& engine, const std::string& method, const std::string& body) {
+    auto promise = std::make_shared<std::promise<result>>();
+    auto data = std::make_shared<std::string>(body);
+    u::http_engine_request request;
+    request.method = method;
+    request.headers.emplace_back("Content-Type", "application/atom+xml;type=entry;charset=utf-8");
+    request.body = reinterpret_cast<const unsigned char*>(data->data());
+    request.body_size = data->size();
+    request.body_owner = data;
+    engine.submit(std::move(request), [promise](const std::string& error, u::http_engine_response& response) {
+      promise->set_value({ error, std::move(response) });
+    });
+    return promise->get_future();
+  }
+
+  std::future<result> post(u::http_engine& engine, const std::string& body) {
+    return send(engine, "POST", body);
+  }
+
+  std::string body_of(const result& r) {
+    return std::string(r.response.body.begin(), r.response.body.end());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(http_engine_post_and_keep_alive) {
+  loopback_server server([](const std::string&, const std::string& body) {
+    return "HTTP/1.1 201 Created\r\nContent-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+  });
+
+  u::http_engine_options options;
+  options.max_connections = 1;
+  u::http_engine engine(server.url(), options, nullptr);
+  r::api_status status;
+  BOOST_REQUIRE_EQUAL(engine.init(&status), r::error_code::success);
+
+  for (int i = 0; i < 5; ++i) {
+    const auto body = "batch " + std::to_string(i);
+    const auto r = post(engine, body).get();
+    BOOST_CHECK(r.error.empty());
+    BOOST_CHECK_EQUAL(r.response.status_code, 201);
+    BOOST_CHECK_EQUAL(body_of(r), body);
+  }
+
+  // All requests went over one pooled connection
+  BOOST_CHECK_EQUAL(server.accepted(), 1);
+  const auto stats = engine.get_stats();
+  BOOST_CHECK_EQUAL(stats.requests, 5);
+  BOOST_CHECK_EQUAL(stats.connections_opened, 1);
+  BOOST_CHECK_EQUAL(stats.connections_reused, 4);
+
+  const auto heads = server.heads();
+  BOOST_REQUIRE_EQUAL(heads.size(), 5);
+  BOOST_CHECK_EQUAL(heads[0].substr(0, heads[0].find("\r\n")), "POST /hub/messages?timeout=60 HTTP/1.1");
+  BOOST_CHECK(heads[0].find("Host: 127.0.0.1:") != std::string::npos);
+  BOOST_CHECK(heads[0].find("Content-Length: 7") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(http_engine_concurrent_requests_use_the_pool) {
+  loopback_server server([](const std::string&, const std::string&) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    return std::string("HTTP/1.1 201 Created\r\nContent-Length: 0\r\n\r\n");
+  });
+
+  u::http_engine_options options;
+  options.max_connections = 4;
+  u::http_engine engine(server.url(), options, nullptr);
+  BOOST_REQUIRE_EQUAL(engine.init(nullptr), r::error_code::success);
+
+  std::vector<std::future<result>> results;
+  for (int i = 0; i < 20; ++i) results.push_back(post(engine, "event"));
+  for (auto& f : results) {
+    const auto r = f.get();
+    BOOST_CHECK(r.error.empty());
+    BOOST_CHECK_EQUAL(r.response.status_code, 201);
+  }
+  BOOST_CHECK_EQUAL(server.accepted(), 4);
+}
+
+BOOST_AUTO_TEST_CASE(http_engine_chunked_and_close_delimited_responses) {
+  std::atomic<int> calls{ 0 };
+  loopback_server server([&calls](const std::string&, const std::string&) {
+    if (calls++ == 0) {
+      return std::string("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n5\r\nhello\r\n7;ext=1\r\n, world\r\n0\r\n\r\n");
+    }
+    return std::string("HTTP/1.0 200 OK\r\n\r\nuntil close");
+  });
+
+  u::http_engine engine(server.url(), u::http_engine_options(), nullptr);
+  BOOST_REQUIRE_EQUAL(engine.init(nullptr), r::error_code::success);
+
+  const auto chunked = post(engine, "a").get();
+  BOOST_CHECK(chunked.error.empty());
+  BOOST_CHECK_EQUAL(body_of(chunked), "hello, world");
+
+  // Without a length the body runs until the server closes the connection
+  const auto until_close = post(engine, "b").get();
+  BOOST_CHECK(until_close.error.empty());
+  BOOST_CHECK_EQUAL(body_of(until_close), "until close");
+  BOOST_CHECK_EQUAL(engine.get_stats().connections_reused, 1);
+}
+
+BOOST_AUTO_TEST_CASE(http_engine_retries_idempotent_request_on_stale_pooled_connection) {
+  std::atomic<int> calls{ 0 };
+  loopback_server server([&calls](const std::string&, const std::string&) {
+    // The first connection serves one response and is then dropped by the server while it sits in the pool
+    if (calls++ == 1) return std::string();
+    return std::string("HTTP/1.1 201 Created\r\nContent-Length: 0\r\n\r\n");
+  });
+
+  u::http_engine_options options;
+  options.max_connections = 1;
+  u::http_engine engine(server.url(), options, nullptr);
+  BOOST_REQUIRE_EQUAL(engine.init(nullptr), r::error_code::success);
+
+  BOOST_CHECK(send(engine, "GET", "").get().error.empty());
+  const auto r = send(engine, "GET", "").get();
+  BOOST_CHECK(r.error.empty());
+  BOOST_CHECK_EQUAL(r.response.status_code, 201);
+  BOOST_CHECK_EQUAL(engine.get_stats().connections_opened, 2);
+  BOOST_CHECK_EQUAL(server.heads().size(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(http_engine_does_not_replay_a_post_the_server_received) {
+  std::atomic<int> calls{ 0 };
+  loopback_server server([&calls](const std::string&, const std::string&) {
+    // The server reads the second request in full and drops the connection without answering
+    if (calls++ == 1) return std::string();
+    return std::string("HTTP/1.1 201 Created\r\nContent-Length: 0\r\n\r\n");
+  });
+
+  u::http_engine_options options;
+  options.max_connections = 1;
+  u::http_engine engine(server.url(), options, nullptr);
+  BOOST_REQUIRE_EQUAL(engine.init(nullptr), r::error_code::success);
+
+  BOOST_CHECK(post(engine, "first").get().error.empty());
+  // Whether the server acted on it is unknown, the caller's retry policy decides
+  BOOST_CHECK(!post(engine, "second").get().error.empty());
+  BOOST_CHECK_EQUAL(server.heads().size(), 2);
+
+  const auto r = post(engine, "third").get();
+  BOOST_CHECK(r.error.empty());
+  BOOST_CHECK_EQUAL(r.response.status_code, 201);
+  BOOST_CHECK_EQUAL(server.heads().size(), 3);
+  BOOST_CHECK_EQUAL(engine.get_stats().connections_opened, 2);
+}
+
+BOOST_AUTO_TEST_CASE(http_engine_request_timeout) {
+  loopback_server server([](const std::string&, const std::string&) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    return std::string("HTTP/1.1 201 Created\r\nContent-Length: 0\r\n\r\n");
+  });
+
+  u::http_engine_options options;
+  options.timeout = std::chrono::milliseconds(100);
+  u::http_engine engine(server.url(), options, nullptr);
+  BOOST_REQUIRE_EQUAL(engine.init(nullptr), r::error_code::success);
+
+  const auto start = std::chrono::steady_clock::now();
+  const auto r = post(engine, "slow").get();
+  BOOST_CHECK(!r.error.empty());
+  BOOST_CHECK(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(400));
+}
+
+BOOST_AUTO_TEST_CASE(http_engine_connection_refused_and_bad_url) {
+  u::http_engine bad("ftp://example.com", u::http_engine_options(), nullptr);
+  r::api_status status;
+  BOOST_CHECK_EQUAL(bad.init(&status), r::error_code::invalid_argument);
+
+  int port;
+  {
+    loopback_server server([](const std::string&, const std::string&) { return std::string(); });
+    port = std::stoi(server.url("").substr(17));
+  }
+  u::http_engine engine("http://127.0.0.1:" + std::to_string(port) + "/", u::http_engine_options(), nullptr);
+  BOOST_REQUIRE_EQUAL(engine.init(nullptr), r::error_code::success);
+  BOOST_CHECK(!post(engine, "nobody listens").get().error.empty());
+}
+#endif
@@ -0,0 +1,103 @@
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE Main
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include "vw_model/model_cache.h"
+
+using namespace reinforcement_learning::model_management;
+
+BOOST_AUTO_TEST_CASE(model_cache_keeps_newest_first) {
+  model_cache<int> cache(3, 1000);
+  cache.add("a", 1, 10);
+  cache.add("b", 2, 10);
+  cache.add("c", 3, 10);
+
+  const std::vector<std::string> expected = { "c", "b", "a" };
+  const auto versions = cache.versions();
+  BOOST_CHECK_EQUAL_COLLECTIONS(versions.begin(), versions.end(), expected.begin(), expected.end());
+
+  std::string previous;
+  BOOST_CHECK(cache.get_previous("c", previous));
+  BOOST_CHECK_EQUAL(previous, "b");
+  BOOST_CHECK(!cache.get_previous("a", previous));
+
+  int model = 0;
+  BOOST_CHECK(cache.get("b", model));
+  BOOST_CHECK_EQUAL(model, 2);
+  BOOST_CHECK(!cache.get("x", model));
+}
+
+BOOST_AUTO_TEST_CASE(model_cache_re_add_moves_to_front) {
+  model_cache<int> cache(3, 1000);
+  cache.add("a", 1, 10);
+  cache.add("b", 2, 10);
+  cache.add("a", 3, 20);
+
+  BOOST_CHECK_EQUAL(cache.size(), 2);
+  BOOST_CHECK_EQUAL(cache.bytes(), 30);
+  std::string latest;
+  BOOST_CHECK(cache.get_latest(latest));
+  BOOST_CHECK_EQUAL(latest, "a");
+  int model = 0;
+  BOOST_CHECK(cache.get("a", model));
+  BOOST_CHECK_EQUAL(model, 3);
+}
+
+BOOST_AUTO_TEST_CASE(model_cache_evicts_by_count_but_keeps_active) {
+  model_cache<int> cache(2, 1000);
+  cache.add("a", 1, 10);
+  cache.set_active("a");
+  cache.add("b", 2, 10);
+  cache.add("c", 3, 10);
+
+  // "b" is the oldest entry that is not active
+  const std::vector<std::string> expected = { "c", "a" };
+  const auto versions = cache.versions();
+  BOOST_CHECK_EQUAL_COLLECTIONS(versions.begin(), versions.end(), expected.begin(), expected.end());
+
+  // Moving off "a" lets it go
+  cache.set_active("c");
+  cache.add("d", 4, 10);
+  const std::vector<std::string> expected_after = { "d", "c" };
+  const auto versions_after = cache.versions();
+  BOOST_CHECK_EQUAL_COLLECTIONS(versions_after.begin(), versions_after.end(), expected_after.begin(), expected_after.end());
+}
+
+BOOST_AUTO_TEST_CASE(model_cache_evicts_by_bytes) {
+  model_cache<int> cache(10, 100);
+  cache.add("a", 1, 40);
+  cache.add("b", 2, 40);
+  cache.set_active("b");
+  cache.add("c", 3, 40);
+
+  BOOST_CHECK_EQUAL(cache.size(), 2);
+  BOOST_CHECK_EQUAL(cache.bytes(), 80);
+
+  // A single model over budget is still retained while it is the newest
+  cache.add("huge", 4, 500);
+  const std::vector<std::string> expected = { "huge", "b" };
+  const auto versions = cache.versions();
+  BOOST_CHECK_EQUAL_COLLECTIONS(versions.begin(), versions.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(model_cache_keeps_loads_of_the_same_model_id_apart) {
+  using cache_t = model_cache<int>;
+  cache_t cache(3, 1000);
+  cache.add(cache_t::make_version("N/A", 1), 1, 10);
+  cache.add(cache_t::make_version("m@2", 2), 2, 10);
+  cache.add(cache_t::make_version("N/A", 3), 3, 10);
+
+  const std::vector<std::string> expected = { "N/A@3", "m@2@2", "N/A@1" };
+  const auto versions = cache.versions();
+  BOOST_CHECK_EQUAL_COLLECTIONS(versions.begin(), versions.end(), expected.begin(), expected.end());
+
+  // A model id selects the newest load of that model
+  std::string version;
+  BOOST_CHECK(cache.get_latest_of("N/A", version));
+  BOOST_CHECK_EQUAL(version, "N/A@3");
+  BOOST_CHECK(cache.get_latest_of("m@2", version));
+  BOOST_CHECK_EQUAL(version, "m@2@2");
+  BOOST_CHECK(!cache.get_latest_of("m", version));
+}
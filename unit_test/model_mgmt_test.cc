@@ -11,11 +11,14 @@
 #include "constants.h"
 #include "api_status.h"
 #include "err_constants.h"
+#include <atomic>
+#include <cstdio>
 #include <regex>
 #include "utility/periodic_background_proc.h"
 #include "model_mgmt/model_downloader.h"
 #include "model_mgmt/data_callback_fn.h"
 #include "model_mgmt/restapi_data_transport.h"
+#include "model_mgmt/byte_pipe.h"
 #include "mock_http_client.h"
 #include "config_utility.h"
 #include "configuration.h"
@@ -133,6 +136,237 @@ BOOST_AUTO_TEST_CASE(mock_azure_storage_model_data)
 }
 #endif //_WIN32 (http_server http protocol issues in linux)
 
+namespace {
+  // In-process stand-in for blob storage.  Each GET sleeps in proportion to the bytes it returns, which emulates a
+  // per connection bandwidth cap.
+  class ranged_blob {
+  public:
+    ranged_blob(size_t size, bool accept_ranges) : _accept_ranges(accept_ranges), _last_modified(::utility::datetime::utc_now().to_string()) {
+      for (size_t i = 0; i < size; ++i) _blob.push_back(static_cast<char>(i % 251));
+    }
+
+    void install(mock_http_client* client) {
+      client->set_responder(methods::HEAD, [this](const http_request&, http_response& resp) {
+        ++heads;
+        if (fail_first_heads-- > 0) {
+          resp.set_status_code(head_failure);
+          return;
+        }
+        resp.set_status_code(status_codes::OK);
+        resp.headers().add(U("Last-Modified"), _last_modified);
+        if (_accept_ranges) resp.headers().add(U("Accept-Ranges"), U("bytes"));
+        resp.headers().set_content_length(_blob.size());
+      });
+      client->set_responder(methods::GET, [this](const http_request& request, http_response& resp) {
+        ++gets;
+        size_t begin = 0;
+        size_t end = _blob.size() - 1;
+        const auto range = request.headers().find(U("Range"));
+        if (range != request.headers().end()) {
+          ++range_gets;
+          if (fail_first_range_gets-- > 0) {
+            resp.set_status_code(status_codes::ServiceUnavailable);
+            return;
+          }
+          if (ignore_ranges) {
+            resp.set_status_code(status_codes::OK);
+          }
+          else {
+            const auto spec = ::utility::conversions::to_utf8string(range->second);
+            sscanf(spec.c_str(), "bytes=%zu-%zu", &begin, &end);
+            resp.set_status_code(status_codes::PartialContent);
+          }
+        }
+        else {
+          if (fail_first_gets-- > 0) {
+            resp.set_status_code(status_codes::ServiceUnavailable);
+            return;
+          }
+          resp.set_status_code(status_codes::OK);
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds((end - begin + 1) / 10));
+        resp.headers().add(U("Last-Modified"), _last_modified);
+        resp.set_body(std::vector<unsigned char>(_blob.begin() + begin, _blob.begin() + end + 1));
+      });
+    }
+
+    bool matches(const m::model_data& md) const {
+      return md.data_sz() == _blob.size() && std::equal(_blob.begin(), _blob.end(), md.data());
+    }
+
+    bool matches(const std::vector<char>& data) const {
+      return data == _blob;
+    }
+
+    std::atomic<int> heads{ 0 };
+    std::atomic<int> gets{ 0 };
+    std::atomic<int> range_gets{ 0 };
+    std::atomic<int> fail_first_range_gets{ 0 };
+    std::atomic<int> fail_first_heads{ 0 };
+    std::atomic<int> fail_first_gets{ 0 };
+    // Answers Range requests with the whole blob although HEAD advertises Accept-Ranges
+    bool ignore_ranges = false;
+    status_code head_failure = status_codes::ServiceUnavailable;
+
+  private:
+    std::vector<char> _blob;
+    const bool _accept_ranges;
+    const ::utility::string_t _last_modified;
+  };
+}
+
+BOOST_AUTO_TEST_CASE(restapi_ranged_download) {
+  auto http_client = new mock_http_client("http://test.com");
+  ranged_blob blob(10000, true);
+  blob.install(http_client);
+  m::restapi_data_transport transport(http_client, nullptr, 4, 0, 1000);
+
+  m::model_data md;
+  BOOST_CHECK_EQUAL(transport.get_data(md), r::error_code::success);
+  BOOST_CHECK(blob.matches(md));
+  BOOST_CHECK_EQUAL(md.refresh_count(), 1);
+  BOOST_CHECK_EQUAL(blob.range_gets, 4);
+
+  // Unchanged blob is not downloaded again
+  BOOST_CHECK_EQUAL(transport.get_data(md), r::error_code::success);
+  BOOST_CHECK_EQUAL(blob.gets, 4);
+}
+
+BOOST_AUTO_TEST_CASE(restapi_ranged_download_retries_failed_range) {
+  auto http_client = new mock_http_client("http://test.com");
+  ranged_blob blob(10000, true);
+  blob.fail_first_range_gets = 2;
+  blob.install(http_client);
+  m::restapi_data_transport transport(http_client, nullptr, 4, 2, 1000);
+
+  m::model_data md;
+  BOOST_CHECK_EQUAL(transport.get_data(md), r::error_code::success);
+  BOOST_CHECK(blob.matches(md));
+  BOOST_CHECK_EQUAL(blob.range_gets, 6);
+}
+
+BOOST_AUTO_TEST_CASE(restapi_ranged_download_gives_up) {
+  auto http_client = new mock_http_client("http://test.com");
+  ranged_blob blob(10000, true);
+  blob.fail_first_range_gets = 100;
+  blob.install(http_client);
+  m::restapi_data_transport transport(http_client, nullptr, 4, 1, 1000);
+
+  m::model_data md;
+  r::api_status status;
+  BOOST_CHECK_EQUAL(transport.get_data(md, &status), r::error_code::model_range_download_error);
+  BOOST_CHECK_EQUAL(md.data_sz(), 0);
+  BOOST_CHECK_EQUAL(md.refresh_count(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(restapi_ranged_download_falls_back_to_single_stream) {
+  auto http_client = new mock_http_client("http://test.com");
+  ranged_blob blob(10000, false);
+  blob.install(http_client);
+  m::restapi_data_transport transport(http_client, nullptr, 4, 0, 1000);
+
+  m::model_data md;
+  BOOST_CHECK_EQUAL(transport.get_data(md), r::error_code::success);
+  BOOST_CHECK(blob.matches(md));
+  BOOST_CHECK_EQUAL(blob.gets, 1);
+  BOOST_CHECK_EQUAL(blob.range_gets, 0);
+}
+
+BOOST_AUTO_TEST_CASE(restapi_ranged_download_falls_back_when_ranges_are_ignored) {
+  auto http_client = new mock_http_client("http://test.com");
+  ranged_blob blob(10000, true);
+  blob.ignore_ranges = true;
+  blob.install(http_client);
+  m::restapi_data_transport transport(http_client, nullptr, 4, 3, 1000);
+
+  m::model_data md;
+  BOOST_CHECK_EQUAL(transport.get_data(md), r::error_code::success);
+  BOOST_CHECK(blob.matches(md));
+  BOOST_CHECK_EQUAL(md.refresh_count(), 1);
+  // Ranges are not retried, the blob comes from one more plain GET
+  BOOST_CHECK_EQUAL(blob.range_gets, 4);
+  BOOST_CHECK_EQUAL(blob.gets, 5);
+}
+
+BOOST_AUTO_TEST_CASE(restapi_retries_server_errors) {
+  auto http_client = new mock_http_client("http://test.com");
+  ranged_blob blob(10000, false);
+  blob.fail_first_heads = 2;
+  blob.install(http_client);
+  const auto policy = std::make_shared<r::utility::retry_policy>(std::chrono::milliseconds(1), std::chrono::milliseconds(5), 0, std::chrono::seconds(1));
+  m::restapi_data_transport transport(http_client, nullptr, 1, 0, 1000, 3, policy);
+
+  m::model_data md;
+  BOOST_CHECK_EQUAL(transport.get_data(md), r::error_code::success);
+  BOOST_CHECK(blob.matches(md));
+  BOOST_CHECK_EQUAL(blob.heads, 3);
+  BOOST_CHECK_EQUAL(transport.get_retry_stats().retries, 2);
+}
+
+BOOST_AUTO_TEST_CASE(restapi_does_not_retry_client_errors) {
+  auto http_client = new mock_http_client("http://test.com");
+  ranged_blob blob(10000, false);
+  blob.fail_first_heads = 1;
+  blob.head_failure = status_codes::NotFound;
+  blob.install(http_client);
+  m::restapi_data_transport transport(http_client, nullptr, 1, 0, 1000, 3);
+
+  m::model_data md;
+  r::api_status status;
+  BOOST_CHECK_EQUAL(transport.get_data(md, &status), r::error_code::http_bad_status_code);
+  BOOST_CHECK_EQUAL(blob.heads, 1);
+  BOOST_CHECK_EQUAL(transport.get_retry_stats().retries, 0);
+}
+
+BOOST_AUTO_TEST_CASE(restapi_streamed_download) {
+  auto http_client = new mock_http_client("http://test.com");
+  ranged_blob blob(100000, false);
+  blob.install(http_client);
+  m::restapi_data_transport transport(http_client, nullptr);
+
+  // A small pipe forces the transport to wait for the reader
+  const auto pipe = std::make_shared<m::byte_pipe>(1024);
+  bool updated = false;
+  BOOST_CHECK_EQUAL(transport.get_data_streamed(pipe, updated), r::error_code::success);
+  BOOST_CHECK(updated);
+
+  std::vector<char> received;
+  char chunk[100];
+  int64_t n;
+  while ((n = pipe->read(chunk, sizeof(chunk))) > 0) received.insert(received.end(), chunk, chunk + n);
+  BOOST_CHECK_EQUAL(n, 0);
+  BOOST_CHECK(blob.matches(received));
+
+  // Nothing new to stream
+  const auto second_pipe = std::make_shared<m::byte_pipe>(1024);
+  BOOST_CHECK_EQUAL(transport.get_data_streamed(second_pipe, updated), r::error_code::success);
+  BOOST_CHECK(!updated);
+  BOOST_CHECK_EQUAL(blob.gets, 1);
+}
+
+BOOST_AUTO_TEST_CASE(restapi_streamed_download_retries_server_errors) {
+  auto http_client = new mock_http_client("http://test.com");
+  ranged_blob blob(100000, false);
+  blob.fail_first_gets = 2;
+  blob.install(http_client);
+  const auto policy = std::make_shared<r::utility::retry_policy>(std::chrono::milliseconds(1), std::chrono::milliseconds(5), 0, std::chrono::seconds(1));
+  m::restapi_data_transport transport(http_client, nullptr, 1, 0, 1000, 3, policy);
+
+  const auto pipe = std::make_shared<m::byte_pipe>(1024);
+  bool updated = false;
+  BOOST_CHECK_EQUAL(transport.get_data_streamed(pipe, updated), r::error_code::success);
+  BOOST_CHECK(updated);
+
+  std::vector<char> received;
+  char chunk[100];
+  int64_t n;
+  while ((n = pipe->read(chunk, sizeof(chunk))) > 0) received.insert(received.end(), chunk, chunk + n);
+  BOOST_CHECK_EQUAL(n, 0);
+  BOOST_CHECK(blob.matches(received));
+  BOOST_CHECK_EQUAL(blob.gets, 3);
+  BOOST_CHECK_EQUAL(transport.get_retry_stats().retries, 2);
+}
+
 void register_local_file_factory();
 const char * const DUMMY_DATA_TRANSPORT = "DUMMY_DATA_TRANSPORT";
 const char * const CFG_PARAM = "model.local.file";
@@ -194,3 +428,34 @@ int dummy_data_tranport_create( m::i_data_transport** retval,
 void register_local_file_factory() {
   r::data_transport_factory.register_type(DUMMY_DATA_TRANSPORT, dummy_data_tranport_create);
 }
+
+namespace {
+  struct stream_context {
+    size_t bytes = 0;
+    int streams = 0;
+  };
+
+  void count_data(const m::model_data&, stream_context*) {}
+
+  void count_stream(m::byte_pipe& pipe, stream_context* ctxt) {
+    char chunk[64];
+    int64_t n;
+    while ((n = pipe.read(chunk, sizeof(chunk))) > 0) ctxt->bytes += n;
+    ++ctxt->streams;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(model_downloader_streams_to_callback) {
+  register_local_file_factory();
+  m::i_data_transport* data_transport;
+  BOOST_CHECK_EQUAL(r::data_transport_factory.create(&data_transport, DUMMY_DATA_TRANSPORT, u::configuration()), r::error_code::success);
+  std::unique_ptr<m::i_data_transport> transport(data_transport);
+
+  // The dummy transport only implements get_data, the default get_data_streamed adapts it
+  stream_context ctxt;
+  m::data_callback_fn dfn(count_data, count_stream, &ctxt);
+  m::model_downloader downloader(transport.get(), &dfn, nullptr, 4);
+  BOOST_CHECK_EQUAL(downloader.run_iteration(nullptr), r::error_code::success);
+  BOOST_CHECK_EQUAL(ctxt.streams, 1);
+  BOOST_CHECK_EQUAL(ctxt.bytes, 10);
+}
@@ -0,0 +1,71 @@
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE Main
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include "err_constants.h"
+#include "vw_model/pdf_extractor.h"
+
+#include <thread>
+#include <vector>
+
+using namespace reinforcement_learning;
+namespace m = reinforcement_learning::model_management;
+
+BOOST_AUTO_TEST_CASE(pdf_extract_basic) {
+  auto const context = R"({"Shared":{"t":"abc"}, "_multi":[{"Action":{"c":1}},{"Action":{"c":2}}],"p":[0.4, 0.6]})";
+  std::vector<int> action_ids;
+  std::vector<float> pdf;
+  BOOST_CHECK_EQUAL(m::extract_pdf(context, action_ids, pdf, nullptr), error_code::success);
+  BOOST_REQUIRE_EQUAL(pdf.size(), 2);
+  BOOST_CHECK_EQUAL(action_ids[0], 0);
+  BOOST_CHECK_EQUAL(action_ids[1], 1);
+  BOOST_CHECK_CLOSE(pdf[0], 0.4f, 0.0001f);
+  BOOST_CHECK_CLOSE(pdf[1], 0.6f, 0.0001f);
+}
+
+BOOST_AUTO_TEST_CASE(pdf_extract_skips_nested_values) {
+  // Nested "p" keys, brackets inside strings and escaped quotes must not confuse the scanner.
+  auto const context = R"({
+    "p_like":{"p":[1.0]},
+    "_multi":[ {"s":"a]}\"{["}, {"p":[0.5,0.5]}, {"n":[true, null, -1e5]} ],
+    "p" : [ 0.2 , 0.3 , 0.5 ]
+  })";
+  std::vector<int> action_ids;
+  std::vector<float> pdf;
+  BOOST_CHECK_EQUAL(m::extract_pdf(context, action_ids, pdf, nullptr), error_code::success);
+  BOOST_REQUIRE_EQUAL(pdf.size(), 3);
+  BOOST_CHECK_CLOSE(pdf[2], 0.5f, 0.0001f);
+  BOOST_CHECK_EQUAL(action_ids[2], 2);
+}
+
+BOOST_AUTO_TEST_CASE(pdf_extract_errors) {
+  std::vector<int> action_ids;
+  std::vector<float> pdf;
+  BOOST_CHECK_EQUAL(m::extract_pdf(R"({"_multi":[{},{}]})", action_ids, pdf, nullptr), error_code::json_no_pdf_found);
+  BOOST_CHECK_EQUAL(m::extract_pdf(R"({"_multi":[{},{}],"p":[]})", action_ids, pdf, nullptr), error_code::json_no_pdf_found);
+  BOOST_CHECK_EQUAL(m::extract_pdf(R"({"_multi":[{},{},{}],"p":[0.5,0.5]})", action_ids, pdf, nullptr), error_code::json_pdf_size_mismatch);
+  BOOST_CHECK_EQUAL(m::extract_pdf(R"({"_multi":[{},{})", action_ids, pdf, nullptr), error_code::json_parse_error);
+  BOOST_CHECK_EQUAL(m::extract_pdf(R"({"p":[0.5,"x"]})", action_ids, pdf, nullptr), error_code::json_parse_error);
+  BOOST_CHECK_EQUAL(m::extract_pdf(R"([0.5])", action_ids, pdf, nullptr), error_code::json_parse_error);
+}
+
+BOOST_AUTO_TEST_CASE(pdf_extract_concurrent) {
+  auto const context = R"({"_multi":[{"a":1},{"a":2},{"a":3}],"p":[0.1, 0.2, 0.7]})";
+  std::vector<std::thread> threads;
+  std::vector<int> failures(8, 0);
+  for (size_t t = 0; t < failures.size(); ++t) {
+    threads.emplace_back([&, t]() {
+      std::vector<int> action_ids;
+      std::vector<float> pdf;
+      for (int i = 0; i < 1000; ++i) {
+        if (m::extract_pdf(context, action_ids, pdf, nullptr) != error_code::success || pdf.size() != 3) {
+          ++failures[t];
+        }
+      }
+    });
+  }
+  for (auto& t : threads) t.join();
+  for (auto f : failures) BOOST_CHECK_EQUAL(f, 0);
+}
@@ -0,0 +1,74 @@
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE Main
+#endif
+#include <boost/test/unit_test.hpp>
+#include "utility/retry_scheduler.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace u = reinforcement_learning::utility;
+using std::chrono::milliseconds;
+
+BOOST_AUTO_TEST_CASE(retry_policy_backoff_bounds) {
+  u::retry_policy policy(milliseconds(10), milliseconds(200), 0, milliseconds(1000));
+  milliseconds previous(0);
+  for (int i = 0; i < 50; ++i) {
+    milliseconds delay;
+    BOOST_CHECK(policy.next_retry(previous, delay));
+    // Decorrelated jitter stays between the base delay and three times the previous delay, capped by the max
+    BOOST_CHECK_GE(delay.count(), 10);
+    BOOST_CHECK_LE(delay.count(), (std::min)(200ll, 3 * (std::max)(10ll, static_cast<long long>(previous.count()))));
+    previous = delay;
+  }
+  BOOST_CHECK_EQUAL(policy.get_stats().retries, 50);
+  BOOST_CHECK_EQUAL(policy.get_stats().budget_exhausted, 0);
+}
+
+BOOST_AUTO_TEST_CASE(retry_policy_budget_per_window) {
+  u::retry_policy policy(milliseconds(0), milliseconds(0), 3, milliseconds(50));
+  milliseconds delay;
+  for (int i = 0; i < 3; ++i) {
+    BOOST_CHECK(policy.next_retry(milliseconds(0), delay));
+  }
+  BOOST_CHECK(!policy.next_retry(milliseconds(0), delay));
+  BOOST_CHECK_EQUAL(policy.get_stats().budget_exhausted, 1);
+
+  // The budget is restored once the window has passed
+  std::this_thread::sleep_for(milliseconds(60));
+  BOOST_CHECK(policy.next_retry(milliseconds(0), delay));
+  BOOST_CHECK_EQUAL(policy.get_stats().retries, 4);
+}
+
+BOOST_AUTO_TEST_CASE(retry_scheduler_runs_in_due_order) {
+  u::retry_scheduler scheduler;
+  std::atomic<int> order{ 0 };
+  std::atomic<int> late{ -1 };
+  std::atomic<int> early{ -1 };
+  scheduler.schedule(milliseconds(40), [&]() { late = order++; });
+  scheduler.schedule(milliseconds(10), [&]() { early = order++; });
+
+  for (int i = 0; i < 1000 && order < 2; ++i) {
+    std::this_thread::sleep_for(milliseconds(1));
+  }
+  BOOST_CHECK_EQUAL(early, 0);
+  BOOST_CHECK_EQUAL(late, 1);
+  BOOST_CHECK_EQUAL(scheduler.pending(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(retry_scheduler_flushes_on_destruction) {
+  std::atomic<bool> ran{ false };
+  {
+    u::retry_scheduler scheduler;
+    scheduler.schedule(std::chrono::hours(1), [&ran]() { ran = true; });
+  }
+  BOOST_CHECK(ran);
+}
+
+BOOST_AUTO_TEST_CASE(retry_scheduler_is_shared) {
+  const auto first = u::retry_scheduler::shared();
+  const auto second = u::retry_scheduler::shared();
+  BOOST_CHECK_EQUAL(first.get(), second.get());
+}
@@ -110,3 +110,24 @@ BOOST_AUTO_TEST_CASE(factory_with_empty_model) {
     BOOST_CHECK_EQUAL_COLLECTIONS(ranking.begin(), ranking.end(), ranking_expected.begin(), ranking_expected.end());
   }
 }
+
+BOOST_AUTO_TEST_CASE(factory_with_master) {
+  const auto json = R"({"a":{"0":1,"5":2},"_multi":[{"b":{"0":1}},{"b":{"0":2}},{"b":{"0":3}}]})";
+  std::vector<float> ranking_expected = { .8f, .1f, .1f };
+
+  std::shared_ptr<safe_vw> master(new safe_vw((const char*)cb_data_5_model, cb_data_5_model_len));
+  versioned_object_pool<safe_vw, safe_vw_factory> pool(new safe_vw_factory(master), 2);
+
+  // Seeded objects share the master weights and report the master model id
+  pooled_vw vw(pool, pool.get_or_create());
+  BOOST_CHECK_EQUAL(std::string(vw->id()), std::string(master->id()));
+  // Only the master holds the dense weights, which are allocated whole whatever the file carries
+  BOOST_CHECK_GT(master->weights_bytes(), cb_data_5_model_len);
+  BOOST_CHECK_EQUAL(vw->weights_bytes(), 0);
+
+  std::vector<int> actions;
+  std::vector<float> ranking;
+  vw->rank(json, actions, ranking);
+
+  BOOST_CHECK_EQUAL_COLLECTIONS(ranking.begin(), ranking.end(), ranking_expected.begin(), ranking_expected.end());
+}
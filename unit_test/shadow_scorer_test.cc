@@ -0,0 +1,171 @@
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE Main
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include "err_constants.h"
+#include "explore_internal.h"
+#include "hash.h"
+#include "ranking_response.h"
+#include "shadow_scorer.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+
+using namespace reinforcement_learning;
+namespace m = reinforcement_learning::model_management;
+
+namespace {
+  // Shadow model returning a fixed pdf.  Optionally blocks until released to simulate a slow model.
+  class fixed_pdf_model : public m::i_model {
+  public:
+    fixed_pdf_model(std::vector<float> pdf, std::atomic<bool>* release = nullptr) : _pdf(std::move(pdf)), _release(release) {}
+
+    int update(const m::model_data& data, bool& model_ready, api_status* status = nullptr) override {
+      model_ready = true;
+      return error_code::success;
+    }
+
+    int choose_rank(uint64_t rnd_seed, const char* features, std::vector<int>& action_ids, std::vector<float>& action_pdf, std::string& model_version, api_status* status = nullptr) override {
+      while (_release != nullptr && !*_release) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      action_ids.clear();
+      for (size_t i = 0; i < _pdf.size(); ++i) action_ids.push_back(static_cast<int>(i));
+      action_pdf = _pdf;
+      model_version = "shadow";
+      return error_code::success;
+    }
+
+    int request_decision(const std::vector<const char*>&, const char*, std::vector<std::vector<uint32_t>>&, std::vector<std::vector<float>>&, std::string&, api_status* = nullptr) override {
+      return error_code::not_supported;
+    }
+
+    int request_slates_decision(const char*, uint32_t, const char*, std::vector<std::vector<uint32_t>>&, std::vector<std::vector<float>>&, std::string&, api_status* = nullptr) override {
+      return error_code::not_supported;
+    }
+
+  private:
+    std::vector<float> _pdf;
+    std::atomic<bool>* _release;
+  };
+
+  void make_primary(ranking_response& response, size_t chosen) {
+    response.push_back(0, chosen == 0 ? 1.f : 0.f);
+    response.push_back(1, chosen == 1 ? 1.f : 0.f);
+    response.set_chosen_action_id(chosen);
+  }
+
+  shadow_stats wait_for_scored(shadow_scorer& scorer, uint64_t expected) {
+    for (int i = 0; i < 2000; ++i) {
+      const auto stats = scorer.get_stats();
+      if (stats.scored + stats.failed >= expected) return stats;
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return scorer.get_stats();
+  }
+}
+
+BOOST_AUTO_TEST_CASE(shadow_not_ready_before_model_update) {
+  shadow_scorer scorer(new fixed_pdf_model({ 1.f, 0.f }), 1, 16, 1.f, nullptr);
+  BOOST_CHECK_EQUAL(scorer.init(), error_code::success);
+
+  ranking_response primary;
+  make_primary(primary, 0);
+  BOOST_CHECK(!scorer.try_enqueue("1", 1, "{}", primary));
+  BOOST_CHECK_EQUAL(scorer.get_stats().enqueued, 0);
+}
+
+BOOST_AUTO_TEST_CASE(shadow_divergence_stats) {
+  shadow_scorer scorer(new fixed_pdf_model({ 1.f, 0.f }), 2, 16, 1.f, nullptr);
+  BOOST_CHECK_EQUAL(scorer.init(), error_code::success);
+  m::model_data data;
+  BOOST_CHECK_EQUAL(scorer.update_model(data), error_code::success);
+
+  ranking_response agree;
+  make_primary(agree, 0);
+  ranking_response disagree;
+  make_primary(disagree, 1);
+
+  BOOST_CHECK(scorer.try_enqueue("1", 1, "{}", agree));
+  BOOST_CHECK(scorer.try_enqueue("2", 2, "{}", disagree));
+
+  const auto stats = wait_for_scored(scorer, 2);
+  BOOST_CHECK_EQUAL(stats.enqueued, 2);
+  BOOST_CHECK_EQUAL(stats.scored, 2);
+  BOOST_CHECK_EQUAL(stats.failed, 0);
+  BOOST_CHECK_EQUAL(stats.chosen_action_matches, 1);
+  BOOST_CHECK_CLOSE(stats.total_variation_sum, 1.0, 0.001);
+  BOOST_CHECK_CLOSE(stats.total_variation_max, 1.f, 0.001);
+}
+
+BOOST_AUTO_TEST_CASE(shadow_queue_drops_under_load) {
+  std::atomic<bool> release{ false };
+  const size_t queue_size = 4;
+  shadow_scorer scorer(new fixed_pdf_model({ 1.f, 0.f }, &release), 1, queue_size, 1.f, nullptr);
+  BOOST_CHECK_EQUAL(scorer.init(), error_code::success);
+  m::model_data data;
+  BOOST_CHECK_EQUAL(scorer.update_model(data), error_code::success);
+
+  ranking_response primary;
+  make_primary(primary, 0);
+
+  // The single worker is stuck in the model, so at most queue_size + 1 requests can be accepted.
+  size_t accepted = 0;
+  for (int i = 0; i < 100; ++i) {
+    if (scorer.try_enqueue(std::to_string(i).c_str(), i, "{}", primary)) ++accepted;
+  }
+  BOOST_CHECK_LE(accepted, queue_size + 1);
+  BOOST_CHECK_EQUAL(scorer.get_stats().dropped, 100 - accepted);
+
+  release = true;
+  const auto stats = wait_for_scored(scorer, accepted);
+  BOOST_CHECK_EQUAL(stats.scored, accepted);
+}
+
+BOOST_AUTO_TEST_CASE(shadow_sampling_is_deterministic) {
+  shadow_scorer scorer(new fixed_pdf_model({ 1.f, 0.f }), 1, 1024, 0.f, nullptr);
+  BOOST_CHECK_EQUAL(scorer.init(), error_code::success);
+  m::model_data data;
+  BOOST_CHECK_EQUAL(scorer.update_model(data), error_code::success);
+
+  ranking_response primary;
+  make_primary(primary, 0);
+  for (int i = 0; i < 100; ++i) {
+    BOOST_CHECK(!scorer.try_enqueue(std::to_string(i).c_str(), i, "{}", primary));
+  }
+  BOOST_CHECK_EQUAL(scorer.get_stats().enqueued, 0);
+}
+
+BOOST_AUTO_TEST_CASE(shadow_sampling_is_independent_of_the_decision) {
+  const float sample_rate = 0.25f;
+  const int events = 4000;
+  shadow_scorer scorer(new fixed_pdf_model({ 1.f, 0.f }), 1, events, sample_rate, nullptr);
+  BOOST_CHECK_EQUAL(scorer.init(), error_code::success);
+  m::model_data data;
+  BOOST_CHECK_EQUAL(scorer.update_model(data), error_code::success);
+
+  // The primary draws its action from the seed of the event id as live_model does, uniformly over two actions
+  int chosen[2] = { 0, 0 };
+  int sampled[2] = { 0, 0 };
+  for (int i = 0; i < events; ++i) {
+    const auto event_id = "event-" + std::to_string(i);
+    const auto seed = uniform_hash(event_id.c_str(), event_id.size(), 0);
+    const size_t action = exploration::uniform_random_merand48(seed) < 0.5f ? 0 : 1;
+    ranking_response primary;
+    make_primary(primary, action);
+    ++chosen[action];
+    if (scorer.try_enqueue(event_id.c_str(), seed, "{}", primary)) ++sampled[action];
+  }
+
+  BOOST_CHECK_CLOSE_FRACTION(static_cast<float>(sampled[0] + sampled[1]) / events, sample_rate, 0.1);
+  for (int action = 0; action < 2; ++action) {
+    BOOST_REQUIRE_GT(chosen[action], events / 4);
+    BOOST_CHECK_CLOSE_FRACTION(static_cast<float>(sampled[action]) / chosen[action], sample_rate, 0.15);
+  }
+  BOOST_CHECK_EQUAL(scorer.get_stats().dropped, 0);
+}
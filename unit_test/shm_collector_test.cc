@@ -0,0 +1,100 @@
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE Main
+#endif
+#include <boost/test/unit_test.hpp>
+
+#ifdef __linux__
+#include "collector.h"
+#include "logger/shm/shm_ring.h"
+#include "api_status.h"
+#include "configuration.h"
+#include "constants.h"
+#include "err_constants.h"
+#include "factory_resolver.h"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace r = reinforcement_learning;
+namespace shm = reinforcement_learning::logger::shm;
+
+namespace {
+  const char* const RECORDING_SENDER = "shm_collector_test_sender";
+
+  std::mutex received_mutex;
+  std::vector<std::string> received;
+
+  class recording_sender : public r::i_sender {
+  public:
+    int init(r::api_status*) override { return r::error_code::success; }
+
+  protected:
+    int v_send(const buffer& data, r::api_status*) override {
+      std::lock_guard<std::mutex> lock(received_mutex);
+      received.emplace_back(reinterpret_cast<const char*>(data->body_begin()), data->body_filled_size());
+      return r::error_code::success;
+    }
+  };
+
+  size_t received_count() {
+    std::lock_guard<std::mutex> lock(received_mutex);
+    return received.size();
+  }
+}
+
+BOOST_AUTO_TEST_CASE(shm_collector_drains_the_whole_backlog_of_an_exited_process) {
+  r::sender_factory.register_type(RECORDING_SENDER,
+    [](r::i_sender** retval, const r::utility::configuration&, r::error_callback_fn*, r::i_trace*, r::api_status*) {
+      *retval = new recording_sender();
+      return r::error_code::success;
+    });
+  const auto prefix = "rltest_collector" + std::to_string(getpid());
+  const auto name = prefix + ".interaction.1.0";
+  // More than the collector reads from one ring at a time
+  const int records = 600;
+
+  const auto child = fork();
+  if (child == 0) {
+    std::unique_ptr<shm::shm_ring> ring;
+    if (shm::shm_ring::create(name, 64 * 1024, ring, nullptr, nullptr) != r::error_code::success) _exit(1);
+    for (int i = 0; i < records; ++i) {
+      // 8 byte preamble and the body
+      const auto record = std::string(8, '\0') + "batch " + std::to_string(i);
+      if (!ring->try_write(reinterpret_cast<const uint8_t*>(record.data()), record.size())) _exit(2);
+    }
+    // Exits without closing the ring, like a crashed worker
+    _exit(0);
+  }
+  int child_status = 0;
+  waitpid(child, &child_status, 0);
+  BOOST_REQUIRE(WIFEXITED(child_status) && WEXITSTATUS(child_status) == 0);
+
+  r::utility::configuration config;
+  config.set(r::name::INTERACTION_SENDER_IMPLEMENTATION, RECORDING_SENDER);
+  config.set(r::name::OBSERVATION_SENDER_IMPLEMENTATION, RECORDING_SENDER);
+  collector c(config, prefix, std::chrono::microseconds(1000));
+  BOOST_REQUIRE(c.init());
+  std::atomic<bool> stop{ false };
+  std::thread runner([&c, &stop] { c.run(stop); });
+  for (int i = 0; i < 300 && !shm::shm_ring::list(prefix + ".").empty(); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  stop = true;
+  runner.join();
+
+  // Removed only once everything was read
+  BOOST_CHECK(shm::shm_ring::list(prefix + ".").empty());
+  BOOST_REQUIRE_EQUAL(received_count(), records);
+  for (int i = 0; i < records; ++i) BOOST_CHECK_EQUAL(received[i], "batch " + std::to_string(i));
+  shm::shm_ring::unlink(name);
+}
+#endif
@@ -0,0 +1,162 @@
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE Main
+#endif
+#include <boost/test/unit_test.hpp>
+
+#ifdef __linux__
+#include "logger/shm/shm_ring.h"
+#include "logger/shm/shm_sender.h"
+#include "utility/data_buffer_streambuf.h"
+#include "api_status.h"
+#include "err_constants.h"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace r = reinforcement_learning;
+namespace shm = reinforcement_learning::logger::shm;
+
+namespace {
+  std::string test_ring_name(const std::string& test) {
+    return "rltest." + test + "." + std::to_string(getpid());
+  }
+
+  std::vector<std::string> drain(shm::shm_ring& ring) {
+    std::vector<std::string> records;
+    ring.read([&records](const uint8_t* data, size_t size) {
+      records.emplace_back(reinterpret_cast<const char*>(data), size);
+    });
+    return records;
+  }
+
+  bool write(shm::shm_ring& ring, const std::string& record) {
+    return ring.try_write(reinterpret_cast<const uint8_t*>(record.data()), record.size());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(shm_ring_round_trip_and_wrap) {
+  const auto name = test_ring_name("wrap");
+  std::unique_ptr<shm::shm_ring> producer;
+  std::unique_ptr<shm::shm_ring> consumer;
+  r::api_status status;
+  BOOST_REQUIRE_EQUAL(shm::shm_ring::create(name, 4096, producer, nullptr, &status), r::error_code::success);
+  BOOST_REQUIRE_EQUAL(shm::shm_ring::open(name, consumer, nullptr, &status), r::error_code::success);
+  BOOST_CHECK_EQUAL(consumer->capacity(), 4096);
+  BOOST_CHECK(consumer->empty());
+
+  // Odd sizes move the records around the ring so that they pad at the end many times
+  for (int i = 0; i < 500; ++i) {
+    const std::string a(100 + i % 37, static_cast<char>('a' + i % 26));
+    const std::string b(7 + i % 13, static_cast<char>('A' + i % 26));
+    BOOST_REQUIRE(write(*producer, a));
+    BOOST_REQUIRE(write(*producer, b));
+    const auto records = drain(*consumer);
+    BOOST_REQUIRE_EQUAL(records.size(), 2);
+    BOOST_CHECK(records[0] == a);
+    BOOST_CHECK(records[1] == b);
+  }
+  BOOST_CHECK(consumer->empty());
+  shm::shm_ring::unlink(name);
+}
+
+BOOST_AUTO_TEST_CASE(shm_ring_full_and_oversized) {
+  const auto name = test_ring_name("full");
+  std::unique_ptr<shm::shm_ring> ring;
+  BOOST_REQUIRE_EQUAL(shm::shm_ring::create(name, 4096, ring, nullptr, nullptr), r::error_code::success);
+
+  BOOST_CHECK(!write(*ring, std::string(ring->max_record_size() + 1, 'x')));
+  const std::string record(1000, 'y');
+  int written = 0;
+  while (write(*ring, record)) ++written;
+  BOOST_CHECK_EQUAL(written, 4);
+
+  // Reading frees the space again
+  BOOST_CHECK_EQUAL(drain(*ring).size(), 4);
+  BOOST_CHECK(write(*ring, record));
+  shm::shm_ring::unlink(name);
+}
+
+BOOST_AUTO_TEST_CASE(shm_ring_concurrent_producers) {
+  const auto name = test_ring_name("threads");
+  std::unique_ptr<shm::shm_ring> ring;
+  BOOST_REQUIRE_EQUAL(shm::shm_ring::create(name, 64 * 1024, ring, nullptr, nullptr), r::error_code::success);
+
+  const int threads = 4;
+  const int per_thread = 20000;
+  std::vector<std::thread> producers;
+  for (int t = 0; t < threads; ++t) {
+    producers.emplace_back([&ring, t] {
+      for (int i = 0; i < per_thread; ++i) {
+        const auto record = std::to_string(t) + ":" + std::to_string(i) + std::string(i % 50, '.');
+        while (!write(*ring, record)) std::this_thread::yield();
+      }
+    });
+  }
+
+  // Records of one producer arrive in its order
+  std::map<int, int> next;
+  int total = 0;
+  while (total < threads * per_thread) {
+    for (const auto& record : drain(*ring)) {
+      const auto t = std::stoi(record.substr(0, record.find(':')));
+      const auto i = std::stoi(record.substr(record.find(':') + 1));
+      BOOST_REQUIRE_EQUAL(i, next[t]);
+      next[t] = i + 1;
+      ++total;
+    }
+  }
+  for (auto& p : producers) p.join();
+  BOOST_CHECK(ring->empty());
+  shm::shm_ring::unlink(name);
+}
+
+BOOST_AUTO_TEST_CASE(shm_sender_across_processes) {
+  const auto name = test_ring_name("sender");
+  const int batches = 1000;
+
+  const auto child = fork();
+  if (child == 0) {
+    // The sender marks the ring closed when it goes out of scope
+    const auto result = [&name] {
+      shm::shm_sender sender(name, 16 * 1024, std::chrono::milliseconds(5000), nullptr);
+      if (sender.init(nullptr) != r::error_code::success) return 1;
+      for (int i = 0; i < batches; ++i) {
+        const auto db = std::make_shared<r::utility::data_buffer>();
+        r::utility::data_buffer_streambuf sbuff(db.get());
+        std::ostream message(&sbuff);
+        message << "batch " << i;
+        sbuff.finalize();
+        if (sender.send(db) != r::error_code::success) return 2;
+      }
+      return 0;
+    }();
+    _exit(result);
+  }
+
+  std::unique_ptr<shm::shm_ring> ring;
+  while (shm::shm_ring::open(name, ring, nullptr, nullptr) != r::error_code::success) std::this_thread::yield();
+  int received = 0;
+  while (received < batches) {
+    for (const auto& record : drain(*ring)) {
+      // Preamble followed by the body
+      BOOST_REQUIRE_GT(record.size(), 8);
+      BOOST_CHECK_EQUAL(record.substr(8), "batch " + std::to_string(received));
+      ++received;
+    }
+  }
+
+  int child_status = 0;
+  waitpid(child, &child_status, 0);
+  BOOST_CHECK(WIFEXITED(child_status) && WEXITSTATUS(child_status) == 0);
+  BOOST_CHECK(ring->producer_closed());
+  BOOST_CHECK(!ring->owner_alive());
+  shm::shm_ring::unlink(name);
+}
+#endif
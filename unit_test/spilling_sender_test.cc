@@ -0,0 +1,305 @@
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE Main
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include "logger/spill/spilling_sender.h"
+#include "logger/file/segment_index.h"
+#include "logger/preamble.h"
+#include "utility/data_buffer_streambuf.h"
+#include "api_status.h"
+#include "err_constants.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace rl = reinforcement_learning;
+namespace rlog = reinforcement_learning::logger;
+namespace rspill = reinforcement_learning::logger::spill;
+namespace rerr = reinforcement_learning::error_code;
+namespace rutil = reinforcement_learning::utility;
+
+namespace {
+  // Keeps what it is sent, and can be told to be full or to fail
+  class controlled_sender : public rl::i_sender {
+  public:
+    struct state {
+      std::mutex mutex;
+      std::vector<std::string> sent;
+      std::atomic<bool> full{ false };
+      std::atomic<bool> failing{ false };
+      bool windowed = true;
+      size_t capacity = SIZE_MAX;  // full once it has been sent this many batches
+      std::vector<rl::i_sender::undelivered_fn> handlers;
+
+      std::vector<std::string> get() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return sent;
+      }
+
+      // Gives up on a batch it accepted, like an asynchronous sender after its retries
+      bool give_up(const rl::i_sender::buffer& data) {
+        for (const auto& handler : handlers) {
+          if (handler(data)) return true;
+        }
+        return false;
+      }
+    };
+
+    explicit controlled_sender(std::shared_ptr<state> state) : _state(std::move(state)) {}
+
+    int init(rl::api_status*) override { return rerr::success; }
+    float window_occupancy() const override {
+      if (!_state->windowed) return -1.f;
+      return _state->full || _state->get().size() >= _state->capacity ? 1.f : 0.f;
+    }
+    void add_undelivered_handler(undelivered_fn handler) override { _state->handlers.push_back(std::move(handler)); }
+
+  protected:
+    int v_send(const buffer& data, rl::api_status* status) override {
+      if (_state->failing) {
+        RETURN_ERROR_LS(nullptr, status, http_bad_status_code) << "failing on purpose";
+      }
+      std::lock_guard<std::mutex> lock(_state->mutex);
+      _state->sent.emplace_back(reinterpret_cast<const char*>(data->preamble_begin()), data->buffer_filled_size());
+      return rerr::success;
+    }
+
+  private:
+    std::shared_ptr<state> _state;
+  };
+
+  rl::i_sender::buffer make_message(const std::string& content) {
+    rl::i_sender::buffer db(new rutil::data_buffer());
+    rutil::data_buffer_streambuf sbuff(db.get());
+    std::ostream message(&sbuff);
+    message << content;
+    sbuff.finalize();
+    rlog::preamble pre;
+    pre.msg_type = 1;
+    pre.msg_size = static_cast<uint32_t>(db->body_filled_size());
+    pre.write_to_bytes(db->preamble_begin(), db->preamble_size());
+    return db;
+  }
+
+  std::string wire(const rl::i_sender::buffer& db) {
+    return std::string(reinterpret_cast<const char*>(db->preamble_begin()), db->buffer_filled_size());
+  }
+
+  void remove_spill_log(const std::string& base_directory) {
+    for (const auto& directory : { base_directory, base_directory + ".1" }) {
+      for (size_t i = 0; i < 32; ++i) remove(rlog::file::segment_file_name(directory + "/spill", i).c_str());
+      remove((directory + "/cursor").c_str());
+      remove((directory + "/lock").c_str());
+      remove(directory.c_str());
+    }
+  }
+
+  std::vector<std::string> wait_for_sent(controlled_sender::state& state, size_t count) {
+    for (int i = 0; i < 300 && state.get().size() < count; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return state.get();
+  }
+
+  rspill::spilling_sender_options test_options() {
+    rspill::spilling_sender_options options;
+    options.log.segment_bytes = 200;  // a few batches per segment
+    options.poll_interval = std::chrono::milliseconds(1);
+    options.retry_base_delay = std::chrono::milliseconds(5);
+    options.retry_max_delay = std::chrono::milliseconds(20);
+    return options;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(spilling_sender_replays_in_order_once_the_window_frees) {
+  const std::string directory("spilling_sender_window_test");
+  remove_spill_log(directory);
+  auto state = std::make_shared<controlled_sender::state>();
+  state->full = true;
+
+  std::vector<std::string> expected;
+  {
+    rspill::spilling_sender sender(new controlled_sender(state), directory, test_options(), nullptr, nullptr);
+    BOOST_REQUIRE_EQUAL(sender.init(nullptr), rerr::success);
+    for (int i = 0; i < 6; ++i) {
+      const auto msg = make_message("batch " + std::to_string(i) + std::string(40, 'x'));
+      expected.push_back(wire(msg));
+      BOOST_CHECK_EQUAL(sender.send(msg), rerr::success);
+    }
+    BOOST_CHECK(state->get().empty());
+    auto stats = sender.get_stats();
+    BOOST_CHECK_EQUAL(stats.spilled_batches, 6);
+    BOOST_CHECK_GT(stats.backlog_bytes, 0);
+
+    // Room again, a new batch still queues behind the backlog
+    state->full = false;
+    const auto last = make_message("last");
+    expected.push_back(wire(last));
+    BOOST_CHECK_EQUAL(sender.send(last), rerr::success);
+
+    BOOST_CHECK(wait_for_sent(*state, expected.size()) == expected);
+    for (int i = 0; i < 100 && sender.get_stats().replayed_batches < expected.size(); ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    stats = sender.get_stats();
+    BOOST_CHECK_EQUAL(stats.backlog_bytes, 0);
+    BOOST_CHECK_EQUAL(stats.replayed_batches, expected.size());
+    BOOST_CHECK_EQUAL(stats.dropped_batches, 0);
+
+    // Caught up, batches go straight to the destination
+    const auto direct = make_message("direct");
+    expected.push_back(wire(direct));
+    BOOST_CHECK_EQUAL(sender.send(direct), rerr::success);
+    BOOST_CHECK(state->get() == expected);
+  }
+  remove_spill_log(directory);
+}
+
+BOOST_AUTO_TEST_CASE(spilling_sender_retries_failed_sends) {
+  const std::string directory("spilling_sender_failure_test");
+  remove_spill_log(directory);
+  auto state = std::make_shared<controlled_sender::state>();
+  state->windowed = false;
+  state->failing = true;
+
+  rspill::spilling_sender sender(new controlled_sender(state), directory, test_options(), nullptr, nullptr);
+  BOOST_REQUIRE_EQUAL(sender.init(nullptr), rerr::success);
+  std::vector<std::string> expected;
+  for (int i = 0; i < 3; ++i) {
+    const auto msg = make_message("batch " + std::to_string(i));
+    expected.push_back(wire(msg));
+    BOOST_CHECK_EQUAL(sender.send(msg), rerr::success);
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  BOOST_CHECK(state->get().empty());
+
+  state->failing = false;
+  BOOST_CHECK(wait_for_sent(*state, expected.size()) == expected);
+  BOOST_CHECK_EQUAL(sender.get_stats().spilled_batches, 3);
+  remove_spill_log(directory);
+}
+
+BOOST_AUTO_TEST_CASE(spilling_sender_backlog_survives_a_restart) {
+  const std::string directory("spilling_sender_restart_test");
+  remove_spill_log(directory);
+  std::vector<std::string> expected;
+  {
+    auto state = std::make_shared<controlled_sender::state>();
+    state->full = true;
+    state->capacity = 3;
+    rspill::spilling_sender sender(new controlled_sender(state), directory, test_options(), nullptr, nullptr);
+    BOOST_REQUIRE_EQUAL(sender.init(nullptr), rerr::success);
+    for (int i = 0; i < 8; ++i) {
+      const auto msg = make_message("batch " + std::to_string(i) + std::string(30, 'y'));
+      expected.push_back(wire(msg));
+      BOOST_CHECK_EQUAL(sender.send(msg), rerr::success);
+    }
+    // Three get through before the first process goes away
+    state->full = false;
+    wait_for_sent(*state, 3);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    const auto sent = state->get();
+    BOOST_REQUIRE(sent == std::vector<std::string>(expected.begin(), expected.begin() + 3));
+    expected.erase(expected.begin(), expected.begin() + 3);
+  }
+
+  auto state = std::make_shared<controlled_sender::state>();
+  {
+    rspill::spilling_sender sender(new controlled_sender(state), directory, test_options(), nullptr, nullptr);
+    BOOST_REQUIRE_EQUAL(sender.init(nullptr), rerr::success);
+    BOOST_CHECK(wait_for_sent(*state, expected.size()) == expected);
+  }
+  remove_spill_log(directory);
+}
+
+BOOST_AUTO_TEST_CASE(spilling_sender_drops_batches_beyond_the_log_size) {
+  const std::string directory("spilling_sender_full_test");
+  remove_spill_log(directory);
+  auto state = std::make_shared<controlled_sender::state>();
+  state->full = true;
+  auto options = test_options();
+  options.log.max_bytes = 250;
+
+  rspill::spilling_sender sender(new controlled_sender(state), directory, options, nullptr, nullptr);
+  BOOST_REQUIRE_EQUAL(sender.init(nullptr), rerr::success);
+  // 8 byte preamble and 100 byte body, two fit
+  BOOST_CHECK_EQUAL(sender.send(make_message(std::string(100, 'a'))), rerr::success);
+  BOOST_CHECK_EQUAL(sender.send(make_message(std::string(100, 'b'))), rerr::success);
+  rl::api_status status;
+  BOOST_CHECK_EQUAL(sender.send(make_message(std::string(100, 'c')), &status), rerr::spill_log_full);
+
+  const auto stats = sender.get_stats();
+  BOOST_CHECK_EQUAL(stats.spilled_batches, 2);
+  BOOST_CHECK_EQUAL(stats.dropped_batches, 1);
+  BOOST_CHECK_EQUAL(stats.backlog_bytes, 216);
+  remove_spill_log(directory);
+}
+
+BOOST_AUTO_TEST_CASE(spilling_sender_spills_batches_the_destination_gives_up_on) {
+  const std::string directory("spilling_sender_undelivered_test");
+  remove_spill_log(directory);
+  auto state = std::make_shared<controlled_sender::state>();
+  state->windowed = false;
+
+  const auto msg = make_message("accepted, then lost");
+  {
+    rspill::spilling_sender sender(new controlled_sender(state), directory, test_options(), nullptr, nullptr);
+    BOOST_REQUIRE_EQUAL(sender.init(nullptr), rerr::success);
+    BOOST_CHECK_EQUAL(sender.send(msg), rerr::success);
+    BOOST_CHECK_EQUAL(state->get().size(), 1);
+
+    // The destination gives up on it after the send returned, replay sends it again
+    BOOST_CHECK(state->give_up(msg));
+    BOOST_CHECK(wait_for_sent(*state, 2) == std::vector<std::string>(2, wire(msg)));
+    BOOST_CHECK_EQUAL(sender.get_stats().spilled_batches, 1);
+  }
+
+  // A destination that outlives the sender has nowhere to put its batches
+  BOOST_CHECK(!state->give_up(msg));
+  remove_spill_log(directory);
+}
+
+BOOST_AUTO_TEST_CASE(spilling_senders_do_not_share_a_directory) {
+  const std::string directory("spilling_sender_shared_directory_test");
+  remove_spill_log(directory);
+  auto first_state = std::make_shared<controlled_sender::state>();
+  first_state->full = true;
+  auto second_state = std::make_shared<controlled_sender::state>();
+  second_state->full = true;
+
+  const auto first_msg = make_message("first");
+  const auto second_msg = make_message("second");
+  {
+    rspill::spilling_sender first(new controlled_sender(first_state), directory, test_options(), nullptr, nullptr);
+    BOOST_REQUIRE_EQUAL(first.init(nullptr), rerr::success);
+    rspill::spilling_sender second(new controlled_sender(second_state), directory, test_options(), nullptr, nullptr);
+    BOOST_REQUIRE_EQUAL(second.init(nullptr), rerr::success);
+    BOOST_CHECK_EQUAL(first.directory(), directory);
+    BOOST_CHECK_EQUAL(second.directory(), directory + ".1");
+
+    BOOST_CHECK_EQUAL(first.send(first_msg), rerr::success);
+    BOOST_CHECK_EQUAL(second.send(second_msg), rerr::success);
+  }
+
+  // Restarted, each directory is replayed by the sender that takes it
+  first_state = std::make_shared<controlled_sender::state>();
+  second_state = std::make_shared<controlled_sender::state>();
+  {
+    rspill::spilling_sender first(new controlled_sender(first_state), directory, test_options(), nullptr, nullptr);
+    BOOST_REQUIRE_EQUAL(first.init(nullptr), rerr::success);
+    rspill::spilling_sender second(new controlled_sender(second_state), directory, test_options(), nullptr, nullptr);
+    BOOST_REQUIRE_EQUAL(second.init(nullptr), rerr::success);
+    BOOST_CHECK(wait_for_sent(*first_state, 1) == std::vector<std::string>(1, wire(first_msg)));
+    BOOST_CHECK(wait_for_sent(*second_state, 1) == std::vector<std::string>(1, wire(second_msg)));
+  }
+  remove_spill_log(directory);
+}
@@ -0,0 +1,228 @@
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE Main
+#endif
+#include <boost/test/unit_test.hpp>
+
+#ifdef __linux__
+#include "logger/stream/stream_sender.h"
+#include "logger/preamble.h"
+#include "utility/data_buffer_streambuf.h"
+#include "api_status.h"
+#include "err_constants.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace r = reinforcement_learning;
+namespace stream = reinforcement_learning::logger::stream;
+
+namespace {
+  // Unix socket server that splits what it reads into preamble framed batches.  Each connection can be cut after a
+  // number of bytes to simulate a dropped peer.
+  class frame_server {
+  public:
+    explicit frame_server(const std::string& path, size_t cut_first_after = 0) : _path(path), _cut_after(cut_first_after) {
+      unlink(path.c_str());
+      _listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+      sockaddr_un addr{};
+      addr.sun_family = AF_UNIX;
+      strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+      bind(_listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+      listen(_listen_fd, 16);
+      _thread = std::thread([this] { run(); });
+    }
+
+    ~frame_server() {
+      _stop = true;
+      shutdown(_listen_fd, SHUT_RDWR);
+      shutdown(_client_fd, SHUT_RDWR);
+      ::close(_listen_fd);
+      _thread.join();
+      unlink(_path.c_str());
+    }
+
+    std::vector<std::string> bodies() {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return _bodies;
+    }
+
+    int connections() const { return _connections; }
+
+  private:
+    void run() {
+      while (!_stop) {
+        const int fd = accept(_listen_fd, nullptr, nullptr);
+        if (fd < 0) return;
+        _client_fd = fd;
+        const auto limit = _connections++ == 0 && _cut_after > 0 ? _cut_after : SIZE_MAX;
+        std::string in;
+        size_t total = 0;
+        char buf[4096];
+        ssize_t n;
+        while (total < limit && (n = ::read(fd, buf, std::min(sizeof(buf), limit - total))) > 0) {
+          total += n;
+          in.append(buf, n);
+          split(in);
+        }
+        _client_fd = -1;
+        ::close(fd);
+      }
+    }
+
+    void split(std::string& in) {
+      while (in.size() >= r::logger::preamble::size()) {
+        r::logger::preamble pre;
+        pre.read_from_bytes(reinterpret_cast<uint8_t*>(&in[0]), in.size());
+        const auto frame = r::logger::preamble::size() + pre.msg_size;
+        if (in.size() < frame) return;
+        std::lock_guard<std::mutex> lock(_mutex);
+        _bodies.push_back(in.substr(r::logger::preamble::size(), pre.msg_size));
+        in.erase(0, frame);
+      }
+    }
+
+    const std::string _path;
+    const size_t _cut_after;
+    int _listen_fd;
+    std::atomic<int> _client_fd{ -1 };
+    std::atomic<bool> _stop{ false };
+    std::atomic<int> _connections{ 0 };
+    std::thread _thread;
+    std::mutex _mutex;
+    std::vector<std::string> _bodies;
+  };
+
+  r::i_sender::buffer make_batch(const std::string& body) {
+    r::i_sender::buffer db(new r::utility::data_buffer());
+    r::utility::data_buffer_streambuf sbuff(db.get());
+    std::ostream message(&sbuff);
+    message << body;
+    sbuff.finalize();
+    r::logger::preamble pre;
+    pre.msg_type = 2;
+    pre.msg_size = static_cast<uint32_t>(db->body_filled_size());
+    pre.write_to_bytes(db->preamble_begin(), db->preamble_size());
+    return db;
+  }
+
+  std::string socket_path(const std::string& test) {
+    return "/tmp/rl_stream_test_" + test + "_" + std::to_string(getpid()) + ".sock";
+  }
+
+  bool wait_for(const std::function<bool()>& done) {
+    for (int i = 0; i < 500 && !done(); ++i) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    return done();
+  }
+}
+
+BOOST_AUTO_TEST_CASE(stream_address_parsing) {
+  stream::stream_address address;
+  BOOST_CHECK_EQUAL(stream::parse_stream_address("unix:/tmp/x.sock", address, nullptr, nullptr), r::error_code::success);
+  BOOST_CHECK(address.is_unix);
+  BOOST_CHECK_EQUAL(address.path, "/tmp/x.sock");
+  BOOST_CHECK_EQUAL(stream::parse_stream_address("tcp:[::1]:9000", address, nullptr, nullptr), r::error_code::success);
+  BOOST_CHECK(!address.is_unix);
+  BOOST_CHECK_EQUAL(address.host, "::1");
+  BOOST_CHECK_EQUAL(address.port, "9000");
+  BOOST_CHECK_EQUAL(stream::parse_stream_address("tcp:localhost", address, nullptr, nullptr), r::error_code::invalid_argument);
+  BOOST_CHECK_EQUAL(stream::parse_stream_address("http://x", address, nullptr, nullptr), r::error_code::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(stream_sender_writes_framed_batches) {
+  const auto path = socket_path("frames");
+  frame_server server(path);
+  stream::stream_sender sender("unix:" + path, stream::stream_sender_options(), nullptr, nullptr);
+  BOOST_REQUIRE_EQUAL(sender.init(nullptr), r::error_code::success);
+
+  for (int i = 0; i < 2000; ++i) {
+    BOOST_CHECK_EQUAL(sender.send(make_batch("batch " + std::to_string(i))), r::error_code::success);
+  }
+  BOOST_REQUIRE(wait_for([&server] { return server.bodies().size() == 2000; }));
+  const auto bodies = server.bodies();
+  for (int i = 0; i < 2000; ++i) BOOST_CHECK_EQUAL(bodies[i], "batch " + std::to_string(i));
+
+  const auto stats = sender.get_stats();
+  BOOST_CHECK_EQUAL(stats.batches, 2000);
+  BOOST_CHECK_EQUAL(stats.connects, 1);
+  // Batches queued during a write share the next one
+  BOOST_CHECK_LE(stats.writes, stats.batches);
+}
+
+BOOST_AUTO_TEST_CASE(stream_sender_buffers_until_the_peer_is_up) {
+  const auto path = socket_path("late");
+  unlink(path.c_str());
+  stream::stream_sender_options options;
+  options.reconnect_base_delay = std::chrono::milliseconds(5);
+  options.reconnect_max_delay = std::chrono::milliseconds(20);
+  stream::stream_sender sender("unix:" + path, options, nullptr, nullptr);
+  BOOST_REQUIRE_EQUAL(sender.init(nullptr), r::error_code::success);
+
+  // Nobody listens yet
+  for (int i = 0; i < 100; ++i) {
+    BOOST_CHECK_EQUAL(sender.send(make_batch("early " + std::to_string(i))), r::error_code::success);
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  BOOST_CHECK_EQUAL(sender.get_stats().connects, 0);
+
+  frame_server server(path);
+  BOOST_REQUIRE(wait_for([&server] { return server.bodies().size() == 100; }));
+  const auto bodies = server.bodies();
+  for (int i = 0; i < 100; ++i) BOOST_CHECK_EQUAL(bodies[i], "early " + std::to_string(i));
+}
+
+BOOST_AUTO_TEST_CASE(stream_sender_reconnects_after_a_cut) {
+  const auto path = socket_path("cut");
+  stream::stream_sender_options options;
+  options.reconnect_base_delay = std::chrono::milliseconds(5);
+  // The first connection is closed by the server in the middle of a batch
+  frame_server server(path, 1000);
+  stream::stream_sender sender("unix:" + path, options, nullptr, nullptr);
+  BOOST_REQUIRE_EQUAL(sender.init(nullptr), r::error_code::success);
+
+  // What the kernel accepted before the sender noticed the cut is lost, the sender finds out on its next write
+  int sent = 0;
+  const auto body = [](int i) { return std::string(64, 'c') + std::to_string(i); };
+  for (; sent < 5000 && server.connections() < 2; ++sent) {
+    BOOST_REQUIRE_EQUAL(sender.send(make_batch(body(sent))), r::error_code::success);
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+  }
+  BOOST_REQUIRE_EQUAL(server.connections(), 2);
+  for (int i = 0; i < 50; ++i, ++sent) sender.send(make_batch(body(sent)));
+
+  const auto last = body(sent - 1);
+  BOOST_REQUIRE(wait_for([&server, &last] { const auto b = server.bodies(); return !b.empty() && b.back() == last; }));
+  // Every batch that arrived is whole and in order
+  int previous = -1;
+  for (const auto& b : server.bodies()) {
+    BOOST_REQUIRE_EQUAL(b.substr(0, 64), std::string(64, 'c'));
+    const auto index = std::stoi(b.substr(64));
+    BOOST_CHECK_GT(index, previous);
+    previous = index;
+  }
+  BOOST_CHECK_GE(sender.get_stats().connects, 2);
+}
+
+BOOST_AUTO_TEST_CASE(stream_sender_bounded_buffer) {
+  stream::stream_sender_options options;
+  options.max_buffered_bytes = 1000;
+  stream::stream_sender sender("unix:" + socket_path("nobody"), options, nullptr, nullptr);
+  BOOST_REQUIRE_EQUAL(sender.init(nullptr), r::error_code::success);
+
+  int accepted = 0;
+  r::api_status status;
+  while (sender.send(make_batch(std::string(200, 'b')), &status) == r::error_code::success) ++accepted;
+  BOOST_CHECK_EQUAL(accepted, 4);
+  BOOST_CHECK_EQUAL(status.get_error_code(), r::error_code::stream_buffer_full);
+  BOOST_CHECK_EQUAL(sender.get_stats().dropped, 1);
+}
+#endif